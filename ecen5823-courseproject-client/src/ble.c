@@ -3,6 +3,42 @@
  * @brief Function definitions for handling BT events
  *******************************************************************************
  * Editor: Dec 08, 2022, Amey More
+ *
+ * Editor: Oct 19, 2026
+ * Change: Bondings are kept across reboots and disconnects, a reconnect with
+ *         a stored bonding is encrypted from its keys without pairing.
+ *
+ * Editor: Oct 19, 2026
+ * Change: With NOTIFY_MODE_ENABLE the state comes as notifications of a
+ *         sequence number and the state, only a newer snapshot is taken and
+ *         the last one is acknowledged by writing its sequence number back.
+ *
+ * Editor: Oct 19, 2026
+ * Change: The fixed connection parameters are no longer requested on open,
+ *         the server manages them.
+ *
+ * Editor: Oct 19, 2026
+ * Change: With PHY_CODED_ENABLE the client advertises on the Coded PHY and
+ *         switches between the Coded and 1M PHYs after failed connections.
+ *
+ * Editor: Oct 19, 2026
+ * Change: The advertising data carries the Heater Device or AC Device service
+ *         UUID of the build, the server provisions the client by it.
+ *
+ * Editor: Oct 19, 2026
+ * Change: With BROADCAST_MODE_ENABLE the broadcast key and slot are read once
+ *         bonded and the link is closed. The state is taken from the command
+ *         table of the server's periodic advertising train, only with a valid
+ *         MAC and a newer sequence number, and acked in the advertising data.
+ *
+ * Editor: Oct 19, 2026
+ * Change: With PROBE_ENABLE the whole service of the build is discovered, the
+ *         probe characteristic is subscribed to after the state and every
+ *         ping is echoed with the times it was taken and sent.
+ *
+ * Editor: Oct 19, 2026
+ * Change: The estimate of the time sync after a ping is kept, the server
+ *         time is taken from the sleeptimer by it for the logs.
  ******************************************************************************/
 
 #include "ble.h"
@@ -12,6 +48,8 @@
 #include "sl_bt_api.h"
 #include "em_gpio.h"
 #include "gpio.h"
+#include "mbedtls/cmac.h"
+#include "sl_sleeptimer.h"
 
 #define INCLUDE_LOG_DEBUG (1)
 #include "log.h"
@@ -21,21 +59,121 @@
 #define ADVERTISING_DURATION    (0)
 #define ADVERTISING_MAXEVENTS   (0)
 
-#define CONNECTION_MIN_INTERVAL   (75/1.25)
-#define CONNECTION_MAX_INTERVAL   (75/1.25)
-#define CONNECTION_LATENCY        (300/75)
-#define CONNECTION_TIMEOUT        (((1 + (300/75)) * (75/1.25) * 2)+(75/1.25))
-#define CONNECTION_MIN_CE         (0)
-#define CONNECTION_MAX_CE         (4)
+// Flags and the complete list of 128 bit service UUIDs, little endian
+#if (DEVICE_IS_HEATER)
+// Heater Device 21685485-b057-4cc5-bed4-f18cdfd32de3
+static const uint8_t advertising_data[] = {
+    0x02, 0x01, 0x06,
+    0x11, 0x07, 0xe3, 0x2d, 0xd3, 0xdf, 0x8c, 0xf1, 0xd4, 0xbe,
+                0xc5, 0x4c, 0x57, 0xb0, 0x85, 0x54, 0x68, 0x21
+};
+#else
+// AC Device 1032814e-7df0-4c6f-8c9f-a6735f9baa00
+static const uint8_t advertising_data[] = {
+    0x02, 0x01, 0x06,
+    0x11, 0x07, 0x00, 0xaa, 0x9b, 0x5f, 0x73, 0xa6, 0x9f, 0x8c,
+                0x6f, 0x4c, 0xf0, 0x7d, 0x4e, 0x81, 0x32, 0x10
+};
+#endif
+
+#if (NOTIFY_MODE_ENABLE)
+#define STATE_SUBSCRIPTION        (sl_bt_gatt_notification)
+#else
+#define STATE_SUBSCRIPTION        (sl_bt_gatt_indication)
+#endif
 
 sl_status_t sl_status;
 uint8_t gattCount=0;
 uint8_t temp;
 
 ble_client_data_t ble_client_data = {
-    .stateTransition = Advertising
+    .stateTransition = Advertising,
+#if (PHY_CODED_ENABLE)
+    .advertisingPhy = sl_bt_gap_phy_coded
+#else
+    .advertisingPhy = sl_bt_gap_phy_1m
+#endif
 };
 
+// Sets the advertising data, with the ack of the newest table taken while
+// synchronized to the server's train: [5, 0xFF, company, sequence number low
+// 16 bits]
+void set_advertising_data()  {
+  uint8_t data[sizeof(advertising_data) + 6];
+  uint8_t len = sizeof(advertising_data);
+
+  memcpy(data, advertising_data, len);
+
+#if (BROADCAST_MODE_ENABLE)
+  if(ble_client_data.bcastSynced && ble_client_data.bcastSeq)  {
+      data[len++] = 5;
+      data[len++] = 0xFF;
+      data[len++] = (uint8_t)BCAST_COMPANY_ID;
+      data[len++] = (uint8_t)(BCAST_COMPANY_ID >> 8);
+      data[len++] = (uint8_t)ble_client_data.bcastSeq;
+      data[len++] = (uint8_t)(ble_client_data.bcastSeq >> 8);
+  }
+#endif
+
+  sl_status = sl_bt_advertiser_set_data(ble_client_data.advertisingHandle,
+                                        0,
+                                        len,
+                                        data
+  );
+  if(sl_status != SL_STATUS_OK) {
+      LOG_ERROR("Advertiser Set Data Error 0x%x",sl_status);
+  }
+}
+
+// Restarts advertising with the data and interval of the sync state, the
+// acks go out at BCAST_ADV_INTERVAL while synchronized
+sl_status_t restart_advertising()  {
+  uint32_t interval = ble_client_data.bcastSynced ? BCAST_ADV_INTERVAL : ADVERTISING_MIN;
+
+  // Already stopped by a connection
+  sl_bt_advertiser_stop(ble_client_data.advertisingHandle);
+
+  sl_status = sl_bt_advertiser_set_timing(ble_client_data.advertisingHandle,
+                                          interval,
+                                          interval,
+                                          ADVERTISING_DURATION,
+                                          ADVERTISING_MAXEVENTS
+  );
+  if(sl_status != SL_STATUS_OK) {
+      LOG_ERROR("Advertiser Set Timing Error 0x%x",sl_status);
+  }
+
+  set_advertising_data();
+
+  return start_advertising();
+}
+
+// Starts advertising the data set on boot, as extended advertising on the
+// Coded PHY or legacy advertising on the 1M PHY
+sl_status_t start_advertising()  {
+#if (PHY_CODED_ENABLE)
+  sl_status = sl_bt_advertiser_set_phy(ble_client_data.advertisingHandle,
+                                       ble_client_data.advertisingPhy,
+                                       ble_client_data.advertisingPhy
+  );
+  if(sl_status != SL_STATUS_OK) {
+      LOG_ERROR("Advertiser Set PHY Error 0x%x",sl_status);
+  }
+
+  // Extended advertising on the Coded PHY cannot be scannable
+  if(ble_client_data.advertisingPhy == sl_bt_gap_phy_coded)  {
+      return sl_bt_advertiser_start(ble_client_data.advertisingHandle,
+                                    sl_bt_advertiser_user_data,
+                                    sl_bt_advertiser_connectable_non_scannable
+      );
+  }
+#endif
+  return sl_bt_advertiser_start(ble_client_data.advertisingHandle,
+                                sl_bt_advertiser_user_data,
+                                sl_bt_advertiser_connectable_scannable
+  );
+}
+
 // BLE Structure pointer function
 ble_client_data_t *getbleData() {
   return &ble_client_data;
@@ -75,20 +213,27 @@ void handle_bt_boot() {
       LOG_ERROR("Advertiser Set Timing Error 0x%x",sl_status);
   }
 
-  sl_status = sl_bt_sm_delete_bondings();
+  set_advertising_data();
+
+#if (BROADCAST_MODE_ENABLE)
+  sl_status = sl_bt_sync_set_parameters(BCAST_SYNC_SKIP, BCAST_SYNC_TIMEOUT, 0);
   if(sl_status != SL_STATUS_OK) {
-      LOG_ERROR("Delete Bondings Error 0x%x",sl_status);
+      LOG_ERROR("Sync Set Parameters Error 0x%x",sl_status);
   }
+#endif
 
   sl_status = sl_bt_sm_configure(0x0f, sm_io_capability_displayyesno);
   if(sl_status != SL_STATUS_OK) {
       LOG_ERROR("SM Configure Error 0x%x",sl_status);
   }
 
-  sl_status = sl_bt_advertiser_start(ble_client_data.advertisingHandle,
-                                     sl_bt_advertiser_general_discoverable,
-                                     sl_bt_advertiser_connectable_scannable
-  );
+  // Keys of the server are stored for the reconnects
+  sl_status = sl_bt_sm_set_bondable_mode(1);
+  if(sl_status != SL_STATUS_OK) {
+      LOG_ERROR("SM Set Bondable Mode Error 0x%x",sl_status);
+  }
+
+  sl_status = start_advertising();
   if(sl_status == SL_STATUS_OK) {
       displayPrintf(DISPLAY_ROW_CONNECTION, "Advertising");
   }
@@ -101,22 +246,10 @@ void handle_bt_open(sl_bt_msg_t *evt) {
   ble_client_data.connectionHandle = evt->data.evt_connection_opened.connection;
 
   sl_bt_advertiser_stop(ble_client_data.advertisingHandle);
-  sl_status =  sl_bt_connection_set_parameters ( ble_client_data.connectionHandle,
-                                                 CONNECTION_MIN_INTERVAL,
-                                                 CONNECTION_MAX_INTERVAL,
-                                                 CONNECTION_LATENCY,
-                                                 CONNECTION_TIMEOUT,
-                                                 CONNECTION_MIN_CE,
-                                                 CONNECTION_MAX_CE
-  );
 
-  if(sl_status == SL_STATUS_OK) {
-      displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
-      ble_client_data.connectionFlag = true;
-  }
-  else {
-      LOG_ERROR("Error 0x%x",sl_status);
-  }
+  // The server switches the connection parameters with the traffic
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
+  ble_client_data.connectionFlag = true;
 }
 
 void handle_bt_confirm_bonding()  {
@@ -187,7 +320,21 @@ void handle_bt_bonded() {
 void handle_bt_gatt_complete()  {
   if(gattCount == 0)  {
 
-#if (DEVICE_IS_HEATER)
+#if (PROBE_ENABLE)
+      // The probe characteristics are found along with the state one
+      sl_status = sl_bt_gatt_discover_characteristics(ble_client_data.connectionHandle,
+                                                      (DEVICE_IS_HEATER ?
+                                                          ble_client_data.HeaterServiceHandle :
+                                                          ble_client_data.ACServiceHandle)
+      );
+      if(sl_status != SL_STATUS_OK) {
+          LOG_ERROR("Discover Characteristics Error 0x%04x",sl_status);
+      }
+      else {
+          LOG_INFO("Discover Characteristics Success");
+          gattCount = 1;
+      }
+#elif (DEVICE_IS_HEATER)
       sl_status = sl_bt_gatt_discover_characteristics_by_uuid(ble_client_data.connectionHandle,
                                                               ble_client_data.HeaterServiceHandle,
                                                               sizeof(heater_char),
@@ -221,7 +368,7 @@ void handle_bt_gatt_complete()  {
 #if (DEVICE_IS_HEATER)
       sl_status = sl_bt_gatt_set_characteristic_notification(ble_client_data.connectionHandle,
                                                              ble_client_data.HeaterCharacteristicsHandle,
-                                                             sl_bt_gatt_indication
+                                                             STATE_SUBSCRIPTION
       );
       if(sl_status == SL_STATUS_OK) {
           LOG_INFO("Heater Set Notification Success");
@@ -233,7 +380,7 @@ void handle_bt_gatt_complete()  {
 #else
       sl_status = sl_bt_gatt_set_characteristic_notification(ble_client_data.connectionHandle,
                                                              ble_client_data.ACCharacteristicsHandle,
-                                                             sl_bt_gatt_indication
+                                                             STATE_SUBSCRIPTION
       );
       if(sl_status == SL_STATUS_OK) {
           LOG_INFO("AC Set Notification Success");
@@ -250,10 +397,20 @@ void handle_bt_close()  {
   gattCount = 0;
   gpioLed0SetOff();
   //gpioLed1SetOff();
-  sl_status = sl_bt_advertiser_start(ble_client_data.advertisingHandle,
-                                     sl_bt_advertiser_general_discoverable,
-                                     sl_bt_advertiser_connectable_scannable
-  );
+  sl_status = restart_advertising();
+
+#if (BROADCAST_MODE_ENABLE)
+  // Released to the train, the SyncInfo of the server is scanned for
+  if(ble_client_data.bcastKeyed && !ble_client_data.bcastSynced && !ble_client_data.bcastScanning)  {
+      sl_status_t scan_status = sl_bt_scanner_start(sl_bt_gap_phy_1m, sl_bt_scanner_discover_observation);
+      if(scan_status == SL_STATUS_OK) {
+          ble_client_data.bcastScanning = true;
+      }
+      else  {
+          LOG_ERROR("Scanner Start Error 0x%x",scan_status);
+      }
+  }
+#endif
 
   if(sl_status == SL_STATUS_OK) {
       displayPrintf(DISPLAY_ROW_CONNECTION, "Advertising");
@@ -263,10 +420,330 @@ void handle_bt_close()  {
   else {
       LOG_ERROR("Advertiser Start Error 0x%x",sl_status);
   }
+}
 
-  sl_status = sl_bt_sm_delete_bondings();
+// Sets the relay to the state sent by the server
+void handle_bt_state(uint8_t state)  {
+  if(state == 0x01) {
+      displayPrintf(DISPLAY_ROW_9, "ON");
+      gpioLed1SetOn();
+      DEVICE_IS_HEATER ? gpioRelayOn() : gpioRelayOff();
+  }
+  if(state == 0x00) {
+      displayPrintf(DISPLAY_ROW_9, "OFF");
+      gpioLed1SetOff();
+      DEVICE_IS_HEATER ? gpioRelayOff() : gpioRelayOn();
+  }
+}
+
+// Takes a state snapshot of the notification mode, [sequence number, state]
+void handle_bt_notification(sl_bt_msg_t *evt)  {
+  uint8_t seq;
+
+  if(evt->data.evt_gatt_characteristic_value.value.len < 2)  {
+      LOG_ERROR("Short State Snapshot %d",evt->data.evt_gatt_characteristic_value.value.len);
+      return;
+  }
+
+  seq = evt->data.evt_gatt_characteristic_value.value.data[0];
+
+  // An older snapshot overtaken by a newer one is dropped, still acknowledged
+  if(!ble_client_data.seqValid || (int8_t)(seq - ble_client_data.lastSeq) > 0)  {
+      ble_client_data.lastSeq = seq;
+      ble_client_data.seqValid = true;
+      handle_bt_state(evt->data.evt_gatt_characteristic_value.value.data[1]);
+  }
+
+  // Snapshots taken until the timer fires are acknowledged together
+  if(!ble_client_data.ackPending)  {
+      sl_status = sl_bt_system_set_soft_timer((ACK_DELAY_MS * 32768) / 1000,
+                                              ACK_TIMER_HANDLE,
+                                              1
+      );
+      if(sl_status == SL_STATUS_OK) {
+          ble_client_data.ackPending = true;
+      }
+      else  {
+          LOG_ERROR("Ack Timer Error 0x%x",sl_status);
+      }
+  }
+}
+
+// Acknowledges the newest snapshot taken
+void handle_bt_ack_timer()  {
+  uint16_t sentLen;
+
+  ble_client_data.ackPending = false;
+
+  sl_status = sl_bt_gatt_write_characteristic_value_without_response(ble_client_data.connectionHandle,
+                                                                     (DEVICE_IS_HEATER ?
+                                                                         ble_client_data.HeaterCharacteristicsHandle :
+                                                                         ble_client_data.ACCharacteristicsHandle),
+                                                                     1,
+                                                                     &ble_client_data.lastSeq,
+                                                                     &sentLen
+  );
   if(sl_status != SL_STATUS_OK) {
-      LOG_ERROR("Delete Bondings Error 0x%x",sl_status);
+      LOG_ERROR("Ack Write Error 0x%x",sl_status);
+  }
+}
+
+// Reads the broadcast key and slot from the service of the build once the
+// state subscription is set, refused by a server without the broadcast mode
+void handle_bt_read_key()  {
+#if (BROADCAST_MODE_ENABLE)
+  sl_status = sl_bt_gatt_read_characteristic_value_by_uuid(ble_client_data.connectionHandle,
+                                                           (DEVICE_IS_HEATER ?
+                                                               ble_client_data.HeaterServiceHandle :
+                                                               ble_client_data.ACServiceHandle),
+                                                           sizeof(bcast_key_char),
+                                                           bcast_key_char
+  );
+  if(sl_status == SL_STATUS_OK) {
+      LOG_INFO("Read Broadcast Key Success");
+      gattCount = 3;
+  }
+  else  {
+      LOG_ERROR("Read Broadcast Key Error 0x%04x",sl_status);
+  }
+#endif
+}
+
+// Takes the broadcast key record, [key, slot]
+void handle_bt_key(sl_bt_msg_t *evt)  {
+  uint8array *value = &evt->data.evt_gatt_characteristic_value.value;
+
+  if(value->len != BCAST_KEY_LEN + 1)  {
+      LOG_ERROR("Broadcast Key Length %d",value->len);
+      return;
+  }
+
+  // A new key restarts the sequence numbers of the server
+  if(memcmp(ble_client_data.bcastKey, value->data, BCAST_KEY_LEN))  {
+      memcpy(ble_client_data.bcastKey, value->data, BCAST_KEY_LEN);
+      ble_client_data.bcastSeq = 0;
+  }
+
+  ble_client_data.bcastSlot = value->data[BCAST_KEY_LEN];
+  ble_client_data.bcastKeyed = true;
+  LOG_INFO("Broadcast Slot %d",ble_client_data.bcastSlot);
+}
+
+// Closes the link once the key is held, the server takes the client into the
+// broadcast mode
+void handle_bt_release()  {
+  if(!ble_client_data.bcastKeyed)  {
+      return;
+  }
+
+  sl_status = sl_bt_connection_close(ble_client_data.connectionHandle);
+  if(sl_status != SL_STATUS_OK) {
+      LOG_ERROR("Connection Close Error 0x%x",sl_status);
+  }
+}
+
+// Sleeptimer time in microseconds, wrapping, only differences of it are used
+static uint32_t probe_time_us()  {
+  return (uint32_t)((sl_sleeptimer_get_tick_count64() * 1000000) / sl_sleeptimer_get_timer_frequency());
+}
+
+// Subscribes to the pings of the server's probe once the state subscription
+// is set, a server without the probe has no probe characteristic
+void handle_bt_probe_subscribe()  {
+#if (PROBE_ENABLE && !BROADCAST_MODE_ENABLE)
+  if(ble_client_data.ProbeCharacteristicsHandle == 0 || ble_client_data.ProbeEchoHandle == 0)  {
+      LOG_INFO("No Probe Characteristics");
+      return;
+  }
+
+  sl_status = sl_bt_gatt_set_characteristic_notification(ble_client_data.connectionHandle,
+                                                         ble_client_data.ProbeCharacteristicsHandle,
+                                                         sl_bt_gatt_notification
+  );
+  if(sl_status == SL_STATUS_OK) {
+      LOG_INFO("Probe Set Notification Success");
+      gattCount = 4;
+  }
+  else  {
+      LOG_ERROR("Probe Set Notification Error 0x%04x",sl_status);
+  }
+#endif
+}
+
+// Reads a little endian uint32
+static uint32_t get_le32(const uint8_t *data)  {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+// Takes the time sync estimate after a ping, [sent, epoch, reference,
+// offset, drift]
+static void handle_bt_sync(const uint8_t *ping)  {
+  const uint8_t *record = &ping[PROBE_PING_LEN];
+
+  if(!record[0])  {
+      return;
+  }
+
+  if(!ble_client_data.syncValid)  {
+      LOG_INFO("Time Synced");
+  }
+
+  ble_client_data.syncEpoch = record[1] | (record[2] << 8);
+  ble_client_data.syncT1 = get_le32(&ping[1]);
+  ble_client_data.syncRef = get_le32(&record[3]);
+  ble_client_data.syncOffset = get_le32(&record[7]);
+  ble_client_data.syncDrift = (int32_t)get_le32(&record[11]);
+  ble_client_data.syncValid = true;
+}
+
+// Server time in milliseconds once synced, the sleeptimer uptime before
+uint32_t getSyncedTimeMs()  {
+  uint32_t now = probe_time_us();
+  int32_t dt;
+  uint32_t serverTime;
+  uint64_t serverTime64;
+
+  if(!ble_client_data.syncValid)  {
+      return (uint32_t)((sl_sleeptimer_get_tick_count64() * 1000) / sl_sleeptimer_get_timer_frequency());
+  }
+
+  // Offset and drift as the server predicts them, see timesync.c
+  dt = (int32_t)(now - ble_client_data.syncRef);
+  serverTime = now - ble_client_data.syncOffset -
+      (uint32_t)(((int64_t)ble_client_data.syncDrift * dt / 1000000) >> 16);
+
+  // Widened from the 64 bit time of the ping, within half a wrap of it
+  serverTime64 = (((uint64_t)ble_client_data.syncEpoch << 32) | ble_client_data.syncT1) +
+      (int32_t)(serverTime - ble_client_data.syncT1);
+
+  return (uint32_t)(serverTime64 / 1000);
+}
+
+// Echoes a ping of the probe, [ping, time taken, time sent], the time taken
+// is read as the event comes in. The time sync estimate after the ping is kept
+void handle_bt_probe(sl_bt_msg_t *evt, uint32_t rxTime)  {
+  uint8array *value = &evt->data.evt_gatt_characteristic_value.value;
+  uint8_t echo[PROBE_ECHO_LEN];
+  uint32_t txTime;
+  uint16_t sentLen;
+
+  if(value->len < PROBE_PING_LEN)  {
+      LOG_ERROR("Probe Ping Length %d",value->len);
+      return;
+  }
+
+  memcpy(echo, value->data, PROBE_PING_LEN);
+  for(uint8_t i = 0; i < 4; i++)  {
+      echo[PROBE_PING_LEN + i] = (uint8_t)(rxTime >> (8 * i));
+  }
+
+  txTime = probe_time_us();
+  for(uint8_t i = 0; i < 4; i++)  {
+      echo[PROBE_PING_LEN + 4 + i] = (uint8_t)(txTime >> (8 * i));
+  }
+
+  sl_status = sl_bt_gatt_write_characteristic_value_without_response(ble_client_data.connectionHandle,
+                                                                     ble_client_data.ProbeEchoHandle,
+                                                                     sizeof(echo),
+                                                                     echo,
+                                                                     &sentLen
+  );
+  if(sl_status != SL_STATUS_OK) {
+      LOG_ERROR("Probe Echo Write Error 0x%x",sl_status);
+  }
+
+  if(value->len == PROBE_PING_LEN + TIMESYNC_RECORD_LEN)  {
+      handle_bt_sync(value->data);
+  }
+}
+
+// Opens the sync on the SyncInfo of the server, the scanner runs until the
+// sync is opened
+void handle_bt_scan_report(sl_bt_msg_t *evt)  {
+  sl_bt_evt_scanner_scan_report_t *report = &evt->data.evt_scanner_scan_report;
+
+  if(!ble_client_data.bcastScanning || report->periodic_interval == 0 ||
+     memcmp(report->address.addr, ble_client_data.serverAddress.addr, sizeof(bd_addr)))  {
+      return;
+  }
+
+  sl_status = sl_bt_sync_open(report->address,
+                              report->address_type,
+                              report->adv_sid,
+                              &ble_client_data.syncHandle
+  );
+  if(sl_status != SL_STATUS_OK) {
+      LOG_ERROR("Sync Open Error 0x%x",sl_status);
+  }
+}
+
+// Takes a command table of the train, see bcast.h of the server for the frame
+void handle_bt_sync_data(sl_bt_msg_t *evt)  {
+  uint8array *data = &evt->data.evt_sync_data.data;
+  uint8_t mac[16];
+  uint8_t len;
+  uint8_t count;
+  uint32_t seq;
+
+  if(evt->data.evt_sync_data.data_status != 0 || data->len < BCAST_HEADER_LEN + BCAST_MAC_LEN)  {
+      return;
+  }
+
+  len = data->data[0] + 1;
+  count = data->data[8];
+
+  if(len > data->len || data->data[1] != 0xFF ||
+     data->data[2] != (uint8_t)BCAST_COMPANY_ID || data->data[3] != (uint8_t)(BCAST_COMPANY_ID >> 8) ||
+     len != BCAST_HEADER_LEN + (count + 7) / 8 + BCAST_MAC_LEN)  {
+      return;
+  }
+
+  seq = data->data[4] | (data->data[5] << 8) | ((uint32_t)data->data[6] << 16) | ((uint32_t)data->data[7] << 24);
+
+  // The table repeats until the next change, a replayed one is older
+  if(seq <= ble_client_data.bcastSeq)  {
+      return;
+  }
+
+  if(mbedtls_cipher_cmac(mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB),
+                         ble_client_data.bcastKey, BCAST_KEY_LEN * 8,
+                         &data->data[2], len - BCAST_MAC_LEN - 2, mac) != 0 ||
+     memcmp(mac, &data->data[len - BCAST_MAC_LEN], BCAST_MAC_LEN))  {
+      LOG_ERROR("Broadcast MAC Error %lu",seq);
+      return;
+  }
+
+  ble_client_data.bcastSeq = seq;
+
+  if(ble_client_data.bcastSlot < count)  {
+      handle_bt_state((data->data[BCAST_HEADER_LEN + ble_client_data.bcastSlot / 8] >>
+          (ble_client_data.bcastSlot % 8)) & 0x01);
+  }
+
+  set_advertising_data();
+}
+
+// Synchronized, the scanner is stopped and the acks go out
+void handle_bt_sync_opened()  {
+  LOG_INFO("Synced");
+  ble_client_data.bcastSynced = true;
+  ble_client_data.bcastScanning = false;
+  sl_bt_scanner_stop();
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Broadcast");
+
+  if(ble_client_data.stateTransition == Advertising)  {
+      restart_advertising();
+  }
+}
+
+// The train is lost, back to fast advertising and the SyncInfo is scanned
+// for again once no link is open
+void handle_bt_sync_closed()  {
+  LOG_INFO("Sync Closed");
+  ble_client_data.bcastSynced = false;
+
+  if(ble_client_data.stateTransition == Advertising)  {
+      handle_bt_close();
   }
 }
 
@@ -289,9 +766,24 @@ void handle_ble_event(sl_bt_msg_t *evt) {
     case sl_bt_evt_connection_opened_id:
       LOG_INFO("Connected");
       //handle_bt_open(evt);
+      ble_client_data.bondingHandle = evt->data.evt_connection_opened.bonding;
+      ble_client_data.serverAddress = evt->data.evt_connection_opened.address;
+      ble_client_data.serverAddress_type = evt->data.evt_connection_opened.address_type;
+      ble_client_data.bcastKeyed = false;
       ble_client_data.stateTransition = Connected;
       break;
 
+    case sl_bt_evt_connection_parameters_id:
+      // Encrypted from a stored bonding, no pairing and no bonded event
+      if(ble_client_data.stateTransition == Connected &&
+         ble_client_data.bondingHandle != SL_BT_INVALID_BONDING_HANDLE &&
+         evt->data.evt_connection_parameters.security_mode != sl_bt_connection_mode1_level1)  {
+          LOG_INFO("Encrypted");
+          gpioLed0SetOn();
+          ble_client_data.stateTransition = Bonded;
+      }
+      break;
+
     case sl_bt_evt_sm_confirm_bonding_id:
       LOG_INFO("Confirm Bonding");
       //handle_bt_confirm_bonding();
@@ -334,40 +826,82 @@ void handle_ble_event(sl_bt_msg_t *evt) {
       if(gattCount == 2)  {
           ble_client_data.stateTransition = SetNotification;
       }
+      if(gattCount == 3)  {
+          ble_client_data.stateTransition = ReadBroadcastKey;
+      }
+      // gattCount 4, the probe subscription, ends the procedures of the link
       break;
 
     case sl_bt_evt_connection_closed_id:
       LOG_INFO("Closed");
       //      handle_bt_close();
+#if (PHY_CODED_ENABLE)
+      // The server may not reach the client on this PHY, the other one is tried
+      if(ble_client_data.stateTransition < Bonded)  {
+          ble_client_data.openFailures++;
+      }
+      else  {
+          ble_client_data.openFailures = 0;
+      }
+      if(ble_client_data.openFailures >= PHY_FALLBACK_FAILURES)  {
+          ble_client_data.openFailures = 0;
+          ble_client_data.advertisingPhy = (ble_client_data.advertisingPhy == sl_bt_gap_phy_coded) ?
+              sl_bt_gap_phy_1m : sl_bt_gap_phy_coded;
+          LOG_INFO("Advertising PHY %d",ble_client_data.advertisingPhy);
+      }
+#endif
+      // The server may have restarted its sequence numbers
+      ble_client_data.seqValid = false;
+      ble_client_data.ackPending = false;
+      ble_client_data.ProbeCharacteristicsHandle = 0;
+      ble_client_data.ProbeEchoHandle = 0;
+      sl_bt_system_set_soft_timer(0, ACK_TIMER_HANDLE, 1);
       ble_client_data.stateTransition = Advertising;
       break;
 
+    case sl_bt_evt_scanner_scan_report_id:
+      handle_bt_scan_report(evt);
+      break;
+
+    case sl_bt_evt_sync_opened_id:
+      handle_bt_sync_opened();
+      break;
+
+    case sl_bt_evt_sync_data_id:
+      handle_bt_sync_data(evt);
+      break;
+
+    case sl_bt_evt_sync_closed_id:
+      handle_bt_sync_closed();
+      break;
+
+    case sl_bt_evt_system_soft_timer_id:
+      if(evt->data.evt_system_soft_timer.handle == ACK_TIMER_HANDLE)  {
+          handle_bt_ack_timer();
+      }
+      break;
+
     case sl_bt_evt_gatt_characteristic_value_id:
+      if(evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_handle_value_notification)  {
+          if(ble_client_data.ProbeCharacteristicsHandle != 0 &&
+             evt->data.evt_gatt_characteristic_value.characteristic == ble_client_data.ProbeCharacteristicsHandle)  {
+              handle_bt_probe(evt, probe_time_us());
+              break;
+          }
+          handle_bt_notification(evt);
+          break;
+      }
+      if(evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_read_by_type_response)  {
+          handle_bt_key(evt);
+          break;
+      }
       LOG_INFO("Send Confirmation");
       sl_bt_gatt_send_characteristic_confirmation(ble_client_data.connectionHandle);
       if(evt->data.evt_gatt_characteristic_value.characteristic == ble_client_data.HeaterCharacteristicsHandle)  {
-          if(evt->data.evt_gatt_characteristic_value.value.data[0] == 0x01) {
-              displayPrintf(DISPLAY_ROW_9, "ON");
-              gpioLed1SetOn();
-              DEVICE_IS_HEATER ? gpioRelayOn() : gpioRelayOff();
-          }
-          if(evt->data.evt_gatt_characteristic_value.value.data[0] == 0x00) {
-              displayPrintf(DISPLAY_ROW_9, "OFF");
-              gpioLed1SetOff();
-              DEVICE_IS_HEATER ? gpioRelayOff() : gpioRelayOn();
-          }
+          handle_bt_state(evt->data.evt_gatt_characteristic_value.value.data[0]);
       }
       if(evt->data.evt_gatt_characteristic_value.characteristic == ble_client_data.ACCharacteristicsHandle)  {
-          if(evt->data.evt_gatt_characteristic_value.value.data[0] == 0x01) {
-              displayPrintf(DISPLAY_ROW_9, "ON");
-              gpioLed1SetOn();
-              DEVICE_IS_HEATER ? gpioRelayOn() : gpioRelayOff();
-          }
-          if(evt->data.evt_gatt_characteristic_value.value.data[0] == 0x00) {
-              displayPrintf(DISPLAY_ROW_9, "OFF");
-              gpioLed1SetOff();
-              DEVICE_IS_HEATER ? gpioRelayOff() : gpioRelayOn();
-          }
+          handle_bt_state(evt->data.evt_gatt_characteristic_value.value.data[0]);
       }
       break;
 
@@ -405,6 +939,16 @@ void handle_ble_event(sl_bt_msg_t *evt) {
               displayPrintf(DISPLAY_ROW_CONNECTION, "Handling Indications");
           }
 
+          if (!memcmp(evt->data.evt_gatt_characteristic.uuid.data, probe_char, 16)) {
+              LOG_INFO("Probe Char ID");
+              ble_client_data.ProbeCharacteristicsHandle = evt->data.evt_gatt_characteristic.characteristic;
+          }
+
+          if (!memcmp(evt->data.evt_gatt_characteristic.uuid.data, probe_echo_char, 16)) {
+              LOG_INFO("Probe Echo Char ID");
+              ble_client_data.ProbeEchoHandle = evt->data.evt_gatt_characteristic.characteristic;
+          }
+
       }
       break;
   }
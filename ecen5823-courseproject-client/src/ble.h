@@ -3,6 +3,22 @@
  * @brief Header file
  *******************************************************************************
  * Editor: Dec 08, 2022, Amey More
+ *
+ * Editor: Oct 19, 2026
+ * Change: Added the notification mode of the state characteristic.
+ *
+ * Editor: Oct 19, 2026
+ * Change: Added the Coded PHY advertising of a distant client.
+ *
+ * Editor: Oct 19, 2026
+ * Change: Added the broadcast mode, the state is taken from the command table
+ *         in the periodic advertising train of the server.
+ *
+ * Editor: Oct 19, 2026
+ * Change: Added the echo of the server's latency probe.
+ *
+ * Editor: Oct 19, 2026
+ * Change: Added the time sync to the server's clock carried by the probe.
  ******************************************************************************/
 
 #ifndef BLE_H
@@ -11,12 +27,51 @@
 #include "sl_bluetooth.h"
 #include "scheduler.h"
 
+// Set to 1 to take the state as notifications of a sequence number and the
+// state, acknowledged every ACK_DELAY_MS, instead of confirmed indications
+#define NOTIFY_MODE_ENABLE    (0)
+#define ACK_DELAY_MS          (100)
+#define ACK_TIMER_HANDLE      (1)     // Handle 0 is the LCD timer
+
+// Set to 1 for a client far from the server, it advertises on the Coded PHY
+// and falls back to the 1M PHY after PHY_FALLBACK_FAILURES links lost before
+// bonding, and back again
+#define PHY_CODED_ENABLE      (0)
+#define PHY_FALLBACK_FAILURES (3)
+
+// Set to 1 to read the broadcast key once bonded, close the link and take the
+// state from the command table of the server's periodic advertising train.
+// The table applied is acked in the advertising data, which slows down to
+// BCAST_ADV_INTERVAL while synchronized. The server has to be built with
+// BROADCAST_ENABLE, the link stays open otherwise.
+#define BROADCAST_MODE_ENABLE (0)
+#define BCAST_SYNC_SKIP       (4)       // Listens to every 5th train packet
+#define BCAST_SYNC_TIMEOUT    (900)     // 9 s in 10 ms units
+#define BCAST_ADV_INTERVAL    (2000*1.6)
+#define BCAST_COMPANY_ID      (0xFFFF)  // See bcast.h of the server
+#define BCAST_KEY_LEN         (16)
+#define BCAST_MAC_LEN         (4)
+#define BCAST_HEADER_LEN      (9)
+
+// Set to 1 to answer the latency probe of the server, every ping notified on
+// the probe characteristic is written back on the echo characteristic with
+// the sleeptimer times it was taken and the echo sent. Not with the broadcast
+// mode, its link is released.
+#define PROBE_ENABLE          (0)
+#define PROBE_PING_LEN        (5)       // See probe.h of the server
+#define PROBE_ECHO_LEN        (13)
+
+// The estimate of the time sync after the ping, see timesync.h of the server.
+// Once sent, the logs are stamped with the server time in milliseconds.
+#define TIMESYNC_RECORD_LEN   (15)
+
 typedef struct {
   bd_addr   myAddress;
   uint8_t   myAddress_type;
 
   uint8_t   advertisingHandle;
   uint8_t   connectionHandle;
+  uint8_t   bondingHandle;
 
   uint32_t  HeaterServiceHandle;
   uint16_t  HeaterCharacteristicsHandle;
@@ -24,8 +79,35 @@ typedef struct {
   uint32_t  ACServiceHandle;
   uint16_t  ACCharacteristicsHandle;
 
+  uint16_t  ProbeCharacteristicsHandle;   // In the service of the build
+  uint16_t  ProbeEchoHandle;
+
+  bool      syncValid;        // Estimate of the server's time sync held
+  uint16_t  syncEpoch;        // Bits 32 to 47 of the server time of syncT1
+  uint32_t  syncT1;           // Server time of the ping it came with, us
+  uint32_t  syncRef;          // Client time of the estimate, us
+  uint32_t  syncOffset;       // Client less server time at it, us
+  int32_t   syncDrift;        // ppm Q16 the client clock runs fast
+
   bool      connectionFlag;
 
+  uint8_t   lastSeq;          // Newest state snapshot taken
+  bool      seqValid;
+  bool      ackPending;       // Acknowledgement timer running
+
+  uint8_t   advertisingPhy;
+  uint8_t   openFailures;     // Links lost before bonding in a row
+
+  bd_addr   serverAddress;    // Of the last link, the train is synced from it
+  uint8_t   serverAddress_type;
+  uint8_t   bcastKey[BCAST_KEY_LEN];
+  uint8_t   bcastSlot;
+  bool      bcastKeyed;       // Key and slot read from the server
+  bool      bcastScanning;    // Scanning for the SyncInfo of the server
+  bool      bcastSynced;
+  uint16_t  syncHandle;
+  uint32_t  bcastSeq;         // Newest table taken
+
   connection_states_t stateTransition;
 
 } ble_client_data_t;
@@ -40,6 +122,13 @@ static const uint8_t ac_service[]       = { 0x00, 0xaa, 0x9b, 0x5f, 0x73, 0xa6,
 // cf527086-8ccd-4ca5-8b48-85d5a0516d6d
 static const uint8_t ac_char[]          = { 0x6d, 0x6d, 0x51, 0xa0, 0xd5, 0x85, 0x48, 0x8b, 0xa5, 0x4c, 0xcd, 0x8c, 0x86, 0x70, 0x52, 0xcf };
 
+// 8b3f0e17-5c2a-4f6e-9d41-7a2c3b9e6f00, in both services
+static const uint8_t bcast_key_char[]   = { 0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x17, 0x0e, 0x3f, 0x8b };
+// 8b3f0e18-5c2a-4f6e-9d41-7a2c3b9e6f00, in both services
+static const uint8_t probe_char[]       = { 0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x18, 0x0e, 0x3f, 0x8b };
+// 8b3f0e19-5c2a-4f6e-9d41-7a2c3b9e6f00, in both services
+static const uint8_t probe_echo_char[]  = { 0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x19, 0x0e, 0x3f, 0x8b };
+
 // Function Prototypes
 ble_client_data_t *getbleData();
 void handle_ble_event(sl_bt_msg_t *evt);
@@ -52,5 +141,21 @@ void handle_bt_external_signals(sl_bt_msg_t *evt);
 void handle_bt_bonded();
 void handle_bt_gatt_complete();
 void handle_bt_close();
+void handle_bt_state(uint8_t state);
+void handle_bt_notification(sl_bt_msg_t *evt);
+void handle_bt_ack_timer();
+void handle_bt_read_key();
+void handle_bt_key(sl_bt_msg_t *evt);
+void handle_bt_release();
+void handle_bt_probe_subscribe();
+void handle_bt_probe(sl_bt_msg_t *evt, uint32_t rxTime);
+uint32_t getSyncedTimeMs();
+void handle_bt_scan_report(sl_bt_msg_t *evt);
+void handle_bt_sync_opened();
+void handle_bt_sync_data(sl_bt_msg_t *evt);
+void handle_bt_sync_closed();
+void set_advertising_data();
+sl_status_t restart_advertising();
+sl_status_t start_advertising();
 
 #endif    //    BLE_H
@@ -11,11 +11,16 @@
  *      Editor: Mar 17, 2021, Dave Sluiter
  *      Change: Commented out logInit() and logFlush() as not needed in SSv5.
  *
+ *      Editor: Oct 19, 2026
+ *      Change: The timestamp is the server time in milliseconds once synced
+ *              over the probe, the uptime before.
+ *
  */
 
 
 #include <stdbool.h>
 #include "irq.h"
+#include "ble.h"
 
 // Include logging for this file
 #define INCLUDE_LOG_DEBUG 1
@@ -46,7 +51,7 @@ uint32_t loggerGetTimestamp()
        //           assignments. Put the letimerMilliseconds() function in your irq.c/.h files.
        
 //       return letimerMilliseconds();
-	   return (0);
+	   return getSyncedTimeMs();
 	   
     #endif
 
@@ -3,6 +3,14 @@
  * @brief Scheduler functions
  *******************************************************************************
  * Editor: Dec 08, 2022, Amey More
+ *
+ * Editor: Oct 19, 2026
+ * Change: The broadcast key is read once the subscription is set and the link
+ *         is released after it.
+ *
+ * Editor: Oct 19, 2026
+ * Change: The probe pings are subscribed to once the state subscription is
+ *         set.
  ******************************************************************************/
 
 #include "scheduler.h"
@@ -127,6 +135,8 @@ void connection_state_machine(sl_bt_msg_t *event) {
       //LOG_INFO("DiscoverCharacteristics");
       if(bleDataPtr->stateTransition == SetNotification) {
           //handle_bt_gatt_complete();
+          handle_bt_read_key();
+          handle_bt_probe_subscribe();
           nextState = SetNotification;
       }
 
@@ -138,6 +148,19 @@ void connection_state_machine(sl_bt_msg_t *event) {
 
     case SetNotification:
       //LOG_INFO("SetNotification");
+      if(bleDataPtr->stateTransition == ReadBroadcastKey) {
+          handle_bt_release();
+          nextState = ReadBroadcastKey;
+      }
+
+      if(bleDataPtr->stateTransition == Advertising)  {
+          handle_bt_close();
+          nextState = Advertising;
+      }
+      break;
+
+    case ReadBroadcastKey:
+      //LOG_INFO("ReadBroadcastKey");
 
       if(bleDataPtr->stateTransition == Advertising)  {
           handle_bt_close();
@@ -3,6 +3,9 @@
  * @brief Header file
  *******************************************************************************
  * Editor: Dec 08, 2022, Amey More
+ *
+ * Editor: Oct 19, 2026
+ * Change: Added the ReadBroadcastKey state of the broadcast mode.
  ******************************************************************************/
 
 #ifndef SCHEDULER_H
@@ -24,7 +27,8 @@ typedef enum {
   Bonded,
   DiscoverServices,
   DiscoverCharacteristics,
-  SetNotification
+  SetNotification,
+  ReadBroadcastKey
 //  n_states
 } connection_states_t;
 
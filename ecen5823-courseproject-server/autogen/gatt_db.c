@@ -25,24 +25,68 @@ GATT_DATA(const uint16_t gattdb_uuidtable_16_map[]) =
 GATT_DATA(const uint8_t gattdb_uuidtable_128_map[]) =
 {
   0x27, 0x82, 0x81, 0xf2, 0x67, 0xd7, 0xce, 0x8d, 0xc8, 0x44, 0x76, 0xf3, 0xf3, 0x55, 0xbf, 0x4a, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x17, 0x0e, 0x3f, 0x8b, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x18, 0x0e, 0x3f, 0x8b, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x19, 0x0e, 0x3f, 0x8b, 
   0x6d, 0x6d, 0x51, 0xa0, 0xd5, 0x85, 0x48, 0x8b, 0xa5, 0x4c, 0xcd, 0x8c, 0x86, 0x70, 0x52, 0xcf, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x11, 0x0e, 0x3f, 0x8b, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x12, 0x0e, 0x3f, 0x8b, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x13, 0x0e, 0x3f, 0x8b, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x14, 0x0e, 0x3f, 0x8b, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x15, 0x0e, 0x3f, 0x8b, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x16, 0x0e, 0x3f, 0x8b, 
+  0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x1a, 0x0e, 0x3f, 0x8b, 
   0x63, 0x60, 0x32, 0xe0, 0x37, 0x5e, 0xa4, 0x88, 0x53, 0x4e, 0x6d, 0xfb, 0x64, 0x35, 0xbf, 0xf7, 
 };
-GATT_DATA(const sli_bt_gattdb_value_t gattdb_attribute_field_26) = {
+GATT_DATA(const sli_bt_gattdb_value_t gattdb_attribute_field_56) = {
   .len = 16,
   .data = { 0xf0, 0x19, 0x21, 0xb4, 0x47, 0x8f, 0xa4, 0xbf, 0xa1, 0x4f, 0x63, 0xfd, 0xee, 0xd6, 0x14, 0x1d, }
 };
-GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_24) = {
-  .properties = 0x22,
+GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_48) = {
+  .properties = 0x08,
+  .max_len = 2,
+  .data = { 0x00, 0x00, },
+};
+GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_46) = {
+  .properties = 0x02,
+  .max_len = 32,
+  .data = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
+};
+GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_44) = {
+  .properties = 0x08,
+  .max_len = 4,
+  .data = { 0x00, 0x00, 0x00, 0x00, },
+};
+GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_42) = {
+  .properties = 0x0a,
+  .max_len = 56,
+  .data = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
+};
+GATT_DATA(const sli_bt_gattdb_value_t gattdb_attribute_field_40) = {
+  .len = 16,
+  .data = { 0x00, 0x6f, 0x9e, 0x3b, 0x2c, 0x7a, 0x41, 0x9d, 0x6e, 0x4f, 0x2a, 0x5c, 0x10, 0x0e, 0x3f, 0x8b, }
+};
+GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_39) = {
+  .properties = 0x04,
+  .max_len = 13,
+  .data = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
+};
+GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_31) = {
+  .properties = 0x36,
   .max_len = 1,
   .data = { 0x00, },
 };
-GATT_DATA(const sli_bt_gattdb_value_t gattdb_attribute_field_22) = {
+GATT_DATA(const sli_bt_gattdb_value_t gattdb_attribute_field_29) = {
   .len = 16,
   .data = { 0x00, 0xaa, 0x9b, 0x5f, 0x73, 0xa6, 0x9f, 0x8c, 0x6f, 0x4c, 0xf0, 0x7d, 0x4e, 0x81, 0x32, 0x10, }
 };
+GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_28) = {
+  .properties = 0x04,
+  .max_len = 13,
+  .data = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
+};
 GATT_DATA(sli_bt_gattdb_attribute_chrvalue_t gattdb_attribute_field_20) = {
-  .properties = 0x22,
+  .properties = 0x36,
   .max_len = 1,
   .data = { 0x00, },
 };
@@ -116,29 +160,59 @@ GATT_DATA(const sli_bt_gattdb_attribute_t gattdb_attributes_map[]) = {
   { .handle = 0x11, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x02, .char_uuid = 0x0006 } },
   { .handle = 0x12, .uuid = 0x0006, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_17 },
   { .handle = 0x13, .uuid = 0x0000, .permissions = 0x8801, .caps = 0xffff, .state = 0x00, .datatype = 0x00, .constdata = &gattdb_attribute_field_18 },
-  { .handle = 0x14, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x22, .char_uuid = 0x8000 } },
-  { .handle = 0x15, .uuid = 0x8000, .permissions = 0x4841, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_20 },
-  { .handle = 0x16, .uuid = 0x0007, .permissions = 0x803, .caps = 0xffff, .state = 0x00, .datatype = 0x03, .configdata = { .flags = 0x02, .clientconfig_index = 0x01 } },
-  { .handle = 0x17, .uuid = 0x0000, .permissions = 0x8801, .caps = 0xffff, .state = 0x00, .datatype = 0x00, .constdata = &gattdb_attribute_field_22 },
-  { .handle = 0x18, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x22, .char_uuid = 0x8001 } },
-  { .handle = 0x19, .uuid = 0x8001, .permissions = 0x4841, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_24 },
-  { .handle = 0x1a, .uuid = 0x0007, .permissions = 0x803, .caps = 0xffff, .state = 0x00, .datatype = 0x03, .configdata = { .flags = 0x02, .clientconfig_index = 0x02 } },
-  { .handle = 0x1b, .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x00, .constdata = &gattdb_attribute_field_26 },
-  { .handle = 0x1c, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x08, .char_uuid = 0x8002 } },
-  { .handle = 0x1d, .uuid = 0x8002, .permissions = 0x802, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
+  { .handle = 0x14, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x36, .char_uuid = 0x8000 } },
+  { .handle = 0x15, .uuid = 0x8000, .permissions = 0x48c3, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_20 },
+  { .handle = 0x16, .uuid = 0x0007, .permissions = 0x803, .caps = 0xffff, .state = 0x00, .datatype = 0x03, .configdata = { .flags = 0x03, .clientconfig_index = 0x01 } },
+  { .handle = 0x17, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x02, .char_uuid = 0x8001 } },
+  { .handle = 0x18, .uuid = 0x8001, .permissions = 0x841, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
+  { .handle = 0x19, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x10, .char_uuid = 0x8002 } },
+  { .handle = 0x1a, .uuid = 0x8002, .permissions = 0x800, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
+  { .handle = 0x1b, .uuid = 0x0007, .permissions = 0x803, .caps = 0xffff, .state = 0x00, .datatype = 0x03, .configdata = { .flags = 0x01, .clientconfig_index = 0x02 } },
+  { .handle = 0x1c, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x04, .char_uuid = 0x8003 } },
+  { .handle = 0x1d, .uuid = 0x8003, .permissions = 0x802, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_28 },
+  { .handle = 0x1e, .uuid = 0x0000, .permissions = 0x8801, .caps = 0xffff, .state = 0x00, .datatype = 0x00, .constdata = &gattdb_attribute_field_29 },
+  { .handle = 0x1f, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x36, .char_uuid = 0x8004 } },
+  { .handle = 0x20, .uuid = 0x8004, .permissions = 0x48c3, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_31 },
+  { .handle = 0x21, .uuid = 0x0007, .permissions = 0x803, .caps = 0xffff, .state = 0x00, .datatype = 0x03, .configdata = { .flags = 0x03, .clientconfig_index = 0x03 } },
+  { .handle = 0x22, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x02, .char_uuid = 0x8001 } },
+  { .handle = 0x23, .uuid = 0x8001, .permissions = 0x841, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
+  { .handle = 0x24, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x10, .char_uuid = 0x8002 } },
+  { .handle = 0x25, .uuid = 0x8002, .permissions = 0x800, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
+  { .handle = 0x26, .uuid = 0x0007, .permissions = 0x803, .caps = 0xffff, .state = 0x00, .datatype = 0x03, .configdata = { .flags = 0x01, .clientconfig_index = 0x04 } },
+  { .handle = 0x27, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x04, .char_uuid = 0x8003 } },
+  { .handle = 0x28, .uuid = 0x8003, .permissions = 0x802, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_39 },
+  { .handle = 0x29, .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x00, .constdata = &gattdb_attribute_field_40 },
+  { .handle = 0x2a, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x0a, .char_uuid = 0x8005 } },
+  { .handle = 0x2b, .uuid = 0x8005, .permissions = 0x883, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_42 },
+  { .handle = 0x2c, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x08, .char_uuid = 0x8006 } },
+  { .handle = 0x2d, .uuid = 0x8006, .permissions = 0x882, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_44 },
+  { .handle = 0x2e, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x02, .char_uuid = 0x8007 } },
+  { .handle = 0x2f, .uuid = 0x8007, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_46 },
+  { .handle = 0x30, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x08, .char_uuid = 0x8008 } },
+  { .handle = 0x31, .uuid = 0x8008, .permissions = 0x882, .caps = 0xffff, .state = 0x00, .datatype = 0x01, .dynamicdata = &gattdb_attribute_field_48 },
+  { .handle = 0x32, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x12, .char_uuid = 0x8009 } },
+  { .handle = 0x33, .uuid = 0x8009, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
+  { .handle = 0x34, .uuid = 0x0007, .permissions = 0x803, .caps = 0xffff, .state = 0x00, .datatype = 0x03, .configdata = { .flags = 0x01, .clientconfig_index = 0x05 } },
+  { .handle = 0x35, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x08, .char_uuid = 0x800a } },
+  { .handle = 0x36, .uuid = 0x800a, .permissions = 0x882, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
+  { .handle = 0x37, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x02, .char_uuid = 0x800b } },
+  { .handle = 0x38, .uuid = 0x800b, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
+  { .handle = 0x39, .uuid = 0x0000, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x00, .constdata = &gattdb_attribute_field_56 },
+  { .handle = 0x3a, .uuid = 0x0002, .permissions = 0x801, .caps = 0xffff, .state = 0x00, .datatype = 0x05, .characteristic = { .properties = 0x08, .char_uuid = 0x800c } },
+  { .handle = 0x3b, .uuid = 0x800c, .permissions = 0x802, .caps = 0xffff, .state = 0x00, .datatype = 0x07, .dynamicdata = NULL },
 };
 
 GATT_HEADER(const sli_bt_gattdb_t gattdb) = {
   .attributes = gattdb_attributes_map,
-  .attribute_table_size = 29,
-  .attribute_num = 29,
+  .attribute_table_size = 59,
+  .attribute_num = 59,
   .uuid16 = gattdb_uuidtable_16_map,
   .uuid16_table_size = 11,
   .uuid16_num = 11,
   .uuid128 = gattdb_uuidtable_128_map,
-  .uuid128_table_size = 3,
-  .uuid128_num = 3,
-  .num_ccfg = 3,
+  .uuid128_table_size = 13,
+  .uuid128_num = 13,
+  .num_ccfg = 6,
   .caps_mask = 0xffff,
   .enabled_caps = 0xffff,
 };
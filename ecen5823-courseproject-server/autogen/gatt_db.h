@@ -16,8 +16,21 @@ extern const sli_bt_gattdb_t gattdb;
 #define gattdb_manufacturer_name_string       16
 #define gattdb_system_id                      18
 #define gattdb_heater_state                   21
-#define gattdb_ac_state                       25
-#define gattdb_ota_control                    29
+#define gattdb_heater_bcast_key               24
+#define gattdb_heater_probe                   26
+#define gattdb_heater_probe_echo              29
+#define gattdb_ac_state                       32
+#define gattdb_ac_bcast_key                   35
+#define gattdb_ac_probe                       37
+#define gattdb_ac_probe_echo                  40
+#define gattdb_thermostat_schedule            43
+#define gattdb_thermostat_time                45
+#define gattdb_thermostat_zones               47
+#define gattdb_thermostat_zone_target         49
+#define gattdb_thermostat_status              51
+#define gattdb_thermostat_control             54
+#define gattdb_thermostat_probe_report        56
+#define gattdb_ota_control                    59
 
 
 #endif // __GATT_DB_H
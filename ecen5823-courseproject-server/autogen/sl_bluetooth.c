@@ -28,6 +28,8 @@ static const struct sli_bgapi_class * const bt_class_table[] =
   SL_BT_BGAPI_CLASS(gatt),
   SL_BT_BGAPI_CLASS(gatt_server),
   SL_BT_BGAPI_CLASS(sm),
+  SL_BT_BGAPI_CLASS(nvm),
+  SL_BT_BGAPI_CLASS(l2cap),
   NULL
 };
 #if !defined(SL_CATALOG_KERNEL_PRESENT)
@@ -55,6 +57,7 @@ void sl_bt_init(void)
   sl_status_t err = sl_bt_init_stack(&config);
   (void) err;
   sl_bt_init_classes(bt_class_table);
+  sl_bt_init_periodic_advertising();
 }
 
 SL_WEAK void sl_bt_on_event(sl_bt_msg_t* evt)
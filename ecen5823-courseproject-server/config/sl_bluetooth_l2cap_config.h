@@ -0,0 +1,11 @@
+#ifndef SL_BT_L2CAP_CONFIG_H
+#define SL_BT_L2CAP_CONFIG_H
+
+// <<< Use Configuration Wizard in Context Menu >>>
+// <o SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS> Max number of L2CAP connection-oriented channels <0-255>
+// <i> Default: 1
+// <i> Define the number of L2CAP connection-oriented channels the application needs.
+#define SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS     (1)
+// <<< end of configuration section >>>
+
+#endif
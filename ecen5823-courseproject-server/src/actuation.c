@@ -0,0 +1,103 @@
+/*******************************************************************************
+ * @file    actuation.c
+ * @brief   Actuation scheduler. See actuation.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "actuation.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Initializes the scheduler.
+ ******************************************************************************/
+void actuation_init(actuation_t *sched, uint32_t stagger_s)
+{
+  memset(sched, 0, sizeof(actuation_t));
+  sched->stagger_s = stagger_s;
+}
+
+
+/******************************************************************************
+ * @brief Checks if the stagger holds the starts at the given time.
+ ******************************************************************************/
+static uint8_t stagger_holds(const actuation_t *sched, uint32_t now_s)
+{
+  return sched->stagger_s && sched->started &&
+      now_s - sched->last_start_s < sched->stagger_s;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sends the requested actuator changes that are due.
+ ******************************************************************************/
+uint8_t actuation_run(actuation_t *sched, zone_table_t *table, uint32_t now_s,
+                      actuation_send_t send, void *ctx)
+{
+  uint64_t change = table->requested ^ table->on;
+  uint64_t stops = change & table->on;
+  uint64_t starts = change & table->requested;
+  uint8_t count = 0;
+
+  while (stops) {
+      uint8_t index = __builtin_ctzll(stops);
+      uint64_t bit = (uint64_t)1 << index;
+
+      stops &= stops - 1;
+      sched->visits++;
+
+      if (send(table->actuators[index].id, 0, ctx) == 0)
+        table->on &= ~bit;
+      count++;
+  }
+
+  while (starts && !stagger_holds(sched, now_s)) {
+      uint8_t index = __builtin_ctzll(starts);
+      uint64_t bit = (uint64_t)1 << index;
+      uint64_t others = table->zones[table->actuators[index].zone].actuators;
+
+      starts &= starts - 1;
+      sched->visits++;
+
+      // Held until every actuator of the other kind in the zone is off
+      others &= (table->heat & bit) ? ~table->heat : table->heat;
+      if (others & table->on)
+        continue;
+
+      count++;
+
+      if (send(table->actuators[index].id, 1, ctx) == 0) {
+          table->on |= bit;
+          sched->last_start_s = now_s;
+          sched->started = 1;
+          sched->starts++;
+      }
+  }
+
+  if (count) {
+      sched->commands += count;
+      sched->bursts++;
+      if (count > sched->peak_burst)
+        sched->peak_burst = count;
+  }
+
+  return count;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Time until the stagger lets the next start go.
+ ******************************************************************************/
+uint32_t actuation_wait_s(const actuation_t *sched, const zone_table_t *table,
+                          uint32_t now_s)
+{
+  if (!(table->requested & ~table->on) || !stagger_holds(sched, now_s))
+    return 0;
+
+  return sched->stagger_s - (now_s - sched->last_start_s);
+}
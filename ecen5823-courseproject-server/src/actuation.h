@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * @file    actuation.h
+ * @brief   Actuation scheduler. Sends the actuator states requested by
+ *          zone_run() to the devices. Stops always go first and a start is
+ *          held while an actuator of the other kind in the same zone is still
+ *          on, so the heater and the AC of a zone are never on together even
+ *          if a stop fails. Starts are spaced by a stagger interval so that
+ *          several compressors do not start at the same time. All the
+ *          commands due are sent in one run, back to back, so the stack
+ *          sends their indications in the next connection event of every
+ *          client instead of one run per change. A request that is undone
+ *          before it is sent costs no command.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_ACTUATION_H_
+#define SRC_ACTUATION_H_
+
+#include <stdint.h>
+
+#include "zone.h"
+
+
+#define ACTUATION_STAGGER_S     (10)    // Default time between two starts
+
+
+/******************************************************************************
+ * @brief Sends a state to an actuator, called by actuation_run() for every
+ * actuator that has to change.
+ *
+ * @param
+ *  id    Handle the actuator was added to the zone table with
+ *  on    1 to turn the actuator on, 0 to turn it off
+ *  ctx   Context passed to actuation_run()
+ *
+ * @return
+ *  Returns 0 if the actuator is in the requested state, else non-zero and the
+ *  change is tried again on the next run.
+ *
+ ******************************************************************************/
+typedef uint8_t (*actuation_send_t)(uint8_t id, uint8_t on, void *ctx);
+
+typedef struct {
+  uint32_t stagger_s;             // Minimum time between two starts, 0 = none
+  uint32_t last_start_s;
+  uint8_t started;                // Set once last_start_s is valid
+  uint32_t starts;                // Work and bursts, for benchmarks
+  uint32_t commands;
+  uint32_t bursts;                // Runs that sent at least one command
+  uint32_t peak_burst;            // Most commands sent by one run
+  uint32_t visits;                // Actuators looked at
+}actuation_t;
+
+
+/******************************************************************************
+ * @brief Initializes the scheduler.
+ *
+ * @param
+ *  sched       Scheduler to be initialized
+ *  stagger_s   Minimum time between two starts in seconds, 0 for none
+ *
+ ******************************************************************************/
+void actuation_init(actuation_t *sched, uint32_t stagger_s);
+
+
+/******************************************************************************
+ * @brief Sends the requested actuator changes that are due. All the stops
+ * are sent, then the starts that are not held by an actuator of the other
+ * kind in their zone, at most one per stagger interval.
+ *
+ * @param
+ *  sched   Scheduler
+ *  table   Zone table with the requested and current actuator states
+ *  now_s   Current time in seconds
+ *  send    Called for every actuator that has to change
+ *  ctx     Passed to send
+ *
+ * @return
+ *  Number of commands sent.
+ *
+ ******************************************************************************/
+uint8_t actuation_run(actuation_t *sched, zone_table_t *table, uint32_t now_s,
+                      actuation_send_t send, void *ctx);
+
+
+/******************************************************************************
+ * @brief Time until the stagger lets the next start go.
+ *
+ * @param
+ *  sched   Scheduler
+ *  table   Zone table
+ *  now_s   Current time in seconds
+ *
+ * @return
+ *  Seconds to wait before the next run, 0 if no start is waiting on the
+ *  stagger.
+ *
+ ******************************************************************************/
+uint32_t actuation_wait_s(const actuation_t *sched, const zone_table_t *table,
+                          uint32_t now_s);
+
+
+#endif /* SRC_ACTUATION_H_ */
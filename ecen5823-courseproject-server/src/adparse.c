@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * @file    adparse.c
+ * @brief   Iterator over the AD structures of a payload. See adparse.h for
+ *          details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "adparse.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Starts the iterator.
+ ******************************************************************************/
+void ad_iter_init(ad_iter_t *it, const uint8_t *data, uint8_t len)
+{
+  memset(it, 0, sizeof(ad_iter_t));
+  it->data = data;
+  it->len = len;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes the next structure.
+ ******************************************************************************/
+uint8_t ad_iter_next(ad_iter_t *it, ad_struct_t *ad)
+{
+  uint8_t field_len;
+
+  if (it->pos >= it->len)
+    return 0;
+
+  field_len = it->data[it->pos];
+
+  // Length 0 pads the rest, a length past the end is malformed
+  if (field_len == 0 || field_len > it->len - it->pos - 1) {
+      it->pos = it->len;
+      return 0;
+  }
+
+  ad->type = it->data[it->pos + 1];
+  ad->len = field_len - 1;
+  ad->value = &it->data[it->pos + 2];
+
+  it->pos += field_len + 1;
+  it->visited++;
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Looks for a UUID of the table.
+ ******************************************************************************/
+uint8_t ad_find_uuid128(ad_iter_t *it, const uint8_t (*uuids)[AD_UUID128_LEN],
+                        uint8_t count)
+{
+  ad_struct_t ad;
+
+  while (ad_iter_next(it, &ad)) {
+      if (ad.type != AD_TYPE_UUID128_COMPLETE && ad.type != AD_TYPE_UUID128_INCOMPLETE)
+        continue;
+
+      for (uint8_t pos = 0; pos + AD_UUID128_LEN <= ad.len; pos += AD_UUID128_LEN) {
+          for (uint8_t i = 0; i < count; i++) {
+              it->compares++;
+              if (!memcmp(&ad.value[pos], uuids[i], AD_UUID128_LEN))
+                return i + 1;
+          }
+      }
+  }
+
+  return 0;
+}
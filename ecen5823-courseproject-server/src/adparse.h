@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * @file    adparse.h
+ * @brief   Zero copy iterator over the AD structures of an advertising or scan
+ *          response payload. A structure is one length byte, one AD type byte
+ *          and the value, the iterator hands out views into the payload of
+ *          the scan report and never copies it. A structure of length 0 ends
+ *          the significant part of the payload, a structure running past the
+ *          end of the payload ends the walk. The service UUIDs of a payload
+ *          are matched against a table of 128 bit UUIDs in the little endian
+ *          order of the air and of the GATT database.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_ADPARSE_H_
+#define SRC_ADPARSE_H_
+
+#include <stdint.h>
+
+
+#define AD_TYPE_FLAGS               (0x01)
+#define AD_TYPE_UUID16_INCOMPLETE   (0x02)
+#define AD_TYPE_UUID16_COMPLETE     (0x03)
+#define AD_TYPE_UUID128_INCOMPLETE  (0x06)
+#define AD_TYPE_UUID128_COMPLETE    (0x07)
+#define AD_TYPE_NAME_SHORT          (0x08)
+#define AD_TYPE_NAME_COMPLETE       (0x09)
+#define AD_TYPE_TX_POWER            (0x0A)
+#define AD_TYPE_MANUFACTURER        (0xFF)
+
+#define AD_UUID128_LEN              (16)
+
+
+typedef struct {
+  const uint8_t *data;            // Payload of the report, not owned
+  uint8_t len;
+  uint8_t pos;                    // Length byte of the next structure
+  uint16_t visited;               // Structures walked, for benchmarks
+  uint16_t compares;              // UUIDs compared, for benchmarks
+}ad_iter_t;
+
+typedef struct {
+  uint8_t type;
+  uint8_t len;                    // Of the value
+  const uint8_t *value;           // Into the payload
+}ad_struct_t;
+
+
+/******************************************************************************
+ * @brief Starts an iterator at the first structure of a payload.
+ *
+ * @param
+ *  it      Iterator
+ *  data    Payload, it has to outlive the iterator
+ *  len     Length of the payload
+ *
+ ******************************************************************************/
+void ad_iter_init(ad_iter_t *it, const uint8_t *data, uint8_t len);
+
+
+/******************************************************************************
+ * @brief Takes the next structure.
+ *
+ * @return
+ *  Returns 1 with the structure in ad, 0 at the end of the payload or on a
+ *  malformed structure.
+ *
+ ******************************************************************************/
+uint8_t ad_iter_next(ad_iter_t *it, ad_struct_t *ad);
+
+
+/******************************************************************************
+ * @brief Walks the rest of the payload for a 128 bit service UUID of the
+ * table, in the complete and incomplete lists.
+ *
+ * @param
+ *  it      Iterator, the work is counted in it
+ *  uuids   Table of the UUIDs, little endian
+ *  count   Entries of the table
+ *
+ * @return
+ *  Index + 1 of the first UUID of the table found, 0 if none is found.
+ *
+ ******************************************************************************/
+uint8_t ad_find_uuid128(ad_iter_t *it, const uint8_t (*uuids)[AD_UUID128_LEN],
+                        uint8_t count);
+
+
+#endif /* SRC_ADPARSE_H_ */
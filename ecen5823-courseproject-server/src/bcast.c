@@ -0,0 +1,141 @@
+/*******************************************************************************
+ * @file    bcast.c
+ * @brief   Command table of the actuators for the periodic advertising train.
+ *          See bcast.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "bcast.h"
+#include "adparse.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the table.
+ ******************************************************************************/
+void bcast_init(bcast_t *bc, const uint8_t *key, uint32_t seq_limit)
+{
+  memset(bc, 0, sizeof(bcast_t));
+  memcpy(bc->key, key, BCAST_KEY_LEN);
+
+  // The numbers up to the saved block end may have been used before the reboot
+  bc->seq = seq_limit;
+  bc->seq_limit = seq_limit;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sets the state of a slot.
+ ******************************************************************************/
+uint8_t bcast_set(bcast_t *bc, uint8_t slot, uint8_t on)
+{
+  uint32_t states;
+
+  if (slot >= BCAST_MAX_ACTUATORS)
+    return 0;
+
+  states = on ? bc->states | (1UL << slot) : bc->states & ~(1UL << slot);
+
+  if (states == bc->states && slot < bc->count)
+    return 0;
+
+  bc->states = states;
+  if (slot >= bc->count)
+    bc->count = slot + 1;
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Reserves the next block of sequence numbers.
+ ******************************************************************************/
+uint8_t bcast_reserve(bcast_t *bc)
+{
+  if (bc->seq < bc->seq_limit)
+    return 0;
+
+  bc->seq_limit = bc->seq + BCAST_SEQ_BLOCK;
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Builds the frame of the table.
+ ******************************************************************************/
+uint8_t bcast_build(bcast_t *bc, bcast_mac_t mac, void *ctx)
+{
+  uint8_t frame[BCAST_FRAME_MAX_LEN];
+  uint8_t state_len = (bc->count + 7) / 8;
+  uint8_t len = BCAST_HEADER_LEN + state_len;
+  uint32_t seq = bc->seq + 1;
+
+  if (seq > bc->seq_limit)
+    return 0;
+
+  frame[0] = len + BCAST_MAC_LEN - 1;
+  frame[1] = AD_TYPE_MANUFACTURER;
+  frame[2] = (uint8_t)BCAST_COMPANY_ID;
+  frame[3] = (uint8_t)(BCAST_COMPANY_ID >> 8);
+  frame[4] = (uint8_t)seq;
+  frame[5] = (uint8_t)(seq >> 8);
+  frame[6] = (uint8_t)(seq >> 16);
+  frame[7] = (uint8_t)(seq >> 24);
+  frame[8] = bc->count;
+
+  for (uint8_t i = 0; i < state_len; i++)
+    frame[BCAST_HEADER_LEN + i] = (uint8_t)(bc->states >> (8 * i));
+
+  // The AD length and type are left out, a client checks them separately
+  if (mac(&frame[2], len - 2, &frame[len], ctx) != 0)
+    return 0;
+
+  memcpy(bc->frame, frame, len + BCAST_MAC_LEN);
+  bc->frame_len = len + BCAST_MAC_LEN;
+  bc->seq = seq;
+  bc->published++;
+
+  return bc->frame_len;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Looks for the ack of a client.
+ ******************************************************************************/
+uint8_t bcast_find_ack(const uint8_t *data, uint8_t len, uint16_t *seq16)
+{
+  ad_iter_t it;
+  ad_struct_t ad;
+
+  ad_iter_init(&it, data, len);
+
+  while (ad_iter_next(&it, &ad)) {
+      if (ad.type != AD_TYPE_MANUFACTURER || ad.len != BCAST_ACK_LEN - 2 ||
+          ad.value[0] != (uint8_t)BCAST_COMPANY_ID ||
+          ad.value[1] != (uint8_t)(BCAST_COMPANY_ID >> 8))
+        continue;
+
+      *seq16 = ad.value[2] | (ad.value[3] << 8);
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Ack covering a table.
+ ******************************************************************************/
+uint8_t bcast_acked(uint16_t seq16, uint32_t seq)
+{
+  return (int16_t)(seq16 - (uint16_t)seq) >= 0;
+}
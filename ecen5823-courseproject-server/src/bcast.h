@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * @file    bcast.h
+ * @brief   Command table of the actuators for the periodic advertising train
+ *          of the server. The table holds the state of every actuator as one
+ *          bit at its slot, the index of its client, and is published as one
+ *          manufacturer specific AD structure. Every publication takes the
+ *          next sequence number and is authenticated with a MAC truncated to
+ *          BCAST_MAC_LEN bytes over the company ID, the sequence number and
+ *          the states, under the key the clients read over their bonded link.
+ *          A client takes a table only with a valid MAC and a sequence number
+ *          above the last one it took, so a recorded table cannot be played
+ *          back. The sequence numbers are reserved in blocks of
+ *          BCAST_SEQ_BLOCK kept in NVM, a reboot goes on from the end of the
+ *          last block and never reuses one. A client acknowledges the table
+ *          it applied with the low 16 bits of its sequence number in its own
+ *          advertising data, in a manufacturer specific AD structure of the
+ *          same company ID.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_BCAST_H_
+#define SRC_BCAST_H_
+
+#include <stdint.h>
+
+
+#define BCAST_MAX_ACTUATORS     (32)      // One bit each in a uint32_t
+#define BCAST_COMPANY_ID        (0xFFFF)  // Reserved for tests, no company
+#define BCAST_KEY_LEN           (16)      // AES-128
+#define BCAST_MAC_LEN           (4)
+#define BCAST_SEQ_BLOCK         (256)     // Sequence numbers per NVM write
+#define BCAST_ACK_LEN           (6)       // Ack AD structure of a client
+
+/* Frame of the table, little endian:
+ *  [0]       AD length, the bytes after it
+ *  [1]       AD_TYPE_MANUFACTURER
+ *  [2..3]    BCAST_COMPANY_ID
+ *  [4..7]    Sequence number
+ *  [8]       Actuators in the table
+ *  [9..]     States, bit i % 8 of byte i / 8 for the actuator at slot i
+ *  [..]      MAC of bytes 2 up to the MAC */
+#define BCAST_HEADER_LEN        (9)
+#define BCAST_FRAME_MAX_LEN     (BCAST_HEADER_LEN + BCAST_MAX_ACTUATORS / 8 + BCAST_MAC_LEN)
+
+
+/******************************************************************************
+ * @brief Computes the MAC of a table under the broadcast key.
+ *
+ * @param
+ *  data    Bytes covered by the MAC
+ *  len     Length of data
+ *  mac     BCAST_MAC_LEN bytes out
+ *  ctx     Context passed to the bcast call, e.g. the key
+ *
+ * @return
+ *  Returns 0 if the MAC is computed.
+ *
+ ******************************************************************************/
+typedef uint8_t (*bcast_mac_t)(const uint8_t *data, uint8_t len, uint8_t *mac,
+                               void *ctx);
+
+typedef struct {
+  uint8_t key[BCAST_KEY_LEN];
+  uint32_t seq;                   // Of the table published last
+  uint32_t seq_limit;             // End of the block reserved in NVM
+  uint8_t count;                  // Actuators in the table
+  uint32_t states;                // Bit per slot
+  uint8_t frame[BCAST_FRAME_MAX_LEN];
+  uint8_t frame_len;              // 0 until the first table is built
+  uint32_t published;             // Stats
+  uint32_t acks;
+  uint32_t fallbacks;             // Commands sent again over a link
+  uint32_t ack_ms_sum;            // From the publication to the ack
+  uint32_t ack_ms_max;
+}bcast_t;
+
+
+/******************************************************************************
+ * @brief Clears the table.
+ *
+ * @param
+ *  bc          Table
+ *  key         Broadcast key, BCAST_KEY_LEN bytes
+ *  seq_limit   Block end saved in NVM, 0 if none is saved
+ *
+ ******************************************************************************/
+void bcast_init(bcast_t *bc, const uint8_t *key, uint32_t seq_limit);
+
+
+/******************************************************************************
+ * @brief Sets the state of the actuator at a slot, the table grows to hold it.
+ *
+ * @return
+ *  Returns 1 if the table changed, 0 if it holds the state already or the
+ *  slot is past BCAST_MAX_ACTUATORS.
+ *
+ ******************************************************************************/
+uint8_t bcast_set(bcast_t *bc, uint8_t slot, uint8_t on);
+
+
+/******************************************************************************
+ * @brief Reserves the next block of sequence numbers once the current one is
+ * used up. Called before bcast_build().
+ *
+ * @return
+ *  Returns 1 if seq_limit moved and has to be saved in NVM before the next
+ *  table is published.
+ *
+ ******************************************************************************/
+uint8_t bcast_reserve(bcast_t *bc);
+
+
+/******************************************************************************
+ * @brief Builds the frame of the table with the next sequence number.
+ *
+ * @param
+ *  bc    Table
+ *  mac   MAC of the frame
+ *  ctx   Context passed to mac
+ *
+ * @return
+ *  Length of the frame, 0 if the MAC failed or the block of sequence numbers
+ *  is used up, the previous frame is kept then.
+ *
+ ******************************************************************************/
+uint8_t bcast_build(bcast_t *bc, bcast_mac_t mac, void *ctx);
+
+
+/******************************************************************************
+ * @brief Looks for the ack AD structure in the advertising data of a client.
+ *
+ * @param
+ *  data    Advertising data of the scan report
+ *  len     Length of data
+ *  seq16   Low 16 bits of the sequence number acknowledged, out
+ *
+ * @return
+ *  Returns 1 if an ack is found.
+ *
+ ******************************************************************************/
+uint8_t bcast_find_ack(const uint8_t *data, uint8_t len, uint16_t *seq16);
+
+
+/******************************************************************************
+ * @brief Returns 1 if an ack covers the table of a sequence number, the
+ * later tables hold the states of the earlier ones.
+ ******************************************************************************/
+uint8_t bcast_acked(uint16_t seq16, uint32_t seq);
+
+
+#endif /* SRC_BCAST_H_ */
@@ -0,0 +1,111 @@
+/*******************************************************************************
+ * @file    beacon.c
+ * @brief   Status beacon of the server. See beacon.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "beacon.h"
+#include "adparse.h"
+
+
+#define BEACON_MANUFACTURER_LEN (BEACON_DATA_LEN - 5)   // After the AD type
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the beacon.
+ ******************************************************************************/
+void beacon_init(beacon_t *beacon)
+{
+  memset(beacon, 0, sizeof(beacon_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Encodes a status.
+ ******************************************************************************/
+uint8_t beacon_encode(const beacon_status_t *status, uint8_t counter,
+                      uint8_t *data)
+{
+  data[0] = 2;
+  data[1] = AD_TYPE_FLAGS;
+  data[2] = 0x04;
+  data[3] = BEACON_MANUFACTURER_LEN + 1;
+  data[4] = AD_TYPE_MANUFACTURER;
+  data[5] = (uint8_t)BEACON_COMPANY_ID;
+  data[6] = (uint8_t)(BEACON_COMPANY_ID >> 8);
+  data[7] = BEACON_TYPE_STATUS;
+  data[8] = counter;
+  data[9] = (uint8_t)status->current;
+  data[10] = (uint8_t)((uint16_t)status->current >> 8);
+  data[11] = (uint8_t)status->target;
+  data[12] = (uint8_t)((uint16_t)status->target >> 8);
+  data[13] = status->mode;
+  data[14] = status->on;
+  data[15] = status->health;
+
+  return BEACON_DATA_LEN;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Decodes a status.
+ ******************************************************************************/
+uint8_t beacon_decode(const uint8_t *data, uint8_t len, beacon_status_t *status,
+                      uint8_t *counter)
+{
+  ad_iter_t it;
+  ad_struct_t ad;
+
+  ad_iter_init(&it, data, len);
+
+  while (ad_iter_next(&it, &ad)) {
+      if (ad.type != AD_TYPE_MANUFACTURER || ad.len != BEACON_MANUFACTURER_LEN ||
+          ad.value[0] != (uint8_t)BEACON_COMPANY_ID ||
+          ad.value[1] != (uint8_t)(BEACON_COMPANY_ID >> 8) ||
+          ad.value[2] != BEACON_TYPE_STATUS)
+        continue;
+
+      *counter = ad.value[3];
+      status->current = (int16_t)(ad.value[4] | (ad.value[5] << 8));
+      status->target = (int16_t)(ad.value[6] | (ad.value[7] << 8));
+      status->mode = ad.value[8];
+      status->on = ad.value[9];
+      status->health = ad.value[10];
+
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Builds the data of a new status.
+ ******************************************************************************/
+uint8_t beacon_update(beacon_t *beacon, const beacon_status_t *status)
+{
+  if (beacon->built &&
+      beacon->status.current == status->current &&
+      beacon->status.target == status->target &&
+      beacon->status.mode == status->mode &&
+      beacon->status.on == status->on &&
+      beacon->status.health == status->health) {
+      beacon->unchanged++;
+      return 0;
+  }
+
+  beacon->status = *status;
+  beacon->counter++;
+  beacon_encode(&beacon->status, beacon->counter, beacon->data);
+  beacon->built = 1;
+  beacon->updates++;
+
+  return 1;
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * @file    beacon.h
+ * @brief   Status beacon of the server for passive monitors. The status is
+ *          one manufacturer specific AD structure in a non-connectable
+ *          advertising set, a gateway takes it from its scan reports without
+ *          connecting or sending a scan request. The beacon data is built
+ *          again only when the status changes, and every change steps a
+ *          counter so an observer can tell a new status from a repeat.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_BEACON_H_
+#define SRC_BEACON_H_
+
+#include <stdint.h>
+
+
+#define BEACON_COMPANY_ID       (0xFFFF)  // Reserved for tests, no company
+#define BEACON_TYPE_STATUS      (0x01)    // Format version of the record
+
+/* Advertising data, little endian:
+ *  [0..2]    Flags AD structure, BR/EDR not supported
+ *  [3]       AD length, the bytes after it
+ *  [4]       AD_TYPE_MANUFACTURER
+ *  [5..6]    BEACON_COMPANY_ID
+ *  [7]       BEACON_TYPE_STATUS
+ *  [8]       Change counter
+ *  [9..10]   Current temperature of the main zone in tenths of F
+ *  [11..12]  Target temperature of the main zone in tenths of F
+ *  [13]      Mode, BEACON_MODE_OUTPUT_MASK bits the control output and
+ *            BEACON_MODE_AUTO
+ *  [14]      Actuators that are on, bit per client index
+ *  [15]      Health, beacon_health_t */
+#define BEACON_DATA_LEN         (16)
+#define BEACON_MODE_OUTPUT_MASK (0x03)
+#define BEACON_MODE_AUTO        (1 << 2)
+
+
+// The worst condition of the server, higher is worse
+typedef enum {
+  BEACON_HEALTH_OK = 0,
+  BEACON_HEALTH_CLOCK_NOT_SET,    // The schedule waits for the local time
+  BEACON_HEALTH_CLIENT_LOST,      // An actuator cannot be controlled
+  BEACON_HEALTH_NO_CLIENTS        // Nothing provisioned yet
+}beacon_health_t;
+
+typedef struct {
+  int16_t current;                // Tenths of F
+  int16_t target;
+  uint8_t mode;                   // BEACON_MODE_* bits
+  uint8_t on;                     // Bit per client index
+  uint8_t health;                 // beacon_health_t
+}beacon_status_t;
+
+typedef struct {
+  beacon_status_t status;         // Of the data
+  uint8_t counter;
+  uint8_t data[BEACON_DATA_LEN];
+  uint8_t built;                  // 0 until the first update
+  uint32_t updates;               // Stats
+  uint32_t unchanged;
+}beacon_t;
+
+
+/******************************************************************************
+ * @brief Clears the beacon, the first update builds its data.
+ ******************************************************************************/
+void beacon_init(beacon_t *beacon);
+
+
+/******************************************************************************
+ * @brief Encodes a status into the advertising data.
+ *
+ * @param
+ *  status    Status
+ *  counter   Change counter
+ *  data      BEACON_DATA_LEN bytes out
+ *
+ * @return
+ *  Length of the data, BEACON_DATA_LEN.
+ *
+ ******************************************************************************/
+uint8_t beacon_encode(const beacon_status_t *status, uint8_t counter,
+                      uint8_t *data);
+
+
+/******************************************************************************
+ * @brief Decodes the status from the advertising data of a scan report, for
+ * a monitor. The AD structures are walked with adparse.h, the beacon may come
+ * with other structures in any order.
+ *
+ * @param
+ *  data      Advertising data
+ *  len       Length of data
+ *  status    Status out
+ *  counter   Change counter out
+ *
+ * @return
+ *  Returns 1 if a status beacon of a known format is found.
+ *
+ ******************************************************************************/
+uint8_t beacon_decode(const uint8_t *data, uint8_t len, beacon_status_t *status,
+                      uint8_t *counter);
+
+
+/******************************************************************************
+ * @brief Builds the data of a new status, the counter steps. Nothing is done
+ * if the status is the one of the data.
+ *
+ * @return
+ *  Returns 1 if the data changed and has to be set on the advertiser.
+ *
+ ******************************************************************************/
+uint8_t beacon_update(beacon_t *beacon, const beacon_status_t *status);
+
+
+#endif /* SRC_BEACON_H_ */
@@ -12,60 +12,206 @@
  *          automatically (auto feature on) and manual triggering of scanning
  *          using PB0 event.
  *
+ * @editor  Oct 19, 2026
+ * @change  Replaced the on/off logic in update_current_temperature() with the
+ *          control engine in control.c and added daily switch/indication
+ *          stats.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the weekly schedule of target temperatures. The schedule and
+ *          the local time are written over GATT, the schedule is kept in NVM
+ *          and a soft timer wakes up at every transition.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the learned recovery, the heating and cooling rates are
+ *          learned on every sample and the next target of the schedule is
+ *          taken early by the lead time they give.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Moved the temperatures and the control state into zones, the
+ *          clients are the actuators of their zone and only the zones with a
+ *          new sample or target are run. The zones are shown on the LCD and
+ *          over GATT.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The client states requested by the zones are sent by the
+ *          actuation scheduler in actuation.c, which keeps the AC and the
+ *          Heater of a zone from being on together, staggers the starts and
+ *          sends the indications of a run together.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The clients are looked up through the registry in registry.c
+ *          instead of linear scans, the connection state and handle of a
+ *          client are set through set_client_conn_state() and
+ *          set_client_conn_handle() to keep it in sync.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The scanner keeps running across scan reports and while clients
+ *          connect and bond, it stops once no client is left to be found or
+ *          after SCAN_TIMEOUT_S. The clients are opened one after another as
+ *          their reports come in.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The clients are put on the accept list of the controller and the
+ *          scanner only reports them, other advertisers no longer wake the
+ *          application.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The bondings are no longer deleted on boot and on disconnect. A
+ *          client with a stored bonding is encrypted from its keys on
+ *          reconnect without pairing, the time from a link loss until the
+ *          client takes indications again is logged.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The state indications go through the outbox of the client in
+ *          outbox.c, one in flight per client with the waiting states
+ *          coalesced, retried with a backoff on failure and sent again after
+ *          an indication timeout or a link loss.
+ *
+ * @editor  Oct 19, 2026
+ * @change  A client subscribing to notifications of its state characteristic
+ *          gets the states as notifications of a sequence number and the
+ *          state, without waiting on a confirmation. It acknowledges them by
+ *          writing the sequence number back to the characteristic.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The connection parameters of a client link follow its traffic
+ *          through the manager in connparam.c, short intervals during the
+ *          setup of the client, commands and OTA, a long interval with a high
+ *          peripheral latency once the link is idle.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the PHY policy of a client in phy.c. A near client runs the
+ *          2M PHY while its link is active, a distant one is scanned for and
+ *          opened on the Coded PHY. The opens and the airtime of the state
+ *          transactions are kept per PHY.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the status and control characteristics of the thermostat
+ *          service. The status is a user characteristic packed from the live
+ *          state on every read, a change is batched into one notification of
+ *          the whole record. The server advertises the thermostat service so
+ *          a phone can connect while it is central to the clients.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The scan timing follows the duty cycle scheduler in scansched.c,
+ *          aggressive after the boot, a link loss or PB0 and backing off to a
+ *          background duty cycle. The scanner no longer gives up on a client
+ *          after SCAN_TIMEOUT_S.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Removed the hard coded client addresses. PB0 starts the
+ *          provisioning mode, the scan reports of unknown devices are walked
+ *          with the AD iterator in adparse.c for the AC or Heater service
+ *          UUID and a match is added as a client, bonded and saved in NVM.
+ *          The clients are loaded from NVM on boot, with none saved the
+ *          provisioning starts by itself.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The server takes up to SERVER_MAX_CLIENTS clients. The active
+ *          interval of the links is planned by linksched.c so the events of
+ *          all the links fit in a schedule repeating every idle interval, the
+ *          max CE length of a link follows its PHY. The state commands are
+ *          handed to the stack round robin over the links, at most
+ *          LINKSCHED_TX_PER_ROUND per round, and the capacity of the
+ *          schedule is reported.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the broadcast mode. The states of all the clients are kept
+ *          in the command table of bcast.c, published in a periodic
+ *          advertising train. A bonded client reads the broadcast key and
+ *          its slot and closes its link, it then takes its states from the
+ *          train and acks them in its advertising. A client missing an ack
+ *          for BCAST_ACK_TIMEOUT_MS is connected again.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the status beacon. With BEACON_ENABLE the current and
+ *          target temperatures, the mode, the actuator states and a health
+ *          code are advertised in a non-connectable set, rebuilt from
+ *          update_lcd() only when they change.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the latency probe. With PROBE_ENABLE every client subscribed
+ *          to the probe characteristic of its service is pinged every
+ *          PROBE_PERIOD_MS, its echo gives the round trip and one way
+ *          latencies of probe.c under the connection parameters in effect.
+ *          The probes are logged and read from the probe report
+ *          characteristic.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the time sync. Every echo taken is a sample of the client
+ *          clock for timesync.c and every ping carries the estimate after it,
+ *          for the client to take the server time from its own clock.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Every sample of a zone is kept in the history of history.c. With
+ *          EXPORT_ENABLE a phone on an encrypted link opens the L2CAP channel
+ *          of export.c and takes the history from any record index in SDUs
+ *          sent straight out of the ring, paced by its credits. A phone
+ *          pairs like a client, its passkey is confirmed with PB0.
+ *
  ******************************************************************************/
+#include <stdio.h>
 #include "ble.h"
 #include "lcd.h"
 #include "scheduler.h"
 #include "common.h"
 #include "gpio.h"
+#include "timers.h"
+#include "sl_sleeptimer.h"
+#include "adparse.h"
+#include "mbedtls/cmac.h"
 #include "../autogen/gatt_db.h"
 
 
 #define PASSIVE_SCANNING 0
-#define SCAN_INTERVAL 80          // => 50ms / 0.625ms = 80
-#define SCAN_WINDOW 40            // => 25ms / 0.625ms = 40
-#define CONNECTION_INTERVAL 75    // => 75ms / 1.25ms = 60
-#define CONNECTION_LATENCY 4
-#define CONNECTION_TIMEOUT 750    // => (1 + @p latency) * @p max_interval * 2 = (1 + 4) * 75 * 2 = 750ms
 #define CONNECTION_MIN_CE 0
 #define CONNECTION_MAX_CE 4
+#define STATE_INDICATION_LEN 12   // State, L2CAP and ATT headers and the MIC
+#define STATE_NOTIFICATION_LEN 13 // Same with the sequence number
+#define STATE_CONFIRMATION_LEN 9
+#define PROBE_NOTIFICATION_LEN TIMESYNC_PING_PDU_LEN
+#define PROBE_ECHO_WRITE_LEN TIMESYNC_ECHO_PDU_LEN
+#define ADV_INTERVAL 400          // => 250ms / 0.625ms = 400
+#define ATT_ERROR_REQUEST_NOT_SUPPORTED 0x06
+#define ATT_ERROR_INVALID_OFFSET 0x07
+#define ATT_ERROR_INVALID_LENGTH 0x0D
+#define ATT_ERROR_OUT_OF_RANGE 0xFF
+
+
+/* Service UUIDs advertised by the clients, little endian, at client_type - 1:
+ * AC Device 1032814e-7df0-4c6f-8c9f-a6735f9baa00 and
+ * Heater Device 21685485-b057-4cc5-bed4-f18cdfd32de3 */
+static const uint8_t client_uuids[][AD_UUID128_LEN] = {
+    {0x00, 0xaa, 0x9b, 0x5f, 0x73, 0xa6, 0x9f, 0x8c,
+     0x6f, 0x4c, 0xf0, 0x7d, 0x4e, 0x81, 0x32, 0x10},
+    {0xe3, 0x2d, 0xd3, 0xdf, 0x8c, 0xf1, 0xd4, 0xbe,
+     0xc5, 0x4c, 0x57, 0xb0, 0x85, 0x54, 0x68, 0x21}
+};
 
+client_data_t g_client_data[SERVER_MAX_CLIENTS];
 
-client_data_t g_client_data[] = {
-    {
-        {.addr = {0x49, 0x4a, 0xa6, 0x14, 0x2e, 0x84}},
-        .client_type = CLIENT_TYPE_AC,
-        .conn_state = CONN_STATE_UNKNOWN,
-        .onoff_state = CLIENT_STATE_OFF,
-        .conn_handle = 0,
-        .bond_handle = 0,
-        .indications_enabled = 0,
-        .gatt_ack_pending = 0
-    },
-    {
-        {.addr = {0x3f, 0x4a, 0xa6, 0x14, 0x2e, 0x84}},
-        .client_type = CLIENT_TYPE_HEATER,
-        .conn_state = CONN_STATE_UNKNOWN,
-        .onoff_state = CLIENT_STATE_OFF,
-        .conn_handle = 0,
-        .bond_handle = 0,
-        .indications_enabled = 0,
-        .gatt_ack_pending = 0
-    }
-};
+// Defined with the broadcast mode further down, next to the scanner it needs
+void broadcast_client_state(client_data_t *client);
 
 server_data_t g_server_data = {
-    .current_temp = 0,
-    .target_temp = 0,
-    .offset_temp = 0,
-    .session_scans_count = 0,
+    .indications_sent = 0,
+    .stats_start_s = 0,
+    .clock_set = 0,
+    .scanning = 0,
     .automatic_temp_control = 1,
     .clients_data = g_client_data,
-    .clients_count = sizeof(g_client_data) / sizeof(client_data_t),
+    .clients_count = 0,
     .lcd_on = 0,
     .lcd_on_timeout = 0
 };
 
+// Rings of the export streams, at EXPORT_STREAM_*
+static const export_source_t export_sources[EXPORT_STREAMS] = {
+    { g_server_data.history.records, HISTORY_RECORD_LEN, HISTORY_RECORDS,
+      &g_server_data.history.written }
+};
+
 
 /******************************************************************************
  * SEE HEADER FILE FOR FULL DETAILS
@@ -74,6 +220,102 @@ server_data_t g_server_data = {
 void ble_init()
 {
   displayInit();
+
+  zone_table_init(&g_server_data.zones);
+
+  for (uint8_t i = 0; i < SERVER_ZONE_COUNT; i++)
+    zone_add(&g_server_data.zones, timerGetUptimeSec());
+
+  actuation_init(&g_server_data.actuation, ACTUATION_STAGGER_S);
+  registry_init(&g_server_data.registry);
+  linksched_init(&g_server_data.link_sched);
+
+  schedule_init(&g_server_data.schedule);
+  recovery_init(&g_server_data.recovery);
+
+  history_init(&g_server_data.history);
+  export_init(&g_server_data.export);
+}
+
+
+/******************************************************************************
+ * @brief   Adds a client in the next free slot and makes it an actuator of
+ * ZONE_MAIN. The index of the client in clients_data is its index in the
+ * registry.
+ *
+ * @param
+ *  addr          Address of the client.
+ *  addr_type     Type of the address.
+ *  client_type   AC/Heater.
+ *
+ * @return
+ *  Returns NULL if no slot is left or the zone takes no more actuators else
+ *  returns the pointer to the client.
+ *
+ ******************************************************************************/
+client_data_t* add_client(bd_addr addr, uint8_t addr_type, client_type_t client_type)
+{
+  uint8_t index = g_server_data.clients_count;
+  client_data_t *client = &g_server_data.clients_data[index];
+  control_output_t kind = CONTROL_OUTPUT_COOL;
+  int8_t actuator;
+
+  if (index == SERVER_MAX_CLIENTS)
+    return NULL;
+
+  if (registry_add(&g_server_data.registry, addr.addr, client_type,
+                   CONN_STATE_UNKNOWN) != index) {
+      LOG_ERROR("Failed to add client %u to the registry\n", index);
+      return NULL;
+  }
+
+  memset(client, 0, sizeof(client_data_t));
+  client->addr = addr;
+  client->addr_type = addr_type;
+  client->client_type = client_type;
+  client->conn_state = CONN_STATE_UNKNOWN;
+  client->onoff_state = CLIENT_STATE_OFF;
+  client->bond_handle = SL_BT_INVALID_BONDING_HANDLE;
+  client->zone = ZONE_MAIN;
+  client->phy_policy = PHY_POLICY_2M;
+
+  outbox_init(&client->outbox);
+  phy_init(&client->phy, client->phy_policy);
+
+  if (client_type == CLIENT_TYPE_HEATER)
+    kind = CONTROL_OUTPUT_HEAT;
+
+  // Without an actuator of its own it would drive the actuator 0 of the memset
+  actuator = zone_add_actuator(&g_server_data.zones, client->zone, kind, index);
+  if (actuator < 0) {
+      LOG_ERROR("Failed to add client %u to zone %u\n", index, client->zone);
+      registry_remove_last(&g_server_data.registry);
+      return NULL;
+  }
+
+  client->actuator = (uint8_t)actuator;
+  g_server_data.clients_count++;
+
+  return client;
+}
+
+
+/******************************************************************************
+ * @brief   Maps an index of the registry to the client.
+ *
+ * @param
+ *  index   Index of the client, REGISTRY_NONE if not found.
+ *
+ * @return
+ *  Returns NULL for REGISTRY_NONE else returns the pointer to the client.
+ *
+ ******************************************************************************/
+client_data_t* get_client_by_index(uint8_t index)
+{
+  if (index >= g_server_data.clients_count)
+    return NULL;
+
+  return &g_server_data.clients_data[index];
 }
 
 
@@ -90,12 +332,7 @@ void ble_init()
  ******************************************************************************/
 client_data_t* get_client_by_addr(bd_addr addr)
 {
-  for (int i = 0; i < g_server_data.clients_count; i++) {
-      if (!memcmp(addr.addr, g_server_data.clients_data[i].addr.addr, 6)) {
-          return &g_server_data.clients_data[i];
-      }
-  }
-  return NULL;
+  return get_client_by_index(registry_find_addr(&g_server_data.registry, addr.addr));
 }
 
 
@@ -112,12 +349,7 @@ client_data_t* get_client_by_addr(bd_addr addr)
  ******************************************************************************/
 client_data_t* get_client_by_conn_handle(uint8_t conn_handle)
 {
-  for (int i = 0; i < g_server_data.clients_count; i++) {
-      if (conn_handle == g_server_data.clients_data[i].conn_handle) {
-          return &g_server_data.clients_data[i];
-      }
-  }
-  return NULL;
+  return get_client_by_index(registry_find_conn(&g_server_data.registry, conn_handle));
 }
 
 
@@ -125,7 +357,7 @@ client_data_t* get_client_by_conn_handle(uint8_t conn_handle)
  * @brief   Searches for client with matching connection state.
  *
  * @param
- *  conn_handle    Client with given connection state to be searched.
+ *  conn_state    OR of the connection states to be searched.
  *
  * @return
  *  Returns NULL if the client with matching connection state is not found else
@@ -134,12 +366,7 @@ client_data_t* get_client_by_conn_handle(uint8_t conn_handle)
  ******************************************************************************/
 client_data_t* get_client_by_conn_state(uint32_t conn_state)
 {
-  for (int i = 0; i < g_server_data.clients_count; i++) {
-      if (conn_state & (uint32_t)g_server_data.clients_data[i].conn_state) {
-          return &g_server_data.clients_data[i];
-      }
-  }
-  return NULL;
+  return get_client_by_index(registry_first_in_states(&g_server_data.registry, conn_state));
 }
 
 
@@ -157,321 +384,2479 @@ client_data_t* get_client_by_conn_state(uint32_t conn_state)
  ******************************************************************************/
 client_data_t* get_client_by_type(client_type_t client_type)
 {
-  for (int i = 0; i < g_server_data.clients_count; i++) {
-      if (client_type == g_server_data.clients_data[i].client_type) {
-          return &g_server_data.clients_data[i];
-      }
-  }
-  return NULL;
+  return get_client_by_index(registry_first_of_kind(&g_server_data.registry, client_type));
 }
 
+
 /******************************************************************************
- * @brief   Updates the server and client info on the LCD.
+ * @brief   Sets the connection state of a client.
+ *
+ * @param
+ *  client        Client to be updated.
+ *  conn_state    New connection state.
+ *
  ******************************************************************************/
-void update_lcd(void)
+void set_client_conn_state(client_data_t *client, client_conn_state_t conn_state)
 {
-  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
-      char display_str[20];
-      uint32_t display_row;
-
-      if (g_server_data.clients_data[i].client_type == CLIENT_TYPE_AC) {
-          strcpy (display_str, "AC: ");
-          display_row = DISPLAY_ROW_BTADDR2;
-      }
-      else if (g_server_data.clients_data[i].client_type == CLIENT_TYPE_HEATER) {
-          strcpy (display_str, "Heater: ");
-          display_row = DISPLAY_ROW_CLIENTADDR;
-      }
+  client->conn_state = conn_state;
+  registry_set_state(&g_server_data.registry,
+                     (uint8_t)(client - g_server_data.clients_data), conn_state);
+}
 
-      switch (g_server_data.clients_data[i].conn_state)
-      {
-        case CONN_STATE_UNKNOWN:
-          strcat(display_str, "UNKNOWN");
-          break;
-        case CONN_STATE_SCANNING:
-          strcat(display_str, "SCANNING");
-          break;
-        case CONN_STATE_CONNECTING:
-          strcat(display_str, "CONNECTING");
-          break;
-        case CONN_STATE_CONNECTED:
-          strcat(display_str, "CONNECTED");
-          break;
-        case CONN_STATE_BONDING:
-        case CONN_STATE_PASSKEY:
-          strcat(display_str, "BONDING");
-          break;
-        case CONN_STATE_BONDED:
-          if (g_server_data.clients_data[i].onoff_state == CLIENT_STATE_ON)
-            strcat(display_str, "ON");
-          else
-            strcat(display_str, "OFF");
-          break;
-        case CONN_STATE_NOT_BONDED:
-          strcat(display_str, "NOT BOND");
-          break;
-        case CONN_STATE_DISCONNECTED:
-          strcat(display_str, "DISCONNECTED");
-          break;
-        case CONN_STATE_NOT_FOUND:
-          strcat(display_str, "NOT FOUND");
-          break;
-      }
 
-      displayPrintf( display_row, display_str);
-  }
+/******************************************************************************
+ * @brief   Sets the connection handle of a client, 0 when not connected.
+ *
+ * @param
+ *  client        Client to be updated.
+ *  conn_handle   New connection handle.
+ *
+ ******************************************************************************/
+void set_client_conn_handle(client_data_t *client, uint8_t conn_handle)
+{
+  client->conn_handle = conn_handle;
+  registry_set_conn(&g_server_data.registry,
+                    (uint8_t)(client - g_server_data.clients_data), conn_handle);
+}
 
-  if (get_client_by_conn_state(CONN_STATE_PASSKEY) == NULL) {
-      displayPrintf(DISPLAY_ROW_PASSKEY, "");
-      displayPrintf(DISPLAY_ROW_ACTION, "");
-  }
 
-  displayPrintf(DISPLAY_ROW_NAME, "Smart Thermostat");
-  displayPrintf(DISPLAY_ROW_8, "Curr Temp : %dF", g_server_data.current_temp);
-  displayPrintf(DISPLAY_ROW_ASSIGNMENT, "Course Project");
+/******************************************************************************
+ * @brief   Moves all the clients in any of the given connection states to a
+ * new state.
+ *
+ * @param
+ *  from_states   OR of the connection states of the clients to be moved.
+ *  conn_state    New connection state.
+ *
+ ******************************************************************************/
+void move_clients_conn_state(uint32_t from_states, client_conn_state_t conn_state)
+{
+  uint64_t clients = registry_in_states(&g_server_data.registry, from_states);
 
-  if (g_server_data.automatic_temp_control) {
-      displayPrintf(DISPLAY_ROW_11, "Auto On");
-      displayPrintf(DISPLAY_ROW_9, "Target Temp : %dF", g_server_data.target_temp);
-  }
-  else {
-      displayPrintf(DISPLAY_ROW_11, "Auto Off");
-      displayPrintf(DISPLAY_ROW_9, "");
+  while (clients) {
+      set_client_conn_state(&g_server_data.clients_data[__builtin_ctzll(clients)],
+                            conn_state);
+      clients &= clients - 1;
   }
 }
 
-
 /******************************************************************************
- * @brief   Turns On/Off a client of type AC/Heater, sends respective
- * indication to respective client and finally updates the same data on the
- * LCD.
+ * @brief   Packs the status record from the live state, see STATUS_RECORD_LEN
+ * for the layout. The temperatures are in tenths of F.
  *
  * @param
- *  client_type   The client device type to be controlled AC/Heater.
- *  onoff_state   State to which client device to be set On/Off.
+ *  data    STATUS_RECORD_LEN bytes
  *
  ******************************************************************************/
-void set_client_state(client_type_t client_type, client_state_t onoff_state)
+void pack_status(uint8_t *data)
 {
-  client_data_t *client = get_client_by_type(client_type);
-
-  if (client == NULL)
-    return;
+  const zone_t *main_zone = &g_server_data.zones.zones[ZONE_MAIN];
+  int16_t current = main_zone->current_temp * 10;
+  int16_t target = main_zone->target_temp * 10;
+  uint32_t switches = 0;
+  uint8_t on = 0;
+  uint8_t bonded = 0;
+
+  for (uint8_t i = 0; i < g_server_data.zones.zone_count; i++)
+    switches += g_server_data.zones.zones[i].control.switches;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count && i < 8; i++) {
+      if (g_server_data.clients_data[i].onoff_state == CLIENT_STATE_ON)
+        on |= 1 << i;
+      if (g_server_data.clients_data[i].conn_state & (CONN_STATE_BONDED | CONN_STATE_BROADCAST))
+        bonded |= 1 << i;
+  }
 
-  if (client->conn_state == CONN_STATE_BONDED && client->onoff_state != onoff_state) {
-      client->onoff_state = onoff_state;
-      // send indication
-      sl_status_t status;
+  data[0] = g_server_data.status_seq;
+  data[1] = (g_server_data.automatic_temp_control ? STATUS_FLAG_AUTO : 0) |
+      (g_server_data.clock_set ? STATUS_FLAG_CLOCK_SET : 0) |
+      (g_server_data.scanning ? STATUS_FLAG_SCANNING : 0);
+  data[2] = (uint8_t)current;
+  data[3] = (uint8_t)(current >> 8);
+  data[4] = (uint8_t)target;
+  data[5] = (uint8_t)(target >> 8);
+  data[6] = zone_output(&g_server_data.zones, ZONE_MAIN);
+  data[7] = on;
+  data[8] = bonded;
+  data[9] = g_server_data.zones.zone_count;
+  data[10] = (uint8_t)switches;
+  data[11] = (uint8_t)(switches >> 8);
+  data[12] = (uint8_t)(switches >> 16);
+  data[13] = (uint8_t)(switches >> 24);
+  data[14] = (uint8_t)g_server_data.indications_sent;
+  data[15] = (uint8_t)(g_server_data.indications_sent >> 8);
+  data[16] = (uint8_t)(g_server_data.indications_sent >> 16);
+  data[17] = (uint8_t)(g_server_data.indications_sent >> 24);
+}
 
-      if (client->client_type == CLIENT_TYPE_AC && client->indications_enabled) {
-          LOG_INFO("TURNED ON/OFF THE AC\n");
-          status = sl_bt_gatt_server_send_indication(
-              client->conn_handle,
-              gattdb_ac_state,
-              1,
-              &client->onoff_state
-          );
 
-          if (status != SL_STATUS_OK)
-            LOG_ERROR("Failed to send indication %u\n", status);
-          else
-            LOG_INFO("Successfully sent indication\n");
-      }
-      else if (client->client_type == CLIENT_TYPE_HEATER && client->indications_enabled) {
-          LOG_INFO("TURNED ON/OFF THE Heater\n");
-          status = sl_bt_gatt_server_send_indication(
-              client->conn_handle,
-              gattdb_heater_state,
-              1,
-              &client->onoff_state
-          );
+/******************************************************************************
+ * @brief   Arms the status timer if a subscriber waits for the status, the
+ * changes until it fires go out in one notification.
+ ******************************************************************************/
+void queue_status_notification(void)
+{
+  sl_status_t status;
 
-          if (status != SL_STATUS_OK)
-            LOG_ERROR("Failed to send indication %u\n", status);
-          else
-            LOG_INFO("Successfully sent indication\n");
-      }
+  if (g_server_data.status_subscribers == 0 || g_server_data.status_queued)
+    return;
 
-      update_lcd();
+  status = sl_bt_system_set_soft_timer(ms_to_ticks(STATUS_BATCH_MS),
+                                       SOFT_TIMER_HANDLE_STATUS, 1);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to set status timer %u\n", status);
+      return;
   }
+
+  g_server_data.status_queued = 1;
 }
 
 
 /******************************************************************************
- * SEE HEADER FILE FOR FULL DETAILS
- * Toggles the state of the connected client On/Off state.
+ * @brief   Notifies the subscribers of the status record if it changed since
+ * the last notification.
  ******************************************************************************/
-void toggle_client_state(client_type_t client_type)
+void handle_status_timer(void)
 {
-  g_server_data.automatic_temp_control = 0;
+  uint8_t data[STATUS_RECORD_LEN];
+  uint32_t subscribers = g_server_data.status_subscribers;
 
-  client_data_t *client = get_client_by_type(client_type);
+  g_server_data.status_queued = 0;
 
-  if (client == NULL)
+  pack_status(data);
+
+  // The sequence number aside, nothing the subscribers see changed
+  if (memcmp(data + 1, g_server_data.status_sent + 1, STATUS_RECORD_LEN - 1) == 0)
     return;
 
-  if (client->onoff_state == CLIENT_STATE_ON)
-    set_client_state(client_type, CLIENT_STATE_OFF);
-  else
-    set_client_state(client_type, CLIENT_STATE_ON);
+  data[0] = ++g_server_data.status_seq;
+  memcpy(g_server_data.status_sent, data, STATUS_RECORD_LEN);
+
+  while (subscribers) {
+      uint8_t connection = __builtin_ctz(subscribers);
+      sl_status_t status;
+
+      subscribers &= subscribers - 1;
+
+      status = sl_bt_gatt_server_send_notification(connection,
+                                                   gattdb_thermostat_status,
+                                                   STATUS_RECORD_LEN, data);
+      if (status != SL_STATUS_OK)
+        LOG_ERROR("Failed to notify status %u\n", status);
+      else
+        g_server_data.status_notifications++;
+  }
 }
 
 
 /******************************************************************************
- * SEE HEADER FILE FOR FULL DETAILS
- * Toggles the auto On/Off feature.
+ * @brief   Packs the status of the beacon, see beacon.h. The health is the
+ * worst condition of the server.
  ******************************************************************************/
-void toggle_auto_feature()
+void pack_beacon_status(beacon_status_t *status)
 {
-  g_server_data.automatic_temp_control = !g_server_data.automatic_temp_control;
+  const zone_t *main_zone = &g_server_data.zones.zones[ZONE_MAIN];
 
-  if (g_server_data.automatic_temp_control)
-    update_current_temperature(g_server_data.current_temp);
+  status->current = main_zone->current_temp * 10;
+  status->target = main_zone->target_temp * 10;
+  status->mode = (zone_output(&g_server_data.zones, ZONE_MAIN) & BEACON_MODE_OUTPUT_MASK) |
+      (g_server_data.automatic_temp_control ? BEACON_MODE_AUTO : 0);
+  status->on = 0;
+  status->health = g_server_data.clock_set ? BEACON_HEALTH_OK : BEACON_HEALTH_CLOCK_NOT_SET;
 
-  update_lcd();
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      const client_data_t *client = &g_server_data.clients_data[i];
+
+      if (i < 8 && client->onoff_state == CLIENT_STATE_ON)
+        status->on |= 1 << i;
+      if (!(client->conn_state & (CONN_STATE_BONDED | CONN_STATE_BROADCAST)))
+        status->health = BEACON_HEALTH_CLIENT_LOST;
+  }
+
+  if (g_server_data.clients_count == 0)
+    status->health = BEACON_HEALTH_NO_CLIENTS;
 }
 
 
 /******************************************************************************
- * SEE HEADER FILE FOR FULL DETAILS
- * Updates the current temperature and displays the same on the LCD.
+ * @brief   Sets the beacon data on its advertiser if the status changed.
  ******************************************************************************/
-void update_current_temperature(int16_t temp)
+void update_beacon(void)
 {
-  if (temp > 0 && temp <= 125) {
-      LOG_INFO("Current temperature = %d", temp);
+#if BEACON_ENABLE
+  beacon_status_t status;
+  sl_status_t sc;
 
-      g_server_data.current_temp = temp;
+  if (!g_server_data.beacon_on)
+    return;
 
-      if (g_server_data.target_temp == 0)
-        g_server_data.target_temp = temp;
+  pack_beacon_status(&status);
 
-      if (g_server_data.automatic_temp_control) {
-          if (g_server_data.current_temp > (g_server_data.target_temp + g_server_data.offset_temp)) {
-              set_client_state(CLIENT_TYPE_AC, CLIENT_STATE_ON);
-              set_client_state(CLIENT_TYPE_HEATER, CLIENT_STATE_OFF);
-          }
-          else if (g_server_data.current_temp < (g_server_data.target_temp - g_server_data.offset_temp)) {
-              set_client_state(CLIENT_TYPE_AC, CLIENT_STATE_OFF);
-              set_client_state(CLIENT_TYPE_HEATER, CLIENT_STATE_ON);
-          }
-          else {
-              set_client_state(CLIENT_TYPE_AC, CLIENT_STATE_OFF);
-              set_client_state(CLIENT_TYPE_HEATER, CLIENT_STATE_OFF);
-          }
-      }
+  if (!beacon_update(&g_server_data.beacon, &status))
+    return;
 
-      update_lcd();
-  }
-  else {
-      LOG_ERROR("Invalid temperature range!");
-  }
+  sc = sl_bt_advertiser_set_data(g_server_data.beacon_handle, 0, BEACON_DATA_LEN,
+                                 g_server_data.beacon.data);
+  if (sc != SL_STATUS_OK)
+    LOG_ERROR("Failed to set beacon data %u\n", sc);
+#endif
 }
 
 
 /******************************************************************************
- * SEE HEADER FILE FOR FULL DETAILS
- * Increases the value of the target temperature value.
+ * @brief   Starts the status beacon, legacy non-connectable advertising of the
+ * data of beacon.h only, a gateway scanning passively takes it.
  ******************************************************************************/
-void increase_taget_temperature()
+void start_beacon(void)
 {
-  if (!g_server_data.automatic_temp_control)
-    return;
+  sl_status_t status;
 
-  if (g_server_data.target_temp < 125)
-    g_server_data.target_temp++;
-  else
-    g_server_data.target_temp = 125;
+  beacon_init(&g_server_data.beacon);
+
+  status = sl_bt_advertiser_create_set(&g_server_data.beacon_handle);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to create beacon advertiser set %u\n", status);
+      return;
+  }
 
-  update_current_temperature(g_server_data.current_temp);
+  g_server_data.beacon_on = 1;
 
-  update_lcd();
+  status = sl_bt_advertiser_set_timing(g_server_data.beacon_handle, BEACON_INTERVAL,
+                                       BEACON_INTERVAL, 0, 0);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set beacon timing %u\n", status);
+
+  update_beacon();
+
+  status = sl_bt_advertiser_start(g_server_data.beacon_handle,
+                                  sl_bt_advertiser_user_data,
+                                  sl_bt_advertiser_non_connectable);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to start beacon %u\n", status);
 }
 
 
 /******************************************************************************
- * SEE HEADER FILE FOR FULL DETAILS
- * Decreases the value of the target temperature value.
+ * @brief   Starts advertising the thermostat service for a phone to connect.
  ******************************************************************************/
-void decrease_taget_temperature()
+void start_advertising(void)
 {
-  if (!g_server_data.automatic_temp_control)
-    return;
-
-  if (g_server_data.target_temp > 1)
-    g_server_data.target_temp--;
-  else
-    g_server_data.target_temp = 1;
-
-  update_current_temperature(g_server_data.current_temp);
+  sl_status_t status;
 
-  update_lcd();
+  status = sl_bt_advertiser_start(g_server_data.adv_handle,
+                                  sl_bt_advertiser_general_discoverable,
+                                  sl_bt_advertiser_connectable_scannable);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to start advertising %u\n", status);
 }
 
 
 /******************************************************************************
- * @brief   Initiates the BT scanning. Does number of checks to verify if the
- * scan can be initiated (when one of the client is bonding) or if it is
- * necessary to initiate the scanning( when all the clients are connected).
- *
+ * @brief   Updates the server and client info on the LCD.
  ******************************************************************************/
-void start_bt_scan(void)
+void update_lcd(void)
 {
-  sl_status_t status;
-  client_data_t *client;
+  const zone_t *main_zone = &g_server_data.zones.zones[ZONE_MAIN];
 
-  /* If one of the clients is in the process of connection/bonding then don't
-   * scan until bonding is complete */
-  client = get_client_by_conn_state(CONN_STATE_CONNECTING | CONN_STATE_CONNECTED
-                                    | CONN_STATE_BONDING);
+  // Each kind shares one row: index 0 is the ACs, index 1 the heaters
+  static const uint32_t kind_row[2] = { DISPLAY_ROW_BTADDR2, DISPLAY_ROW_CLIENTADDR };
+  static const char *kind_name[2] = { "AC", "Heater" };
+  char display_str[2][DISPLAY_ROW_LEN + 1];
+  uint8_t total[2] = { 0, 0 };
+  uint8_t bonded[2] = { 0, 0 };
+  uint8_t on[2] = { 0, 0 };
 
-  if (client != NULL)
-    return;
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      const client_data_t *client = &g_server_data.clients_data[i];
+      uint8_t kind = (client->client_type == CLIENT_TYPE_HEATER) ? 1 : 0;
+      const char *state = "";
 
-  /* If the clients are not found with the number of scans limit then set the
-   * client status as NOT FOUND and block any further scanning unless scanning
-   * is manually triggered by the user */
-  if (g_server_data.session_scans_count == MAX_SESSION_SCANS) {
-      g_server_data.session_scans_count = MAX_SESSION_SCANS;
-      while(get_client_by_conn_state(CONN_STATE_SCANNING) != NULL){
-          get_client_by_conn_state(CONN_STATE_SCANNING)->conn_state = CONN_STATE_NOT_FOUND;
+      switch (client->conn_state)
+      {
+        case CONN_STATE_UNKNOWN:
+          state = "UNKNOWN";
+          break;
+        case CONN_STATE_SCANNING:
+          state = "SCANNING";
+          break;
+        case CONN_STATE_CONNECTING:
+          state = "CONNECTING";
+          break;
+        case CONN_STATE_CONNECTED:
+          state = "CONNECTED";
+          break;
+        case CONN_STATE_BONDING:
+        case CONN_STATE_PASSKEY:
+        case CONN_STATE_ENCRYPTING:
+          state = "BONDING";
+          break;
+        case CONN_STATE_BONDED:
+        case CONN_STATE_BROADCAST:
+          bonded[kind]++;
+          if (client->onoff_state == CLIENT_STATE_ON) {
+              state = "ON";
+              on[kind]++;
+          }
+          else
+            state = "OFF";
+          break;
+        case CONN_STATE_NOT_BONDED:
+          state = "NOT BOND";
+          break;
+        case CONN_STATE_DISCONNECTED:
+          state = "DISCONNECTED";
+          break;
+        case CONN_STATE_NOT_FOUND:
+          state = "NOT FOUND";
+          break;
       }
-      update_lcd();
-      return;
+
+      total[kind]++;
+      snprintf(display_str[kind], sizeof(display_str[kind]), "%s: %s",
+               kind_name[kind], state);
   }
 
-  client = get_client_by_conn_state(CONN_STATE_SCANNING | CONN_STATE_NOT_FOUND);
+  // A lone client shows its state, several show bonded/total and how many
+  // are on, so no client overwrites another's row
+  for (uint8_t kind = 0; kind < 2; kind++) {
+      if (total[kind] == 0)
+        displayPrintf(kind_row[kind], "");
+      else if (total[kind] == 1)
+        displayPrintf(kind_row[kind], "%s", display_str[kind]);
+      else
+        displayPrintf(kind_row[kind], "%s %u/%u ok, %u on", kind_name[kind],
+                      bonded[kind], total[kind], on[kind]);
+  }
+
+  if (get_client_by_conn_state(CONN_STATE_PASSKEY) == NULL && !g_server_data.phone_passkey) {
+      displayPrintf(DISPLAY_ROW_PASSKEY, "");
+      displayPrintf(DISPLAY_ROW_ACTION, g_server_data.provisioning ? "Provisioning" : "");
+  }
+
+  displayPrintf(DISPLAY_ROW_NAME, "Smart Thermostat");
+  displayPrintf(DISPLAY_ROW_8, "Curr Temp : %dF", main_zone->current_temp);
+  displayPrintf(DISPLAY_ROW_ASSIGNMENT, "Course Project");
+
+  if (g_server_data.zones.zone_count > 1) {
+      uint8_t heating = 0;
+      uint8_t cooling = 0;
+
+      for (uint8_t i = 0; i < g_server_data.zones.zone_count; i++) {
+          control_output_t output = zone_output(&g_server_data.zones, i);
+
+          if (output == CONTROL_OUTPUT_HEAT)
+            heating++;
+          else if (output == CONTROL_OUTPUT_COOL)
+            cooling++;
+      }
+
+      displayPrintf(DISPLAY_ROW_10, "Zones:%u Heat:%u Cool:%u",
+                    g_server_data.zones.zone_count, heating, cooling);
+  }
+
+  if (g_server_data.automatic_temp_control) {
+      displayPrintf(DISPLAY_ROW_11, "Auto On");
+      displayPrintf(DISPLAY_ROW_9, "Target Temp : %dF", main_zone->target_temp);
+  }
+  else {
+      displayPrintf(DISPLAY_ROW_11, "Auto Off");
+      displayPrintf(DISPLAY_ROW_9, "");
+  }
+
+  // The status record and the beacon hold what the LCD shows
+  queue_status_notification();
+  update_beacon();
+}
+
+
+/******************************************************************************
+ * @brief   Sends the state of a client, called by the outbox. A client in the
+ * notification mode gets a notification of the sequence number and the state,
+ * else an indication of the state.
+ *
+ * @param
+ *  value   On/off state
+ *  seq     Sequence number of the snapshot
+ *  ctx     Client
+ *
+ * @return
+ *  Returns 0 if the state is sent.
+ *
+ ******************************************************************************/
+uint8_t send_client_state(uint8_t value, uint8_t seq, void *ctx)
+{
+  client_data_t *client = ctx;
+  uint16_t characteristic = gattdb_ac_state;
+  sl_status_t status;
+
+  if (client->client_type == CLIENT_TYPE_HEATER)
+    characteristic = gattdb_heater_state;
+
+  if (client->outbox.mode == OUTBOX_MODE_NOTIFICATION) {
+      uint8_t snapshot[2] = { seq, value };
+
+      status = sl_bt_gatt_server_send_notification(client->conn_handle,
+                                                   characteristic,
+                                                   sizeof(snapshot),
+                                                   snapshot);
+  }
+  else {
+      status = sl_bt_gatt_server_send_indication(client->conn_handle,
+                                                 characteristic,
+                                                 1,
+                                                 &value);
+  }
+
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to send state %u\n", status);
+      return 1;
+  }
+
+  if (client->outbox.mode == OUTBOX_MODE_NOTIFICATION)
+    phy_transaction(&client->phy, STATE_NOTIFICATION_LEN, 0);
+  else
+    phy_transaction(&client->phy, STATE_INDICATION_LEN, STATE_CONFIRMATION_LEN);
+
+  LOG_INFO("Successfully sent state %u seq %u\n", value, seq);
+  g_server_data.indications_sent++;
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief   Sender of the outbox of a client, NULL while the client takes no
+ * indications and its states wait.
+ ******************************************************************************/
+outbox_send_t client_sender(client_data_t *client)
+{
+  if (client->conn_state != CONN_STATE_BONDED || !client->indications_enabled)
+    return NULL;
+
+  return send_client_state;
+}
+
+
+/******************************************************************************
+ * @brief   Arms the indication timer for the earliest retry or
+ * acknowledgement timeout of the outboxes.
+ ******************************************************************************/
+void arm_indication_timer(void)
+{
+  uint32_t now_ms = timerGetUptimeMs();
+  uint32_t wait_ms = 0;
+  sl_status_t status;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      uint32_t client_ms = outbox_wait_ms(&g_server_data.clients_data[i].outbox, now_ms);
+
+      if (client_ms && (wait_ms == 0 || client_ms < wait_ms))
+        wait_ms = client_ms;
+  }
+
+  // Commands left over by the last round go in the next connection interval
+  if (g_server_data.link_sched.pending) {
+      uint32_t round_ms = g_server_data.link_sched.interval * 5 / 4;
+
+      if (wait_ms == 0 || round_ms < wait_ms)
+        wait_ms = round_ms;
+  }
+
+  if (wait_ms == 0)
+    return;
+
+  status = sl_bt_system_set_soft_timer(ms_to_ticks(wait_ms) + 1,
+                                       SOFT_TIMER_HANDLE_INDICATION, 1);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set indication timer %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Runs a round of the commands waiting, the links are served round
+ * robin and at most LINKSCHED_TX_PER_ROUND states are handed to the stack.
+ * The links not served keep their mark for the next round.
+ ******************************************************************************/
+void service_links(void)
+{
+  linksched_t *ls = &g_server_data.link_sched;
+  uint32_t now_ms = timerGetUptimeMs();
+  uint8_t budget = LINKSCHED_TX_PER_ROUND;
+  uint8_t index;
+
+  while (budget && (index = linksched_next(ls)) != LINKSCHED_NONE) {
+      client_data_t *client = get_client_by_index(index);
+      outbox_send_t send;
+
+      if (client == NULL)
+        continue;
+
+      // Nothing due on the link costs no budget
+      send = client_sender(client);
+      if (send != NULL && outbox_flush(&client->outbox, now_ms, send, client))
+        budget--;
+  }
+
+  if (ls->pending)
+    ls->deferred_rounds++;
+
+  arm_indication_timer();
+}
+
+
+/******************************************************************************
+ * @brief   Sends the states waiting in the outboxes once their backoff ends,
+ * the snapshots not acknowledged in time and the commands left over by the
+ * last round.
+ ******************************************************************************/
+void handle_indication_timer(void)
+{
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++)
+    if (client_sender(&g_server_data.clients_data[i]) != NULL)
+      linksched_mark(&g_server_data.link_sched, i);
+
+  service_links();
+}
+
+
+/******************************************************************************
+ * @brief   Requests the PHY the policy of a client calls for on its link.
+ *
+ * @param
+ *  client  Client of the link
+ *  active  1 while the link runs the active profile
+ *
+ ******************************************************************************/
+void apply_client_phy(client_data_t *client, uint8_t active)
+{
+  sl_status_t status;
+
+  status = sl_bt_connection_set_preferred_phy(client->conn_handle,
+                                              phy_link_phy(&client->phy, active),
+                                              sl_bt_gap_phy_any);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set preferred PHY %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Applies a connection parameter profile to the link of a client,
+ * called by the connection parameter manager.
+ *
+ * @param
+ *  profile   Active or idle profile
+ *  ctx       Client
+ *
+ * @return
+ *  Returns 0 if the parameter update is started.
+ *
+ ******************************************************************************/
+uint8_t apply_client_profile(connparam_profile_t profile, void *ctx)
+{
+  client_data_t *client = ctx;
+  sl_status_t status;
+
+  const linksched_t *ls = &g_server_data.link_sched;
+  uint8_t max_ce = linksched_ce(client->phy.link_phy);
+
+  // The intervals of the schedule, the event of the link sized to its PHY
+  if (profile == CONNPARAM_PROFILE_ACTIVE)
+    status = sl_bt_connection_set_parameters(client->conn_handle,
+                                             ls->interval,
+                                             ls->interval,
+                                             CONNPARAM_ACTIVE_LATENCY,
+                                             CONNPARAM_ACTIVE_TIMEOUT,
+                                             CONNECTION_MIN_CE,
+                                             max_ce);
+  else
+    status = sl_bt_connection_set_parameters(client->conn_handle,
+                                             ls->idle_interval,
+                                             ls->idle_interval,
+                                             CONNPARAM_IDLE_LATENCY,
+                                             CONNPARAM_IDLE_TIMEOUT,
+                                             CONNECTION_MIN_CE,
+                                             max_ce);
+
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to set connection parameters %u\n", status);
+      return 1;
+  }
+
+  apply_client_phy(client, profile == CONNPARAM_PROFILE_ACTIVE);
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief   Reports the capacity of the link schedule: the links, the intervals,
+ * the worst case command latency in both profiles and the radio time of the
+ * links.
+ ******************************************************************************/
+void report_link_capacity(void)
+{
+  const linksched_t *ls = &g_server_data.link_sched;
+  uint32_t active_us = 0;
+  uint32_t idle_us = 0;
+  uint32_t radio_pm;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      const client_data_t *client = &g_server_data.clients_data[i];
+
+      if (client->conn_handle == 0)
+        continue;
+
+      if (client->conn_params.profile == CONNPARAM_PROFILE_IDLE &&
+          client->conn_state == CONN_STATE_BONDED)
+        idle_us += linksched_slot_us(client->phy.link_phy);
+      else
+        active_us += linksched_slot_us(client->phy.link_phy);
+  }
+
+  radio_pm = linksched_utilisation_pm(ls, active_us, idle_us);
+
+  LOG_INFO("Links: %u of %u, interval %u idle %u%s, worst command latency active %lu ms idle %lu ms, radio %lu.%lu%%, deferred rounds %lu\n",
+           ls->links,
+           SERVER_MAX_CLIENTS,
+           ls->interval,
+           ls->idle_interval,
+           ls->fits ? "" : " (overbooked)",
+           linksched_worst_latency_ms(ls, 0, CONNPARAM_ACTIVE_LATENCY),
+           linksched_worst_latency_ms(ls, 1, CONNPARAM_IDLE_LATENCY),
+           radio_pm / 10,
+           radio_pm % 10,
+           ls->deferred_rounds);
+}
+
+
+/******************************************************************************
+ * @brief   Plans the link schedule again after a link opened, closed or
+ * changed its PHY. A new interval is applied to the bonded links in their
+ * current profile and taken by the links opened from then on.
+ ******************************************************************************/
+void plan_links(void)
+{
+  linksched_t *ls = &g_server_data.link_sched;
+  uint32_t slots_us = 0;
+  uint8_t links = 0;
+  sl_status_t status;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      const client_data_t *client = &g_server_data.clients_data[i];
+
+      if (client->conn_handle == 0)
+        continue;
+
+      slots_us += linksched_slot_us(client->phy.link_phy);
+      links++;
+  }
+
+  if (linksched_plan(ls, links, slots_us)) {
+      status = sl_bt_connection_set_default_parameters(ls->interval,
+                                                       ls->interval,
+                                                       CONNPARAM_ACTIVE_LATENCY,
+                                                       CONNPARAM_ACTIVE_TIMEOUT,
+                                                       CONNECTION_MIN_CE,
+                                                       CONNECTION_MAX_CE);
+      if (status != SL_STATUS_OK)
+        LOG_ERROR("Failed to set connection parameters %u\n", status);
+
+      for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+          client_data_t *client = &g_server_data.clients_data[i];
+
+          if (client->conn_state == CONN_STATE_BONDED)
+            apply_client_profile(client->conn_params.profile, client);
+      }
+  }
+
+  report_link_capacity();
+}
+
+
+/******************************************************************************
+ * @brief   Profile applier of a client link, NULL while the link is not
+ * bonded yet.
+ ******************************************************************************/
+connparam_apply_t client_profile_applier(client_data_t *client)
+{
+  if (client->conn_state != CONN_STATE_BONDED)
+    return NULL;
+
+  return apply_client_profile;
+}
+
+
+/******************************************************************************
+ * @brief   Arms the connection parameter timer for the earliest client link
+ * to go idle.
+ ******************************************************************************/
+void arm_connparam_timer(void)
+{
+  uint32_t now_ms = timerGetUptimeMs();
+  uint32_t wait_ms = 0;
+  sl_status_t status;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      client_data_t *client = &g_server_data.clients_data[i];
+      uint32_t client_ms;
+
+      if (client->conn_state != CONN_STATE_BONDED)
+        continue;
+
+      client_ms = connparam_wait_ms(&client->conn_params, now_ms);
+      if (client_ms && (wait_ms == 0 || client_ms < wait_ms))
+        wait_ms = client_ms;
+  }
+
+  if (wait_ms == 0)
+    return;
+
+  status = sl_bt_system_set_soft_timer(ms_to_ticks(wait_ms) + 1,
+                                       SOFT_TIMER_HANDLE_CONNPARAM, 1);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set connection parameter timer %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Drops the client links that went quiet to the idle profile.
+ ******************************************************************************/
+void handle_connparam_timer(void)
+{
+  uint32_t now_ms = timerGetUptimeMs();
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      client_data_t *client = &g_server_data.clients_data[i];
+
+      connparam_update(&client->conn_params, now_ms,
+                       client_profile_applier(client), client);
+  }
+
+  arm_connparam_timer();
+}
+
+
+/******************************************************************************
+ * @brief   Turns On/Off a client, queues the respective indication to the
+ * client and finally updates the same data on the LCD. The state is recorded
+ * in the actuator of the client.
+ *
+ * @param
+ *  client        The client device to be controlled.
+ *  onoff_state   State to which client device to be set On/Off.
+ *
+ ******************************************************************************/
+void set_client_onoff(client_data_t *client, client_state_t onoff_state)
+{
+  // Without a link the state goes out in the command table only
+  if (client->conn_state == CONN_STATE_BROADCAST && client->onoff_state != onoff_state) {
+      client->onoff_state = onoff_state;
+      zone_set_actuator(&g_server_data.zones, client->actuator,
+                        onoff_state == CLIENT_STATE_ON);
+
+      LOG_INFO("Broadcast client %u state %u\n",
+               (uint8_t)(client - g_server_data.clients_data), onoff_state);
+
+      // Sent over the link instead if the client misses the table
+      outbox_push(&client->outbox, onoff_state, timerGetUptimeMs(), NULL, NULL);
+      broadcast_client_state(client);
+
+      update_lcd();
+      return;
+  }
+
+  if (client->conn_state == CONN_STATE_BONDED && client->onoff_state != onoff_state) {
+      client->onoff_state = onoff_state;
+      zone_set_actuator(&g_server_data.zones, client->actuator,
+                        onoff_state == CLIENT_STATE_ON);
+
+      if (client->client_type == CLIENT_TYPE_AC)
+        LOG_INFO("TURNED ON/OFF THE AC\n");
+      else if (client->client_type == CLIENT_TYPE_HEATER)
+        LOG_INFO("TURNED ON/OFF THE Heater\n");
+
+      // The link goes active for the command and the ones that may follow
+      connparam_activity(&client->conn_params, timerGetUptimeMs(),
+                         apply_client_profile, client);
+      arm_connparam_timer();
+
+      /* Sent in the next round of the links once the state in flight, if
+       * any, is confirmed */
+      outbox_push(&client->outbox, onoff_state, timerGetUptimeMs(), NULL, NULL);
+      linksched_mark(&g_server_data.link_sched,
+                     (uint8_t)(client - g_server_data.clients_data));
+      service_links();
+
+      // The table holds the states of all the clients for their release
+      broadcast_client_state(client);
+
+      update_lcd();
+  }
+}
+
+
+/******************************************************************************
+ * @brief   Turns On/Off the client of type AC/Heater.
+ *
+ * @param
+ *  client_type   The client device type to be controlled AC/Heater.
+ *  onoff_state   State to which client device to be set On/Off.
+ *
+ ******************************************************************************/
+void set_client_state(client_type_t client_type, client_state_t onoff_state)
+{
+  client_data_t *client = get_client_by_type(client_type);
+
+  if (client != NULL)
+    set_client_onoff(client, onoff_state);
+}
+
+
+/******************************************************************************
+ * @brief   Sends the state of the client of an actuator for actuation_run().
+ *
+ * @param
+ *  id    Index of the client
+ *  on    1 to turn the client On, 0 to turn it Off
+ *  ctx   Unused
+ *
+ * @return
+ *  Returns 0 if the client is in the requested state, else 1 and the zone
+ *  tries again on its next run, e.g. once the client is bonded.
+ *
+ ******************************************************************************/
+uint8_t actuate_client(uint8_t id, uint8_t on, void *ctx)
+{
+  client_data_t *client = &g_server_data.clients_data[id];
+  client_state_t onoff_state = on ? CLIENT_STATE_ON : CLIENT_STATE_OFF;
+
+  (void)ctx;
+
+  set_client_onoff(client, onoff_state);
+
+  return client->onoff_state != onoff_state;
+}
+
+
+/******************************************************************************
+ * @brief   Writes the current and target temperature of every zone to the
+ * GATT database, so that reads return the values in use.
+ ******************************************************************************/
+void update_zones_attribute(void)
+{
+  sl_status_t status;
+  uint8_t data[2 * ZONE_MAX] = {0};
+
+  for (uint8_t i = 0; i < g_server_data.zones.zone_count; i++) {
+      data[2 * i] = (uint8_t)g_server_data.zones.zones[i].current_temp;
+      data[2 * i + 1] = (uint8_t)g_server_data.zones.zones[i].target_temp;
+  }
+
+  status = sl_bt_gatt_server_write_attribute_value(gattdb_thermostat_zones, 0,
+                                                   sizeof(data), data);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to write zones attribute %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Reports the actuator switches and indications sent once every
+ * CONTROL_STATS_PERIOD_S, along with the switches the plain on/off control
+ * would have made. Every switch is one indication to a client.
+ ******************************************************************************/
+void report_control_stats(void)
+{
+  uint32_t now_s = timerGetUptimeSec();
+  uint32_t switches = 0;
+  uint32_t legacy_switches = 0;
+
+  if (now_s - g_server_data.stats_start_s < CONTROL_STATS_PERIOD_S)
+    return;
+
+  for (uint8_t i = 0; i < g_server_data.zones.zone_count; i++) {
+      control_state_t *control = &g_server_data.zones.zones[i].control;
+
+      switches += control->switches;
+      legacy_switches += control->legacy_switches;
+      control_clear_stats(control);
+  }
+
+  LOG_INFO("Control stats: switches %lu, indications %lu, on/off control switches %lu\n",
+           switches, g_server_data.indications_sent, legacy_switches);
+
+  // Indication stats of the clients since boot
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      const outbox_t *box = &g_server_data.clients_data[i].outbox;
+
+      LOG_INFO("Client %u indications: sent %lu, confirmed %lu, coalesced %lu, retries %lu, timeouts %lu, latency mean %lu ms, max %lu ms\n",
+               i,
+               box->sent,
+               box->confirmations,
+               box->coalesced,
+               box->retries,
+               box->timeouts,
+               box->confirmations ? box->latency_ms_sum / box->confirmations : 0,
+               box->latency_ms_max);
+  }
+
+  // Connection parameter profiles of the client links since they opened
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      const connparam_t *cp = &g_server_data.clients_data[i].conn_params;
+
+      LOG_INFO("Client %u link: active %lu s, idle %lu s, switches %lu, failed %lu\n",
+               i,
+               connparam_profile_ms(cp, CONNPARAM_PROFILE_ACTIVE, timerGetUptimeMs()) / 1000,
+               connparam_profile_ms(cp, CONNPARAM_PROFILE_IDLE, timerGetUptimeMs()) / 1000,
+               cp->switches,
+               cp->failures);
+  }
+
+  // Opens and state transactions of the clients per PHY since boot
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      const phy_link_t *phy = &g_server_data.clients_data[i].phy;
+
+      for (uint8_t p = 0; p < PHY_COUNT; p++) {
+          if (phy->opens[p] == 0 && phy->transactions[p] == 0)
+            continue;
+
+          LOG_INFO("Client %u PHY %u: opens %lu, bonded %lu, transactions %lu, airtime %lu us per transaction\n",
+                   i,
+                   p,
+                   phy->opens[p],
+                   phy->opens_ok[p],
+                   phy->transactions[p],
+                   phy->transactions[p] ? phy->airtime_us[p] / phy->transactions[p] : 0);
+      }
+  }
+
+  LOG_INFO("Status: notifications %lu\n", g_server_data.status_notifications);
+
+  report_link_capacity();
+
+  LOG_INFO("Provisioning: clients %lu, reports %lu, AD structures %lu, UUID compares %lu\n",
+           g_server_data.provisioned,
+           g_server_data.ad_reports,
+           g_server_data.ad_structs,
+           g_server_data.ad_compares);
+
+  LOG_INFO("Scanner: on %lu s, restarts %lu, phase %u\n",
+           scansched_on_ms(&g_server_data.scan_sched, timerGetUptimeMs()) / 1000,
+           g_server_data.scan_sched.restarts,
+           g_server_data.scan_sched.phase);
+
+#if BEACON_ENABLE
+  LOG_INFO("Beacon: updates %lu, unchanged %lu\n",
+           g_server_data.beacon.updates,
+           g_server_data.beacon.unchanged);
+#endif
+
+#if BROADCAST_ENABLE
+  LOG_INFO("Broadcast: tables %lu, acks %lu, fallbacks %lu, ack mean %lu ms, max %lu ms\n",
+           g_server_data.bcast.published,
+           g_server_data.bcast.acks,
+           g_server_data.bcast.fallbacks,
+           g_server_data.bcast.acks ? g_server_data.bcast.ack_ms_sum / g_server_data.bcast.acks : 0,
+           g_server_data.bcast.ack_ms_max);
+#endif
+
+  g_server_data.indications_sent = 0;
+  g_server_data.status_notifications = 0;
+  g_server_data.stats_start_s = now_s;
+}
+
+
+/******************************************************************************
+ * @brief   Sends the client states requested by the zones that are due, and
+ * arms the actuation soft timer for the starts held by the stagger.
+ ******************************************************************************/
+void run_actuation(void)
+{
+  sl_status_t status;
+  uint32_t now_s = timerGetUptimeSec();
+  uint32_t wait_s;
+
+  actuation_run(&g_server_data.actuation, &g_server_data.zones, now_s,
+                actuate_client, NULL);
+
+  wait_s = actuation_wait_s(&g_server_data.actuation, &g_server_data.zones, now_s);
+  if (wait_s == 0)
+    return;
+
+  status = sl_bt_system_set_soft_timer(wait_s * 32768, SOFT_TIMER_HANDLE_ACTUATION, 1);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set actuation timer %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Runs the control of the zones with a new sample or target when the
+ * Auto feature is On, then updates the stats, the GATT database and the LCD.
+ * Without the Auto feature the new samples and targets are only shown.
+ ******************************************************************************/
+void run_zones(void)
+{
+  if (g_server_data.automatic_temp_control) {
+      zone_run(&g_server_data.zones, timerGetUptimeSec());
+      run_actuation();
+  }
+  else {
+      g_server_data.zones.dirty = 0;
+  }
+
+  update_zones_attribute();
+
+  report_control_stats();
+
+  update_lcd();
+}
+
+
+/******************************************************************************
+ * @brief   Arms the schedule soft timer to expire at the next transition of
+ * the schedule. Transitions further than SCHEDULE_MAX_TIMER_S away are reached
+ * in steps. The timer is stopped if the clock is not set or the schedule is
+ * empty.
+ ******************************************************************************/
+void arm_schedule_timer(void)
+{
+  sl_status_t status;
+  uint32_t now_s = sl_sleeptimer_get_time();
+  uint32_t wait_s = 0;
+
+  if (!g_server_data.clock_set || g_server_data.schedule.next_s == SCHEDULE_NEXT_NONE) {
+      sl_bt_system_set_soft_timer(0, SOFT_TIMER_HANDLE_SCHEDULE, 1);
+      return;
+  }
+
+  if (g_server_data.schedule.next_s > now_s)
+    wait_s = g_server_data.schedule.next_s - now_s;
+
+  if (wait_s > SCHEDULE_MAX_TIMER_S)
+    wait_s = SCHEDULE_MAX_TIMER_S;
+
+  // Soft timer runs at 32768 Hz, a zero time would stop the timer
+  status = sl_bt_system_set_soft_timer(wait_s ? wait_s * 32768 : 1,
+                                       SOFT_TIMER_HANDLE_SCHEDULE, 1);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set schedule timer %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Sets the target temperature from the schedule and runs the control
+ * with it.
+ *
+ * @param
+ *  target    Target temperature of the schedule transition in effect
+ *
+ ******************************************************************************/
+void apply_schedule_target(int16_t target)
+{
+  LOG_INFO("Schedule target temperature = %d\n", target);
+
+  zone_set_target(&g_server_data.zones, ZONE_MAIN, target);
+
+  run_zones();
+}
+
+
+/******************************************************************************
+ * @brief   Handles the schedule soft timer, applies the transition that is due
+ * and arms the timer for the next one.
+ ******************************************************************************/
+void handle_schedule_timer(void)
+{
+  int16_t target;
+
+  if (g_server_data.clock_set &&
+      schedule_poll(&g_server_data.schedule, sl_sleeptimer_get_time(), &target))
+    apply_schedule_target(target);
+
+  arm_schedule_timer();
+}
+
+
+/******************************************************************************
+ * @brief   Checks the schedule on a new sample. A passed transition sets its
+ * target, else the next target is taken early once the learned lead time to
+ * reach it from the current temperature is longer than the time left.
+ ******************************************************************************/
+void update_schedule_target(void)
+{
+  const zone_t *main_zone = &g_server_data.zones.zones[ZONE_MAIN];
+  uint32_t now_s = sl_sleeptimer_get_time();
+  int16_t next_target = schedule_next_target(&g_server_data.schedule);
+  int16_t target;
+
+  // Single compare unless a transition of the schedule was passed
+  if (schedule_poll(&g_server_data.schedule, now_s, &target)) {
+      zone_set_target(&g_server_data.zones, ZONE_MAIN, target);
+      arm_schedule_timer();
+      return;
+  }
+
+  if (next_target == 0 || next_target == main_zone->target_temp)
+    return;
+
+  if (recovery_precondition(&g_server_data.recovery, main_zone->current_temp,
+                            next_target, g_server_data.schedule.next_s, now_s)) {
+      LOG_INFO("Starting early on the next target %d\n", next_target);
+      zone_set_target(&g_server_data.zones, ZONE_MAIN, next_target);
+  }
+}
+
+
+/******************************************************************************
+ * @brief   Loads a packed schedule and applies the target temperature in
+ * effect when the clock is set. The normalized schedule is written back to
+ * the GATT database so that reads return what is in use.
+ *
+ * @param
+ *  data    Packed schedule, SCHEDULE_PACKED_LEN bytes
+ *  len     Length of data
+ *  save    Set to 1 to store the schedule in NVM
+ *
+ ******************************************************************************/
+void load_schedule(uint8_t *data, size_t len, uint8_t save)
+{
+  sl_status_t status;
+  int16_t target = g_server_data.zones.zones[ZONE_MAIN].target_temp;
+  uint32_t now_s = sl_sleeptimer_get_time();
+
+  if (schedule_load(&g_server_data.schedule, data, len, now_s, &target)) {
+      LOG_ERROR("Invalid schedule length %u\n", len);
+      return;
+  }
+
+  schedule_pack(&g_server_data.schedule, data);
+
+  status = sl_bt_gatt_server_write_attribute_value(gattdb_thermostat_schedule, 0, len, data);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to write schedule attribute %u\n", status);
+
+  if (save) {
+      status = sl_bt_nvm_save(NVM_KEY_SCHEDULE, len, data);
+      if (status != SL_STATUS_OK)
+        LOG_ERROR("Failed to save schedule %u\n", status);
+  }
+
+  LOG_INFO("Schedule loaded with %u transitions\n", g_server_data.schedule.count);
+
+  if (g_server_data.clock_set && g_server_data.schedule.count)
+    apply_schedule_target(target);
+
+  arm_schedule_timer();
+}
+
+
+/******************************************************************************
+ * @brief   Loads the schedule stored in NVM, if any.
+ ******************************************************************************/
+void load_schedule_from_nvm(void)
+{
+  sl_status_t status;
+  uint8_t data[SCHEDULE_PACKED_LEN];
+  size_t len;
+
+  status = sl_bt_nvm_load(NVM_KEY_SCHEDULE, sizeof(data), &len, data);
+  if (status != SL_STATUS_OK) {
+      LOG_INFO("No schedule stored\n");
+      return;
+  }
+
+  load_schedule(data, len, 0);
+}
+
+
+/******************************************************************************
+ * @brief   Saves the clients to NVM, CLIENT_RECORD_LEN bytes per client: the
+ * address, the address type and the client type.
+ ******************************************************************************/
+void save_clients(void)
+{
+  sl_status_t status;
+  uint8_t data[SERVER_MAX_CLIENTS * CLIENT_RECORD_LEN];
+  uint8_t *record = data;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      const client_data_t *client = &g_server_data.clients_data[i];
+
+      memcpy(record, client->addr.addr, sizeof(client->addr.addr));
+      record[6] = client->addr_type;
+      record[7] = client->client_type;
+      record += CLIENT_RECORD_LEN;
+  }
+
+  status = sl_bt_nvm_save(NVM_KEY_CLIENTS, record - data, data);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to save clients %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Adds the clients saved in NVM, if any.
+ ******************************************************************************/
+void load_clients_from_nvm(void)
+{
+  sl_status_t status;
+  uint8_t data[SERVER_MAX_CLIENTS * CLIENT_RECORD_LEN];
+  size_t len;
+
+  status = sl_bt_nvm_load(NVM_KEY_CLIENTS, sizeof(data), &len, data);
+  if (status != SL_STATUS_OK) {
+      LOG_INFO("No clients stored\n");
+      return;
+  }
+
+  for (size_t pos = 0; pos + CLIENT_RECORD_LEN <= len; pos += CLIENT_RECORD_LEN) {
+      bd_addr addr;
+
+      if (data[pos + 7] != CLIENT_TYPE_AC && data[pos + 7] != CLIENT_TYPE_HEATER)
+        continue;
+
+      memcpy(addr.addr, &data[pos], sizeof(addr.addr));
+
+      if (add_client(addr, data[pos + 6], data[pos + 7]) == NULL)
+        LOG_ERROR("Failed to add stored client\n");
+  }
+
+  LOG_INFO("Loaded %u clients\n", g_server_data.clients_count);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Toggles the state of the connected client On/Off state.
+ ******************************************************************************/
+void toggle_client_state(client_type_t client_type)
+{
+  g_server_data.automatic_temp_control = 0;
+  zone_cancel_requests(&g_server_data.zones);
+
+  client_data_t *client = get_client_by_type(client_type);
+
+  if (client == NULL)
+    return;
+
+  if (client->onoff_state == CLIENT_STATE_ON)
+    set_client_state(client_type, CLIENT_STATE_OFF);
+  else
+    set_client_state(client_type, CLIENT_STATE_ON);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Toggles the auto On/Off feature.
+ ******************************************************************************/
+void toggle_auto_feature()
+{
+  g_server_data.automatic_temp_control = !g_server_data.automatic_temp_control;
+
+  if (g_server_data.automatic_temp_control) {
+      for (uint8_t i = 0; i < g_server_data.zones.zone_count; i++)
+        zone_reset(&g_server_data.zones, i, timerGetUptimeSec());
+
+      run_zones();
+  }
+  else {
+      zone_cancel_requests(&g_server_data.zones);
+  }
+
+  update_lcd();
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Updates the current temperature of a zone and runs the control.
+ ******************************************************************************/
+void update_zone_temperature(uint8_t zone, int16_t temp)
+{
+  if (temp > 0 && temp <= 125) {
+      LOG_INFO("Zone %u current temperature = %d", zone, temp);
+
+      zone_set_current(&g_server_data.zones, zone, temp);
+
+      if (zone == ZONE_MAIN && g_server_data.clock_set)
+        update_schedule_target();
+
+      run_zones();
+
+      if (zone == ZONE_MAIN)
+        recovery_update(&g_server_data.recovery,
+                        zone_output(&g_server_data.zones, ZONE_MAIN),
+                        temp, timerGetUptimeSec());
+
+      if (zone < g_server_data.zones.zone_count)
+        history_add(&g_server_data.history, timerGetUptimeSec(), zone,
+                    zone_output(&g_server_data.zones, zone), temp,
+                    g_server_data.zones.zones[zone].target_temp);
+  }
+  else {
+      LOG_ERROR("Invalid temperature range!");
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Increases the value of the target temperature value.
+ ******************************************************************************/
+void increase_taget_temperature()
+{
+  int16_t target;
+
+  if (!g_server_data.automatic_temp_control)
+    return;
+
+  target = g_server_data.zones.zones[ZONE_MAIN].target_temp;
+
+  if (target < 125)
+    target++;
+  else
+    target = 125;
+
+  zone_set_target(&g_server_data.zones, ZONE_MAIN, target);
+
+  run_zones();
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Decreases the value of the target temperature value.
+ ******************************************************************************/
+void decrease_taget_temperature()
+{
+  int16_t target;
+
+  if (!g_server_data.automatic_temp_control)
+    return;
+
+  target = g_server_data.zones.zones[ZONE_MAIN].target_temp;
+
+  if (target > 1)
+    target--;
+  else
+    target = 1;
+
+  zone_set_target(&g_server_data.zones, ZONE_MAIN, target);
+
+  run_zones();
+}
+
+
+/******************************************************************************
+ * @brief   Stops the BT scanning and its phase timer.
+ ******************************************************************************/
+void stop_bt_scan(void)
+{
+  sl_status_t status;
+
+  if (!g_server_data.scanning)
+    return;
+
+  status = sl_bt_scanner_stop();
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to stop scanning :: %u\n", status);
+
+  sl_bt_system_set_soft_timer(0, SOFT_TIMER_HANDLE_SCAN, 1);
+  scansched_stop(&g_server_data.scan_sched, timerGetUptimeMs());
+  g_server_data.scanning = 0;
+}
+
+
+/******************************************************************************
+ * @brief   PHYs to scan on, the Coded PHY is only scanned with a distant client.
+ ******************************************************************************/
+uint8_t scan_phys(void)
+{
+  uint8_t phys = 0;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++)
+    phys |= phy_scan_phys(g_server_data.clients_data[i].phy_policy);
+
+  return phys;
+}
+
+
+/******************************************************************************
+ * @brief   Arms the scan timer for the end of the current scan phase. No
+ * timer in the background phase, it lasts until the scanner stops.
+ ******************************************************************************/
+void arm_scan_timer(void)
+{
+  uint32_t wait_ms = scansched_wait_ms(&g_server_data.scan_sched, timerGetUptimeMs());
+  sl_status_t status;
+
+  if (wait_ms == 0)
+    return;
+
+  status = sl_bt_system_set_soft_timer(ms_to_ticks(wait_ms) + 1, SOFT_TIMER_HANDLE_SCAN, 1);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set scan timer %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Starts the scanner with the timing of the current phase of the
+ * scan scheduler and arms the timer for the end of the phase.
+ *
+ * @return
+ *  Returns 0 if the scanner runs, else non-zero.
+ *
+ ******************************************************************************/
+uint8_t run_bt_scan_phase(void)
+{
+  sl_status_t status;
+
+  // The timing is only taken on the next scanner start
+  status = sl_bt_scanner_set_timing(scan_phys(),
+                                    scansched_interval(&g_server_data.scan_sched),
+                                    scansched_window(&g_server_data.scan_sched));
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set scanner timing %u\n", status);
+
+  status = sl_bt_scanner_start(scan_phys(), sl_bt_scanner_discover_generic);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to start scanning\n");
+      return 1;
+  }
+
+  LOG_INFO("Scan phase %u, interval %u window %u\n",
+           g_server_data.scan_sched.phase,
+           scansched_interval(&g_server_data.scan_sched),
+           scansched_window(&g_server_data.scan_sched));
+
+  arm_scan_timer();
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief   Returns 1 if a client in the broadcast mode has not acknowledged
+ * its latest table yet, the scanner keeps running for its ack.
+ ******************************************************************************/
+uint8_t broadcast_acks_pending(void)
+{
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      if (g_server_data.clients_data[i].bcast_pending)
+        return 1;
+  }
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief   Initiates the BT scanning if a client is left to be found. The
+ * scanning goes on while other clients connect and bond, and is stopped once
+ * every client is found, the provisioning is over and no client in the
+ * broadcast mode owes an ack. A scanner started from stopped runs the aggressive
+ * phase of the scan scheduler first. Does nothing if the scanner already runs.
+ *
+ ******************************************************************************/
+void start_bt_scan(void)
+{
+  if (!g_server_data.provisioning &&
+      get_client_by_conn_state(CONN_STATE_SCANNING) == NULL &&
+      !broadcast_acks_pending()) {
+      stop_bt_scan();
+      return;
+  }
+
+  if (g_server_data.scanning)
+    return;
+
+  scansched_restart(&g_server_data.scan_sched, timerGetUptimeMs());
+
+  if (run_bt_scan_phase() != 0) {
+      scansched_stop(&g_server_data.scan_sched, timerGetUptimeMs());
+      return;
+  }
+
+  g_server_data.scanning = 1;
+
+  update_lcd();
+}
+
+
+/******************************************************************************
+ * @brief   Handles the end of a scan phase, the scanner is restarted with the
+ * timing of the next phase. The clients are never given up on, the last phase
+ * runs until they are found.
+ ******************************************************************************/
+void handle_scan_timer(void)
+{
+  sl_status_t status;
+
+  if (!g_server_data.scanning)
+    return;
+
+  // Fired early, the phase runs on for the time it has left
+  if (!scansched_update(&g_server_data.scan_sched, timerGetUptimeMs())) {
+      arm_scan_timer();
+      return;
+  }
+
+  status = sl_bt_scanner_stop();
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to stop scanning :: %u\n", status);
+
+  if (run_bt_scan_phase() != 0) {
+      scansched_stop(&g_server_data.scan_sched, timerGetUptimeMs());
+      g_server_data.scanning = 0;
+      update_lcd();
+  }
+}
+
+
+/******************************************************************************
+ * @brief   Restarts the scanning in the aggressive phase of the scan scheduler,
+ * after a link loss or PB0.
+ *
+ ******************************************************************************/
+void start_manual_scan(void)
+{
+  move_clients_conn_state(CONN_STATE_NOT_FOUND, CONN_STATE_SCANNING);
+
+  stop_bt_scan();
+  start_bt_scan();
+}
+
+
+/******************************************************************************
+ * @brief   MAC of a command table for bcast_build(), AES-CMAC under the
+ * broadcast key truncated to BCAST_MAC_LEN bytes.
+ *
+ * @param
+ *  ctx     Broadcast key
+ *
+ ******************************************************************************/
+uint8_t broadcast_mac(const uint8_t *data, uint8_t len, uint8_t *mac, void *ctx)
+{
+  uint8_t full[16];
+
+  if (mbedtls_cipher_cmac(mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB),
+                          ctx, BCAST_KEY_LEN * 8, data, len, full) != 0)
+    return 1;
+
+  memcpy(mac, full, BCAST_MAC_LEN);
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief   Saves the broadcast key and the end of the reserved block of
+ * sequence numbers to NVM, BCAST_NVM_LEN bytes.
+ *
+ * @return
+ *  Returns 0 if saved.
+ *
+ ******************************************************************************/
+uint8_t save_broadcast(void)
+{
+  sl_status_t status;
+  uint8_t data[BCAST_NVM_LEN];
+  uint32_t seq_limit = g_server_data.bcast.seq_limit;
+
+  memcpy(data, g_server_data.bcast.key, BCAST_KEY_LEN);
+  data[BCAST_KEY_LEN] = (uint8_t)seq_limit;
+  data[BCAST_KEY_LEN + 1] = (uint8_t)(seq_limit >> 8);
+  data[BCAST_KEY_LEN + 2] = (uint8_t)(seq_limit >> 16);
+  data[BCAST_KEY_LEN + 3] = (uint8_t)(seq_limit >> 24);
+
+  status = sl_bt_nvm_save(NVM_KEY_BROADCAST, sizeof(data), data);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to save broadcast key %u\n", status);
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief   Takes the broadcast key and the sequence numbers from NVM, a new
+ * key is drawn from the random generator of the stack if none is saved.
+ *
+ * @return
+ *  Returns 0 if the key is taken, 1 if no key could be drawn.
+ *
+ ******************************************************************************/
+uint8_t load_broadcast_from_nvm(void)
+{
+  sl_status_t status;
+  uint8_t data[BCAST_NVM_LEN];
+  uint32_t seq_limit = 0;
+  size_t len;
+
+  status = sl_bt_nvm_load(NVM_KEY_BROADCAST, sizeof(data), &len, data);
+  if (status == SL_STATUS_OK && len == BCAST_NVM_LEN) {
+      seq_limit = data[BCAST_KEY_LEN] | (data[BCAST_KEY_LEN + 1] << 8) |
+          ((uint32_t)data[BCAST_KEY_LEN + 2] << 16) |
+          ((uint32_t)data[BCAST_KEY_LEN + 3] << 24);
+  }
+  else {
+      LOG_INFO("No broadcast key stored\n");
+
+      status = sl_bt_system_get_random_data(BCAST_KEY_LEN, BCAST_KEY_LEN, &len, data);
+      if (status != SL_STATUS_OK || len != BCAST_KEY_LEN) {
+          LOG_ERROR("Failed to draw broadcast key %u\n", status);
+          return 1;
+      }
+  }
+
+  bcast_init(&g_server_data.bcast, data, seq_limit);
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief   Publishes the command table with the next sequence number in the
+ * periodic advertising train. A new block of sequence numbers is saved to
+ * NVM before its first number goes on the air.
+ *
+ * @return
+ *  Returns 0 if the table is published.
+ *
+ ******************************************************************************/
+uint8_t publish_broadcast(void)
+{
+  bcast_t *bc = &g_server_data.bcast;
+  sl_status_t status;
+
+  if (bcast_reserve(bc) && save_broadcast() != 0) {
+      bc->seq_limit = bc->seq;
+      return 1;
+  }
+
+  if (bcast_build(bc, broadcast_mac, bc->key) == 0) {
+      LOG_ERROR("Failed to build broadcast table\n");
+      return 1;
+  }
+
+  status = sl_bt_advertiser_set_data(g_server_data.bcast_handle, 8,
+                                     bc->frame_len, bc->frame);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to set periodic advertising data %u\n", status);
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief   Starts the periodic advertising train of the broadcast mode with
+ * the states of all the clients. The extended advertising of the set carries
+ * the SyncInfo the clients synchronize on, it is not connectable.
+ ******************************************************************************/
+void start_broadcast(void)
+{
+  sl_status_t status;
+  uint8_t handle;
+
+  // The train is never keyed on bytes the generator did not draw
+  if (load_broadcast_from_nvm() != 0)
+    return;
+
+  status = sl_bt_advertiser_create_set(&handle);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to create broadcast advertiser set %u\n", status);
+      return;
+  }
+
+  g_server_data.bcast_handle = handle;
+  g_server_data.bcast_on = 1;
+
+  status = sl_bt_advertiser_set_timing(handle, BCAST_ADV_INTERVAL,
+                                       BCAST_ADV_INTERVAL, 0, 0);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set broadcast advertiser timing %u\n", status);
+
+  status = sl_bt_advertiser_set_phy(handle, gap_1m_phy, gap_1m_phy);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set broadcast advertiser PHY %u\n", status);
+
+  status = sl_bt_advertiser_start_periodic_advertising(handle, BCAST_INTERVAL,
+                                                       BCAST_INTERVAL, 0);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to start periodic advertising %u\n", status);
+      return;
+  }
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++)
+    bcast_set(&g_server_data.bcast, i,
+              g_server_data.clients_data[i].onoff_state == CLIENT_STATE_ON);
+
+  publish_broadcast();
+
+  status = sl_bt_advertiser_start(handle, sl_bt_advertiser_general_discoverable,
+                                  sl_bt_advertiser_non_connectable);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to start broadcast advertising %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Arms the broadcast timer for the earliest ack to time out.
+ ******************************************************************************/
+void arm_broadcast_timer(void)
+{
+  uint32_t now_ms = timerGetUptimeMs();
+  uint32_t wait_ms = 0;
+  sl_status_t status;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      client_data_t *client = &g_server_data.clients_data[i];
+      uint32_t elapsed_ms = now_ms - client->bcast_sent_ms;
+      uint32_t client_ms;
+
+      if (!client->bcast_pending)
+        continue;
+
+      client_ms = elapsed_ms >= BCAST_ACK_TIMEOUT_MS ? 1 : BCAST_ACK_TIMEOUT_MS - elapsed_ms;
+      if (wait_ms == 0 || client_ms < wait_ms)
+        wait_ms = client_ms;
+  }
+
+  if (wait_ms == 0) {
+      sl_bt_system_set_soft_timer(0, SOFT_TIMER_HANDLE_BROADCAST, 1);
+      return;
+  }
+
+  status = sl_bt_system_set_soft_timer(ms_to_ticks(wait_ms) + 1,
+                                       SOFT_TIMER_HANDLE_BROADCAST, 1);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set broadcast timer %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Waits for the ack of the latest table of a client in the broadcast
+ * mode, from now on.
+ ******************************************************************************/
+void expect_broadcast_ack(client_data_t *client)
+{
+  client->bcast_pending = 1;
+  client->bcast_seq = g_server_data.bcast.seq;
+  client->bcast_sent_ms = timerGetUptimeMs();
+
+  arm_broadcast_timer();
+  start_bt_scan();
+}
+
+
+/******************************************************************************
+ * @brief   Puts the state of a client in the command table and publishes it.
+ * A client in the broadcast mode is to acknowledge the table, it is connected
+ * again if the table cannot be published.
+ ******************************************************************************/
+void broadcast_client_state(client_data_t *client)
+{
+#if BROADCAST_ENABLE
+  uint8_t slot = (uint8_t)(client - g_server_data.clients_data);
+
+  if (!g_server_data.bcast_on)
+    return;
+
+  if (!bcast_set(&g_server_data.bcast, slot, client->onoff_state == CLIENT_STATE_ON))
+    return;
+
+  if (publish_broadcast() != 0) {
+      if (client->conn_state == CONN_STATE_BROADCAST) {
+          set_client_conn_state(client, CONN_STATE_SCANNING);
+          start_bt_scan();
+      }
+      return;
+  }
+
+  if (client->conn_state == CONN_STATE_BROADCAST)
+    expect_broadcast_ack(client);
+#else
+  (void)client;
+#endif
+}
+
+
+/******************************************************************************
+ * @brief   Takes the ack of a client in the broadcast mode from its scan
+ * report, an ack of its latest table or a later one ends the wait.
+ ******************************************************************************/
+void handle_broadcast_report(client_data_t *client,
+                             sl_bt_evt_scanner_scan_report_t *report)
+{
+  bcast_t *bc = &g_server_data.bcast;
+  uint32_t ack_ms;
+  uint16_t seq16;
+
+  if (!client->bcast_pending ||
+      !bcast_find_ack(report->data.data, report->data.len, &seq16) ||
+      !bcast_acked(seq16, client->bcast_seq))
+    return;
+
+  ack_ms = timerGetUptimeMs() - client->bcast_sent_ms;
+  client->bcast_pending = 0;
+
+  bc->acks++;
+  bc->ack_ms_sum += ack_ms;
+  if (ack_ms > bc->ack_ms_max)
+    bc->ack_ms_max = ack_ms;
+
+  arm_broadcast_timer();
+
+  // Stops the scanner once no ack or client is left to wait for
+  start_bt_scan();
+}
+
+
+/******************************************************************************
+ * @brief   Connects again the clients in the broadcast mode whose ack timed
+ * out. The state waits in the outbox of the client and goes out as an
+ * indication once it is bonded, its link is released again after it.
+ ******************************************************************************/
+void handle_broadcast_timer(void)
+{
+  uint32_t now_ms = timerGetUptimeMs();
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      client_data_t *client = &g_server_data.clients_data[i];
+
+      if (!client->bcast_pending || now_ms - client->bcast_sent_ms < BCAST_ACK_TIMEOUT_MS)
+        continue;
+
+      LOG_INFO("Client %u missed the broadcast, connecting\n", i);
+      client->bcast_pending = 0;
+      g_server_data.bcast.fallbacks++;
+      set_client_conn_state(client, CONN_STATE_SCANNING);
+  }
+
+  arm_broadcast_timer();
+  start_bt_scan();
+  update_lcd();
+}
+
+
+/******************************************************************************
+ * @brief   Answers the read of the broadcast key characteristic of a client
+ * with the key and the slot of the client, BCAST_KEY_RECORD_LEN bytes. The
+ * client closes the link once it holds them and the server takes it into the
+ * broadcast mode. Refused without BROADCAST_ENABLE.
+ ******************************************************************************/
+void read_broadcast_key(uint8_t connection, uint16_t characteristic, uint16_t offset)
+{
+  sl_status_t status;
+  uint8_t data[BCAST_KEY_RECORD_LEN];
+  client_data_t *client = get_client_by_conn_handle(connection);
+  uint8_t att_error = 0;
+  uint16_t sent_len;
+
+  if (!BROADCAST_ENABLE || client == NULL || g_server_data.bcast.frame_len == 0)
+    att_error = ATT_ERROR_REQUEST_NOT_SUPPORTED;
+  else if (offset > BCAST_KEY_RECORD_LEN)
+    att_error = ATT_ERROR_INVALID_OFFSET;
+
+  if (att_error) {
+      status = sl_bt_gatt_server_send_user_read_response(connection, characteristic,
+                                                         att_error, 0, NULL, &sent_len);
+  }
+  else {
+      memcpy(data, g_server_data.bcast.key, BCAST_KEY_LEN);
+      data[BCAST_KEY_LEN] = (uint8_t)(client - g_server_data.clients_data);
+
+      status = sl_bt_gatt_server_send_user_read_response(connection, characteristic, 0,
+                                                         BCAST_KEY_RECORD_LEN - offset,
+                                                         data + offset, &sent_len);
+      if (status == SL_STATUS_OK)
+        client->bcast_keyed = 1;
+  }
+
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to send broadcast key read response %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Logs the probe of a client: the echoes, the round trip and one way
+ * latencies and the round trip histogram, under the connection parameters the
+ * probe ran.
+ ******************************************************************************/
+void report_probe(client_data_t *client)
+{
+  const probe_t *p = &client->probe;
+  const uint32_t *h = p->rtt.counts;
+  uint8_t i = (uint8_t)(client - g_server_data.clients_data);
+
+  if (p->pings == 0)
+    return;
+
+  LOG_INFO("Client %u probe, interval %u latency %u: pings %lu, echoes %lu, lost %lu, stale %lu\n",
+           i, client->interval, client->latency, p->pings, p->echoes, p->lost, p->stale);
+
+  LOG_INFO("Client %u probe us: rtt mean %lu p50 %lu p90 %lu max %lu, down mean %lu max %lu, up mean %lu max %lu\n",
+           i,
+           probe_dist_mean_us(&p->rtt),
+           probe_dist_percentile_us(&p->rtt, 50),
+           probe_dist_percentile_us(&p->rtt, 90),
+           p->rtt.max_us,
+           probe_dist_mean_us(&p->down),
+           p->down.max_us,
+           probe_dist_mean_us(&p->up),
+           p->up.max_us);
+
+  LOG_INFO("Client %u probe rtt histogram: %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu\n",
+           i, h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7], h[8], h[9], h[10], h[11]);
+
+  LOG_INFO("Client %u sync: locked %u, samples %lu, dropped %lu, invalid %lu, relocks %lu, error mean %lu us max %lu, drift %ld ppm/65536\n",
+           i,
+           client->sync.locked,
+           client->sync.samples,
+           client->sync.dropped,
+           client->sync.invalid,
+           client->sync.relocks,
+           client->sync.samples > 1 ? (uint32_t)(client->sync.error_us_sum / (client->sync.samples - 1)) : 0,
+           client->sync.error_us_max,
+           client->sync.drift_q16);
+}
+
+
+/******************************************************************************
+ * @brief   Takes the connection parameters in effect on a link. The probe of
+ * the old ones is logged and the probe starts over, the latencies are kept
+ * per set of parameters.
+ ******************************************************************************/
+void set_link_parameters(client_data_t *client, uint16_t interval, uint16_t latency)
+{
+  if (client->interval == interval && client->latency == latency)
+    return;
+
+  report_probe(client);
+  probe_init(&client->probe);
+
+  client->interval = interval;
+  client->latency = latency;
+}
+
+
+/******************************************************************************
+ * @brief   Notifies the next ping to a client, followed by the estimate of
+ * its time sync. The ping is not handed to the link schedule and does not
+ * hold the link active, it waits for the next connection event the client
+ * listens to like any idle traffic.
+ ******************************************************************************/
+void send_probe(client_data_t *client)
+{
+  uint8_t ping[PROBE_PING_LEN + TIMESYNC_RECORD_LEN];
+  uint16_t characteristic = gattdb_ac_probe;
+  uint64_t now_us = timerGetUptimeUs();
+  sl_status_t status;
+
+  if (client->client_type == CLIENT_TYPE_HEATER)
+    characteristic = gattdb_heater_probe;
+
+  probe_ping(&client->probe, (uint32_t)now_us, ping);
+  timesync_pack(&client->sync, now_us, &ping[PROBE_PING_LEN]);
+
+  status = sl_bt_gatt_server_send_notification(client->conn_handle, characteristic,
+                                               sizeof(ping), ping);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to send probe %u\n", status);
+      return;
+  }
+
+  phy_transaction(&client->phy, PROBE_NOTIFICATION_LEN, PROBE_ECHO_WRITE_LEN);
+}
+
+
+/******************************************************************************
+ * @brief   Handles the probe timer, pings the bonded clients subscribed to
+ * the probe and logs the probes every PROBE_REPORT_PINGS.
+ ******************************************************************************/
+void handle_probe_timer(void)
+{
+  g_server_data.probe_rounds++;
+
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      client_data_t *client = &g_server_data.clients_data[i];
+
+      if (client->conn_state == CONN_STATE_BONDED && client->probe_enabled)
+        send_probe(client);
+
+      if (g_server_data.probe_rounds % PROBE_REPORT_PINGS == 0)
+        report_probe(client);
+  }
+}
+
+
+/******************************************************************************
+ * @brief   Starts the periodic probe timer.
+ ******************************************************************************/
+void start_probe(void)
+{
+  sl_status_t status;
+
+  status = sl_bt_system_set_soft_timer(ms_to_ticks(PROBE_PERIOD_MS),
+                                       SOFT_TIMER_HANDLE_PROBE, 0);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to start probe timer %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Answers a read of the probe report characteristic, packed from the
+ * live probes with an entry of PROBE_ENTRY_LEN per client.
+ ******************************************************************************/
+void read_probe_report(uint8_t connection, uint16_t characteristic, uint16_t offset)
+{
+  sl_status_t status;
+  uint8_t data[PROBE_REPORT_LEN];
+  uint16_t len = g_server_data.clients_count * PROBE_ENTRY_LEN;
+  uint16_t sent_len;
+
+  if (offset > len) {
+      status = sl_bt_gatt_server_send_user_read_response(connection, characteristic,
+                                                         ATT_ERROR_INVALID_OFFSET,
+                                                         0, NULL, &sent_len);
+  }
+  else {
+      for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+          const client_data_t *client = &g_server_data.clients_data[i];
+          uint8_t *entry = &data[i * PROBE_ENTRY_LEN];
+
+          entry[0] = client->interval ? client->client_type : 0;
+          entry[1] = (uint8_t)client->interval;
+          entry[2] = (uint8_t)(client->interval >> 8);
+          entry[3] = (uint8_t)client->latency;
+          probe_pack(&client->probe, &entry[4]);
+      }
+
+      status = sl_bt_gatt_server_send_user_read_response(connection, characteristic, 0,
+                                                         len - offset, data + offset,
+                                                         &sent_len);
+  }
+
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to send probe report read response %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief   Logs the transfers of the export channel.
+ ******************************************************************************/
+void report_export(void)
+{
+  const export_chan_t *ch = &g_server_data.export;
+
+  LOG_INFO("Export: requests %lu, rejected %lu, sdus %lu, pdus %lu, bytes %lu, records %lu, gaps %lu, stalls %lu, overruns %lu\n",
+           ch->requests, ch->rejected, ch->sdus, ch->pdus, ch->bytes,
+           ch->records, ch->gaps, ch->stalls, ch->overruns);
+}
+
+
+/******************************************************************************
+ * @brief   Closes the export channel on its side and logs its transfers.
+ ******************************************************************************/
+void close_export(void)
+{
+  report_export();
+  export_close(&g_server_data.export);
+  sl_bt_system_set_soft_timer(0, SOFT_TIMER_HANDLE_EXPORT, 1);
+}
+
+
+/******************************************************************************
+ * @brief   Sends the PDUs of the export the peer has credits for. The peer
+ * gives no credit back before it gets a PDU, so one the stack has no room for
+ * is sent again from the export timer. A record overwritten while its SDU was
+ * being sent aborts the channel, the peer resumes on a new one.
+ ******************************************************************************/
+void pump_export(void)
+{
+  export_chan_t *ch = &g_server_data.export;
+  const uint8_t *pdu;
+  uint16_t len;
+  sl_status_t status;
+
+  while ((len = export_next(ch, &pdu)) != 0) {
+      if (len == EXPORT_ABORT) {
+          LOG_ERROR("Export overrun by the history, closing the channel\n");
+          status = sl_bt_l2cap_coc_send_disconnection_request(g_server_data.export_conn,
+                                                              ch->cid);
+          if (status != SL_STATUS_OK)
+            LOG_ERROR("Failed to disconnect the export channel %u\n", status);
+          close_export();
+          return;
+      }
+
+      status = sl_bt_l2cap_coc_send_data(g_server_data.export_conn, ch->cid, len, pdu);
+
+      if (status == SL_STATUS_NO_MORE_RESOURCE) {
+          status = sl_bt_system_set_soft_timer(ms_to_ticks(EXPORT_RETRY_MS),
+                                               SOFT_TIMER_HANDLE_EXPORT, 1);
+          if (status != SL_STATUS_OK)
+            LOG_ERROR("Failed to start export timer %u\n", status);
+          return;
+      }
+
+      if (status != SL_STATUS_OK) {
+          LOG_ERROR("Failed to send export data %u\n", status);
+          close_export();
+          return;
+      }
+
+      export_sent(ch);
+  }
+}
+
+
+/******************************************************************************
+ * @brief   Answers the request of a peer for an L2CAP channel. Only the export
+ * channel on EXPORT_LE_PSM is taken, from a phone on an encrypted link and one
+ * at a time. Refused without EXPORT_ENABLE.
+ *
+ * @param
+ *  *evt    Data structure of BT API message
+ *
+ ******************************************************************************/
+void handle_l2cap_connection_request(sl_bt_msg_t *evt)
+{
+  sl_bt_evt_l2cap_coc_connection_request_t *req = &evt->data.evt_l2cap_coc_connection_request;
+  uint16_t result = sl_bt_l2cap_connection_successful;
+  sl_status_t status;
+
+  if (!EXPORT_ENABLE || req->le_psm != EXPORT_LE_PSM)
+    result = sl_bt_l2cap_le_psm_not_supported;
+  else if (get_client_by_conn_handle(req->connection) != NULL)
+    result = sl_bt_l2cap_insufficient_authorization;
+  else if (!(req->flags & EXPORT_FLAG_ENCRYPTED))
+    result = sl_bt_l2cap_insufficient_encryption;
+  else if (g_server_data.export.open)
+    result = sl_bt_l2cap_no_resources_available;
+
+  status = sl_bt_l2cap_coc_send_connection_response(req->connection, req->source_cid,
+                                                    EXPORT_RX_MTU, EXPORT_RX_MPS,
+                                                    EXPORT_RX_CREDITS, result);
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to send L2CAP connection response %u\n", status);
+      return;
+  }
+
+  if (result != sl_bt_l2cap_connection_successful) {
+      LOG_INFO("L2CAP channel on PSM 0x%x refused 0x%x\n", req->le_psm, result);
+      return;
+  }
+
+  LOG_INFO("Export channel opened, mtu %u mps %u credits %u\n",
+           req->mtu, req->mps, req->initial_credit);
+
+  g_server_data.export_conn = req->connection;
+  export_open(&g_server_data.export, req->source_cid, req->mtu, req->mps,
+              req->initial_credit);
+}
+
+
+/******************************************************************************
+ * @brief   Takes a request on the export channel, gives its credit back to the
+ * peer and starts the stream.
+ *
+ * @param
+ *  *evt    Data structure of BT API message
+ *
+ ******************************************************************************/
+void handle_l2cap_data(sl_bt_msg_t *evt)
+{
+  sl_bt_evt_l2cap_coc_data_t *data = &evt->data.evt_l2cap_coc_data;
+  export_chan_t *ch = &g_server_data.export;
+  sl_status_t status;
+
+  if (!ch->open || data->connection != g_server_data.export_conn || data->cid != ch->cid)
+    return;
+
+  if (!export_request(ch, export_sources, EXPORT_STREAMS, data->data.data, data->data.len))
+    LOG_ERROR("Export request rejected, %u bytes\n", data->data.len);
+
+  status = sl_bt_l2cap_coc_send_le_flow_control_credit(data->connection, data->cid, 1);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to send export credit %u\n", status);
+
+  pump_export();
+}
+
+
+/******************************************************************************
+ * @brief   Takes the credits the peer gives on the export channel and sends
+ * the PDUs waiting for them.
+ *
+ * @param
+ *  *evt    Data structure of BT API message
+ *
+ ******************************************************************************/
+void handle_l2cap_credit(sl_bt_msg_t *evt)
+{
+  sl_bt_evt_l2cap_coc_le_flow_control_credit_t *credit = &evt->data.evt_l2cap_coc_le_flow_control_credit;
+  export_chan_t *ch = &g_server_data.export;
+
+  if (!ch->open || credit->connection != g_server_data.export_conn || credit->cid != ch->cid)
+    return;
+
+  export_credit(ch, credit->credits);
+  pump_export();
+}
+
+
+/******************************************************************************
+ * @brief   Closes the export channel disconnected by the peer or the stack.
+ *
+ * @param
+ *  *evt    Data structure of BT API message
+ *
+ ******************************************************************************/
+void handle_l2cap_disconnected(sl_bt_msg_t *evt)
+{
+  sl_bt_evt_l2cap_coc_channel_disconnected_t *disc = &evt->data.evt_l2cap_coc_channel_disconnected;
+  export_chan_t *ch = &g_server_data.export;
+
+  if (!ch->open || disc->connection != g_server_data.export_conn || disc->cid != ch->cid)
+    return;
+
+  LOG_INFO("Export channel disconnected 0x%x\n", disc->reason);
+  close_export();
+}
+
+
+/******************************************************************************
+ * @brief   Adds the clients of the registry not on the accept list yet to it.
+ * The controller then drops the advertisements of any other device before
+ * they reach handle_bt_scanned(). Called after clients are added, the list is
+ * only used from the next scanner start on so a running scanner is restarted.
+ * The stack clears the list only together with the bondings, so it is built
+ * again from the registry after sl_bt_sm_delete_bondings().
+ *
+ ******************************************************************************/
+void sync_accept_list(void)
+{
+#if ACCEPT_LIST_ENABLE
+  sl_status_t status;
+  uint8_t added = 0;
+
+  for (uint8_t i = 0; i < g_server_data.registry.count; i++) {
+      uint64_t bit = (uint64_t)1 << i;
+
+      if (g_server_data.accept_listed & bit)
+        continue;
+
+      status = sl_bt_sm_add_to_whitelist(g_server_data.clients_data[i].addr,
+                                         g_server_data.clients_data[i].addr_type);
+      if (status != SL_STATUS_OK) {
+          LOG_ERROR("Failed to add client %u to the accept list :: %u\n", i, status);
+          continue;
+      }
+
+      g_server_data.accept_listed |= bit;
+      added++;
+  }
+
+  if (added && g_server_data.scanning) {
+      stop_bt_scan();
+      start_bt_scan();
+  }
+#endif
+}
+
+
+/******************************************************************************
+ * @brief   Takes the bondings of the clients from the bonding database kept by
+ * the stack in NVM, the clients with a bonding are encrypted from its keys on
+ * connection. The entries of the database are also on the accept list.
+ ******************************************************************************/
+void restore_bondings(void)
+{
+  for (uint8_t i = 0; i < g_server_data.clients_count; i++) {
+      client_data_t *client = &g_server_data.clients_data[i];
+      uint32_t bonding;
+      uint8_t security_mode;
+      uint8_t key_size;
+
+      if (sl_bt_sm_find_bonding_by_address(client->addr, &bonding,
+                                           &security_mode, &key_size) != SL_STATUS_OK)
+        continue;
+
+      g_server_data.accept_listed |= (uint64_t)1 << i;
+
+      // An accept list entry only has no key
+      if (key_size) {
+          client->bond_handle = (uint8_t)bonding;
+          LOG_INFO("Restored bonding %u of client %u\n", client->bond_handle, i);
+      }
+  }
+}
+
+
+/******************************************************************************
+ * @brief   Deletes the bonding of a client, its entry on the accept list goes
+ * with it. The accept list is left to the caller to sync.
+ ******************************************************************************/
+void delete_bonding(client_data_t *client)
+{
+  uint8_t index = client - g_server_data.clients_data;
+
+  if (client->bond_handle == SL_BT_INVALID_BONDING_HANDLE)
+    return;
+
+  if (sl_bt_sm_delete_bonding(client->bond_handle) != SL_STATUS_OK)
+    LOG_ERROR("Failed to delete bonding");
+
+  client->bond_handle = SL_BT_INVALID_BONDING_HANDLE;
+  g_server_data.accept_listed &= ~((uint64_t)1 << index);
+}
+
+
+/******************************************************************************
+ * @brief   Deletes the bonding of a client, its entry on the accept list goes
+ * with it and is added back.
+ ******************************************************************************/
+void drop_bonding(client_data_t *client)
+{
+  delete_bonding(client);
+  sync_accept_list();
+}
+
+
+/******************************************************************************
+ * @brief   Starts the provisioning mode for PROVISION_WINDOW_S. The accept
+ * list filtering is turned off so the scanner reports the unknown devices,
+ * it is restarted in the aggressive phase to take the filtering.
+ ******************************************************************************/
+void start_provisioning(void)
+{
+  sl_status_t status;
+
+  status = sl_bt_gap_enable_whitelisting(0);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to turn off accept list filtering %u\n", status);
+
+  status = sl_bt_system_set_soft_timer(PROVISION_WINDOW_S * 32768,
+                                       SOFT_TIMER_HANDLE_PROVISION, 1);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set provisioning timer %u\n", status);
+
+  g_server_data.provisioning = 1;
+  LOG_INFO("Provisioning started\n");
+
+  start_manual_scan();
+  update_lcd();
+}
+
+
+/******************************************************************************
+ * @brief   Ends the provisioning mode, the scanner goes back to the accept
+ * list and stops if every client is found.
+ ******************************************************************************/
+void stop_provisioning(void)
+{
+  sl_status_t status;
+
+  if (!g_server_data.provisioning)
+    return;
 
-  if (client != NULL) {
-      client->conn_state = CONN_STATE_SCANNING;
-      status = sl_bt_scanner_start(sl_bt_gap_1m_phy, sl_bt_scanner_discover_generic);
+  sl_bt_system_set_soft_timer(0, SOFT_TIMER_HANDLE_PROVISION, 1);
 
-      if (status != SL_STATUS_OK)
-        LOG_ERROR("Failed to start scanning\n");
+  status = sl_bt_gap_enable_whitelisting(ACCEPT_LIST_ENABLE);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set accept list filtering %u\n", status);
 
-      update_lcd();
-      g_server_data.session_scans_count++;
-  }
-  else {
-      g_server_data.session_scans_count = MAX_SESSION_SCANS;
-  }
+  g_server_data.provisioning = 0;
+  LOG_INFO("Provisioning ended, %u clients\n", g_server_data.clients_count);
+
+  stop_bt_scan();
+  start_bt_scan();
+  update_lcd();
 }
 
 
 /******************************************************************************
- * @brief   Initiates the force scanning for clients even when the number of
- * scans has reached the limit.
+ * @brief   Checks the scan report of an unknown device for the service UUID of
+ * a client and adds the device as a client. With no free slot it replaces a
+ * client of the same type that is not connected, its bonding is deleted and
+ * its slot, actuator and zone are taken over.
+ *
+ * @param
+ *  report    Scan report of the device.
+ *
+ * @return
+ *  Returns NULL if the device is no client else returns the pointer to the
+ *  new client.
  *
  ******************************************************************************/
-void start_manual_scan(void)
+client_data_t* provision_client(sl_bt_evt_scanner_scan_report_t *report)
 {
-  while (get_client_by_conn_state(CONN_STATE_NOT_FOUND) != NULL) {
-      get_client_by_conn_state(CONN_STATE_NOT_FOUND)->conn_state = CONN_STATE_SCANNING;
+  ad_iter_t it;
+  client_data_t *client;
+  client_type_t client_type;
+  uint64_t idle;
+
+  ad_iter_init(&it, report->data.data, report->data.len);
+  client_type = ad_find_uuid128(&it, client_uuids,
+                                sizeof(client_uuids) / sizeof(client_uuids[0]));
+
+  g_server_data.ad_reports++;
+  g_server_data.ad_structs += it.visited;
+  g_server_data.ad_compares += it.compares;
+
+  if (client_type == 0)
+    return NULL;
+
+  client = add_client(report->address, report->address_type, client_type);
+
+  if (client == NULL) {
+      idle = registry_in_states(&g_server_data.registry,
+                                CONN_STATE_UNKNOWN | CONN_STATE_SCANNING |
+                                CONN_STATE_NOT_BONDED | CONN_STATE_DISCONNECTED |
+                                CONN_STATE_NOT_FOUND);
+      idle &= g_server_data.registry.of_kind[client_type];
+      if (idle == 0)
+        return NULL;
+
+      /* The accept list is synced once the slot has the new address, a sync
+       * before it would put the old address back on the list */
+      client = &g_server_data.clients_data[__builtin_ctzll(idle)];
+      delete_bonding(client);
+
+      if (registry_set_addr(&g_server_data.registry,
+                            (uint8_t)(client - g_server_data.clients_data),
+                            report->address.addr) != 0) {
+          sync_accept_list();
+          return NULL;
+      }
+
+      LOG_INFO("Replacing client %u\n", (uint8_t)(client - g_server_data.clients_data));
+
+      // The old address stays on the accept list until the bondings are deleted
+      client->addr = report->address;
+      client->addr_type = report->address_type;
+      client->link_lost_ms = 0;
+      g_server_data.accept_listed &= ~((uint64_t)1 << (client - g_server_data.clients_data));
+      outbox_init(&client->outbox);
+      outbox_push(&client->outbox, client->onoff_state, timerGetUptimeMs(), NULL, NULL);
+      phy_init(&client->phy, client->phy_policy);
   }
 
-  g_server_data.session_scans_count = 0;
+  LOG_INFO("Provisioned %s %02x:%02x:%02x:%02x:%02x:%02x\n",
+           client_type == CLIENT_TYPE_HEATER ? "Heater" : "AC",
+           client->addr.addr[5], client->addr.addr[4], client->addr.addr[3],
+           client->addr.addr[2], client->addr.addr[1], client->addr.addr[0]);
 
-  start_bt_scan();
+  g_server_data.provisioned++;
+  set_client_conn_state(client, CONN_STATE_SCANNING);
+  save_clients();
+  sync_accept_list();
+
+  return client;
 }
 
 
@@ -491,8 +2876,22 @@ void pb0_event_handle(void)
       else
         LOG_INFO("Succeeded to confirm passkey\n");
   }
+  else if (g_server_data.phone_passkey) {
+      g_server_data.phone_passkey = 0;
+
+      status = sl_bt_sm_passkey_confirm(g_server_data.phone_conn, 1);
+      if (status != SL_STATUS_OK)
+        LOG_ERROR("Failed to confirm phone passkey\n");
+      else
+        LOG_INFO("Succeeded to confirm phone passkey\n");
+
+      update_lcd();
+  }
+  else if (g_server_data.provisioning) {
+      stop_provisioning();
+  }
   else {
-      start_manual_scan();
+      start_provisioning();
   }
 }
 
@@ -508,10 +2907,11 @@ void handle_bt_boot(void)
   if (status != SL_STATUS_OK)
     LOG_ERROR("Failed to get the BT address");
 
-  status = sl_bt_connection_set_default_parameters(CONNECTION_INTERVAL, \
-                                                   CONNECTION_INTERVAL, \
-                                                   CONNECTION_LATENCY, \
-                                                   CONNECTION_TIMEOUT, \
+  // Links open in the active profile for the bonding and discovery
+  status = sl_bt_connection_set_default_parameters(CONNPARAM_ACTIVE_INTERVAL, \
+                                                   CONNPARAM_ACTIVE_INTERVAL, \
+                                                   CONNPARAM_ACTIVE_LATENCY, \
+                                                   CONNPARAM_ACTIVE_TIMEOUT, \
                                                    CONNECTION_MIN_CE, \
                                                    CONNECTION_MAX_CE);
   if (status != SL_STATUS_OK)
@@ -526,29 +2926,55 @@ void handle_bt_boot(void)
   if (status != SL_STATUS_OK)
     LOG_ERROR("Failed to set bonding mode");
 
-  status = sl_bt_sm_delete_bondings();
+  // BT commands, the clients are loaded on boot and not in ble_init()
+  load_clients_from_nvm();
+  restore_bondings();
+  sync_accept_list();
+
+  status = sl_bt_gap_enable_whitelisting(ACCEPT_LIST_ENABLE);
   if (status != SL_STATUS_OK)
-    LOG_ERROR("Failed to delete bonding");
-  else
-    LOG_INFO("Succeeded to delete bonding");
+    LOG_ERROR("Failed to set accept list filtering");
 
   for (int i = 0; i < g_server_data.clients_count; i++)
-    g_server_data.clients_data[i].conn_state = CONN_STATE_SCANNING;
+    set_client_conn_state(&g_server_data.clients_data[i], CONN_STATE_SCANNING);
 
-  //  status = sl_bt_advertiser_create_set(&g_server_data.adv_handle);
-  //  status = sl_bt_advertiser_set_timing(g_server_data.adv_handle, 400, 400, 0, 0);
-  //  status = sl_bt_advertiser_start(g_server_data.adv_handle,
-  //                                  sl_bt_advertiser_general_discoverable,
-  //                                  sl_bt_advertiser_connectable_scannable);
+  load_schedule_from_nvm();
 
-  status = sl_bt_scanner_set_mode(sl_bt_gap_1m_phy, PASSIVE_SCANNING);
+  // A phone connects to the thermostat service while the clients are scanned
+  status = sl_bt_advertiser_create_set(&g_server_data.adv_handle);
   if (status != SL_STATUS_OK)
-    LOG_ERROR("Failed to set scanner mode");
+    LOG_ERROR("Failed to create advertiser set");
 
-  status = sl_bt_scanner_set_timing(sl_bt_gap_1m_phy, SCAN_INTERVAL, SCAN_WINDOW);
+  status = sl_bt_advertiser_set_timing(g_server_data.adv_handle, ADV_INTERVAL,
+                                       ADV_INTERVAL, 0, 0);
   if (status != SL_STATUS_OK)
-    LOG_ERROR("Failed to set scanner timing");
-  start_bt_scan();
+    LOG_ERROR("Failed to set advertiser timing");
+
+  start_advertising();
+
+#if BROADCAST_ENABLE
+  start_broadcast();
+#endif
+
+#if BEACON_ENABLE
+  start_beacon();
+#endif
+
+#if PROBE_ENABLE
+  start_probe();
+#endif
+
+  status = sl_bt_scanner_set_mode(scan_phys(), PASSIVE_SCANNING);
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to set scanner mode");
+
+  scansched_init(&g_server_data.scan_sched);
+
+  // Nothing to scan for yet, the clients are learned first
+  if (g_server_data.clients_count == 0)
+    start_provisioning();
+  else
+    start_bt_scan();
 
   update_lcd();
 }
@@ -564,35 +2990,54 @@ void handle_bt_boot(void)
 void handle_bt_scanned(sl_bt_msg_t *evt)
 {
   sl_status_t status;
+  uint8_t conn_handle;
+  uint8_t report_phy = evt->data.evt_scanner_scan_report.primary_phy;
 
-  status = sl_bt_scanner_stop();
+  client_data_t *client = get_client_by_addr(evt->data.evt_scanner_scan_report.address);
 
-  if (status != SL_STATUS_OK) {
-      LOG_ERROR("Failed to stop scanning :: %u\n", status);
+  // Unknown devices only come in while provisioning
+  if (client == NULL && g_server_data.provisioning)
+    client = provision_client(&evt->data.evt_scanner_scan_report);
+
+  // A client in the broadcast mode acks the tables in its advertising
+  if (client != NULL && client->conn_state == CONN_STATE_BROADCAST) {
+      handle_broadcast_report(client, &evt->data.evt_scanner_scan_report);
       return;
   }
 
-  client_data_t *client = get_client_by_addr(evt->data.evt_scanner_scan_report.address);
+  // Reports of other devices are dropped, the scanner keeps running
+  if (client == NULL || client->conn_state != CONN_STATE_SCANNING)
+    return;
 
-  if (client != NULL && client->conn_state != CONN_STATE_DISCONNECTED) {
-      sl_status_t status;
+  // Opened on the PHY the client advertises on, if its policy allows it
+  if (!phy_accepts(&client->phy, report_phy))
+    return;
 
-      client->conn_state = CONN_STATE_CONNECTING;
+  /* One connection is opened at a time, the next client is opened on one of
+   * its next reports once this one is open */
+  if (get_client_by_conn_state(CONN_STATE_CONNECTING) != NULL)
+    return;
 
-      status = sl_bt_connection_open(client->addr, \
-                                     sl_bt_gap_public_address, \
-                                     sl_bt_gap_1m_phy, \
-                                     &client->conn_handle);
+  set_client_conn_state(client, CONN_STATE_CONNECTING);
 
-      if (status != SL_STATUS_OK)
-        LOG_ERROR("Failed to start connection\n");
-      else
-        LOG_INFO("Succeeded to start connection\n");
-  }
-  else {
-      start_bt_scan();
+  status = sl_bt_connection_open(client->addr, \
+                                 client->addr_type, \
+                                 report_phy, \
+                                 &conn_handle);
+
+  if (status != SL_STATUS_OK) {
+      LOG_ERROR("Failed to start connection\n");
+      set_client_conn_state(client, CONN_STATE_SCANNING);
+      return;
   }
 
+  LOG_INFO("Succeeded to start connection on PHY %u\n", report_phy);
+  set_client_conn_handle(client, conn_handle);
+  phy_open(&client->phy, report_phy);
+
+  // Stops the scanner once no client is left to be found
+  start_bt_scan();
+
   update_lcd();
 }
 
@@ -612,27 +3057,38 @@ void handle_bt_opened(sl_bt_msg_t *evt)
 
   client_data_t *client = get_client_by_addr(evt->data.evt_connection_opened.address);
 
-  //  client_data_t *client = get_client_by_type(CLIENT_TYPE_AC);
-  //  sl_bt_advertiser_stop(g_server_data.adv_handle);
+  // A phone on the advertiser, which stopped until the phone disconnects
+  if (client == NULL && evt->data.evt_connection_opened.master == 0) {
+      LOG_INFO("Phone connected\n");
+      return;
+  }
 
   if (client != NULL) {
       LOG_INFO("Connected\n");
 
-      client->conn_handle = evt->data.evt_connection_opened.connection;
+      set_client_conn_handle(client, evt->data.evt_connection_opened.connection);
       client->bond_handle = evt->data.evt_connection_opened.bonding;
-      client->conn_state = CONN_STATE_CONNECTED;
+      connparam_init(&client->conn_params, timerGetUptimeMs());
 
-      if (client->bond_handle == SL_BT_INVALID_BONDING_HANDLE || client->bond_handle == 0x00)
-        status = sl_bt_sm_increase_security(client->conn_handle);
-      else
-        LOG_INFO("Already Bonded :: %x", client->bond_handle); // NEED TO HANDLE WHEN ALREADY BONDED,
-      //if handled then remove delete_bondings when disconnected
+      // The setup runs in the active profile
+      apply_client_phy(client, 1);
+      set_client_conn_state(client, CONN_STATE_CONNECTED);
+
+      /* With a stored bonding the link is encrypted from its keys, no pairing
+       * and passkey confirmation is needed */
+      if (client->bond_handle != SL_BT_INVALID_BONDING_HANDLE) {
+          LOG_INFO("Already Bonded :: %x", client->bond_handle);
+          set_client_conn_state(client, CONN_STATE_ENCRYPTING);
+      }
+
+      status = sl_bt_sm_increase_security(client->conn_handle);
 
       if (status != SL_STATUS_OK)
         LOG_ERROR("Failed to start bonding\n");
       else
         LOG_INFO("Succeeded to start bonding\n");
 
+      plan_links();
       update_lcd();
   }
 }
@@ -652,7 +3108,7 @@ void handle_bt_confirm_bonding(sl_bt_msg_t *evt)
   client_data_t *client = get_client_by_conn_handle(evt->data.evt_sm_confirm_bonding.connection);
 
   if (client != NULL) {
-      client->conn_state = CONN_STATE_BONDING;
+      set_client_conn_state(client, CONN_STATE_BONDING);
 
       status = sl_bt_sm_bonding_confirm(client->conn_handle, 1);
 
@@ -663,6 +3119,15 @@ void handle_bt_confirm_bonding(sl_bt_msg_t *evt)
 
       update_lcd();
   }
+  // A phone has no client, its bonding goes on to the passkey on PB0
+  else {
+      status = sl_bt_sm_bonding_confirm(evt->data.evt_sm_confirm_bonding.connection, 1);
+
+      if (status != SL_STATUS_OK)
+        LOG_ERROR("Failed to confirm phone bonding\n");
+      else
+        LOG_INFO("Succeeded to confirm phone bonding\n");
+  }
 }
 
 
@@ -678,12 +3143,18 @@ void handle_bt_confirm_passkey(sl_bt_msg_t *evt)
   client_data_t *client = get_client_by_conn_handle(evt->data.evt_sm_confirm_bonding.connection);
 
   if (client != NULL) {
-      client->conn_state = CONN_STATE_PASSKEY;
+      set_client_conn_state(client, CONN_STATE_PASSKEY);
       displayPrintf(DISPLAY_ROW_PASSKEY, "AC Passkey %u", evt->data.evt_sm_confirm_passkey.passkey);
       displayPrintf(DISPLAY_ROW_ACTION, "Confirm with PB0");
 
       update_lcd();
   }
+  else {
+      g_server_data.phone_passkey = 1;
+      g_server_data.phone_conn = evt->data.evt_sm_confirm_passkey.connection;
+      displayPrintf(DISPLAY_ROW_PASSKEY, "Phone Passkey %u", evt->data.evt_sm_confirm_passkey.passkey);
+      displayPrintf(DISPLAY_ROW_ACTION, "Confirm with PB0");
+  }
 }
 
 
@@ -696,11 +3167,16 @@ void handle_bt_confirm_passkey(sl_bt_msg_t *evt)
  ******************************************************************************/
 void handle_bt_bonded(sl_bt_msg_t *evt)
 {
-  client_data_t *client = get_client_by_conn_handle(evt->data.evt_sm_confirm_bonding.connection);
+  client_data_t *client = get_client_by_conn_handle(evt->data.evt_sm_bonded.connection);
 
   if (client != NULL) {
-      client->conn_state = CONN_STATE_BONDED;
-      client->bond_handle = evt->data.evt_sm_confirm_bonding.bonding_handle;
+      set_client_conn_state(client, CONN_STATE_BONDED);
+      client->bond_handle = evt->data.evt_sm_bonded.bonding;
+      phy_open_done(&client->phy, 1);
+  }
+  else {
+      LOG_INFO("Phone bonded %u\n", evt->data.evt_sm_bonded.bonding);
+      g_server_data.phone_passkey = 0;
   }
 
   start_bt_scan();
@@ -708,6 +3184,64 @@ void handle_bt_bonded(sl_bt_msg_t *evt)
 }
 
 
+/******************************************************************************
+ * @brief   Handles the connection parameters event, raised when the security
+ * of a connection changes. A client encrypted from its stored keys gets no
+ * bonded event and is bonded here.
+ *
+ * @param
+ *  *evt    Data structure of BT API message
+ *
+ ******************************************************************************/
+void handle_bt_parameters(sl_bt_msg_t *evt)
+{
+  client_data_t *client = get_client_by_conn_handle(evt->data.evt_connection_parameters.connection);
+
+  if (client != NULL) {
+      LOG_INFO("Client %u interval %u latency %u timeout %u\n",
+               client->client_type,
+               evt->data.evt_connection_parameters.interval,
+               evt->data.evt_connection_parameters.latency,
+               evt->data.evt_connection_parameters.timeout);
+
+      set_link_parameters(client, evt->data.evt_connection_parameters.interval,
+                          evt->data.evt_connection_parameters.latency);
+  }
+
+  if (client != NULL && client->conn_state == CONN_STATE_ENCRYPTING &&
+      evt->data.evt_connection_parameters.security_mode != sl_bt_connection_mode1_level1) {
+      LOG_INFO("Encrypted from the stored bonding\n");
+      set_client_conn_state(client, CONN_STATE_BONDED);
+      phy_open_done(&client->phy, 1);
+
+      start_bt_scan();
+      update_lcd();
+  }
+}
+
+
+/******************************************************************************
+ * @brief   Handles the PHY status event, raised when the PHY of a link changes.
+ *
+ * @param
+ *  *evt    Data structure of BT API message
+ *
+ ******************************************************************************/
+void handle_bt_phy_status(sl_bt_msg_t *evt)
+{
+  client_data_t *client = get_client_by_conn_handle(evt->data.evt_connection_phy_status.connection);
+
+  if (client == NULL)
+    return;
+
+  LOG_INFO("Client %u on PHY %u\n", client->client_type, evt->data.evt_connection_phy_status.phy);
+  client->phy.link_phy = evt->data.evt_connection_phy_status.phy;
+
+  // The slot of the link follows its PHY
+  plan_links();
+}
+
+
 /******************************************************************************
  * @brief   Handles client connection opened event
  *
@@ -719,15 +3253,53 @@ void handle_bt_bonding_failed(sl_bt_msg_t *evt)
 {
   client_data_t *client = get_client_by_conn_handle(evt->data.evt_sm_confirm_bonding.connection);
 
-  if (client != NULL) {
-      client->conn_state = CONN_STATE_NOT_BONDED;
+  if (client != NULL && client->conn_state == CONN_STATE_ENCRYPTING) {
+      /* The client lost its keys, the stale bonding is dropped and the client
+       * is paired again */
+      LOG_INFO("Encryption Failed:: reason :: %u", evt->data.evt_sm_bonding_failed.reason);
+      drop_bonding(client);
+      set_client_conn_state(client, CONN_STATE_CONNECTED);
+
+      if (sl_bt_sm_increase_security(client->conn_handle) != SL_STATUS_OK)
+        LOG_ERROR("Failed to start bonding\n");
+  }
+  else if (client != NULL) {
+      set_client_conn_state(client, CONN_STATE_NOT_BONDED);
       LOG_INFO("Bonding Failed:: reason :: %u", evt->data.evt_sm_bonding_failed.reason);
   }
+  else {
+      LOG_INFO("Phone Bonding Failed:: reason :: %u", evt->data.evt_sm_bonding_failed.reason);
+      g_server_data.phone_passkey = 0;
+  }
 
   start_bt_scan();
   update_lcd();
 }
 
+/******************************************************************************
+ * @brief   Logs the time from the link loss of a client until it takes the
+ * indications again, with the mean and max since boot.
+ ******************************************************************************/
+void report_reconnect(client_data_t *client)
+{
+  uint32_t latency_ms = timerGetUptimeMs() - client->link_lost_ms;
+
+  client->link_lost_ms = 0;
+
+  g_server_data.reconnects++;
+  g_server_data.reconnect_ms_sum += latency_ms;
+  if (latency_ms > g_server_data.reconnect_ms_max)
+    g_server_data.reconnect_ms_max = latency_ms;
+
+  LOG_INFO("Client %u controllable %lu ms after link loss, mean %lu ms, max %lu ms over %lu\n",
+           client->client_type,
+           latency_ms,
+           g_server_data.reconnect_ms_sum / g_server_data.reconnects,
+           g_server_data.reconnect_ms_max,
+           g_server_data.reconnects);
+}
+
+
 /******************************************************************************
  * @brief Handles GATT characteristic status event
  *
@@ -735,26 +3307,289 @@ void handle_bt_bonding_failed(sl_bt_msg_t *evt)
  ******************************************************************************/
 void handle_gatt_server_characteristic_status(sl_bt_msg_t *evt)
 {
-  client_data_t *client = get_client_by_conn_handle(evt->data.evt_gatt_server_characteristic_status.connection);
+  uint8_t connection = evt->data.evt_gatt_server_characteristic_status.connection;
+  client_data_t *client = get_client_by_conn_handle(connection);
+
+  if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_thermostat_status) {
+      if (evt->data.evt_gatt_server_characteristic_status.status_flags != sl_bt_gatt_server_client_config)
+        return;
+
+      if (evt->data.evt_gatt_server_characteristic_status.client_config_flags & sl_bt_gatt_notification)
+        g_server_data.status_subscribers |= 1UL << connection;
+      else
+        g_server_data.status_subscribers &= ~(1UL << connection);
+
+      return;
+  }
 
   if (client == NULL)
     return;
 
-  if (evt->data.evt_gatt_server_characteristic_status.status_flags == 0x01) {
+  // The pings of the probe, not the state
+  if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_heater_probe ||
+      evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_ac_probe) {
+      if (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_client_config)
+        client->probe_enabled = (evt->data.evt_gatt_server_characteristic_status.client_config_flags &
+            sl_bt_gatt_notification) != 0;
+      return;
+  }
+
+  if (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation) {
+      outbox_confirmed(&client->outbox, timerGetUptimeMs(), client_sender(client), client);
+      arm_indication_timer();
+  }
+  else if (evt->data.evt_gatt_server_characteristic_status.client_config_flags != sl_bt_gatt_disable) {
       if (client->client_type == CLIENT_TYPE_AC)
         LOG_INFO("AC State Indications Enabled\n");
       else if (client->client_type == CLIENT_TYPE_HEATER)
         LOG_INFO("Heater State Indications Enabled\n");
 
       client->indications_enabled = 1;
+
+      // A client subscribed to notifications takes sequenced snapshots
+      if (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_notification)
+        outbox_set_mode(&client->outbox, OUTBOX_MODE_NOTIFICATION);
+      else
+        outbox_set_mode(&client->outbox, OUTBOX_MODE_INDICATION);
+
+      // The states that waited for the client go now
+      outbox_flush(&client->outbox, timerGetUptimeMs(), send_client_state, client);
+      arm_indication_timer();
+
+      if (client->link_lost_ms)
+        report_reconnect(client);
+
+      // The client is set up, the link goes idle once it is quiet
+      connparam_release(&client->conn_params, CONNPARAM_HOLD_SETUP, timerGetUptimeMs());
+      arm_connparam_timer();
   }
-  else if (evt->data.evt_gatt_server_characteristic_status.client_config_flags == 0x00) {
+  else {
       if (client->client_type == CLIENT_TYPE_AC)
         LOG_INFO("AC State Indications Disabled\n");
       else if (client->client_type == CLIENT_TYPE_HEATER)
         LOG_INFO("Heater State Indications Disabled\n");
 
       client->indications_enabled = 0;
+
+      // Sent again once the client subscribes again
+      outbox_lost(&client->outbox, 0);
+  }
+}
+
+
+/******************************************************************************
+ * @brief Handles the GATT indication timeout event. No further indication can
+ * be sent on the connection, it is closed and the client reconnects from its
+ * bonding. The state is sent again once the client takes indications.
+ *
+ * @param *evt BT on event evt value
+ ******************************************************************************/
+void handle_gatt_server_indication_timeout(sl_bt_msg_t *evt)
+{
+  client_data_t *client = get_client_by_conn_handle(evt->data.evt_gatt_server_indication_timeout.connection);
+
+  if (client == NULL)
+    return;
+
+  LOG_ERROR("Indication timed out\n");
+  outbox_lost(&client->outbox, 1);
+
+  if (sl_bt_connection_close(client->conn_handle) != SL_STATUS_OK)
+    LOG_ERROR("Failed to close connection\n");
+}
+
+
+/******************************************************************************
+ * @brief Handles GATT user read request event. The status and the probe
+ * report are packed from the live state on every read, no copy of them is
+ * kept in the GATT database.
+ *
+ * @param *evt BT on event evt value
+ ******************************************************************************/
+void handle_gatt_server_user_read_request(sl_bt_msg_t *evt)
+{
+  sl_status_t status;
+  uint8_t data[STATUS_RECORD_LEN];
+  uint8_t connection = evt->data.evt_gatt_server_user_read_request.connection;
+  uint16_t characteristic = evt->data.evt_gatt_server_user_read_request.characteristic;
+  uint16_t offset = evt->data.evt_gatt_server_user_read_request.offset;
+  uint16_t sent_len;
+
+  if (characteristic == gattdb_heater_bcast_key || characteristic == gattdb_ac_bcast_key) {
+      read_broadcast_key(connection, characteristic, offset);
+      return;
+  }
+
+  if (characteristic == gattdb_thermostat_probe_report) {
+      read_probe_report(connection, characteristic, offset);
+      return;
+  }
+
+  if (characteristic != gattdb_thermostat_status)
+    return;
+
+  if (offset > STATUS_RECORD_LEN) {
+      status = sl_bt_gatt_server_send_user_read_response(connection, characteristic,
+                                                         ATT_ERROR_INVALID_OFFSET,
+                                                         0, NULL, &sent_len);
+  }
+  else {
+      pack_status(data);
+      status = sl_bt_gatt_server_send_user_read_response(connection, characteristic, 0,
+                                                         STATUS_RECORD_LEN - offset,
+                                                         data + offset, &sent_len);
+  }
+
+  if (status != SL_STATUS_OK)
+    LOG_ERROR("Failed to send status read response %u\n", status);
+}
+
+
+/******************************************************************************
+ * @brief Takes a write of the thermostat control, one byte automatic control
+ * on or off and one byte target temperature in F of the main zone, 0 leaves
+ * the target as it is. The stack takes the write from a bonded phone only.
+ *
+ * @return
+ *  Returns the ATT error code of the write, 0 if it is taken.
+ *
+ ******************************************************************************/
+uint8_t write_thermostat_control(uint16_t offset, uint8array *value)
+{
+  if (offset != 0 || value->len != 2)
+    return ATT_ERROR_INVALID_LENGTH;
+
+  if (value->data[0] > 1 || value->data[1] > 125)
+    return ATT_ERROR_OUT_OF_RANGE;
+
+  if (value->data[1]) {
+      zone_set_target(&g_server_data.zones, ZONE_MAIN, value->data[1]);
+      run_zones();
+  }
+
+  if (value->data[0] != g_server_data.automatic_temp_control)
+    toggle_auto_feature();
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief Handles GATT user write request event. The thermostat control is
+ * answered here. The OTA control write itself is answered by the OTA DFU
+ * component, the link of the client is held in the active profile for the
+ * OTA.
+ *
+ * @param *evt BT on event evt value
+ ******************************************************************************/
+void handle_gatt_server_user_write_request(sl_bt_msg_t *evt)
+{
+  uint8_t connection = evt->data.evt_gatt_server_user_write_request.connection;
+  uint16_t characteristic = evt->data.evt_gatt_server_user_write_request.characteristic;
+  client_data_t *client = get_client_by_conn_handle(connection);
+
+  if (characteristic == gattdb_thermostat_control) {
+      uint8_t att_error = write_thermostat_control(evt->data.evt_gatt_server_user_write_request.offset,
+                                                   &evt->data.evt_gatt_server_user_write_request.value);
+
+      if (sl_bt_gatt_server_send_user_write_response(connection, characteristic,
+                                                     att_error) != SL_STATUS_OK)
+        LOG_ERROR("Failed to send control write response\n");
+      return;
+  }
+
+  if (client == NULL || characteristic != gattdb_ota_control)
+    return;
+
+  LOG_INFO("OTA started by client %u\n", client->client_type);
+  connparam_hold(&client->conn_params, CONNPARAM_HOLD_OTA, timerGetUptimeMs(),
+                 client_profile_applier(client), client);
+}
+
+
+/******************************************************************************
+ * @brief Handles GATT attribute value event, raised when a remote device
+ * writes the schedule, the target of a zone, the local time, acknowledges
+ * the state snapshots of a client or echoes a probe.
+ *
+ * @param *evt BT on event evt value
+ ******************************************************************************/
+void handle_gatt_server_attribute_value(sl_bt_msg_t *evt)
+{
+  sl_status_t status;
+  uint16_t attribute = evt->data.evt_gatt_server_attribute_value.attribute;
+  uint16_t offset = evt->data.evt_gatt_server_attribute_value.offset;
+  uint8array *value = &evt->data.evt_gatt_server_attribute_value.value;
+
+  if (attribute == gattdb_thermostat_schedule) {
+      uint8_t data[SCHEDULE_PACKED_LEN];
+      size_t len;
+
+      // A long write is reported in parts, load once the last part is in
+      if (offset + value->len < SCHEDULE_PACKED_LEN)
+        return;
+
+      status = sl_bt_gatt_server_read_attribute_value(gattdb_thermostat_schedule, 0,
+                                                      sizeof(data), &len, data);
+      if (status != SL_STATUS_OK) {
+          LOG_ERROR("Failed to read schedule attribute %u\n", status);
+          return;
+      }
+
+      load_schedule(data, len, 1);
+  }
+  else if (attribute == gattdb_thermostat_zone_target && offset == 0 && value->len == 2) {
+      if (value->data[0] >= g_server_data.zones.zone_count ||
+          value->data[1] == 0 || value->data[1] > 125) {
+          LOG_ERROR("Invalid zone target %u %u\n", value->data[0], value->data[1]);
+          return;
+      }
+
+      zone_set_target(&g_server_data.zones, value->data[0], value->data[1]);
+      run_zones();
+  }
+  else if (attribute == gattdb_thermostat_time && offset == 0 && value->len == 4) {
+      int16_t target = g_server_data.zones.zones[ZONE_MAIN].target_temp;
+      uint32_t now_s = value->data[0] | (value->data[1] << 8) |
+          (value->data[2] << 16) | ((uint32_t)value->data[3] << 24);
+
+      status = sl_sleeptimer_set_time(now_s);
+      if (status != SL_STATUS_OK) {
+          LOG_ERROR("Failed to set time %u\n", status);
+          return;
+      }
+
+      LOG_INFO("Local time set to %lu\n", now_s);
+      g_server_data.clock_set = 1;
+
+      // The clock may have jumped, look the transition in effect up again
+      schedule_sync(&g_server_data.schedule, now_s, &target);
+      if (g_server_data.schedule.count)
+        apply_schedule_target(target);
+
+      arm_schedule_timer();
+  }
+  else if ((attribute == gattdb_ac_state || attribute == gattdb_heater_state) &&
+           offset == 0 && value->len == 1) {
+      // Acknowledgement of the state snapshots in the notification mode
+      client_data_t *client = get_client_by_conn_handle(evt->data.evt_gatt_server_attribute_value.connection);
+
+      if (client == NULL)
+        return;
+
+      outbox_acked(&client->outbox, value->data[0], timerGetUptimeMs(),
+                   client_sender(client), client);
+      arm_indication_timer();
+  }
+  else if ((attribute == gattdb_ac_probe_echo || attribute == gattdb_heater_probe_echo) &&
+           offset == 0) {
+      // Taken before anything else, t4 of the probe
+      uint32_t now_us = (uint32_t)timerGetUptimeUs();
+      client_data_t *client = get_client_by_conn_handle(evt->data.evt_gatt_server_attribute_value.connection);
+
+      if (client != NULL && probe_echo(&client->probe, value->data, value->len, now_us))
+        timesync_exchange(&client->sync, client->phy.link_phy, client->interval * 1250,
+                          client->probe.times_us);
   }
 }
 
@@ -768,27 +3603,68 @@ void handle_gatt_server_characteristic_status(sl_bt_msg_t *evt)
  ******************************************************************************/
 void handle_bt_closed(sl_bt_msg_t *evt)
 {
-  client_data_t *client = get_client_by_conn_handle(evt->data.evt_connection_closed.connection);
+  uint8_t connection = evt->data.evt_connection_closed.connection;
+  client_data_t *client = get_client_by_conn_handle(connection);
+  uint8_t released;
 
-  if (client != NULL) {
-      LOG_INFO("Disconnected\n");
+  // A phone, the advertiser takes the next one
+  if (client == NULL) {
+      g_server_data.status_subscribers &= ~(1UL << connection);
 
-      sl_status_t status;
+      if (g_server_data.phone_passkey && connection == g_server_data.phone_conn) {
+          g_server_data.phone_passkey = 0;
+          update_lcd();
+      }
 
-      status = sl_bt_sm_delete_bonding(client->bond_handle);
-      if (status != SL_STATUS_OK)
-        LOG_ERROR("Failed to delete bonding");
-      else
-        LOG_INFO("Succeeded to delete bonding");
+      if (g_server_data.export.open && connection == g_server_data.export_conn)
+        close_export();
 
+      start_advertising();
+  }
 
+  if (client != NULL) {
+      LOG_INFO("Disconnected\n");
 
-      client->conn_handle = 0x00;
-      client->bond_handle = 0x00;
+      // A link lost during its setup counts against the PHY it was opened on
+      if (client->conn_state & (CONN_STATE_CONNECTING | CONN_STATE_CONNECTED |
+                                CONN_STATE_BONDING | CONN_STATE_PASSKEY |
+                                CONN_STATE_ENCRYPTING))
+        phy_open_done(&client->phy, 0);
 
+      // The bonding is kept for the reconnect
+      set_client_conn_handle(client, 0x00);
+      client->indications_enabled = 0;
+      client->probe_enabled = 0;
+      set_link_parameters(client, 0, 0);
+
+      // The client may come back from a reboot with a new clock
+      timesync_init(&client->sync);
+      plan_links();
+
+      /* A bonded client holding the broadcast key closed the link to take
+       * its states from the command table */
+      released = BROADCAST_ENABLE && client->bcast_keyed &&
+          client->conn_state == CONN_STATE_BONDED;
+      client->bcast_keyed = 0;
+
+      /* The client may have restarted, its current state is sent again once
+       * it takes indications */
+      outbox_lost(&client->outbox, 0);
+      outbox_push(&client->outbox, client->onoff_state, timerGetUptimeMs(), NULL, NULL);
+
+      // It acks the current table once it is synchronized to the train
+      if (released) {
+          LOG_INFO("Client %u released to the broadcast\n",
+                   (uint8_t)(client - g_server_data.clients_data));
+          set_client_conn_state(client, CONN_STATE_BROADCAST);
+          expect_broadcast_ack(client);
+      }
       // If connection closed by client but not explicitly by server
-      if (client->conn_state != CONN_STATE_DISCONNECTED) {
-          client->conn_state = CONN_STATE_SCANNING;
+      else if (client->conn_state != CONN_STATE_DISCONNECTED) {
+          if (client->link_lost_ms == 0)
+            client->link_lost_ms = timerGetUptimeMs();
+
+          set_client_conn_state(client, CONN_STATE_SCANNING);
           start_manual_scan();
       }
   }
@@ -820,6 +3696,12 @@ void handle_ble_event(sl_bt_msg_t *evt)
     case sl_bt_evt_sm_bonded_id:
       handle_bt_bonded(evt);
       break;
+    case sl_bt_evt_connection_parameters_id:
+      handle_bt_parameters(evt);
+      break;
+    case sl_bt_evt_connection_phy_status_id:
+      handle_bt_phy_status(evt);
+      break;
     case sl_bt_evt_sm_bonding_failed_id:
       handle_bt_bonding_failed(evt);
       break;
@@ -832,11 +3714,54 @@ void handle_ble_event(sl_bt_msg_t *evt)
     case sl_bt_evt_gatt_server_characteristic_status_id:
       handle_gatt_server_characteristic_status(evt);
       break;
+    case sl_bt_evt_gatt_server_attribute_value_id:
+      handle_gatt_server_attribute_value(evt);
+      break;
     case sl_bt_evt_gatt_server_indication_timeout_id:
-      // handle when gatt indication received ack by gatt pending flag
+      handle_gatt_server_indication_timeout(evt);
+      break;
+    case sl_bt_evt_gatt_server_user_read_request_id:
+      handle_gatt_server_user_read_request(evt);
+      break;
+    case sl_bt_evt_gatt_server_user_write_request_id:
+      handle_gatt_server_user_write_request(evt);
+      break;
+    case sl_bt_evt_l2cap_coc_connection_request_id:
+      handle_l2cap_connection_request(evt);
+      break;
+    case sl_bt_evt_l2cap_coc_data_id:
+      handle_l2cap_data(evt);
+      break;
+    case sl_bt_evt_l2cap_coc_le_flow_control_credit_id:
+      handle_l2cap_credit(evt);
+      break;
+    case sl_bt_evt_l2cap_coc_channel_disconnected_id:
+      handle_l2cap_disconnected(evt);
       break;
     case sl_bt_evt_system_soft_timer_id:
-      displayUpdate(evt);
+      if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_LCD)
+        displayUpdate(evt);
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_SCHEDULE)
+        handle_schedule_timer();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_SCAN)
+        handle_scan_timer();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_INDICATION)
+        handle_indication_timer();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_CONNPARAM)
+        handle_connparam_timer();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_STATUS)
+        handle_status_timer();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_PROVISION)
+        stop_provisioning();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_BROADCAST)
+        handle_broadcast_timer();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_PROBE)
+        handle_probe_timer();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_EXPORT)
+        pump_export();
+      else if (evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_ACTUATION &&
+          g_server_data.automatic_temp_control)
+        run_actuation();
       break;
   } // end - switch
 } // handle_ble_event()
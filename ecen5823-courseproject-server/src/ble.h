@@ -12,6 +12,85 @@
  *          automatically (auto feature on) and manual triggering of scanning
  *          using PB0 event.
  *
+ * @editor  Oct 19, 2026
+ * @change  Replaced the on/off logic in update_current_temperature() with the
+ *          control engine in control.c and added daily switch/indication
+ *          stats.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the weekly schedule of target temperatures, loaded over GATT
+ *          together with the local time and kept in NVM.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the learned recovery, the next target of the schedule is
+ *          taken early enough to be reached at its transition.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Moved the temperatures and the control state into zones, every
+ *          client is an actuator of a zone.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the actuation scheduler that sends the client states.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the client registry for the client lookups.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Replaced the scan count limit with a scan timeout, scanning now
+ *          runs continuously until every client is found.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the accept list filtering of the scan reports.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Bondings are kept across reboots and link losses, a bonded client
+ *          is encrypted from the stored keys on reconnect. Added the link
+ *          loss to controllable latency stats.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Replaced gatt_ack_pending with the outbox of the state
+ *          indications of a client.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the connection parameter manager of a client link.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the PHY policy of a client.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the status record of the thermostat service and its
+ *          subscribers.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Replaced the scan timeout with the scan scheduler.
+ *
+ * @editor  Oct 19, 2026
+ * @change  The clients are no longer hard coded, they are learned in the
+ *          provisioning mode from the service UUID they advertise and kept
+ *          in NVM.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Up to SERVER_MAX_CLIENTS clients, the links share the radio
+ *          schedule of linksched.c.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the broadcast mode, the states go out in the command table
+ *          of bcast.c in a periodic advertising train and the client links
+ *          are released once the client holds the broadcast key.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the status beacon of beacon.c for passive monitors.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the latency probe of probe.c and its report.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the time sync of timesync.c on the probe exchanges.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Added the temperature history of history.c and its export over an
+ *          L2CAP channel in export.c.
+ *
  ******************************************************************************/
 #ifndef SRC_BLE_H_
 #define SRC_BLE_H_
@@ -19,10 +98,108 @@
 
 #include "em_common.h"
 #include "sl_bluetooth.h"
+#include "control.h"
+#include "schedule.h"
+#include "recovery.h"
+#include "zone.h"
+#include "actuation.h"
+#include "registry.h"
+#include "outbox.h"
+#include "connparam.h"
+#include "phy.h"
+#include "scansched.h"
+#include "linksched.h"
+#include "bcast.h"
+#include "beacon.h"
+#include "probe.h"
+#include "timesync.h"
+#include "history.h"
+#include "export.h"
+#include "sl_bluetooth_connection_config.h"
 
 
-#define MAX_SESSION_SCANS 50
 #define LCD_TIMEOUT_PERIOD 10
+#define CONTROL_STATS_PERIOD_S (24 * 60 * 60)
+#define SCHEDULE_MAX_TIMER_S (12 * 60 * 60)   // Soft timer limit is 36 hours
+#define SERVER_ZONE_COUNT 1                   // Zones with a sensor, up to ZONE_MAX
+#define ACCEPT_LIST_ENABLE (1)                // Scanner only reports the clients
+#define STATUS_BATCH_MS 50                    // Changes batched into one notification
+#define SERVER_MAX_CLIENTS (SL_BT_CONFIG_MAX_CONNECTIONS - 1)  // One is left to a phone
+#define PROVISION_WINDOW_S 60                 // Provisioning ends after it
+#define CLIENT_RECORD_LEN 8                   // Address, address type and kind in NVM
+
+/* Broadcast mode, set BROADCAST_ENABLE to 1 to release the link of a client
+ * once it has read the broadcast key and to send its states in the command
+ * table of the periodic advertising train. A client that does not acknowledge
+ * a table within BCAST_ACK_TIMEOUT_MS is connected again and takes the state
+ * as a confirmed indication. */
+#define BROADCAST_ENABLE (0)
+#define BCAST_INTERVAL 240                    // Periodic advertising, 300 ms / 1.25 ms
+#define BCAST_ADV_INTERVAL 1600               // Extended advertising with the SyncInfo, 1 s / 0.625 ms
+#define BCAST_ACK_TIMEOUT_MS 15000            // SCANSCHED_FAST_MS, the aggressive scan phase
+#define BCAST_KEY_RECORD_LEN (BCAST_KEY_LEN + 1)  // Key and slot of the client
+#define BCAST_NVM_LEN (BCAST_KEY_LEN + 4)     // Key and end of the sequence number block
+
+/* Status beacon, set BEACON_ENABLE to 1 to advertise the status of beacon.h
+ * in a non-connectable advertising set every BEACON_INTERVAL. The data is set
+ * on the advertiser only when the status changes. */
+#define BEACON_ENABLE (0)
+#define BEACON_INTERVAL 1600                  // 1 s / 0.625 ms
+
+/* Latency probe, set PROBE_ENABLE to 1 to ping every client subscribed to the
+ * probe characteristic of its service every PROBE_PERIOD_MS. The pings do not
+ * hold the link active, the latencies are the ones of the parameters the link
+ * runs, and the probe of a link starts over when they change. The probes are
+ * logged every PROBE_REPORT_PINGS and read from the probe report
+ * characteristic. The period is above the worst idle round trip, (1 + latency)
+ * idle intervals down and one back. Every echo is a sample of the time sync of
+ * the client and every ping carries its estimate, the client stamps its logs
+ * with the server time by it. */
+#define PROBE_ENABLE (0)
+#define PROBE_PERIOD_MS 5000
+#define PROBE_REPORT_PINGS 12                 // Logged every minute
+
+/* Probe report of the thermostat probe report characteristic, an entry per
+ * client, little endian:
+ *  [0]       Client type, 0 without a link
+ *  [1..2]    Connection interval of the link in 1.25 ms units
+ *  [3]       Peripheral latency of the link
+ *  [4..17]   Report record of probe.h */
+#define PROBE_ENTRY_LEN (4 + PROBE_RECORD_LEN)
+#define PROBE_REPORT_LEN (SERVER_MAX_CLIENTS * PROBE_ENTRY_LEN)
+
+/* Export of the history, set EXPORT_ENABLE to 1 to take the L2CAP channel of
+ * export.h on EXPORT_LE_PSM from a phone on an encrypted link, paired with its
+ * passkey confirmed on PB0. Every sample of a zone is kept in the history
+ * either way. A PDU the stack has no room for is sent again after
+ * EXPORT_RETRY_MS. */
+#define EXPORT_ENABLE (0)
+#define EXPORT_LE_PSM 0x0080                  // First of the dynamic range
+#define EXPORT_STREAMS 1                      // History, at EXPORT_STREAM_HISTORY
+#define EXPORT_RETRY_MS 10
+#define EXPORT_FLAG_ENCRYPTED (1 << 0)        // Of the connection request
+
+/* Status record of the thermostat status characteristic, little endian:
+ *  [0]       Sequence number of the latest notification
+ *  [1]       STATUS_FLAG_* bits
+ *  [2..3]    Current temperature of the main zone in tenths of F
+ *  [4..5]    Target temperature of the main zone in tenths of F
+ *  [6]       Control output of the main zone, control_output_t
+ *  [7]       Clients that are on, bit per client index
+ *  [8]       Clients that are bonded and controllable, bit per client index
+ *  [9]       Zone count
+ *  [10..13]  Actuator switches since the stats period started
+ *  [14..17]  State indications since the stats period started */
+#define STATUS_RECORD_LEN 18
+#define STATUS_FLAG_AUTO (1 << 0)
+#define STATUS_FLAG_CLOCK_SET (1 << 1)
+#define STATUS_FLAG_SCANNING (1 << 2)
+
+// The clients are saved in a single NVM key of at most 56 bytes
+#if SERVER_MAX_CLIENTS * CLIENT_RECORD_LEN > 56 || SERVER_MAX_CLIENTS > LINKSCHED_MAX_LINKS || \
+    SERVER_MAX_CLIENTS > BCAST_MAX_ACTUATORS
+#error "Too many clients for NVM_KEY_CLIENTS, the link schedule or the command table"
+#endif
 
 
 typedef enum {
@@ -45,34 +222,85 @@ typedef enum {
   CONN_STATE_BONDED =     (1 << 6),
   CONN_STATE_NOT_BONDED = (1 << 7),
   CONN_STATE_DISCONNECTED = (1 << 8),
-  CONN_STATE_NOT_FOUND =  (1 << 9)
+  CONN_STATE_NOT_FOUND =  (1 << 9),
+  CONN_STATE_ENCRYPTING = (1 << 10),   // Bonded, encrypting from stored keys
+  CONN_STATE_BROADCAST =  (1 << 11)    // Bonded, link released, in the command table
 }client_conn_state_t;
 
 
 typedef struct {
-  const bd_addr addr;
-  const client_type_t client_type;
+  bd_addr addr;
+  uint8_t addr_type;              // sl_bt_gap_address_type_t of the advertiser
+  client_type_t client_type;
   uint8_t conn_handle;
   uint8_t bond_handle;
   client_conn_state_t conn_state;
   client_state_t onoff_state;
-  uint8_t gatt_ack_pending;
   uint8_t indications_enabled;
+  uint8_t zone;
+  uint8_t actuator;               // Index in zone_table_t.actuators
+  uint32_t link_lost_ms;          // Uptime of the link loss, 0 = none pending
+  outbox_t outbox;                // State indications to the client
+  connparam_t conn_params;        // Profile of the link
+  phy_policy_t phy_policy;
+  phy_link_t phy;                 // PHY of the link and stats per PHY
+  uint8_t bcast_keyed;            // Read the broadcast key on this link
+  uint8_t bcast_pending;          // Waiting for the ack of bcast_seq
+  uint32_t bcast_seq;             // First table with the latest state
+  uint32_t bcast_sent_ms;
+  uint16_t interval;              // Connection parameters in effect, 0 without a link
+  uint16_t latency;
+  uint8_t probe_enabled;          // Subscribed to the pings
+  probe_t probe;                  // Latencies under the parameters in effect
+  timesync_t sync;                // Of the client clock, kept over parameters
 }client_data_t;
 
 typedef struct {
   bd_addr addr;
   uint8_t addr_type;
   uint8_t adv_handle;
-  int16_t current_temp;
-  int16_t target_temp;
-  uint8_t offset_temp;
-  uint8_t session_scans_count;
+  uint8_t bcast_handle;           // Advertising set of the periodic train
+  uint8_t bcast_on;               // Train started with a key
+  bcast_t bcast;                  // Command table of the broadcast mode
+  uint8_t beacon_handle;          // Advertising set of the status beacon
+  uint8_t beacon_on;              // Set created
+  beacon_t beacon;
+  zone_table_t zones;
+  actuation_t actuation;
+  uint32_t indications_sent;
+  uint32_t stats_start_s;
+  schedule_t schedule;
+  recovery_model_t recovery;
+  uint8_t clock_set;
+  uint8_t scanning;
+  scansched_t scan_sched;         // Duty cycle of the scanner
   uint8_t automatic_temp_control;
   client_data_t *clients_data;
   uint8_t clients_count;
+  registry_t registry;            // Index of clients_data
+  uint64_t accept_listed;         // Clients on the accept list, bit per index
+  linksched_t link_sched;         // Radio schedule of the client links
+  uint32_t reconnects;            // Link losses back to controllable
+  uint32_t reconnect_ms_sum;
+  uint32_t reconnect_ms_max;
   uint8_t lcd_on;
   uint8_t lcd_on_timeout;
+  uint32_t status_subscribers;    // Bit per connection handle notified of the status
+  uint8_t status_queued;          // Status timer armed
+  uint8_t status_seq;
+  uint8_t status_sent[STATUS_RECORD_LEN];   // Last status notified
+  uint32_t status_notifications;
+  uint8_t provisioning;           // Unknown advertisers are parsed for clients
+  uint32_t provisioned;           // Clients learned since boot
+  uint32_t ad_reports;            // Scan reports parsed while provisioning
+  uint32_t ad_structs;            // AD structures walked in them
+  uint32_t ad_compares;           // Service UUIDs compared in them
+  uint32_t probe_rounds;          // Probe timer expiries
+  history_t history;              // Samples of the zones
+  export_chan_t export;           // L2CAP channel of the export
+  uint8_t export_conn;            // Connection of the channel
+  uint8_t phone_passkey;          // A phone pairing waits for PB0
+  uint8_t phone_conn;             // Connection of the phone pairing
 }server_data_t;
 
 
@@ -103,16 +331,20 @@ void toggle_auto_feature(void);
 
 
 /******************************************************************************
- * @brief   Updates the current temperature and displays the same on the LCD.
- * In Auto feature On mode, if the current temperature drops below the target
- * temperature then Heater will be turned On and when the current temperature
- * goes above the target temperature then AC will be turned On.
+ * @brief   Updates the current temperature of a zone and displays the same on
+ * the LCD. In Auto feature On mode, the control engine in control.c decides
+ * if the Heaters or the ACs of the zone have to be On, based on the current
+ * temperature, the target temperature, the deadband and the minimum on/off
+ * times. Only the zones with a new sample or target are run. The target of
+ * ZONE_MAIN follows the schedule and moves to the next setpoint early by the
+ * lead time learned in recovery.c. The sample is kept in the history.
  *
  * @param
+ *  zone    Zone of the sensor
  *  temp    The current measured temperature from temperature sensor
  *
  ******************************************************************************/
-void update_current_temperature(int16_t temp);
+void update_zone_temperature(uint8_t zone, int16_t temp);
 
 
 /******************************************************************************
@@ -133,9 +365,11 @@ void decrease_taget_temperature(void);
 
 /******************************************************************************
  * @brief   The PB0 event is used in contexts. When the server is bonding with
- * one of the clients then PB0 is used as confirmation for pass-key. Otherwise,
- * if one of the clients is not connected the PB0 event is used to initiate
- * the scanning.
+ * one of the clients then PB0 is used as confirmation for pass-key. Otherwise
+ * PB0 starts or ends the provisioning mode, in which the scanner restarts
+ * without the accept list and an AC or a Heater advertising its service UUID
+ * is added as a client, bonded and kept in NVM. With every client slot taken,
+ * a new device replaces a client of its kind that is not connected.
  *
  ******************************************************************************/
 void pb0_event_handle(void);
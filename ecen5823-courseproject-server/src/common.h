@@ -12,4 +12,23 @@
 #define INCLUDE_LOG_DEBUG 1
 #include "log.h"
 
+// Handles of the BT stack soft timers
+#define SOFT_TIMER_HANDLE_LCD       (0)
+#define SOFT_TIMER_HANDLE_SENSOR    (1)
+#define SOFT_TIMER_HANDLE_SCHEDULE  (2)
+#define SOFT_TIMER_HANDLE_ACTUATION (3)
+#define SOFT_TIMER_HANDLE_SCAN      (4)
+#define SOFT_TIMER_HANDLE_INDICATION (5)
+#define SOFT_TIMER_HANDLE_CONNPARAM (6)
+#define SOFT_TIMER_HANDLE_STATUS    (7)
+#define SOFT_TIMER_HANDLE_PROVISION (8)
+#define SOFT_TIMER_HANDLE_BROADCAST (9)
+#define SOFT_TIMER_HANDLE_PROBE     (10)
+#define SOFT_TIMER_HANDLE_EXPORT    (11)
+
+// Keys of the BT stack NVM, 0x4000 to 0x407F are for the application
+#define NVM_KEY_SCHEDULE            (0x4000)
+#define NVM_KEY_CLIENTS             (0x4001)
+#define NVM_KEY_BROADCAST           (0x4002)
+
 #endif /* SRC_COMMON_H_ */
@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * @file    connparam.c
+ * @brief   Connection parameter manager. See connparam.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "connparam.h"
+#include "timers.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Starts the manager.
+ ******************************************************************************/
+void connparam_init(connparam_t *cp, uint32_t now_ms)
+{
+  memset(cp, 0, sizeof(connparam_t));
+
+  cp->profile = CONNPARAM_PROFILE_ACTIVE;
+  cp->holds = CONNPARAM_HOLD_SETUP;
+  cp->activity_ms = now_ms;
+  cp->switch_ms = now_ms;
+}
+
+
+/******************************************************************************
+ * @brief Profile the link should run now.
+ ******************************************************************************/
+static connparam_profile_t connparam_wanted(const connparam_t *cp, uint32_t now_ms)
+{
+  if (cp->holds || now_ms - cp->activity_ms < CONNPARAM_IDLE_AFTER_MS)
+    return CONNPARAM_PROFILE_ACTIVE;
+
+  // Dropping to idle waits for the dwell time, going active never waits
+  if (cp->profile == CONNPARAM_PROFILE_ACTIVE && now_ms - cp->switch_ms < CONNPARAM_DWELL_MS)
+    return CONNPARAM_PROFILE_ACTIVE;
+
+  return CONNPARAM_PROFILE_IDLE;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Holds the link active.
+ ******************************************************************************/
+void connparam_hold(connparam_t *cp, connparam_hold_t hold, uint32_t now_ms,
+                    connparam_apply_t apply, void *ctx)
+{
+  cp->holds |= hold;
+  connparam_update(cp, now_ms, apply, ctx);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Releases a hold.
+ ******************************************************************************/
+void connparam_release(connparam_t *cp, connparam_hold_t hold, uint32_t now_ms)
+{
+  if (!(cp->holds & hold))
+    return;
+
+  cp->holds &= ~hold;
+  cp->activity_ms = now_ms;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes a command.
+ ******************************************************************************/
+void connparam_activity(connparam_t *cp, uint32_t now_ms,
+                        connparam_apply_t apply, void *ctx)
+{
+  cp->activity_ms = now_ms;
+  connparam_update(cp, now_ms, apply, ctx);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Switches the profile.
+ ******************************************************************************/
+uint8_t connparam_update(connparam_t *cp, uint32_t now_ms,
+                         connparam_apply_t apply, void *ctx)
+{
+  connparam_profile_t profile = connparam_wanted(cp, now_ms);
+
+  if (profile == cp->profile || apply == NULL)
+    return 0;
+
+  if (apply(profile, ctx) != 0) {
+      cp->failures++;
+      return 0;
+  }
+
+  if (cp->profile == CONNPARAM_PROFILE_ACTIVE)
+    cp->active_ms_sum += now_ms - cp->switch_ms;
+  else
+    cp->idle_ms_sum += now_ms - cp->switch_ms;
+
+  cp->profile = profile;
+  cp->switch_ms = now_ms;
+  cp->switches++;
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Time until the link may go idle.
+ ******************************************************************************/
+uint32_t connparam_wait_ms(const connparam_t *cp, uint32_t now_ms)
+{
+  uint32_t idle_ms = cp->activity_ms + CONNPARAM_IDLE_AFTER_MS;
+  uint32_t dwell_ms = cp->switch_ms + CONNPARAM_DWELL_MS;
+
+  if (cp->profile == CONNPARAM_PROFILE_IDLE || cp->holds)
+    return 0;
+
+  if ((int32_t)(dwell_ms - idle_ms) > 0)
+    idle_ms = dwell_ms;
+
+  return ms_until(idle_ms, now_ms);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Time in a profile.
+ ******************************************************************************/
+uint32_t connparam_profile_ms(const connparam_t *cp, connparam_profile_t profile,
+                              uint32_t now_ms)
+{
+  uint32_t profile_ms = profile == CONNPARAM_PROFILE_ACTIVE ?
+      cp->active_ms_sum : cp->idle_ms_sum;
+
+  if (cp->profile == profile)
+    profile_ms += now_ms - cp->switch_ms;
+
+  return profile_ms;
+}
@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * @file    connparam.h
+ * @brief   Connection parameter manager of a client link. A link runs the
+ *          active profile, a short interval without peripheral latency, while
+ *          it is held busy by the bonding and the discovery of the client or
+ *          an OTA, and for CONNPARAM_IDLE_AFTER_MS after a command. Past that
+ *          it drops to the idle profile, a long interval with a high
+ *          peripheral latency. A command switches the link back to active
+ *          right away, the drop to idle only comes CONNPARAM_DWELL_MS after
+ *          the previous switch so that a link does not flap between the two.
+ *          The time spent in each profile is kept per link.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_CONNPARAM_H_
+#define SRC_CONNPARAM_H_
+
+#include <stdint.h>
+
+
+#define CONNPARAM_IDLE_AFTER_MS     (5000)    // Active after the last command
+#define CONNPARAM_DWELL_MS          (2000)    // Min time in the active profile
+
+// Intervals in 1.25 ms units, supervision timeouts in 10 ms units
+#define CONNPARAM_ACTIVE_INTERVAL   (24)      // 30 ms
+#define CONNPARAM_ACTIVE_LATENCY    (0)
+#define CONNPARAM_ACTIVE_TIMEOUT    (100)     // 1 s
+#define CONNPARAM_IDLE_INTERVAL     (240)     // 300 ms
+#define CONNPARAM_IDLE_LATENCY      (4)       // Peripheral listens every 1.5 s
+#define CONNPARAM_IDLE_TIMEOUT      (400)     // Over (1 + latency) * interval * 2
+
+
+typedef enum {
+  CONNPARAM_PROFILE_IDLE = 0,
+  CONNPARAM_PROFILE_ACTIVE
+}connparam_profile_t;
+
+typedef enum {
+  CONNPARAM_HOLD_SETUP = (1 << 0),   // Bonding and discovery of the client
+  CONNPARAM_HOLD_OTA =   (1 << 1)
+}connparam_hold_t;
+
+
+/******************************************************************************
+ * @brief Applies a profile to the link of the client.
+ *
+ * @param
+ *  profile   Profile to be applied
+ *  ctx       Context passed to the manager call
+ *
+ * @return
+ *  Returns 0 if the parameter update is started, else non-zero and it is
+ *  tried again on the next update.
+ *
+ ******************************************************************************/
+typedef uint8_t (*connparam_apply_t)(connparam_profile_t profile, void *ctx);
+
+typedef struct {
+  connparam_profile_t profile;    // Applied to the link
+  uint8_t holds;                  // connparam_hold_t bits
+  uint32_t activity_ms;           // Last command or hold released
+  uint32_t switch_ms;             // Last profile switch
+  uint32_t switches;              // Stats
+  uint32_t failures;
+  uint32_t active_ms_sum;         // Time in the profiles, up to switch_ms
+  uint32_t idle_ms_sum;
+}connparam_t;
+
+
+/******************************************************************************
+ * @brief Starts the manager of a newly opened link. The link opens with the
+ * default parameters, the active profile, and is held busy by its setup.
+ ******************************************************************************/
+void connparam_init(connparam_t *cp, uint32_t now_ms);
+
+
+/******************************************************************************
+ * @brief Holds the link in the active profile until the hold is released.
+ ******************************************************************************/
+void connparam_hold(connparam_t *cp, connparam_hold_t hold, uint32_t now_ms,
+                    connparam_apply_t apply, void *ctx);
+
+
+/******************************************************************************
+ * @brief Releases a hold, the link goes idle CONNPARAM_IDLE_AFTER_MS later
+ * unless it is busy again.
+ ******************************************************************************/
+void connparam_release(connparam_t *cp, connparam_hold_t hold, uint32_t now_ms);
+
+
+/******************************************************************************
+ * @brief Takes a command sent on the link, switches it to the active profile.
+ *
+ * @param
+ *  cp      Manager of the link
+ *  now_ms  Current time in milliseconds
+ *  apply   Applies the profile to the link
+ *  ctx     Passed to apply
+ *
+ ******************************************************************************/
+void connparam_activity(connparam_t *cp, uint32_t now_ms,
+                        connparam_apply_t apply, void *ctx);
+
+
+/******************************************************************************
+ * @brief Switches the link to the profile its activity calls for.
+ *
+ * @return
+ *  Returns 1 if a profile was applied, else 0.
+ *
+ ******************************************************************************/
+uint8_t connparam_update(connparam_t *cp, uint32_t now_ms,
+                         connparam_apply_t apply, void *ctx);
+
+
+/******************************************************************************
+ * @brief Time until the link may go idle.
+ *
+ * @return
+ *  Milliseconds to wait, 0 if the link is idle or held busy.
+ *
+ ******************************************************************************/
+uint32_t connparam_wait_ms(const connparam_t *cp, uint32_t now_ms);
+
+
+/******************************************************************************
+ * @brief Time spent in a profile until now.
+ ******************************************************************************/
+uint32_t connparam_profile_ms(const connparam_t *cp, connparam_profile_t profile,
+                              uint32_t now_ms);
+
+
+#endif /* SRC_CONNPARAM_H_ */
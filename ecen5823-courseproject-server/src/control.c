@@ -0,0 +1,212 @@
+/*******************************************************************************
+ * @file    control.c
+ * @brief   Temperature control engine deciding whether the heater or the AC
+ *          has to run. Supports an on/off mode with a deadband and a fixed
+ *          point PI mode with time proportioning and anti-windup, both limited
+ *          by minimum on and off times of the actuators.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include "control.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Number of relays that change when going from one output to other.
+ ******************************************************************************/
+uint32_t control_relay_changes(control_output_t from, control_output_t to)
+{
+  if (from == to)
+    return 0;
+
+  if (from == CONTROL_OUTPUT_OFF || to == CONTROL_OUTPUT_OFF)
+    return 1;
+
+  return 2;
+}
+
+
+/******************************************************************************
+ * @brief Plain on/off control without hysteresis.
+ ******************************************************************************/
+static control_output_t legacy_output(int16_t current, int16_t target)
+{
+  if (current > target)
+    return CONTROL_OUTPUT_COOL;
+  else if (current < target)
+    return CONTROL_OUTPUT_HEAT;
+
+  return CONTROL_OUTPUT_OFF;
+}
+
+
+/******************************************************************************
+ * @brief On/off control with the deadband as hysteresis. The actuator turns on
+ * once the temperature is more than a deadband away from the target and stays
+ * on until the target is reached.
+ ******************************************************************************/
+static control_output_t hysteresis_output(control_state_t *ctl, int16_t current,
+                                          int16_t target)
+{
+  int16_t deadband = ctl->config.deadband;
+
+  switch (ctl->output) {
+    case CONTROL_OUTPUT_HEAT:
+      if (current >= target)
+        return CONTROL_OUTPUT_OFF;
+      return CONTROL_OUTPUT_HEAT;
+
+    case CONTROL_OUTPUT_COOL:
+      if (current <= target)
+        return CONTROL_OUTPUT_OFF;
+      return CONTROL_OUTPUT_COOL;
+
+    default:
+      if (current < target - deadband)
+        return CONTROL_OUTPUT_HEAT;
+      if (current > target + deadband)
+        return CONTROL_OUTPUT_COOL;
+      return CONTROL_OUTPUT_OFF;
+  }
+}
+
+
+/******************************************************************************
+ * @brief PI control, positive output is heating and negative is cooling. The
+ * output is turned into an on time within a fixed window since the actuators
+ * can only be on or off. The integral is clamped and not integrated further
+ * while the output is saturated in the direction of the error.
+ ******************************************************************************/
+static control_output_t pi_output(control_state_t *ctl, int16_t current,
+                                  int16_t target, uint32_t now_s)
+{
+  const control_config_t *cfg = &ctl->config;
+  int32_t error = (int32_t)target - current;
+  uint32_t dt_s = now_s - ctl->last_update_s;
+  int32_t u_q8;
+  uint32_t duty_q8;
+  uint32_t elapsed_s;
+
+  u_q8 = cfg->kp_q8 * error + ctl->integral_q8;
+
+  if (!((u_q8 >= CONTROL_Q8_ONE && error > 0) || (u_q8 <= -CONTROL_Q8_ONE && error < 0))) {
+      ctl->integral_q8 += (cfg->ki_q8 * error * (int32_t)dt_s) / 60;
+
+      if (ctl->integral_q8 > CONTROL_Q8_ONE)
+        ctl->integral_q8 = CONTROL_Q8_ONE;
+      else if (ctl->integral_q8 < -CONTROL_Q8_ONE)
+        ctl->integral_q8 = -CONTROL_Q8_ONE;
+
+      u_q8 = cfg->kp_q8 * error + ctl->integral_q8;
+  }
+
+  if (u_q8 > CONTROL_Q8_ONE)
+    u_q8 = CONTROL_Q8_ONE;
+  else if (u_q8 < -CONTROL_Q8_ONE)
+    u_q8 = -CONTROL_Q8_ONE;
+
+  duty_q8 = (u_q8 < 0) ? -u_q8 : u_q8;
+
+  if ((int32_t)duty_q8 < cfg->pi_min_duty_q8)
+    return CONTROL_OUTPUT_OFF;
+
+  elapsed_s = now_s - ctl->cycle_start_s;
+  if (elapsed_s >= cfg->pi_cycle_s) {
+      ctl->cycle_start_s = now_s;
+      elapsed_s = 0;
+  }
+
+  if (elapsed_s >= (cfg->pi_cycle_s * duty_q8) / CONTROL_Q8_ONE)
+    return CONTROL_OUTPUT_OFF;
+
+  return (u_q8 > 0) ? CONTROL_OUTPUT_HEAT : CONTROL_OUTPUT_COOL;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Loads the default configuration and resets the control state.
+ ******************************************************************************/
+void control_init(control_state_t *ctl, uint32_t now_s)
+{
+  ctl->config.mode = CONTROL_MODE_HYSTERESIS;
+  ctl->config.deadband = CONTROL_DEADBAND;
+  ctl->config.min_on_time_s = CONTROL_MIN_ON_TIME_S;
+  ctl->config.min_off_time_s = CONTROL_MIN_OFF_TIME_S;
+  ctl->config.kp_q8 = CONTROL_PI_KP_Q8;
+  ctl->config.ki_q8 = CONTROL_PI_KI_Q8;
+  ctl->config.pi_cycle_s = CONTROL_PI_CYCLE_S;
+  ctl->config.pi_min_duty_q8 = CONTROL_PI_MIN_DUTY_Q8;
+
+  ctl->legacy_output = CONTROL_OUTPUT_OFF;
+  control_reset(ctl, CONTROL_OUTPUT_OFF, now_s);
+  control_clear_stats(ctl);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Restarts the control from the given actuator output.
+ ******************************************************************************/
+void control_reset(control_state_t *ctl, control_output_t output, uint32_t now_s)
+{
+  ctl->output = output;
+  ctl->last_switch_s = now_s;
+  ctl->last_switch_valid = 0;
+  ctl->last_update_s = now_s;
+  ctl->integral_q8 = 0;
+  ctl->cycle_start_s = now_s;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs one control step for the given sample.
+ ******************************************************************************/
+control_output_t control_update(control_state_t *ctl, int16_t current,
+                                int16_t target, uint32_t now_s)
+{
+  control_output_t desired;
+  control_output_t legacy = legacy_output(current, target);
+
+  ctl->legacy_switches += control_relay_changes(ctl->legacy_output, legacy);
+  ctl->legacy_output = legacy;
+
+  if (ctl->config.mode == CONTROL_MODE_PI)
+    desired = pi_output(ctl, current, target, now_s);
+  else
+    desired = hysteresis_output(ctl, current, target);
+
+  ctl->last_update_s = now_s;
+
+  if (desired == ctl->output)
+    return ctl->output;
+
+  // Actuator has to stay in its current state for the minimum on/off time
+  if (ctl->last_switch_valid) {
+      uint32_t min_time_s = (ctl->output == CONTROL_OUTPUT_OFF) ?
+          ctl->config.min_off_time_s : ctl->config.min_on_time_s;
+
+      if (now_s - ctl->last_switch_s < min_time_s)
+        return ctl->output;
+  }
+
+  ctl->switches += control_relay_changes(ctl->output, desired);
+  ctl->output = desired;
+  ctl->last_switch_s = now_s;
+  ctl->last_switch_valid = 1;
+
+  return ctl->output;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the switch counters.
+ ******************************************************************************/
+void control_clear_stats(control_state_t *ctl)
+{
+  ctl->switches = 0;
+  ctl->legacy_switches = 0;
+}
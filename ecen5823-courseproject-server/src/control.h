@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * @file    control.h
+ * @brief   Temperature control engine deciding whether the heater or the AC
+ *          has to run. Supports an on/off mode with a deadband and a fixed
+ *          point PI mode with time proportioning and anti-windup, both limited
+ *          by minimum on and off times of the actuators. Every call to
+ *          control_update() runs in constant time and does not depend on any
+ *          hardware, time is passed in by the caller.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_CONTROL_H_
+#define SRC_CONTROL_H_
+
+#include <stdint.h>
+
+
+// Default configuration, temperatures are in degree Fahrenheit
+#define CONTROL_DEADBAND            (1)     // Hysteresis around the target
+#define CONTROL_MIN_ON_TIME_S       (180)
+#define CONTROL_MIN_OFF_TIME_S      (300)
+#define CONTROL_PI_KP_Q8            (128)   // Half duty per degree of error
+#define CONTROL_PI_KI_Q8            (8)     // Duty per degree minute of error
+#define CONTROL_PI_CYCLE_S          (900)   // Time proportioning window
+#define CONTROL_PI_MIN_DUTY_Q8      (32)    // Smaller duty keeps actuators off
+
+#define CONTROL_Q8_ONE              (256)
+
+
+typedef enum {
+  CONTROL_MODE_HYSTERESIS = 0,
+  CONTROL_MODE_PI
+}control_mode_t;
+
+typedef enum {
+  CONTROL_OUTPUT_OFF = 0,
+  CONTROL_OUTPUT_HEAT,
+  CONTROL_OUTPUT_COOL
+}control_output_t;
+
+typedef struct {
+  control_mode_t mode;
+  int16_t deadband;
+  uint32_t min_on_time_s;
+  uint32_t min_off_time_s;
+  int32_t kp_q8;
+  int32_t ki_q8;
+  uint32_t pi_cycle_s;
+  int32_t pi_min_duty_q8;
+}control_config_t;
+
+typedef struct {
+  control_config_t config;
+  control_output_t output;
+  uint32_t last_switch_s;
+  uint8_t last_switch_valid;      // No minimum time applies till first switch
+  uint32_t last_update_s;
+  int32_t integral_q8;
+  uint32_t cycle_start_s;
+  control_output_t legacy_output; // Plain on/off control, for comparison
+  uint32_t switches;              // Actuator relay changes
+  uint32_t legacy_switches;       // Relay changes the plain on/off would make
+}control_state_t;
+
+
+/******************************************************************************
+ * @brief Loads the default configuration and resets the control state.
+ *
+ * @param
+ *  ctl     Control state to be initialized
+ *  now_s   Current time in seconds
+ *
+ ******************************************************************************/
+void control_init(control_state_t *ctl, uint32_t now_s);
+
+
+/******************************************************************************
+ * @brief Restarts the control from the given actuator output, used when the
+ * actuators were driven manually. The PI integral is cleared and the minimum
+ * on/off times do not apply till the next switch.
+ *
+ * @param
+ *  ctl     Control state
+ *  output  Output the actuators are currently in
+ *  now_s   Current time in seconds
+ *
+ ******************************************************************************/
+void control_reset(control_state_t *ctl, control_output_t output, uint32_t now_s);
+
+
+/******************************************************************************
+ * @brief Runs one control step for the given sample.
+ *
+ * @param
+ *  ctl       Control state
+ *  current   Current temperature
+ *  target    Target temperature
+ *  now_s     Current time in seconds
+ *
+ * @return
+ *  Output the heater and AC have to be set to.
+ *
+ ******************************************************************************/
+control_output_t control_update(control_state_t *ctl, int16_t current,
+                                int16_t target, uint32_t now_s);
+
+
+/******************************************************************************
+ * @brief Number of relays that change when going from one output to other,
+ * every relay change is one indication to a client.
+ ******************************************************************************/
+uint32_t control_relay_changes(control_output_t from, control_output_t to);
+
+
+/******************************************************************************
+ * @brief Clears the switch counters.
+ ******************************************************************************/
+void control_clear_stats(control_state_t *ctl);
+
+
+#endif /* SRC_CONTROL_H_ */
@@ -0,0 +1,253 @@
+/*******************************************************************************
+ * @file    export.c
+ * @brief   Bulk export of the record rings over an L2CAP LE credit based
+ *          channel. See export.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "export.h"
+
+
+/******************************************************************************
+ * @brief Index of the oldest record still in a ring.
+ ******************************************************************************/
+static uint32_t export_oldest(const export_source_t *src)
+{
+  uint32_t written = *src->written;
+
+  return written > src->capacity ? written - src->capacity : 0;
+}
+
+
+/******************************************************************************
+ * @brief Copies bytes of a ring from a record index, across its end.
+ ******************************************************************************/
+static void export_copy(const export_source_t *src, uint32_t index, uint8_t *dst,
+                        uint16_t len)
+{
+  uint32_t ring_len = src->capacity * src->record_len;
+  uint32_t at = (index % src->capacity) * src->record_len;
+  uint16_t first = ring_len - at < len ? (uint16_t)(ring_len - at) : len;
+
+  memcpy(dst, &src->base[at], first);
+  memcpy(&dst[first], src->base, len - first);
+}
+
+
+/******************************************************************************
+ * @brief Plans the next SDU from the records after ch->next and builds its
+ * first PDU. A request waiting for the end of the last SDU is taken first.
+ ******************************************************************************/
+static void export_start_sdu(export_chan_t *ch)
+{
+  const export_source_t *src;
+  uint32_t oldest, available, fit, pdus;
+  uint16_t data_len, head_data;
+
+  if (ch->request_pending) {
+      ch->request_pending = 0;
+      ch->source = ch->request_source;
+      ch->stream = ch->request_stream;
+      ch->next = ch->request_next;
+  }
+
+  src = ch->source;
+  oldest = export_oldest(src);
+
+  // Modulo 2^32, a peer may resume past the wrap of the index
+  if ((int32_t)(ch->next - oldest) < 0) {
+      ch->next = oldest;
+      ch->gaps++;
+  }
+  if ((int32_t)(*src->written - ch->next) < 0)
+    ch->next = *src->written;
+
+  available = *src->written - ch->next;
+  fit = (ch->mtu - (EXPORT_HEADER_LEN - 2)) / src->record_len;
+  if (fit > available)
+    fit = available;
+
+  // An SDU ending early in a PDU is cut to the PDUs before, its tail is a packet
+  pdus = (EXPORT_HEADER_LEN + fit * src->record_len + ch->mps - 1) / ch->mps;
+  if (pdus > 1 && EXPORT_HEADER_LEN + fit * src->record_len - (pdus - 1) * ch->mps < ch->mps / 2)
+    fit = ((pdus - 1) * ch->mps - EXPORT_HEADER_LEN) / src->record_len;
+
+  ch->sdu_first = ch->next;
+  ch->sdu_records = (uint16_t)fit;
+  data_len = ch->sdu_records * src->record_len;
+  ch->sdu_len = EXPORT_HEADER_LEN + data_len;
+  ch->sdu_sent = 0;
+
+  ch->head[0] = (uint8_t)(ch->sdu_len - 2);
+  ch->head[1] = (uint8_t)((ch->sdu_len - 2) >> 8);
+  ch->head[2] = ch->stream;
+  ch->head[3] = (uint8_t)ch->sdu_first;
+  ch->head[4] = (uint8_t)(ch->sdu_first >> 8);
+  ch->head[5] = (uint8_t)(ch->sdu_first >> 16);
+  ch->head[6] = (uint8_t)(ch->sdu_first >> 24);
+  ch->head[7] = (uint8_t)src->record_len;
+
+  // The records after the header in the first PDU are the only ones copied
+  head_data = ch->mps - EXPORT_HEADER_LEN;
+  if (head_data > data_len)
+    head_data = data_len;
+
+  export_copy(src, ch->sdu_first, &ch->head[EXPORT_HEADER_LEN], head_data);
+  ch->head_len = EXPORT_HEADER_LEN + head_data;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears a channel.
+ ******************************************************************************/
+void export_init(export_chan_t *ch)
+{
+  memset(ch, 0, sizeof(export_chan_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Opens a channel.
+ ******************************************************************************/
+void export_open(export_chan_t *ch, uint16_t cid, uint16_t mtu, uint16_t mps,
+                 uint16_t credits)
+{
+  export_close(ch);
+
+  ch->open = 1;
+  ch->cid = cid;
+  ch->mtu = mtu;
+  ch->mps = mps < EXPORT_MAX_MPS ? mps : EXPORT_MAX_MPS;
+  ch->credits = credits;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Closes a channel.
+ ******************************************************************************/
+void export_close(export_chan_t *ch)
+{
+  ch->open = 0;
+  ch->credits = 0;
+  ch->source = NULL;
+  ch->request_pending = 0;
+  ch->sdu_len = 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Adds the credits of the peer.
+ ******************************************************************************/
+void export_credit(export_chan_t *ch, uint16_t credits)
+{
+  // The peer may give at most 65535 credits outstanding
+  ch->credits = ch->credits + credits < ch->credits ? 0xFFFF : ch->credits + credits;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes a request of the peer.
+ ******************************************************************************/
+uint8_t export_request(export_chan_t *ch, const export_source_t *sources,
+                       uint8_t count, const uint8_t *data, uint16_t len)
+{
+  if (!ch->open || len != EXPORT_REQUEST_LEN ||
+      (data[0] | (data[1] << 8)) != EXPORT_REQUEST_LEN - 2 || data[2] >= count) {
+      ch->rejected++;
+      return 0;
+  }
+
+  ch->requests++;
+  ch->request_pending = 1;
+  ch->request_stream = data[2];
+  ch->request_source = &sources[data[2]];
+  ch->request_next = data[3] | (data[4] << 8) | (data[5] << 16) | ((uint32_t)data[6] << 24);
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Gives out the next PDU.
+ ******************************************************************************/
+uint16_t export_next(export_chan_t *ch, const uint8_t **pdu)
+{
+  const export_source_t *src;
+  uint32_t ring_len, index, at;
+  uint16_t offset, len;
+
+  if (!ch->open || ch->credits == 0)
+    return 0;
+
+  if (ch->sdu_len == 0) {
+      if (ch->source == NULL && !ch->request_pending)
+        return 0;
+      export_start_sdu(ch);
+  }
+
+  if (ch->sdu_sent == 0) {
+      *pdu = ch->head;
+      ch->pdu_len = ch->head_len;
+      return ch->pdu_len;
+  }
+
+  // The rest of the SDU is sent from the ring, cut at the MPS and at its end
+  src = ch->source;
+  offset = ch->sdu_sent - EXPORT_HEADER_LEN;
+  index = ch->sdu_first + offset / src->record_len;
+
+  if (*src->written - index > src->capacity) {
+      ch->overruns++;
+      return EXPORT_ABORT;
+  }
+
+  ring_len = src->capacity * src->record_len;
+  at = (index % src->capacity) * src->record_len + offset % src->record_len;
+
+  len = ch->sdu_len - ch->sdu_sent;
+  if (len > ch->mps)
+    len = ch->mps;
+  if (len > ring_len - at)
+    len = (uint16_t)(ring_len - at);
+
+  *pdu = &src->base[at];
+  ch->pdu_len = len;
+
+  return len;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes the PDU as sent.
+ ******************************************************************************/
+void export_sent(export_chan_t *ch)
+{
+  ch->credits--;
+  ch->sdu_sent += ch->pdu_len;
+  ch->pdus++;
+  ch->bytes += ch->pdu_len;
+
+  if (ch->sdu_sent == ch->sdu_len) {
+      ch->sdus++;
+      ch->records += ch->sdu_records;
+      ch->next = ch->sdu_first + ch->sdu_records;
+      ch->sdu_len = 0;
+
+      // An SDU without records tells the peer the stream caught up
+      if (ch->sdu_records == 0)
+        ch->source = NULL;
+  }
+
+  if (ch->credits == 0 && (ch->source != NULL || ch->request_pending))
+    ch->stalls++;
+}
@@ -0,0 +1,166 @@
+/*******************************************************************************
+ * @file    export.h
+ * @brief   Bulk export of the record rings over an L2CAP LE credit based
+ *          channel. A peer requests a stream from a record index and the
+ *          records from there up to the latest go out in SDUs as large as
+ *          the MTU of the peer takes, ended by an SDU without records once
+ *          the stream has caught up. The SDUs are cut into PDUs of the MPS of
+ *          the peer, one per credit it gave, and an SDU whose last PDU would
+ *          be less than half full is cut to the PDUs before it. Only the first PDU of an SDU,
+ *          with the SDU length and the header, is built in the channel, the
+ *          others point into the ring itself and are cut at its end, so the
+ *          records are not copied before the stack takes them.
+ *
+ *          A record is known by its index in the count of records ever
+ *          written to its ring. A request for records already overwritten
+ *          starts at the oldest one, the peer sees the gap in the first index
+ *          of the SDU and resumes a broken transfer from the index after the
+ *          last record it took. A record overwritten while its SDU is being
+ *          sent cannot be taken back, the channel is then aborted and the
+ *          peer resumes on a new one.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_EXPORT_H_
+#define SRC_EXPORT_H_
+
+#include <stdint.h>
+
+
+#define EXPORT_MAX_MPS          (243)     // LE data length 251 less the L2CAP header and MIC
+#define EXPORT_RX_MTU           (23)      // Of the server, the requests are short
+#define EXPORT_RX_MPS           (23)
+#define EXPORT_RX_CREDITS       (4)       // Requests the peer may send ahead
+#define EXPORT_ABORT            (0xFFFF)  // Of export_next(), a record was overwritten
+
+#define EXPORT_STREAM_HISTORY   (0)       // Temperature history of history.h
+
+/* Request of the peer, an SDU in a single PDU, little endian:
+ *  [0..1]    SDU length, 5
+ *  [2]       Stream
+ *  [3..6]    Index of the first record wanted
+ * SDU of the server, little endian:
+ *  [0..1]    SDU length, less these 2 bytes
+ *  [2]       Stream
+ *  [3..6]    Index of the first record in the SDU
+ *  [7]       Length of a record
+ *  [8..]     Records, none once the stream has caught up */
+#define EXPORT_REQUEST_LEN      (7)
+#define EXPORT_HEADER_LEN       (8)
+
+
+typedef struct {
+  const uint8_t *base;            // Ring of records
+  uint16_t record_len;
+  uint32_t capacity;              // Records in the ring
+  const uint32_t *written;        // Records ever written to it
+}export_source_t;
+
+typedef struct {
+  uint8_t open;
+  uint16_t cid;                   // Channel of the peer
+  uint16_t mtu;                   // Largest SDU the peer takes
+  uint16_t mps;                   // Largest PDU the peer takes, up to EXPORT_MAX_MPS
+  uint16_t credits;               // PDUs the peer takes
+  const export_source_t *source;  // Stream being sent, NULL when idle
+  uint8_t stream;
+  uint32_t next;                  // Index the next SDU starts at
+  uint8_t request_pending;        // Taken at the end of the SDU being sent
+  uint8_t request_stream;
+  const export_source_t *request_source;
+  uint32_t request_next;
+  uint32_t sdu_first;             // Index of the first record of the SDU being sent
+  uint16_t sdu_records;
+  uint16_t sdu_len;               // With its length field, 0 without an SDU
+  uint16_t sdu_sent;              // Bytes of it taken by the stack
+  uint16_t pdu_len;               // Of the PDU given out by export_next()
+  uint8_t head[EXPORT_MAX_MPS];   // First PDU of the SDU
+  uint16_t head_len;
+  uint32_t requests;              // Stats
+  uint32_t rejected;              // Requests malformed or of an unknown stream
+  uint32_t sdus;
+  uint32_t pdus;
+  uint32_t bytes;                 // Of the PDUs
+  uint32_t records;
+  uint32_t gaps;                  // Requests for records already overwritten
+  uint32_t stalls;                // Credits run out with the stream not done
+  uint32_t overruns;
+}export_chan_t;
+
+
+/******************************************************************************
+ * @brief Clears a channel.
+ ******************************************************************************/
+void export_init(export_chan_t *ch);
+
+
+/******************************************************************************
+ * @brief Opens a channel on the request of the peer, the stats are kept.
+ *
+ * @param
+ *  ch        Channel
+ *  cid       Channel of the peer
+ *  mtu       Largest SDU the peer takes
+ *  mps       Largest PDU the peer takes
+ *  credits   Initial credits of the peer
+ *
+ ******************************************************************************/
+void export_open(export_chan_t *ch, uint16_t cid, uint16_t mtu, uint16_t mps,
+                 uint16_t credits);
+
+
+/******************************************************************************
+ * @brief Closes a channel, the SDU being sent and the request are dropped.
+ ******************************************************************************/
+void export_close(export_chan_t *ch);
+
+
+/******************************************************************************
+ * @brief Adds the credits given by the peer.
+ ******************************************************************************/
+void export_credit(export_chan_t *ch, uint16_t credits);
+
+
+/******************************************************************************
+ * @brief Takes a request of the peer. It replaces the stream being sent at
+ * the end of its SDU.
+ *
+ * @param
+ *  ch        Channel
+ *  sources   Rings by stream
+ *  count     Streams
+ *  data      PDU of the peer
+ *  len       Length of data
+ *
+ * @return
+ *  Returns 1 if the request is taken.
+ *
+ ******************************************************************************/
+uint8_t export_request(export_chan_t *ch, const export_source_t *sources,
+                       uint8_t count, const uint8_t *data, uint16_t len);
+
+
+/******************************************************************************
+ * @brief Gives out the next PDU of the stream. It stays the next one until
+ * export_sent() is called, a PDU the stack has no room for is given again.
+ *
+ * @param
+ *  ch    Channel
+ *  pdu   Set to the PDU, in the channel or in the ring
+ *
+ * @return
+ *  Length of the PDU, 0 without a credit or a stream, EXPORT_ABORT if a
+ *  record of the SDU was overwritten and the channel has to be disconnected.
+ *
+ ******************************************************************************/
+uint16_t export_next(export_chan_t *ch, const uint8_t **pdu);
+
+
+/******************************************************************************
+ * @brief Takes the PDU given out by export_next() as sent, it used a credit.
+ ******************************************************************************/
+void export_sent(export_chan_t *ch);
+
+
+#endif /* SRC_EXPORT_H_ */
@@ -0,0 +1,52 @@
+/*******************************************************************************
+ * @file    history.c
+ * @brief   Temperature history of the zones. See history.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "history.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the history.
+ ******************************************************************************/
+void history_init(history_t *h)
+{
+  memset(h, 0, sizeof(history_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Writes the record of a sample.
+ ******************************************************************************/
+void history_add(history_t *h, uint32_t time_s, uint8_t zone, uint8_t output,
+                 int16_t current, int16_t target)
+{
+  uint8_t *record = &h->records[(h->written % HISTORY_RECORDS) * HISTORY_RECORD_LEN];
+
+  record[0] = (uint8_t)time_s;
+  record[1] = (uint8_t)(time_s >> 8);
+  record[2] = (uint8_t)(time_s >> 16);
+  record[3] = (uint8_t)(time_s >> 24);
+  record[4] = zone;
+  record[5] = output;
+  record[6] = (uint8_t)current;
+  record[7] = (uint8_t)target;
+
+  h->written++;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Index of the oldest record.
+ ******************************************************************************/
+uint32_t history_oldest(const history_t *h)
+{
+  return h->written > HISTORY_RECORDS ? h->written - HISTORY_RECORDS : 0;
+}
@@ -0,0 +1,64 @@
+/*******************************************************************************
+ * @file    history.h
+ * @brief   Temperature history of the zones, a ring of fixed size records
+ *          written on every sample a zone takes. A record is known by its
+ *          index in the count of records ever written, not by its slot, so
+ *          a reader keeps its offset across the wraps of the ring and sees
+ *          the records it lost as a jump of the index. The ring is read in
+ *          place by the export of export.c.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_HISTORY_H_
+#define SRC_HISTORY_H_
+
+#include <stdint.h>
+
+
+#define HISTORY_RECORDS         (512)     // About 40 minutes at a sample every 5 s
+#define HISTORY_RECORD_LEN      (8)
+
+/* Record, little endian:
+ *  [0..3]    Uptime of the sample in s
+ *  [4]       Zone
+ *  [5]       Control output of the zone after the sample, control_output_t
+ *  [6]       Current temperature in F
+ *  [7]       Target temperature in F */
+
+
+typedef struct {
+  uint8_t records[HISTORY_RECORDS * HISTORY_RECORD_LEN];
+  uint32_t written;               // Records ever written, index of the next one
+}history_t;
+
+
+/******************************************************************************
+ * @brief Clears the history.
+ ******************************************************************************/
+void history_init(history_t *h);
+
+
+/******************************************************************************
+ * @brief Writes the record of a sample over the oldest one.
+ *
+ * @param
+ *  h         History
+ *  time_s    Uptime of the sample
+ *  zone      Zone of the sample
+ *  output    Control output of the zone
+ *  current   Current temperature in F, 0 to 125
+ *  target    Target temperature in F, 0 to 125
+ *
+ ******************************************************************************/
+void history_add(history_t *h, uint32_t time_s, uint8_t zone, uint8_t output,
+                 int16_t current, int16_t target);
+
+
+/******************************************************************************
+ * @brief Index of the oldest record still in the ring.
+ ******************************************************************************/
+uint32_t history_oldest(const history_t *h);
+
+
+#endif /* SRC_HISTORY_H_ */
@@ -11,6 +11,10 @@
  * @change  Rewrote I2C read to do the register address writing and reading
  *          from it in a single transaction.
  *
+ * @editor  Oct 19, 2026
+ * @change  Added I2C0_receive() for sensors that are read without a register
+ *          address and fixed the register address going out of scope.
+ *
  ******************************************************************************/
 #include <sl_i2cspm.h>
 
@@ -28,6 +32,9 @@
 
 I2C_TransferSeq_TypeDef transferSequence;
 
+// Register address must outlive I2C0_read(), it is sent from the I2C0 IRQ
+static uint8_t transferRegAddr;
+
 
 /*******************************************************************************
  * Initializes the I2C0 with proper PORT and PIN values.
@@ -102,7 +109,8 @@ int I2C0_read(uint16_t dev_addr, uint8_t reg_addr, uint8_t *data, uint8_t data_l
   I2C0_init();
 
   transferSequence.addr = dev_addr << 1;
-  transferSequence.buf[0].data = &reg_addr;
+  transferRegAddr = reg_addr;
+  transferSequence.buf[0].data = &transferRegAddr;
   transferSequence.buf[0].len = 1;
   transferSequence.buf[1].data = data;
   transferSequence.buf[1].len = data_len;
@@ -117,3 +125,38 @@ int I2C0_read(uint16_t dev_addr, uint8_t reg_addr, uint8_t *data, uint8_t data_l
 
   return 0;
 }
+
+
+/*******************************************************************************
+ * Reads data over I2C of given length without writing a register address
+ * first. On I2C read complete, the interrupt is generated and is handled in
+ * irq.c
+ *
+ * @param     dev_addr  I2C peripheral device address
+ * @param     *data     Buffer for the received data
+ * @param     data_len  Length of *data array
+ *
+ * @return    Returns non-zero value on fail and 0 on success.
+ *
+ ******************************************************************************/
+int I2C0_receive(uint16_t dev_addr, uint8_t *data, uint8_t data_len)
+{
+  I2C_TransferReturn_TypeDef transferStatus;
+
+  I2C0_init();
+
+  transferSequence.addr = dev_addr << 1;
+  transferSequence.buf[0].data = data;
+  transferSequence.buf[0].len = data_len;
+  transferSequence.flags = I2C_FLAG_READ;
+
+  NVIC_EnableIRQ(I2C0_IRQn);
+
+  transferStatus = I2C_TransferInit (I2C0, &transferSequence);
+  if (transferStatus < 0) {
+      LOG_ERROR("I2CSPM_Transfer: I2C bus read failed\n");
+      return -1;
+  }
+
+  return 0;
+}
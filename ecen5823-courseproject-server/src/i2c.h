@@ -11,6 +11,10 @@
  * @change  Rewrote I2C read to do the register address writing and reading
  *          from it in a single transaction.
  *
+ * @editor  Oct 19, 2026
+ * @change  Added I2C0_receive() for sensors that are read without a register
+ *          address and fixed the register address going out of scope.
+ *
  ******************************************************************************/
 #ifndef SRC_I2C_H_
 #define SRC_I2C_H_
@@ -54,4 +58,19 @@ int I2C0_write(uint16_t dev_addr, uint8_t *data, uint8_t data_len);
 int I2C0_read(uint16_t dev_addr, uint8_t reg_addr, uint8_t *data, uint8_t data_len);
 
 
+/*******************************************************************************
+ * Reads data over I2C of given length without writing a register address
+ * first. On I2C read complete, the interrupt is generated and is handled in
+ * irq.c
+ *
+ * @param     dev_addr  I2C peripheral device address
+ * @param     *data     Buffer for the received data
+ * @param     data_len  Length of *data array
+ *
+ * @return    Returns non-zero value on fail and 0 on success.
+ *
+ ******************************************************************************/
+int I2C0_receive(uint16_t dev_addr, uint8_t *data, uint8_t data_len);
+
+
 #endif /* SRC_I2C_H_ */
@@ -0,0 +1,150 @@
+/*******************************************************************************
+ * @file    linksched.c
+ * @brief   Radio schedule of the client links. See linksched.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "linksched.h"
+#include "connparam.h"
+#include "phy.h"
+
+
+// Divisors of CONNPARAM_IDLE_INTERVAL from CONNPARAM_ACTIVE_INTERVAL up
+static const uint16_t linksched_intervals[] = { 24, 30, 40, 48, 60, 80, 120, 240 };
+
+#if CONNPARAM_IDLE_INTERVAL != 240 || CONNPARAM_ACTIVE_INTERVAL != 24
+#error "linksched_intervals does not match the connection parameter profiles"
+#endif
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the schedule.
+ ******************************************************************************/
+void linksched_init(linksched_t *ls)
+{
+  memset(ls, 0, sizeof(linksched_t));
+  ls->interval = CONNPARAM_ACTIVE_INTERVAL;
+  ls->idle_interval = CONNPARAM_IDLE_INTERVAL;
+  ls->fits = 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Connection event length on a PHY.
+ ******************************************************************************/
+uint8_t linksched_ce(uint8_t phy)
+{
+  uint32_t event_us = phy_transaction_us(phy, LINKSCHED_STATE_TX_LEN, LINKSCHED_STATE_RX_LEN) +
+      3 * LINKSCHED_IFS_US;
+  uint32_t ce = (event_us + 624) / 625;
+
+  return ce < LINKSCHED_MIN_CE ? LINKSCHED_MIN_CE : (uint8_t)ce;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Slot of a link.
+ ******************************************************************************/
+uint32_t linksched_slot_us(uint8_t phy)
+{
+  return linksched_ce(phy) * 625 + LINKSCHED_GUARD_US;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Picks the active interval.
+ ******************************************************************************/
+uint8_t linksched_plan(linksched_t *ls, uint8_t links, uint32_t slots_us)
+{
+  uint16_t interval = linksched_intervals[sizeof(linksched_intervals) / sizeof(linksched_intervals[0]) - 1];
+  uint16_t previous = ls->interval;
+
+  ls->fits = 0;
+
+  for (uint8_t i = 0; i < sizeof(linksched_intervals) / sizeof(linksched_intervals[0]); i++) {
+      if ((uint32_t)linksched_intervals[i] * 1250 >= slots_us + LINKSCHED_RESERVE_US) {
+          interval = linksched_intervals[i];
+          ls->fits = 1;
+          break;
+      }
+  }
+
+  ls->links = links;
+  ls->slots_us = slots_us;
+  ls->interval = interval;
+  ls->idle_interval = CONNPARAM_IDLE_INTERVAL;
+  ls->plans++;
+
+  return interval != previous;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Radio time of the links.
+ ******************************************************************************/
+uint32_t linksched_utilisation_pm(const linksched_t *ls, uint32_t active_us,
+                                  uint32_t idle_us)
+{
+  return active_us * 1000 / (ls->interval * 1250U) +
+      idle_us * 1000 / (ls->idle_interval * 1250U);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Worst case command latency.
+ ******************************************************************************/
+uint32_t linksched_worst_latency_ms(const linksched_t *ls, uint8_t idle,
+                                    uint16_t latency)
+{
+  uint32_t rounds = (ls->links + LINKSCHED_TX_PER_ROUND - 1) / LINKSCHED_TX_PER_ROUND;
+  uint32_t event_wait = idle ? (uint32_t)ls->idle_interval * (1 + latency) : ls->interval;
+
+  if (rounds == 0)
+    rounds = 1;
+
+  return ((rounds - 1) * ls->interval + event_wait) * 5 / 4;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Marks a link.
+ ******************************************************************************/
+void linksched_mark(linksched_t *ls, uint8_t link)
+{
+  if (link < LINKSCHED_MAX_LINKS)
+    ls->pending |= 1UL << link;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes the next link round robin.
+ ******************************************************************************/
+uint8_t linksched_next(linksched_t *ls)
+{
+  uint32_t after;
+  uint8_t link;
+
+  if (ls->pending == 0)
+    return LINKSCHED_NONE;
+
+  // The links from the cursor on first, then the ones before it
+  after = ls->pending & ~((1UL << ls->cursor) - 1);
+  link = (uint8_t)__builtin_ctz(after ? after : ls->pending);
+
+  ls->pending &= ~(1UL << link);
+  ls->cursor = (link + 1) % LINKSCHED_MAX_LINKS;
+  ls->served++;
+
+  return link;
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+ * @file    linksched.h
+ * @brief   Radio schedule of the client links. Every link gets a slot of the
+ *          connection event length one state transaction takes on its PHY,
+ *          and all the links run the same active interval, picked as the
+ *          shortest one that holds the slots of every link back to back plus
+ *          a reserve for the scanner and the advertiser. The intervals are
+ *          divisors of the idle interval, so an idle link keeps its anchor on
+ *          the slot it had while active and the whole schedule repeats every
+ *          idle interval without two links in the same slot. The commands to
+ *          the links are handed to the stack round robin, a bounded number
+ *          per round, so a burst to many links does not starve the last ones
+ *          and does not overrun the TX buffers of the stack.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_LINKSCHED_H_
+#define SRC_LINKSCHED_H_
+
+#include <stdint.h>
+
+
+#define LINKSCHED_MAX_LINKS     (32)      // At most 32, one bit per link
+#define LINKSCHED_NONE          (0xFF)
+#define LINKSCHED_MIN_CE        (4)       // 2.5 ms, CONNECTION_MAX_CE in ble.c
+#define LINKSCHED_IFS_US        (150)     // Between two packets of an event
+#define LINKSCHED_GUARD_US      (150)     // Between the events of two links
+#define LINKSCHED_RESERVE_US    (5000)    // Per interval, scanner and advertiser
+#define LINKSCHED_TX_PER_ROUND  (4)       // Commands handed to the stack per round
+#define LINKSCHED_STATE_TX_LEN  (12)      // STATE_INDICATION_LEN in ble.c
+#define LINKSCHED_STATE_RX_LEN  (9)       // STATE_CONFIRMATION_LEN in ble.c
+
+
+typedef struct {
+  uint8_t links;                  // Links of the plan
+  uint16_t interval;              // Active interval, 1.25 ms units
+  uint16_t idle_interval;         // Multiple of interval
+  uint32_t slots_us;              // Slots of the links back to back
+  uint8_t fits;                   // 0 if even the idle interval is too short
+  uint32_t pending;               // Bit per link with a command waiting
+  uint8_t cursor;                 // First link looked at in the next pick
+  uint32_t plans;                 // Stats
+  uint32_t served;
+  uint32_t deferred_rounds;       // Rounds that left commands waiting
+}linksched_t;
+
+
+/******************************************************************************
+ * @brief Clears the schedule, the links run CONNPARAM_ACTIVE_INTERVAL until
+ * the first plan.
+ ******************************************************************************/
+void linksched_init(linksched_t *ls);
+
+
+/******************************************************************************
+ * @brief Connection event length of a state indication and its confirmation
+ * on a PHY.
+ *
+ * @param
+ *  phy   PHY bit of the link
+ *
+ * @return
+ *  Max CE length in 0.625 ms units, at least LINKSCHED_MIN_CE.
+ *
+ ******************************************************************************/
+uint8_t linksched_ce(uint8_t phy);
+
+
+/******************************************************************************
+ * @brief Slot of a link on a PHY, its connection event and the guard.
+ ******************************************************************************/
+uint32_t linksched_slot_us(uint8_t phy);
+
+
+/******************************************************************************
+ * @brief Picks the active interval for the links.
+ *
+ * @param
+ *  ls        Schedule
+ *  links     Open links
+ *  slots_us  Sum of linksched_slot_us() of the links
+ *
+ * @return
+ *  Returns 1 if the interval changed and the links have to take it, else 0.
+ *
+ ******************************************************************************/
+uint8_t linksched_plan(linksched_t *ls, uint8_t links, uint32_t slots_us);
+
+
+/******************************************************************************
+ * @brief Radio time of the links in per mille.
+ *
+ * @param
+ *  ls          Schedule
+ *  active_us   Sum of the slots of the links in the active profile
+ *  idle_us     Sum of the slots of the links in the idle profile
+ *
+ ******************************************************************************/
+uint32_t linksched_utilisation_pm(const linksched_t *ls, uint32_t active_us,
+                                  uint32_t idle_us);
+
+
+/******************************************************************************
+ * @brief Worst case time from a command until it is on the air, with a
+ * command waiting for every link: the rounds ahead of it and the wait for the
+ * next event of its link that the peripheral listens to.
+ *
+ * @param
+ *  ls        Schedule
+ *  idle      1 for a link in the idle profile
+ *  latency   Peripheral latency of the profile
+ *
+ * @return
+ *  Milliseconds.
+ *
+ ******************************************************************************/
+uint32_t linksched_worst_latency_ms(const linksched_t *ls, uint8_t idle,
+                                    uint16_t latency);
+
+
+/******************************************************************************
+ * @brief Marks a link as having a command waiting.
+ ******************************************************************************/
+void linksched_mark(linksched_t *ls, uint8_t link);
+
+
+/******************************************************************************
+ * @brief Takes the next link with a command waiting, round robin from the
+ * link after the last one taken.
+ *
+ * @return
+ *  Index of the link, LINKSCHED_NONE if no command waits.
+ *
+ ******************************************************************************/
+uint8_t linksched_next(linksched_t *ls);
+
+
+#endif /* SRC_LINKSCHED_H_ */
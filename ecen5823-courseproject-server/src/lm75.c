@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * @file    lm75.c
+ * @brief   Sensor driver for the external LM75 temperature sensor.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include "lm75.h"
+#include "i2c.h"
+
+
+#define LM75_DEV_ADDR         (0x48)
+#define LM75_REG_CONG_ADDR    (0x01)
+#define LM75_REG_TEMP_ADDR    (0x00)
+#define LM75_REG_PID_ADDR     (0x07)
+#define LM75_SHUTDOWN_MASK    (0x01)
+#define LM75_INTERRUPT_MASK   (0x02)
+#define LM75_CONVERSION_MS    (100)
+
+// Reading seen when the sensor returns the power on value instead of a result
+#define LM75_INVALID_TEMP     (33)
+
+
+static uint8_t lm75_data[2];
+
+
+/******************************************************************************
+ * @brief Clears the shutdown bit so that the LM75 starts converting.
+ ******************************************************************************/
+static int lm75_begin_conversion(void)
+{
+  lm75_data[0] = (uint8_t)LM75_REG_CONG_ADDR;
+  lm75_data[1] = (uint8_t)LM75_INTERRUPT_MASK;
+
+  if (I2C0_write(LM75_DEV_ADDR, lm75_data, 2))
+    return SENSOR_TRANSFER_FAILED;
+
+  return SENSOR_TRANSFER_STARTED;
+}
+
+
+/******************************************************************************
+ * @brief Reads the temperature register.
+ ******************************************************************************/
+static int lm75_read(void)
+{
+  if (I2C0_read(LM75_DEV_ADDR, LM75_REG_TEMP_ADDR, lm75_data, 2))
+    return SENSOR_TRANSFER_FAILED;
+
+  return SENSOR_TRANSFER_STARTED;
+}
+
+
+/******************************************************************************
+ * @brief Sets the shutdown bit, the LM75 stops converting until woken up.
+ ******************************************************************************/
+static int lm75_shutdown(void)
+{
+  lm75_data[0] = (uint8_t)LM75_REG_CONG_ADDR;
+  lm75_data[1] = (uint8_t)LM75_INTERRUPT_MASK | LM75_SHUTDOWN_MASK;
+
+  if (I2C0_write(LM75_DEV_ADDR, lm75_data, 2))
+    return SENSOR_TRANSFER_FAILED;
+
+  return SENSOR_TRANSFER_STARTED;
+}
+
+
+/******************************************************************************
+ * @brief Converts the last read temperature register value to Fahrenheit.
+ ******************************************************************************/
+static int lm75_get_temperature(int16_t *temp)
+{
+  uint16_t data16 = lm75_data[0] << 8 | lm75_data[1];
+  int16_t temp_val = (int16_t)((data16 * 9) / (5 * 256)) + 32;
+
+  if (temp_val == LM75_INVALID_TEMP)
+    return -1;
+
+  *temp = temp_val;
+  return 0;
+}
+
+
+const sensor_driver_t lm75_driver = {
+    .name = "LM75",
+    .conversion_time_ms = LM75_CONVERSION_MS,
+    .begin_conversion = lm75_begin_conversion,
+    .read = lm75_read,
+    .shutdown = lm75_shutdown,
+    .get_temperature = lm75_get_temperature
+};
@@ -0,0 +1,17 @@
+/*******************************************************************************
+ * @file    lm75.h
+ * @brief   Sensor driver for the external LM75 temperature sensor.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_LM75_H_
+#define SRC_LM75_H_
+
+#include "sensor.h"
+
+
+extern const sensor_driver_t lm75_driver;
+
+
+#endif /* SRC_LM75_H_ */
@@ -11,10 +11,15 @@
  *      Editor: Mar 17, 2021, Dave Sluiter
  *      Change: Commented out logInit() and logFlush() as not needed in SSv5.
  *
+ *      Editor: Oct 19, 2026
+ *      Change: The timestamp is the uptime in milliseconds, the clients take
+ *              theirs from it by the time sync.
+ *
  */
 
 
 #include <stdbool.h>
+#include "timers.h"
 
 // Include logging for this file
 #define INCLUDE_LOG_DEBUG 1
@@ -45,7 +50,7 @@ uint32_t loggerGetTimestamp()
        //           assignments. Put the letimerMilliseconds() function in your irq.c/.h files.
        
        //return letimerMilliseconds();
-	   return (0);
+	   return timerGetUptimeMs();
 	   
     #endif
 
@@ -0,0 +1,228 @@
+/*******************************************************************************
+ * @file    outbox.c
+ * @brief   Outbound queue of the state indications. See outbox.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "outbox.h"
+#include "timers.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the outbox.
+ ******************************************************************************/
+void outbox_init(outbox_t *box)
+{
+  memset(box, 0, sizeof(outbox_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Switches the mode.
+ ******************************************************************************/
+void outbox_set_mode(outbox_t *box, outbox_mode_t mode)
+{
+  if (box->mode == mode)
+    return;
+
+  // A confirmation or acknowledgement of the old mode never comes
+  outbox_lost(box, 0);
+  box->mode = mode;
+}
+
+
+/******************************************************************************
+ * @brief Time until the backoff of a failed send ends, 0 if none.
+ ******************************************************************************/
+static uint32_t outbox_backoff_ms(const outbox_t *box, uint32_t now_ms)
+{
+  if (!box->pending || box->failures == 0 || (int32_t)(box->retry_ms - now_ms) <= 0)
+    return 0;
+
+  return box->retry_ms - now_ms;
+}
+
+
+/******************************************************************************
+ * @brief Checks if the state is already with the client or on its way.
+ ******************************************************************************/
+static uint8_t outbox_delivered(const outbox_t *box, uint8_t value)
+{
+  if (box->in_flight)
+    return box->sent_value == value;
+
+  return box->confirmed && box->confirmed_value == value;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Queues a state.
+ ******************************************************************************/
+void outbox_push(outbox_t *box, uint8_t value, uint32_t now_ms,
+                 outbox_send_t send, void *ctx)
+{
+  uint8_t waiting = box->pending;
+
+  if (waiting)
+    box->coalesced++;
+  else
+    box->queued_ms = now_ms;
+
+  // Back to the state the client holds, what waited is dropped
+  if (outbox_delivered(box, value)) {
+      box->pending = 0;
+      return;
+  }
+
+  box->pending = 1;
+  box->value = value;
+
+  if (send != NULL)
+    outbox_flush(box, now_ms, send, ctx);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sends the state waiting.
+ ******************************************************************************/
+uint8_t outbox_flush(outbox_t *box, uint32_t now_ms, outbox_send_t send,
+                     void *ctx)
+{
+  uint32_t backoff_ms;
+  uint8_t seq;
+
+  // The snapshot or its acknowledgement got lost, it goes again
+  if (box->mode == OUTBOX_MODE_NOTIFICATION && box->in_flight && !box->pending &&
+      (int32_t)(now_ms - box->sent_ms) >= OUTBOX_ACK_TIMEOUT_MS) {
+      box->pending = 1;
+      box->value = box->sent_value;
+      box->queued_ms = box->sent_queued_ms;
+      box->timeouts++;
+  }
+
+  if (!box->pending || outbox_backoff_ms(box, now_ms) ||
+      (box->mode == OUTBOX_MODE_INDICATION && box->in_flight))
+    return 0;
+
+  seq = box->seq + 1;
+
+  if (send(box->value, seq, ctx) == 0) {
+      // Snapshots in flight are acknowledged together, the oldest counts
+      if (!box->in_flight)
+        box->sent_queued_ms = box->queued_ms;
+
+      box->pending = 0;
+      box->in_flight = 1;
+      box->sent_value = box->value;
+      box->seq = seq;
+      box->sent_ms = now_ms;
+      box->failures = 0;
+      box->sent++;
+      return 1;
+  }
+
+  backoff_ms = OUTBOX_RETRY_MS << (box->failures < 5 ? box->failures : 5);
+  if (backoff_ms > OUTBOX_RETRY_MAX_MS)
+    backoff_ms = OUTBOX_RETRY_MAX_MS;
+
+  box->failures++;
+  box->retries++;
+  box->retry_ms = now_ms + backoff_ms;
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes the confirmation of the state in flight.
+ ******************************************************************************/
+void outbox_confirmed(outbox_t *box, uint32_t now_ms, outbox_send_t send,
+                      void *ctx)
+{
+  uint32_t latency_ms;
+
+  if (!box->in_flight)
+    return;
+
+  latency_ms = now_ms - box->sent_queued_ms;
+
+  box->in_flight = 0;
+  box->confirmed = 1;
+  box->confirmed_value = box->sent_value;
+  box->confirmations++;
+  box->latency_ms_sum += latency_ms;
+  if (latency_ms > box->latency_ms_max)
+    box->latency_ms_max = latency_ms;
+
+  // A state waiting that went back to the confirmed one needs no send
+  if (box->pending && box->value == box->confirmed_value) {
+      box->pending = 0;
+      box->coalesced++;
+  }
+
+  if (send != NULL)
+    outbox_flush(box, now_ms, send, ctx);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes the acknowledgement of the latest snapshot.
+ ******************************************************************************/
+void outbox_acked(outbox_t *box, uint8_t seq, uint32_t now_ms,
+                  outbox_send_t send, void *ctx)
+{
+  // An older snapshot, the latest one is still on its way
+  if (box->mode != OUTBOX_MODE_NOTIFICATION || seq != box->seq)
+    return;
+
+  outbox_confirmed(box, now_ms, send, ctx);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Drops the state in flight.
+ ******************************************************************************/
+void outbox_lost(outbox_t *box, uint8_t timeout)
+{
+  if (timeout)
+    box->timeouts++;
+
+  // What the client holds is unknown until a state is confirmed again
+  box->confirmed = 0;
+
+  if (!box->in_flight)
+    return;
+
+  box->in_flight = 0;
+
+  if (!box->pending) {
+      box->pending = 1;
+      box->value = box->sent_value;
+      box->queued_ms = box->sent_queued_ms;
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Time until the backoff or the acknowledgement timeout ends.
+ ******************************************************************************/
+uint32_t outbox_wait_ms(const outbox_t *box, uint32_t now_ms)
+{
+  uint32_t wait_ms = outbox_backoff_ms(box, now_ms);
+
+  if (box->mode != OUTBOX_MODE_NOTIFICATION || !box->in_flight || box->pending)
+    return wait_ms;
+
+  return ms_until(box->sent_ms + OUTBOX_ACK_TIMEOUT_MS, now_ms);
+}
@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * @file    outbox.h
+ * @brief   Outbound queue of the state indications of a client. A GATT server
+ *          has a single indication in flight per connection, so a new state
+ *          is held until the previous one is confirmed. The states waiting
+ *          are coalesced down to the latest one, a client only ever needs the
+ *          last state, and a state already in flight or confirmed is not sent
+ *          again. A failed send is retried with an exponential backoff and a
+ *          state lost with its connection or an indication timeout is sent
+ *          again once the client takes indications. The time from a state
+ *          being queued until the client confirms it is kept per client.
+ *          A client subscribed to notifications takes the states as snapshots
+ *          of a sequence number and the state instead. They are not held on
+ *          one in flight, the client keeps the newest snapshot and writes the
+ *          sequence number of the last one it got back on its own schedule,
+ *          a snapshot not acknowledged in time is sent again.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_OUTBOX_H_
+#define SRC_OUTBOX_H_
+
+#include <stdint.h>
+
+
+#define OUTBOX_RETRY_MS         (100)     // First retry after a failed send
+#define OUTBOX_RETRY_MAX_MS     (3200)
+#define OUTBOX_ACK_TIMEOUT_MS   (1000)    // Snapshot sent again after that
+
+
+typedef enum {
+  OUTBOX_MODE_INDICATION = 0,     // One state in flight, confirmed by the stack
+  OUTBOX_MODE_NOTIFICATION        // Sequenced snapshots acknowledged by the client
+}outbox_mode_t;
+
+
+/******************************************************************************
+ * @brief Sends a state indication, or a snapshot notification in the
+ * notification mode, to the client.
+ *
+ * @param
+ *  value   State to be sent
+ *  seq     Sequence number of the snapshot
+ *  ctx     Context passed to the outbox call
+ *
+ * @return
+ *  Returns 0 if the state is sent, else non-zero and it is retried.
+ *
+ ******************************************************************************/
+typedef uint8_t (*outbox_send_t)(uint8_t value, uint8_t seq, void *ctx);
+
+typedef struct {
+  outbox_mode_t mode;
+  uint8_t pending;                // A state waits to be sent
+  uint8_t value;                  // Latest state waiting
+  uint8_t in_flight;              // Sent, waiting for the confirmation
+  uint8_t sent_value;
+  uint8_t seq;                    // Of the latest state sent
+  uint8_t confirmed;              // Set once confirmed_value is valid
+  uint8_t confirmed_value;
+  uint8_t failures;               // Failed sends in a row, sets the backoff
+  uint32_t queued_ms;             // Oldest change waiting
+  uint32_t sent_queued_ms;        // queued_ms of the state in flight
+  uint32_t retry_ms;              // No send before then after a failure
+  uint32_t sent_ms;               // Latest send, for the acknowledgement timeout
+  uint32_t sent;                  // Stats
+  uint32_t confirmations;
+  uint32_t coalesced;             // States replaced before being sent
+  uint32_t retries;               // Failed sends
+  uint32_t timeouts;              // Indications timed out, snapshots not acked
+  uint32_t latency_ms_sum;
+  uint32_t latency_ms_max;
+}outbox_t;
+
+
+/******************************************************************************
+ * @brief Clears the outbox.
+ ******************************************************************************/
+void outbox_init(outbox_t *box);
+
+
+/******************************************************************************
+ * @brief Switches the outbox between the indications and the notifications,
+ * a state in flight is sent again in the new mode.
+ ******************************************************************************/
+void outbox_set_mode(outbox_t *box, outbox_mode_t mode);
+
+
+/******************************************************************************
+ * @brief Queues a state, replacing any state waiting, and sends it if nothing
+ * is in flight. In the notification mode it is sent right away.
+ *
+ * @param
+ *  box     Outbox of the client
+ *  value   State to be sent
+ *  now_ms  Current time in milliseconds
+ *  send    Sends the indication, NULL if the client takes no indications
+ *  ctx     Passed to send
+ *
+ ******************************************************************************/
+void outbox_push(outbox_t *box, uint8_t value, uint32_t now_ms,
+                 outbox_send_t send, void *ctx);
+
+
+/******************************************************************************
+ * @brief Sends the state waiting if nothing is in flight and no backoff holds
+ * it. In the notification mode a snapshot not acknowledged within
+ * OUTBOX_ACK_TIMEOUT_MS is sent again under a new sequence number.
+ *
+ * @return
+ *  Returns 1 if a state was sent, else 0.
+ *
+ ******************************************************************************/
+uint8_t outbox_flush(outbox_t *box, uint32_t now_ms, outbox_send_t send,
+                     void *ctx);
+
+
+/******************************************************************************
+ * @brief Takes the confirmation of the state in flight and sends the state
+ * waiting, if any.
+ ******************************************************************************/
+void outbox_confirmed(outbox_t *box, uint32_t now_ms, outbox_send_t send,
+                      void *ctx);
+
+
+/******************************************************************************
+ * @brief Takes the acknowledgement of a client in the notification mode. The
+ * acknowledgement is cumulative, the states in flight are confirmed once the
+ * client acknowledges the latest snapshot, older ones are ignored.
+ *
+ * @param
+ *  box     Outbox of the client
+ *  seq     Sequence number written back by the client
+ *  now_ms  Current time in milliseconds
+ *  send    Sends the state waiting, if any
+ *  ctx     Passed to send
+ *
+ ******************************************************************************/
+void outbox_acked(outbox_t *box, uint8_t seq, uint32_t now_ms,
+                  outbox_send_t send, void *ctx);
+
+
+/******************************************************************************
+ * @brief Drops the state in flight, lost with the connection or timed out.
+ * It waits again unless a newer state does.
+ *
+ * @param
+ *  box       Outbox of the client
+ *  timeout   1 if the indication timed out, for the stats
+ *
+ ******************************************************************************/
+void outbox_lost(outbox_t *box, uint8_t timeout);
+
+
+/******************************************************************************
+ * @brief Time until the backoff lets the state waiting go or, in the
+ * notification mode, until the snapshot in flight is sent again.
+ *
+ * @return
+ *  Milliseconds to wait, 0 if nothing waits on a timer.
+ *
+ ******************************************************************************/
+uint32_t outbox_wait_ms(const outbox_t *box, uint32_t now_ms);
+
+
+#endif /* SRC_OUTBOX_H_ */
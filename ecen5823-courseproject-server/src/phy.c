@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * @file    phy.c
+ * @brief   PHY policy of a client link. See phy.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "phy.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the stats.
+ ******************************************************************************/
+void phy_init(phy_link_t *phy, phy_policy_t policy)
+{
+  memset(phy, 0, sizeof(phy_link_t));
+
+  phy->policy = policy;
+  phy->link_phy = PHY_1M;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Index of a PHY.
+ ******************************************************************************/
+uint8_t phy_index(uint8_t phy)
+{
+  if (phy & PHY_2M)
+    return 1;
+
+  if (phy & (PHY_CODED | PHY_CODED_500K))
+    return 2;
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Scanning PHYs of a policy.
+ ******************************************************************************/
+uint8_t phy_scan_phys(phy_policy_t policy)
+{
+  // The client may have fallen back to 1M
+  if (policy == PHY_POLICY_CODED)
+    return PHY_1M | PHY_CODED;
+
+  return PHY_1M;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Checks the PHY of an advertisement.
+ ******************************************************************************/
+uint8_t phy_accepts(const phy_link_t *phy, uint8_t report_phy)
+{
+  return (phy_scan_phys(phy->policy) & report_phy) != 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes a connection opened.
+ ******************************************************************************/
+void phy_open(phy_link_t *phy, uint8_t open_phy)
+{
+  phy->link_phy = open_phy;
+  phy->opens[phy_index(open_phy)]++;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes the end of the setup.
+ ******************************************************************************/
+void phy_open_done(phy_link_t *phy, uint8_t ok)
+{
+  if (ok)
+    phy->opens_ok[phy_index(phy->link_phy)]++;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Preferred PHY of the link.
+ ******************************************************************************/
+uint8_t phy_link_phy(const phy_link_t *phy, uint8_t active)
+{
+  // A distant client stays on the PHY it could be reached on
+  if (phy->policy == PHY_POLICY_CODED)
+    return phy_index(phy->link_phy) == 2 ? PHY_CODED : PHY_1M;
+
+  if (phy->policy == PHY_POLICY_2M && active)
+    return PHY_2M;
+
+  return PHY_1M;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Airtime of a packet.
+ ******************************************************************************/
+uint32_t phy_packet_us(uint8_t phy, uint8_t len)
+{
+  // Preamble, access address, header, payload and CRC, 2 bytes of preamble
+  // on 2M
+  if (phy & PHY_2M)
+    return (2 + 4 + 2 + len + 3) * 4;
+
+  // 80 us preamble, access address, CI and TERM1 at S=8, then the header,
+  // payload, CRC and TERM2 at S=8 or S=2
+  if (phy & PHY_CODED)
+    return 80 + 296 + (16 + 8 * len + 24 + 3) * 8;
+
+  if (phy & PHY_CODED_500K)
+    return 80 + 296 + (16 + 8 * len + 24 + 3) * 2;
+
+  return (1 + 4 + 2 + len + 3) * 8;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Airtime of a transaction.
+ ******************************************************************************/
+uint32_t phy_transaction_us(uint8_t phy, uint8_t tx_len, uint8_t rx_len)
+{
+  uint32_t airtime_us = phy_packet_us(phy, tx_len) + phy_packet_us(phy, 0);
+
+  if (rx_len)
+    airtime_us += phy_packet_us(phy, rx_len) + phy_packet_us(phy, 0);
+
+  return airtime_us;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Counts a transaction.
+ ******************************************************************************/
+void phy_transaction(phy_link_t *phy, uint8_t tx_len, uint8_t rx_len)
+{
+  uint8_t index = phy_index(phy->link_phy);
+
+  phy->transactions[index]++;
+  phy->airtime_us[index] += phy_transaction_us(phy->link_phy, tx_len, rx_len);
+}
@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * @file    phy.h
+ * @brief   PHY policy of a client link. A client near the server is opened on
+ *          the 1M PHY and, with the 2M policy, moved to the 2M PHY while its
+ *          link runs the active profile of connparam.c, the bursts of the
+ *          bonding, discovery and OTA then take half the airtime. A distant
+ *          client advertises on the Coded PHY and is opened on it, falling
+ *          back to the 1M PHY on its side after failed connections, so the
+ *          server opens it on the PHY its advertisement came on. The opens,
+ *          the opens reaching a bonded link and the airtime of the state
+ *          transactions are kept per PHY.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_PHY_H_
+#define SRC_PHY_H_
+
+#include <stdint.h>
+
+
+// PHY bits, as in sl_bt_gap_phy_t and sl_bt_connection_set_preferred_phy()
+#define PHY_1M                  (0x01)
+#define PHY_2M                  (0x02)
+#define PHY_CODED               (0x04)    // 125k, S=8
+#define PHY_CODED_500K          (0x08)    // S=2, only reported by the stack
+
+#define PHY_COUNT               (3)       // Stats of 1M, 2M and Coded
+
+
+typedef enum {
+  PHY_POLICY_1M = 0,              // 1M only
+  PHY_POLICY_2M,                  // 1M, 2M while the link is active
+  PHY_POLICY_CODED                // Coded for a distant client, 1M fallback
+}phy_policy_t;
+
+typedef struct {
+  phy_policy_t policy;
+  uint8_t link_phy;               // PHY of the open link
+  uint32_t opens[PHY_COUNT];      // Stats
+  uint32_t opens_ok[PHY_COUNT];   // Reached a bonded link
+  uint32_t transactions[PHY_COUNT];
+  uint32_t airtime_us[PHY_COUNT];
+}phy_link_t;
+
+
+/******************************************************************************
+ * @brief Clears the stats and sets the policy of the client.
+ ******************************************************************************/
+void phy_init(phy_link_t *phy, phy_policy_t policy);
+
+
+/******************************************************************************
+ * @brief Index of a PHY in the stats.
+ ******************************************************************************/
+uint8_t phy_index(uint8_t phy);
+
+
+/******************************************************************************
+ * @brief PHYs the server scans on for a client of the policy.
+ ******************************************************************************/
+uint8_t phy_scan_phys(phy_policy_t policy);
+
+
+/******************************************************************************
+ * @brief Checks if the client may be opened on the PHY its advertisement came
+ * on.
+ ******************************************************************************/
+uint8_t phy_accepts(const phy_link_t *phy, uint8_t report_phy);
+
+
+/******************************************************************************
+ * @brief Takes a connection opened on the given PHY.
+ ******************************************************************************/
+void phy_open(phy_link_t *phy, uint8_t open_phy);
+
+
+/******************************************************************************
+ * @brief Takes the end of the setup of the link opened last.
+ *
+ * @param
+ *  phy   PHY state of the client
+ *  ok    1 if the link got bonded, 0 if it was lost before
+ *
+ ******************************************************************************/
+void phy_open_done(phy_link_t *phy, uint8_t ok);
+
+
+/******************************************************************************
+ * @brief PHY the link should run.
+ *
+ * @param
+ *  phy     PHY state of the client
+ *  active  1 while the link runs the active profile
+ *
+ * @return
+ *  Returns the preferred PHY bits for sl_bt_connection_set_preferred_phy().
+ *
+ ******************************************************************************/
+uint8_t phy_link_phy(const phy_link_t *phy, uint8_t active);
+
+
+/******************************************************************************
+ * @brief Airtime of a data channel packet, from the preamble to the CRC.
+ *
+ * @param
+ *  phy   PHY bit
+ *  len   Payload length, with the MIC of an encrypted link
+ *
+ ******************************************************************************/
+uint32_t phy_packet_us(uint8_t phy, uint8_t len);
+
+
+/******************************************************************************
+ * @brief Airtime of a transaction: a packet sent and its empty link layer
+ * acknowledgement, followed by the answer and its acknowledgement if rx_len is
+ * not 0.
+ ******************************************************************************/
+uint32_t phy_transaction_us(uint8_t phy, uint8_t tx_len, uint8_t rx_len);
+
+
+/******************************************************************************
+ * @brief Counts a transaction on the link in the stats.
+ ******************************************************************************/
+void phy_transaction(phy_link_t *phy, uint8_t tx_len, uint8_t rx_len);
+
+
+#endif /* SRC_PHY_H_ */
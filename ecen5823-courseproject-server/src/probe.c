@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * @file    probe.c
+ * @brief   Latency probe of a client link. See probe.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "probe.h"
+
+
+/******************************************************************************
+ * @brief Reads a little endian uint32.
+ ******************************************************************************/
+static uint32_t probe_get32(const uint8_t *data)
+{
+  return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+
+/******************************************************************************
+ * @brief Milliseconds of a latency for the report record, rounded and capped.
+ ******************************************************************************/
+static uint16_t probe_ms(uint32_t us)
+{
+  uint32_t ms = (us + 500) / 1000;
+
+  return ms > 0xFFFF ? 0xFFFF : (uint16_t)ms;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the probe.
+ ******************************************************************************/
+void probe_init(probe_t *p)
+{
+  memset(p, 0, sizeof(probe_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Builds the next ping.
+ ******************************************************************************/
+void probe_ping(probe_t *p, uint32_t now_us, uint8_t *ping)
+{
+  if (p->in_flight)
+    p->lost++;
+
+  p->seq++;
+  p->sent_us = now_us;
+  p->in_flight = 1;
+  p->pings++;
+
+  ping[0] = p->seq;
+  ping[1] = (uint8_t)now_us;
+  ping[2] = (uint8_t)(now_us >> 8);
+  ping[3] = (uint8_t)(now_us >> 16);
+  ping[4] = (uint8_t)(now_us >> 24);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes the echo of the ping in flight.
+ ******************************************************************************/
+uint8_t probe_echo(probe_t *p, const uint8_t *echo, uint8_t len, uint32_t now_us)
+{
+  uint32_t t1, t2, t3, rtt_us;
+  int32_t down_us, up_us;
+
+  if (len != PROBE_ECHO_LEN || !p->in_flight || echo[0] != p->seq) {
+      p->stale++;
+      return 0;
+  }
+
+  t1 = probe_get32(&echo[1]);
+  t2 = probe_get32(&echo[5]);
+  t3 = probe_get32(&echo[9]);
+
+  // The time of the ping is checked against the one kept, not trusted
+  if (t1 != p->sent_us || (t3 - t2) > (now_us - t1)) {
+      p->stale++;
+      return 0;
+  }
+
+  p->in_flight = 0;
+  p->echoes++;
+  p->times_us[0] = t1;
+  p->times_us[1] = t2;
+  p->times_us[2] = t3;
+  p->times_us[3] = now_us;
+
+  rtt_us = (now_us - t1) - (t3 - t2);
+
+  // Modulo 2^32, the two clocks count from unrelated boots
+  p->offset_age++;
+  if (!p->offset_valid || rtt_us <= p->offset_rtt_us || p->offset_age >= PROBE_OFFSET_AGE) {
+      p->offset_us = (t2 - t1) - rtt_us / 2;
+      p->offset_rtt_us = rtt_us;
+      p->offset_age = 0;
+      p->offset_valid = 1;
+  }
+
+  down_us = (int32_t)(t2 - t1 - p->offset_us);
+  up_us = (int32_t)(now_us - t3 + p->offset_us);
+
+  probe_dist_add(&p->rtt, rtt_us);
+  probe_dist_add(&p->down, down_us < 0 ? 0 : (uint32_t)down_us);
+  probe_dist_add(&p->up, up_us < 0 ? 0 : (uint32_t)up_us);
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Adds a latency.
+ ******************************************************************************/
+void probe_dist_add(probe_dist_t *d, uint32_t us)
+{
+  uint32_t ms = us / 1000;
+  uint8_t bucket = 0;
+
+  while (ms && bucket < PROBE_BUCKETS - 1) {
+      ms >>= 1;
+      bucket++;
+  }
+
+  d->counts[bucket]++;
+  d->samples++;
+  d->sum_us += us;
+  if (us > d->max_us)
+    d->max_us = us;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Mean of a distribution.
+ ******************************************************************************/
+uint32_t probe_dist_mean_us(const probe_dist_t *d)
+{
+  if (d->samples == 0)
+    return 0;
+
+  return (uint32_t)(d->sum_us / d->samples);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Percentile of a distribution.
+ ******************************************************************************/
+uint32_t probe_dist_percentile_us(const probe_dist_t *d, uint8_t pct)
+{
+  uint32_t rank = ((uint64_t)d->samples * pct + 99) / 100;
+  uint32_t seen = 0;
+
+  if (d->samples == 0)
+    return 0;
+
+  for (uint8_t i = 0; i < PROBE_BUCKETS - 1; i++) {
+      seen += d->counts[i];
+      if (seen >= rank) {
+          uint32_t bound_us = 1000UL << i;
+
+          return bound_us < d->max_us ? bound_us : d->max_us;
+      }
+  }
+
+  return d->max_us;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Packs the report record.
+ ******************************************************************************/
+void probe_pack(const probe_t *p, uint8_t *record)
+{
+  uint16_t values[PROBE_RECORD_LEN / 2];
+
+  values[0] = p->echoes > 0xFFFF ? 0xFFFF : (uint16_t)p->echoes;
+  values[1] = p->lost > 0xFFFF ? 0xFFFF : (uint16_t)p->lost;
+  values[2] = probe_ms(probe_dist_mean_us(&p->rtt));
+  values[3] = probe_ms(probe_dist_percentile_us(&p->rtt, 90));
+  values[4] = probe_ms(p->rtt.max_us);
+  values[5] = probe_ms(probe_dist_mean_us(&p->down));
+  values[6] = probe_ms(probe_dist_mean_us(&p->up));
+
+  for (uint8_t i = 0; i < PROBE_RECORD_LEN / 2; i++) {
+      record[2 * i] = (uint8_t)values[i];
+      record[2 * i + 1] = (uint8_t)(values[i] >> 8);
+  }
+}
@@ -0,0 +1,150 @@
+/*******************************************************************************
+ * @file    probe.h
+ * @brief   Latency probe of a client link. The server notifies a ping of a
+ *          sequence number and its send time t1 on the probe characteristic
+ *          of the client's service, the client writes back the ping with the
+ *          time it took the ping t2 and the time it sent the echo t3, and the
+ *          server takes the echo at t4. The times are microseconds of the
+ *          sleeptimer of each side, so the round trip is (t4 - t1) - (t3 - t2)
+ *          without the turnaround of the client. The offset of the client
+ *          clock is taken NTP style from the fastest round trip, the one with
+ *          the least queueing on either way, and is taken again every
+ *          PROBE_OFFSET_AGE echoes for the drift of the two clocks. The one
+ *          way latencies, down from the server and up from the client, are
+ *          the times to the other clock less or plus the offset. Every kind
+ *          of latency is kept as a log2 histogram with its mean and max.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_PROBE_H_
+#define SRC_PROBE_H_
+
+#include <stdint.h>
+
+
+#define PROBE_PING_LEN          (5)
+#define PROBE_ECHO_LEN          (13)
+#define PROBE_BUCKETS           (12)      // Below 1 ms up to 1024 ms and above
+#define PROBE_OFFSET_AGE        (16)      // Echoes an offset is kept for at most
+
+/* Ping, little endian:
+ *  [0]       Sequence number
+ *  [1..4]    t1, server send time in us
+ * Echo, little endian:
+ *  [0..4]    Ping
+ *  [5..8]    t2, client receive time in us
+ *  [9..12]   t3, client send time in us */
+
+/* Report record of a link, little endian, milliseconds:
+ *  [0..1]    Echoes
+ *  [2..3]    Pings lost
+ *  [4..5]    Round trip mean
+ *  [6..7]    Round trip 90th percentile, upper bound of its bucket
+ *  [8..9]    Round trip max
+ *  [10..11]  One way down mean
+ *  [12..13]  One way up mean */
+#define PROBE_RECORD_LEN        (14)
+
+
+typedef struct {
+  uint32_t counts[PROBE_BUCKETS]; // Bucket 0 below 1 ms, bucket i below 2^i ms
+  uint32_t samples;
+  uint64_t sum_us;
+  uint32_t max_us;
+}probe_dist_t;
+
+typedef struct {
+  uint8_t seq;                    // Of the ping in flight
+  uint8_t in_flight;
+  uint32_t sent_us;
+  uint8_t offset_valid;
+  uint32_t offset_us;             // Client clock less server clock, modulo 2^32
+  uint32_t offset_rtt_us;         // Round trip the offset is taken from
+  uint8_t offset_age;             // Echoes since
+  uint32_t times_us[4];           // t1 to t4 of the last echo taken
+  probe_dist_t rtt;
+  probe_dist_t down;
+  probe_dist_t up;
+  uint32_t pings;                 // Stats
+  uint32_t echoes;
+  uint32_t lost;                  // No echo before the next ping
+  uint32_t stale;                 // Echo of an older ping or malformed
+}probe_t;
+
+
+/******************************************************************************
+ * @brief Clears the probe of a link.
+ ******************************************************************************/
+void probe_init(probe_t *p);
+
+
+/******************************************************************************
+ * @brief Builds the next ping. A ping still waiting for its echo is counted
+ * as lost.
+ *
+ * @param
+ *  p         Probe
+ *  now_us    Server time
+ *  ping      PROBE_PING_LEN bytes out
+ *
+ ******************************************************************************/
+void probe_ping(probe_t *p, uint32_t now_us, uint8_t *ping);
+
+
+/******************************************************************************
+ * @brief Takes the echo of the ping in flight.
+ *
+ * @param
+ *  p         Probe
+ *  echo      Echo written by the client
+ *  len       Length of echo
+ *  now_us    Server time the echo is taken, t4
+ *
+ * @return
+ *  Returns 1 if the echo is taken, 0 if it is malformed or not of the ping in
+ *  flight.
+ *
+ ******************************************************************************/
+uint8_t probe_echo(probe_t *p, const uint8_t *echo, uint8_t len, uint32_t now_us);
+
+
+/******************************************************************************
+ * @brief Adds a latency to a distribution.
+ ******************************************************************************/
+void probe_dist_add(probe_dist_t *d, uint32_t us);
+
+
+/******************************************************************************
+ * @brief Mean of a distribution in microseconds, 0 without samples.
+ ******************************************************************************/
+uint32_t probe_dist_mean_us(const probe_dist_t *d);
+
+
+/******************************************************************************
+ * @brief Percentile of a distribution as the upper bound of the bucket it
+ * falls in, capped at the max.
+ *
+ * @param
+ *  d     Distribution
+ *  pct   Percentile, 1 to 100
+ *
+ * @return
+ *  Microseconds, 0 without samples.
+ *
+ ******************************************************************************/
+uint32_t probe_dist_percentile_us(const probe_dist_t *d, uint8_t pct);
+
+
+/******************************************************************************
+ * @brief Packs the report record of a link.
+ *
+ * @param
+ *  p         Probe
+ *  record    PROBE_RECORD_LEN bytes out
+ *
+ ******************************************************************************/
+void probe_pack(const probe_t *p, uint8_t *record);
+
+
+#endif /* SRC_PROBE_H_ */
@@ -0,0 +1,186 @@
+/*******************************************************************************
+ * @file    recovery.c
+ * @brief   Learned recovery for the schedule. See recovery.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "recovery.h"
+
+
+/******************************************************************************
+ * @brief Decays the sums of the fit and adds one segment to them.
+ ******************************************************************************/
+static void fit_add(recovery_fit_t *fit, int16_t x, int32_t y)
+{
+  fit->sw -= fit->sw >> RECOVERY_DECAY_SHIFT;
+  fit->sx -= fit->sx >> RECOVERY_DECAY_SHIFT;
+  fit->sy -= fit->sy >> RECOVERY_DECAY_SHIFT;
+  fit->sxx -= fit->sxx >> RECOVERY_DECAY_SHIFT;
+  fit->sxy -= fit->sxy >> RECOVERY_DECAY_SHIFT;
+
+  fit->sw += RECOVERY_WEIGHT;
+  fit->sx += (int64_t)RECOVERY_WEIGHT * x;
+  fit->sy += (int64_t)RECOVERY_WEIGHT * y;
+  fit->sxx += (int64_t)RECOVERY_WEIGHT * x * x;
+  fit->sxy += (int64_t)RECOVERY_WEIGHT * x * y;
+
+  if (fit->segments < UINT32_MAX)
+    fit->segments++;
+}
+
+
+/******************************************************************************
+ * @brief Rate of the fit at the given indoor temperature in mF/h. Falls back
+ * to the mean rate while the indoor temperatures seen are too close together
+ * for a slope.
+ ******************************************************************************/
+static int32_t fit_rate(const recovery_fit_t *fit, int16_t x)
+{
+  int64_t denom;
+  int64_t slope;
+  int64_t mean_y;
+
+  if (fit->segments < RECOVERY_MIN_SEGMENTS || fit->sw == 0)
+    return 0;
+
+  mean_y = fit->sy / fit->sw;
+  denom = fit->sw * fit->sxx - fit->sx * fit->sx;
+
+  // Less than about 1F of spread, the slope is noise
+  if (denom < fit->sw * fit->sw)
+    return (int32_t)mean_y;
+
+  slope = (fit->sw * fit->sxy - fit->sx * fit->sy) / denom;
+
+  return (int32_t)(mean_y + slope * (x - fit->sx / fit->sw));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the learned rates.
+ ******************************************************************************/
+void recovery_init(recovery_model_t *model)
+{
+  memset(model, 0, sizeof(recovery_model_t));
+  model->output = CONTROL_OUTPUT_OFF;
+}
+
+
+/******************************************************************************
+ * @brief Adds the rate of the segment measured so far to the fit of the
+ * actuator that ran, if the segment is at least min_s long.
+ ******************************************************************************/
+static void close_segment(recovery_model_t *model, int16_t temp, uint32_t now_s,
+                          uint32_t min_s)
+{
+  uint32_t elapsed_s = now_s - model->segment_start_s;
+  int32_t rate;
+
+  if (!model->segment_valid || elapsed_s < min_s || elapsed_s == 0)
+    return;
+
+  // Cooling rate is kept positive, as the drop per hour
+  rate = (int32_t)(((int64_t)(temp - model->segment_start_temp) * 1000 * 3600) / elapsed_s);
+
+  if (model->output == CONTROL_OUTPUT_HEAT)
+    fit_add(&model->heat, model->segment_start_temp, rate);
+  else if (model->output == CONTROL_OUTPUT_COOL)
+    fit_add(&model->cool, model->segment_start_temp, -rate);
+
+  model->segment_start_s = now_s;
+  model->segment_start_temp = temp;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Feeds one sample.
+ ******************************************************************************/
+void recovery_update(recovery_model_t *model, control_output_t output,
+                     int16_t temp, uint32_t now_s)
+{
+  if (output != model->output) {
+      /* The run that just ended is kept too, dropping it would leave out the
+       * runs that reach the target fast and bias the rate low */
+      close_segment(model, temp, now_s, RECOVERY_MIN_SEGMENT_S);
+
+      model->output = output;
+      model->segment_start_s = now_s;
+      model->segment_valid = 0;
+      return;
+  }
+
+  if (output == CONTROL_OUTPUT_OFF)
+    return;
+
+  if (!model->segment_valid) {
+      if (now_s - model->segment_start_s < RECOVERY_SETTLE_S)
+        return;
+
+      model->segment_start_s = now_s;
+      model->segment_start_temp = temp;
+      model->segment_valid = 1;
+      return;
+  }
+
+  close_segment(model, temp, now_s, RECOVERY_SEGMENT_S);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Time needed to take the room from the current temperature to the target.
+ ******************************************************************************/
+uint32_t recovery_lead_time(const recovery_model_t *model, int16_t current,
+                            int16_t target)
+{
+  int16_t mid = current + (target - current) / 2;
+  int32_t delta_mf;
+  int32_t rate;
+  uint32_t lead_s;
+
+  if (target > current) {
+      delta_mf = (target - current) * 1000;
+      rate = fit_rate(&model->heat, mid);
+  }
+  else if (target < current) {
+      delta_mf = (current - target) * 1000;
+      rate = fit_rate(&model->cool, mid);
+  }
+  else {
+      return 0;
+  }
+
+  if (rate < RECOVERY_MIN_RATE_MF_PER_H)
+    return 0;
+
+  lead_s = (uint32_t)(((int64_t)delta_mf * 3600) / rate);
+
+  if (lead_s > RECOVERY_MAX_LEAD_S)
+    lead_s = RECOVERY_MAX_LEAD_S;
+
+  return lead_s;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Checks if the next setpoint has to be taken early.
+ ******************************************************************************/
+uint8_t recovery_precondition(const recovery_model_t *model, int16_t current,
+                              int16_t next_target, uint32_t next_s,
+                              uint32_t now_s)
+{
+  uint32_t lead_s;
+
+  if (now_s >= next_s || next_s - now_s > RECOVERY_MAX_LEAD_S)
+    return 0;
+
+  lead_s = recovery_lead_time(model, current, next_target);
+
+  return lead_s && next_s - now_s <= lead_s;
+}
@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * @file    recovery.h
+ * @brief   Learned recovery for the schedule. The heating and cooling rates of
+ *          the room are learned while the actuators run, as a line fit of the
+ *          rate against the indoor temperature done by incremental least
+ *          squares. Only five running sums are kept per fit and they decay so
+ *          that the fit follows the season, every update is O(1). The fit
+ *          gives the lead time needed to reach the next setpoint, so the
+ *          target can be moved to it early enough to arrive on time.
+ *
+ *          There is no outdoor sensor, the indoor/outdoor difference is taken
+ *          against a slowly changing outdoor temperature that ends up in the
+ *          intercept of the fit.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_RECOVERY_H_
+#define SRC_RECOVERY_H_
+
+#include <stdint.h>
+
+#include "control.h"
+
+
+#define RECOVERY_DECAY_SHIFT          (6)     // Fit follows about 64 segments
+#define RECOVERY_WEIGHT               (256)   // Weight of a new segment
+#define RECOVERY_MIN_SEGMENTS         (4)     // Segments before the fit is used
+#define RECOVERY_SETTLE_S             (120)   // Dead time after turning on
+#define RECOVERY_SEGMENT_S            (600)   // Length of a rate measurement
+#define RECOVERY_MIN_SEGMENT_S        (300)   // Shortest run end that is kept
+#define RECOVERY_MIN_RATE_MF_PER_H    (500)   // Slower rates give no lead
+#define RECOVERY_MAX_LEAD_S           (3 * 60 * 60)
+
+
+typedef struct {
+  int64_t sw;                     // Sum of weights
+  int64_t sx;                     // Weighted sums of the indoor temperature,
+  int64_t sy;                     // the rate in mF/h and their products
+  int64_t sxx;
+  int64_t sxy;
+  uint32_t segments;
+}recovery_fit_t;
+
+typedef struct {
+  recovery_fit_t heat;
+  recovery_fit_t cool;
+  control_output_t output;        // Output of the segment being measured
+  uint32_t segment_start_s;
+  int16_t segment_start_temp;
+  uint8_t segment_valid;
+}recovery_model_t;
+
+
+/******************************************************************************
+ * @brief Clears the learned rates.
+ *
+ * @param
+ *  model   Model to be initialized
+ *
+ ******************************************************************************/
+void recovery_init(recovery_model_t *model);
+
+
+/******************************************************************************
+ * @brief Feeds one sample. While the heater or the AC runs, the temperature
+ * change over every RECOVERY_SEGMENT_S is added to the fit of that actuator,
+ * and so is the last part of the run when it is at least
+ * RECOVERY_MIN_SEGMENT_S long. The first RECOVERY_SETTLE_S after turning on
+ * are skipped.
+ *
+ * @param
+ *  model   Model
+ *  output  Output the actuators are in
+ *  temp    Indoor temperature in F
+ *  now_s   Current time in seconds
+ *
+ ******************************************************************************/
+void recovery_update(recovery_model_t *model, control_output_t output,
+                     int16_t temp, uint32_t now_s);
+
+
+/******************************************************************************
+ * @brief Time the heater or the AC needs to take the room from the current
+ * temperature to the target, from the learned rate at the mid point.
+ *
+ * @param
+ *  model     Model
+ *  current   Indoor temperature in F
+ *  target    Temperature to reach in F
+ *
+ * @return
+ *  Lead time in seconds, capped at RECOVERY_MAX_LEAD_S. Returns 0 if the
+ *  target is already reached or the rate is not learned yet.
+ *
+ ******************************************************************************/
+uint32_t recovery_lead_time(const recovery_model_t *model, int16_t current,
+                            int16_t target);
+
+
+/******************************************************************************
+ * @brief Checks if the next setpoint of the schedule has to be taken early to
+ * be reached by the time of its transition.
+ *
+ * @param
+ *  model         Model
+ *  current       Indoor temperature in F
+ *  next_target   Target of the next transition in F
+ *  next_s        Time of the next transition
+ *  now_s         Current time, on the same clock as next_s
+ *
+ * @return
+ *  Returns 1 if the next target has to be applied now, else 0.
+ *
+ ******************************************************************************/
+uint8_t recovery_precondition(const recovery_model_t *model, int16_t current,
+                              int16_t next_target, uint32_t next_s,
+                              uint32_t now_s);
+
+
+#endif /* SRC_RECOVERY_H_ */
@@ -0,0 +1,302 @@
+/*******************************************************************************
+ * @file    registry.c
+ * @brief   Client registry. See registry.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "registry.h"
+
+
+/******************************************************************************
+ * @brief Multiplicative hash of an address, the low bits pick the slot and the
+ * top byte is the tag.
+ ******************************************************************************/
+static uint32_t addr_hash(const uint8_t *addr)
+{
+  uint32_t low = addr[0] | (addr[1] << 8) | (addr[2] << 16) | ((uint32_t)addr[3] << 24);
+  uint32_t high = addr[4] | (addr[5] << 8);
+
+  return (low ^ (high * 0x9E3779B1U)) * 0x85EBCA6BU;
+}
+
+
+/******************************************************************************
+ * @brief Slot of the hash table for the hash, from its high bits.
+ ******************************************************************************/
+static uint8_t hash_slot(uint32_t hash)
+{
+  return (uint8_t)((hash >> 16) & (REGISTRY_HASH_SIZE - 1));
+}
+
+
+/******************************************************************************
+ * @brief Index of the state mask of a single bit state, REGISTRY_STATES if
+ * the state is not a single valid bit.
+ ******************************************************************************/
+static uint8_t state_index(uint32_t state)
+{
+  if (state == 0 || (state & (state - 1)) || state >= (1U << REGISTRY_STATES))
+    return REGISTRY_STATES;
+
+  return (uint8_t)__builtin_ctz(state);
+}
+
+
+/******************************************************************************
+ * @brief Deletes the slot of a client from the hash table by shifting the
+ * following entries of its probe sequence back, so lookups never need
+ * tombstones.
+ ******************************************************************************/
+static void hash_delete(registry_t *reg, uint8_t index)
+{
+  uint8_t slot;
+  uint8_t next;
+
+  slot = hash_slot(addr_hash(reg->addr[index]));
+  while (reg->by_addr[slot] != index + 1)
+    slot = (slot + 1) & (REGISTRY_HASH_SIZE - 1);
+
+  // Backward shift, an entry moves into the hole unless its home slot lies
+  // between the hole and the entry
+  next = slot;
+  while (1) {
+      uint8_t home;
+
+      next = (next + 1) & (REGISTRY_HASH_SIZE - 1);
+      if (reg->by_addr[next] == 0)
+        break;
+
+      home = hash_slot(addr_hash(reg->addr[reg->by_addr[next] - 1]));
+      if (((next - home) & (REGISTRY_HASH_SIZE - 1)) >= ((next - slot) & (REGISTRY_HASH_SIZE - 1))) {
+          reg->by_addr[slot] = reg->by_addr[next];
+          reg->tag[slot] = reg->tag[next];
+          slot = next;
+      }
+  }
+  reg->by_addr[slot] = 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the registry.
+ ******************************************************************************/
+void registry_init(registry_t *reg)
+{
+  memset(reg, 0, sizeof(registry_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Adds a client.
+ ******************************************************************************/
+uint8_t registry_add(registry_t *reg, const uint8_t *addr, uint8_t kind,
+                     uint32_t state)
+{
+  uint32_t hash = addr_hash(addr);
+  uint8_t slot = hash_slot(hash);
+  uint8_t bit = state_index(state);
+  uint8_t index = reg->count;
+
+  if (index == REGISTRY_MAX_CLIENTS || kind >= REGISTRY_KINDS ||
+      bit == REGISTRY_STATES || registry_find_addr(reg, addr) != REGISTRY_NONE)
+    return REGISTRY_NONE;
+
+  while (reg->by_addr[slot])
+    slot = (slot + 1) & (REGISTRY_HASH_SIZE - 1);
+
+  memcpy(reg->addr[index], addr, REGISTRY_ADDR_LEN);
+  reg->by_addr[slot] = index + 1;
+  reg->tag[slot] = (uint8_t)(hash >> 24);
+  reg->conn[index] = 0;
+  reg->state[index] = bit;
+  reg->in_state[bit] |= (uint64_t)1 << index;
+  reg->of_kind[kind] |= (uint64_t)1 << index;
+  reg->count++;
+
+  return index;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Removes the client added last.
+ ******************************************************************************/
+void registry_remove_last(registry_t *reg)
+{
+  uint8_t index;
+
+  if (reg->count == 0)
+    return;
+
+  index = reg->count - 1;
+  hash_delete(reg, index);
+
+  if (reg->conn[index])
+    reg->by_conn[reg->conn[index]] = 0;
+
+  for (uint8_t i = 0; i < REGISTRY_STATES; i++)
+    reg->in_state[i] &= ~((uint64_t)1 << index);
+  for (uint8_t i = 0; i < REGISTRY_KINDS; i++)
+    reg->of_kind[i] &= ~((uint64_t)1 << index);
+
+  reg->count--;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Looks a client up by address.
+ ******************************************************************************/
+uint8_t registry_find_addr(registry_t *reg, const uint8_t *addr)
+{
+  uint32_t hash = addr_hash(addr);
+  uint8_t slot = hash_slot(hash);
+  uint8_t tag = (uint8_t)(hash >> 24);
+
+  // Never full, at least half of the slots are empty
+  while (reg->by_addr[slot]) {
+      uint8_t index = reg->by_addr[slot] - 1;
+
+      reg->probes++;
+
+      if (reg->tag[slot] == tag) {
+          reg->compares++;
+          if (!memcmp(reg->addr[index], addr, REGISTRY_ADDR_LEN))
+            return index;
+      }
+
+      slot = (slot + 1) & (REGISTRY_HASH_SIZE - 1);
+  }
+
+  reg->probes++;
+
+  return REGISTRY_NONE;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Changes the address of a client.
+ ******************************************************************************/
+uint8_t registry_set_addr(registry_t *reg, uint8_t index, const uint8_t *addr)
+{
+  uint32_t hash;
+  uint8_t slot;
+
+  if (index >= reg->count || registry_find_addr(reg, addr) != REGISTRY_NONE)
+    return 1;
+
+  hash_delete(reg, index);
+
+  hash = addr_hash(addr);
+  slot = hash_slot(hash);
+  while (reg->by_addr[slot])
+    slot = (slot + 1) & (REGISTRY_HASH_SIZE - 1);
+
+  memcpy(reg->addr[index], addr, REGISTRY_ADDR_LEN);
+  reg->by_addr[slot] = index + 1;
+  reg->tag[slot] = (uint8_t)(hash >> 24);
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Looks a client up by connection handle.
+ ******************************************************************************/
+uint8_t registry_find_conn(const registry_t *reg, uint8_t conn)
+{
+  if (conn == 0 || reg->by_conn[conn] == 0)
+    return REGISTRY_NONE;
+
+  return reg->by_conn[conn] - 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sets the connection handle of a client.
+ ******************************************************************************/
+void registry_set_conn(registry_t *reg, uint8_t index, uint8_t conn)
+{
+  if (index >= reg->count)
+    return;
+
+  if (reg->conn[index] && reg->by_conn[reg->conn[index]] == index + 1)
+    reg->by_conn[reg->conn[index]] = 0;
+
+  reg->conn[index] = conn;
+
+  if (conn)
+    reg->by_conn[conn] = index + 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sets the state of a client.
+ ******************************************************************************/
+void registry_set_state(registry_t *reg, uint8_t index, uint32_t state)
+{
+  uint8_t bit = state_index(state);
+
+  if (index >= reg->count || bit == REGISTRY_STATES)
+    return;
+
+  reg->in_state[reg->state[index]] &= ~((uint64_t)1 << index);
+  reg->in_state[bit] |= (uint64_t)1 << index;
+  reg->state[index] = bit;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clients in any of the given states.
+ ******************************************************************************/
+uint64_t registry_in_states(const registry_t *reg, uint32_t states)
+{
+  uint64_t clients = 0;
+
+  states &= (1U << REGISTRY_STATES) - 1;
+
+  while (states) {
+      clients |= reg->in_state[__builtin_ctz(states)];
+      states &= states - 1;
+  }
+
+  return clients;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * First client in any of the given states.
+ ******************************************************************************/
+uint8_t registry_first_in_states(const registry_t *reg, uint32_t states)
+{
+  uint64_t clients = registry_in_states(reg, states);
+
+  if (clients == 0)
+    return REGISTRY_NONE;
+
+  return (uint8_t)__builtin_ctzll(clients);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * First client of the given kind.
+ ******************************************************************************/
+uint8_t registry_first_of_kind(const registry_t *reg, uint8_t kind)
+{
+  if (kind >= REGISTRY_KINDS || reg->of_kind[kind] == 0)
+    return REGISTRY_NONE;
+
+  return (uint8_t)__builtin_ctzll(reg->of_kind[kind]);
+}
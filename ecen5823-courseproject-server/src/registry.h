@@ -0,0 +1,168 @@
+/*******************************************************************************
+ * @file    registry.h
+ * @brief   Client registry. Indexes the clients, kept by the caller in an
+ *          array, for O(1) lookups: by connection handle through a table
+ *          indexed by the handle, by address through an open addressing hash
+ *          table with linear probing and by connection state or kind through
+ *          a bitmask of clients per state and per kind, so that "any client
+ *          in these states" is an OR and a count trailing zeros. A slot keeps
+ *          a tag of the hash so that the addresses are only compared on a
+ *          likely match, a scan report of an unknown device mostly costs one
+ *          probe and no compare. All the memory is sized at compile time.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_REGISTRY_H_
+#define SRC_REGISTRY_H_
+
+#include <stdint.h>
+
+
+#define REGISTRY_MAX_CLIENTS    (64)    // At most 64, one bit per client
+#define REGISTRY_HASH_SIZE      (128)   // Power of 2, twice the clients
+#define REGISTRY_STATES         (16)    // States are one bit of a uint16_t
+#define REGISTRY_KINDS          (8)
+#define REGISTRY_ADDR_LEN       (6)
+#define REGISTRY_NONE           (0xFF)
+
+#if REGISTRY_MAX_CLIENTS > 64 || REGISTRY_HASH_SIZE < 2 * REGISTRY_MAX_CLIENTS
+#error "Registry tables are too small for REGISTRY_MAX_CLIENTS"
+#endif
+
+
+typedef struct {
+  uint8_t addr[REGISTRY_MAX_CLIENTS][REGISTRY_ADDR_LEN];
+  uint8_t conn[REGISTRY_MAX_CLIENTS];     // Connection handle, 0 = none
+  uint8_t state[REGISTRY_MAX_CLIENTS];    // Bit number of the state
+  uint8_t by_conn[256];                   // Index + 1 per handle, 0 = none
+  uint8_t by_addr[REGISTRY_HASH_SIZE];    // Index + 1 per slot, 0 = empty
+  uint8_t tag[REGISTRY_HASH_SIZE];        // Top byte of the hash per slot
+  uint64_t in_state[REGISTRY_STATES];     // Bit per client in the state
+  uint64_t of_kind[REGISTRY_KINDS];       // Bit per client of the kind
+  uint8_t count;
+  uint32_t probes;                        // Work, for benchmarks
+  uint32_t compares;
+}registry_t;
+
+
+/******************************************************************************
+ * @brief Clears the registry.
+ *
+ * @param
+ *  reg   Registry to be initialized
+ *
+ ******************************************************************************/
+void registry_init(registry_t *reg);
+
+
+/******************************************************************************
+ * @brief Adds a client, the clients get their indices in the order added.
+ *
+ * @param
+ *  reg     Registry
+ *  addr    Address of the client, REGISTRY_ADDR_LEN bytes
+ *  kind    Kind of the client, below REGISTRY_KINDS
+ *  state   State of the client, a single bit below 1 << REGISTRY_STATES
+ *
+ * @return
+ *  Index of the client, REGISTRY_NONE if the registry is full, the address
+ *  is already in or the kind is invalid.
+ *
+ ******************************************************************************/
+uint8_t registry_add(registry_t *reg, const uint8_t *addr, uint8_t kind,
+                     uint32_t state);
+
+
+/******************************************************************************
+ * @brief Removes the client added last, to undo a registry_add() when the
+ * rest of the setup of the client fails.
+ ******************************************************************************/
+void registry_remove_last(registry_t *reg);
+
+
+/******************************************************************************
+ * @brief Looks a client up by address.
+ *
+ * @return
+ *  Index of the client, REGISTRY_NONE if not found.
+ *
+ ******************************************************************************/
+uint8_t registry_find_addr(registry_t *reg, const uint8_t *addr);
+
+
+/******************************************************************************
+ * @brief Changes the address of a client, for a replaced device. The old slot
+ * is deleted from the hash table by shifting the following entries of its
+ * probe sequence back, so lookups never need tombstones.
+ *
+ * @param
+ *  reg     Registry
+ *  index   Client to be changed
+ *  addr    New address, REGISTRY_ADDR_LEN bytes
+ *
+ * @return
+ *  Returns 0 on success, 1 if the index is invalid or the address is already
+ *  in.
+ *
+ ******************************************************************************/
+uint8_t registry_set_addr(registry_t *reg, uint8_t index, const uint8_t *addr);
+
+
+/******************************************************************************
+ * @brief Looks a client up by connection handle.
+ *
+ * @return
+ *  Index of the client, REGISTRY_NONE if no client has the handle.
+ *
+ ******************************************************************************/
+uint8_t registry_find_conn(const registry_t *reg, uint8_t conn);
+
+
+/******************************************************************************
+ * @brief Sets the connection handle of a client, 0 when it has none.
+ ******************************************************************************/
+void registry_set_conn(registry_t *reg, uint8_t index, uint8_t conn);
+
+
+/******************************************************************************
+ * @brief Sets the state of a client, a single bit below 1 << REGISTRY_STATES.
+ ******************************************************************************/
+void registry_set_state(registry_t *reg, uint8_t index, uint32_t state);
+
+
+/******************************************************************************
+ * @brief Clients in any of the given states.
+ *
+ * @param
+ *  reg     Registry
+ *  states  OR of the states
+ *
+ * @return
+ *  Bit per client index.
+ *
+ ******************************************************************************/
+uint64_t registry_in_states(const registry_t *reg, uint32_t states);
+
+
+/******************************************************************************
+ * @brief First client in any of the given states.
+ *
+ * @return
+ *  Index of the client, REGISTRY_NONE if there is none.
+ *
+ ******************************************************************************/
+uint8_t registry_first_in_states(const registry_t *reg, uint32_t states);
+
+
+/******************************************************************************
+ * @brief First client of the given kind.
+ *
+ * @return
+ *  Index of the client, REGISTRY_NONE if there is none.
+ *
+ ******************************************************************************/
+uint8_t registry_first_of_kind(const registry_t *reg, uint8_t kind);
+
+
+#endif /* SRC_REGISTRY_H_ */
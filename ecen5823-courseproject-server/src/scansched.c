@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * @file    scansched.c
+ * @brief   Duty cycle scheduler of the scanner. See scansched.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "scansched.h"
+#include "timers.h"
+
+
+/******************************************************************************
+ * @brief Length of a phase, 0 for the background one.
+ ******************************************************************************/
+static uint32_t scansched_phase_ms(uint8_t phase)
+{
+  if (phase >= SCANSCHED_PHASES - 1)
+    return 0;
+
+  return (uint32_t)SCANSCHED_FAST_MS << phase;
+}
+
+
+/******************************************************************************
+ * @brief Radio on time of the current phase until now.
+ ******************************************************************************/
+static uint32_t scansched_phase_on_ms(const scansched_t *sched, uint32_t now_ms)
+{
+  if (!sched->running)
+    return 0;
+
+  return (uint32_t)(((uint64_t)(now_ms - sched->phase_ms) * scansched_window(sched)) /
+                    scansched_interval(sched));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Starts the scheduler.
+ ******************************************************************************/
+void scansched_init(scansched_t *sched)
+{
+  memset(sched, 0, sizeof(scansched_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Back to the aggressive phase.
+ ******************************************************************************/
+void scansched_restart(scansched_t *sched, uint32_t now_ms)
+{
+  sched->on_ms_sum += scansched_phase_on_ms(sched, now_ms);
+  sched->running = 1;
+  sched->phase = 0;
+  sched->phase_ms = now_ms;
+  sched->restarts++;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Stops the scanner.
+ ******************************************************************************/
+void scansched_stop(scansched_t *sched, uint32_t now_ms)
+{
+  sched->on_ms_sum += scansched_phase_on_ms(sched, now_ms);
+  sched->running = 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Moves on to the next phase.
+ ******************************************************************************/
+uint8_t scansched_update(scansched_t *sched, uint32_t now_ms)
+{
+  uint8_t changed = 0;
+
+  // A late timer may have missed more than one phase
+  while (sched->running && sched->phase < SCANSCHED_PHASES - 1 &&
+         now_ms - sched->phase_ms >= scansched_phase_ms(sched->phase)) {
+      uint32_t end_ms = sched->phase_ms + scansched_phase_ms(sched->phase);
+
+      sched->on_ms_sum += scansched_phase_on_ms(sched, end_ms);
+      sched->phase++;
+      sched->phase_ms = end_ms;
+      changed = 1;
+  }
+
+  return changed;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Interval of the phase.
+ ******************************************************************************/
+uint16_t scansched_interval(const scansched_t *sched)
+{
+  uint32_t interval;
+
+  if (sched->phase == 0)
+    return SCANSCHED_FAST_INTERVAL;
+
+  interval = (uint32_t)SCANSCHED_FIRST_INTERVAL << (sched->phase - 1);
+  if (interval > SCANSCHED_MAX_INTERVAL)
+    interval = SCANSCHED_MAX_INTERVAL;
+
+  return interval;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Window of the phase.
+ ******************************************************************************/
+uint16_t scansched_window(const scansched_t *sched)
+{
+  return sched->phase == 0 ? SCANSCHED_FAST_WINDOW : SCANSCHED_WINDOW;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Time until the phase is over.
+ ******************************************************************************/
+uint32_t scansched_wait_ms(const scansched_t *sched, uint32_t now_ms)
+{
+  uint32_t phase_ms = scansched_phase_ms(sched->phase);
+
+  if (!sched->running || phase_ms == 0)
+    return 0;
+
+  return ms_until(sched->phase_ms + phase_ms, now_ms);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Radio on time until now.
+ ******************************************************************************/
+uint32_t scansched_on_ms(const scansched_t *sched, uint32_t now_ms)
+{
+  return sched->on_ms_sum + scansched_phase_on_ms(sched, now_ms);
+}
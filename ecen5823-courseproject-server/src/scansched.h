@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * @file    scansched.h
+ * @brief   Duty cycle scheduler of the scanner. After the boot, a link loss or
+ *          PB0 the scanner runs the aggressive phase, short windows on a short
+ *          interval that hop through the advertising channels quickly. It then
+ *          backs off geometrically, every phase lasts twice as long as the one
+ *          before with twice the scan interval. The backoff windows are as
+ *          long as the advertising interval of a client plus its advDelay, a
+ *          client that advertises is found in the first window. The last phase
+ *          is a background duty cycle that lasts until the scanner restarts,
+ *          the scanner never stops while a client is left to be found. The
+ *          radio on time of the scanner is kept as an estimate, the time the
+ *          scanner is stopped with every client found does not count.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_SCANSCHED_H_
+#define SRC_SCANSCHED_H_
+
+#include <stdint.h>
+
+
+// Intervals and windows in 0.625 ms units
+#define SCANSCHED_FAST_INTERVAL     (80)      // 50 ms
+#define SCANSCHED_FAST_WINDOW       (40)      // 25 ms
+#define SCANSCHED_FAST_MS           (15000)   // Aggressive phase
+#define SCANSCHED_WINDOW            (420)     // 262.5 ms, client advertises every 250 ms
+#define SCANSCHED_FIRST_INTERVAL    (1680)    // 1.05 s, doubled on every phase
+#define SCANSCHED_MAX_INTERVAL      (16384)   // 10.24 s, the stack limit
+#define SCANSCHED_PHASES            (6)       // The last one is the background
+
+
+typedef struct {
+  uint8_t running;                // Scanner on
+  uint8_t phase;
+  uint32_t phase_ms;              // Start of the phase
+  uint32_t on_ms_sum;             // Radio on time, up to phase_ms
+  uint32_t restarts;              // Stats
+}scansched_t;
+
+
+/******************************************************************************
+ * @brief Clears the scheduler, the scanner is stopped.
+ ******************************************************************************/
+void scansched_init(scansched_t *sched);
+
+
+/******************************************************************************
+ * @brief Starts the scanner in the aggressive phase, after the boot, a link
+ * loss or PB0.
+ ******************************************************************************/
+void scansched_restart(scansched_t *sched, uint32_t now_ms);
+
+
+/******************************************************************************
+ * @brief Stops the scanner once every client is found.
+ ******************************************************************************/
+void scansched_stop(scansched_t *sched, uint32_t now_ms);
+
+
+/******************************************************************************
+ * @brief Moves on to the next phase once the current one is over.
+ *
+ * @return
+ *  Returns 1 if the phase changed and the scanner timing has to be applied,
+ *  else 0.
+ *
+ ******************************************************************************/
+uint8_t scansched_update(scansched_t *sched, uint32_t now_ms);
+
+
+/******************************************************************************
+ * @brief Scan interval and window of the current phase, in 0.625 ms units.
+ ******************************************************************************/
+uint16_t scansched_interval(const scansched_t *sched);
+uint16_t scansched_window(const scansched_t *sched);
+
+
+/******************************************************************************
+ * @brief Time until the current phase is over.
+ *
+ * @return
+ *  Milliseconds to wait, 0 in the background phase or with the scanner
+ *  stopped.
+ *
+ ******************************************************************************/
+uint32_t scansched_wait_ms(const scansched_t *sched, uint32_t now_ms);
+
+
+/******************************************************************************
+ * @brief Estimated radio on time of the scanner until now, the windows of the
+ * phases against their intervals.
+ ******************************************************************************/
+uint32_t scansched_on_ms(const scansched_t *sched, uint32_t now_ms);
+
+
+#endif /* SRC_SCANSCHED_H_ */
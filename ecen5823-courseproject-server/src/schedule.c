@@ -0,0 +1,210 @@
+/*******************************************************************************
+ * @file    schedule.c
+ * @brief   Weekly schedule of target temperatures. See schedule.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "schedule.h"
+
+
+/******************************************************************************
+ * @brief Seconds since Sunday 00:00 of the given time, Jan 1 1970 was a
+ * Thursday.
+ ******************************************************************************/
+static uint32_t week_position(uint32_t now_s)
+{
+  return (uint32_t)(((uint64_t)now_s + 4 * SCHEDULE_DAY_S) % SCHEDULE_WEEK_S);
+}
+
+
+/******************************************************************************
+ * @brief Seconds since Sunday 00:00 of the transition at the given position in
+ * the time order.
+ ******************************************************************************/
+static uint32_t transition_week_s(const schedule_t *sched, uint8_t pos)
+{
+  uint8_t day = sched->order[pos] / SCHEDULE_MAX_PER_DAY;
+  uint8_t index = sched->order[pos] % SCHEDULE_MAX_PER_DAY;
+
+  return day * SCHEDULE_DAY_S + sched->table[day][index].slot * SCHEDULE_SLOT_S;
+}
+
+
+/******************************************************************************
+ * @brief Target temperature of the transition at the given position in the
+ * time order.
+ ******************************************************************************/
+static int16_t transition_target(const schedule_t *sched, uint8_t pos)
+{
+  uint8_t day = sched->order[pos] / SCHEDULE_MAX_PER_DAY;
+  uint8_t index = sched->order[pos] % SCHEDULE_MAX_PER_DAY;
+
+  return sched->table[day][index].target;
+}
+
+
+/******************************************************************************
+ * @brief Sorts the entries of one day by time and drops the unused and invalid
+ * ones. If two entries have the same slot the later one in the table wins.
+ ******************************************************************************/
+static uint8_t normalize_day(schedule_entry_t *day)
+{
+  schedule_entry_t sorted[SCHEDULE_MAX_PER_DAY];
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < SCHEDULE_MAX_PER_DAY; i++) {
+      uint8_t j = count;
+
+      if (day[i].target == 0 || day[i].target > SCHEDULE_MAX_TARGET ||
+          day[i].slot >= SCHEDULE_SLOTS_PER_DAY)
+        continue;
+
+      while (j > 0 && sorted[j - 1].slot > day[i].slot) {
+          sorted[j] = sorted[j - 1];
+          j--;
+      }
+
+      if (j > 0 && sorted[j - 1].slot == day[i].slot) {
+          sorted[j - 1] = day[i];
+          // Close the gap opened for the insert
+          memmove(&sorted[j], &sorted[j + 1], (count - j) * sizeof(schedule_entry_t));
+          continue;
+      }
+
+      sorted[j] = day[i];
+      count++;
+  }
+
+  memset(day, 0, SCHEDULE_MAX_PER_DAY * sizeof(schedule_entry_t));
+  memcpy(day, sorted, count * sizeof(schedule_entry_t));
+
+  return count;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the schedule.
+ ******************************************************************************/
+void schedule_init(schedule_t *sched)
+{
+  memset(sched, 0, sizeof(schedule_t));
+  sched->next_s = SCHEDULE_NEXT_NONE;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Loads a packed schedule.
+ ******************************************************************************/
+uint8_t schedule_load(schedule_t *sched, const uint8_t *data, uint32_t len,
+                      uint32_t now_s, int16_t *target)
+{
+  if (len != SCHEDULE_PACKED_LEN)
+    return 1;
+
+  memcpy(sched->table, data, SCHEDULE_PACKED_LEN);
+  sched->count = 0;
+
+  for (uint8_t day = 0; day < SCHEDULE_DAYS; day++) {
+      uint8_t day_count = normalize_day(sched->table[day]);
+
+      for (uint8_t i = 0; i < day_count; i++)
+        sched->order[sched->count++] = day * SCHEDULE_MAX_PER_DAY + i;
+  }
+
+  schedule_sync(sched, now_s, target);
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Copies the normalized schedule in packed form.
+ ******************************************************************************/
+void schedule_pack(const schedule_t *sched, uint8_t *data)
+{
+  memcpy(data, sched->table, SCHEDULE_PACKED_LEN);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Finds the transition in effect and the next one.
+ ******************************************************************************/
+void schedule_sync(schedule_t *sched, uint32_t now_s, int16_t *target)
+{
+  uint32_t position = week_position(now_s);
+  uint8_t next = 0;
+
+  if (sched->count == 0) {
+      sched->next_s = SCHEDULE_NEXT_NONE;
+      return;
+  }
+
+  while (next < sched->count && transition_week_s(sched, next) <= position)
+    next++;
+
+  if (next == sched->count) {
+      sched->next = 0;
+      sched->next_s = now_s + (SCHEDULE_WEEK_S - position) + transition_week_s(sched, 0);
+  }
+  else {
+      sched->next = next;
+      sched->next_s = now_s + (transition_week_s(sched, next) - position);
+  }
+
+  // The one before the next transition is in effect, wrapping to last week
+  *target = transition_target(sched, (sched->next + sched->count - 1) % sched->count);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Checks if a transition is due.
+ ******************************************************************************/
+uint8_t schedule_poll(schedule_t *sched, uint32_t now_s, int16_t *target)
+{
+  if (now_s < sched->next_s)
+    return 0;
+
+  // Clock moved on by more than a week, look the transitions up again
+  if (now_s - sched->next_s >= SCHEDULE_WEEK_S) {
+      schedule_sync(sched, now_s, target);
+      return 1;
+  }
+
+  while (now_s >= sched->next_s) {
+      uint32_t passed_week_s = transition_week_s(sched, sched->next);
+      uint32_t next_week_s;
+
+      *target = transition_target(sched, sched->next);
+
+      sched->next = (sched->next + 1) % sched->count;
+      next_week_s = transition_week_s(sched, sched->next);
+
+      if (next_week_s > passed_week_s)
+        sched->next_s += next_week_s - passed_week_s;
+      else
+        sched->next_s += SCHEDULE_WEEK_S - passed_week_s + next_week_s;
+  }
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Target temperature of the next transition.
+ ******************************************************************************/
+int16_t schedule_next_target(const schedule_t *sched)
+{
+  if (sched->count == 0)
+    return 0;
+
+  return transition_target(sched, sched->next);
+}
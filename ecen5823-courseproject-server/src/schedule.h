@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * @file    schedule.h
+ * @brief   Weekly schedule of target temperatures. Every day of the week holds
+ *          up to SCHEDULE_MAX_PER_DAY transitions, each one a time of the day
+ *          and the target temperature from that time on. The time of the next
+ *          transition is kept precomputed so that checking the schedule on
+ *          every sample is a single compare, and it is also the time the
+ *          caller arms its timer for. Time is the local calendar time in
+ *          seconds since Jan 1 1970 (a Thursday), no daylight saving.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_SCHEDULE_H_
+#define SRC_SCHEDULE_H_
+
+#include <stdint.h>
+
+
+#define SCHEDULE_DAYS               (7)     // Sunday is day 0
+#define SCHEDULE_MAX_PER_DAY        (4)
+#define SCHEDULE_MAX_TRANSITIONS    (SCHEDULE_DAYS * SCHEDULE_MAX_PER_DAY)
+#define SCHEDULE_SLOT_S             (15 * 60)   // Resolution of the transitions
+#define SCHEDULE_SLOTS_PER_DAY      (96)
+#define SCHEDULE_DAY_S              (24 * 60 * 60)
+#define SCHEDULE_WEEK_S             (SCHEDULE_DAYS * SCHEDULE_DAY_S)
+#define SCHEDULE_MAX_TARGET         (125)
+#define SCHEDULE_NEXT_NONE          (0xFFFFFFFF)
+
+// Packed size of the schedule, as written over GATT and stored in NVM
+#define SCHEDULE_PACKED_LEN         (SCHEDULE_MAX_TRANSITIONS * sizeof(schedule_entry_t))
+
+
+/* Two bytes per transition, the day is given by the position in the table */
+typedef struct {
+  uint8_t slot;                   // Quarter hour of the day, 0 - 95
+  uint8_t target;                 // Target temperature in F, 0 if unused
+}schedule_entry_t;
+
+typedef struct {
+  schedule_entry_t table[SCHEDULE_DAYS][SCHEDULE_MAX_PER_DAY];
+  uint8_t order[SCHEDULE_MAX_TRANSITIONS];  // Used entries in time order
+  uint8_t count;
+  uint8_t next;                   // Position in order[] of the next transition
+  uint32_t next_s;                // Time of the next transition
+}schedule_t;
+
+
+/******************************************************************************
+ * @brief Clears the schedule, no transitions are due till one is loaded.
+ *
+ * @param
+ *  sched   Schedule to be initialized
+ *
+ ******************************************************************************/
+void schedule_init(schedule_t *sched);
+
+
+/******************************************************************************
+ * @brief Loads a packed schedule, normally written in one GATT write. Entries
+ * with a target of 0 are unused, entries with an invalid slot or target are
+ * dropped and the entries of every day are sorted by time, so the table is
+ * left in the normalized form. The schedule is then synced to the given time.
+ *
+ * @param
+ *  sched   Schedule
+ *  data    Packed schedule, day by day
+ *  len     Length of data, must be SCHEDULE_PACKED_LEN
+ *  now_s   Current local time
+ *  target  Target temperature in effect at now_s, left as is if the schedule
+ *          is empty
+ *
+ * @return
+ *  Returns 0 on success, non-zero if len is wrong and the schedule was not
+ *  changed.
+ *
+ ******************************************************************************/
+uint8_t schedule_load(schedule_t *sched, const uint8_t *data, uint32_t len,
+                      uint32_t now_s, int16_t *target);
+
+
+/******************************************************************************
+ * @brief Copies the normalized schedule in packed form.
+ *
+ * @param
+ *  sched   Schedule
+ *  data    Buffer of SCHEDULE_PACKED_LEN bytes
+ *
+ ******************************************************************************/
+void schedule_pack(const schedule_t *sched, uint8_t *data);
+
+
+/******************************************************************************
+ * @brief Finds the transition in effect at the given time and the next one.
+ * Used after loading the schedule and when the clock is set.
+ *
+ * @param
+ *  sched   Schedule
+ *  now_s   Current local time
+ *  target  Target temperature in effect at now_s, left as is if the schedule
+ *          is empty
+ *
+ ******************************************************************************/
+void schedule_sync(schedule_t *sched, uint32_t now_s, int16_t *target);
+
+
+/******************************************************************************
+ * @brief Checks if a transition is due. This is a single compare unless a
+ * transition was passed, then the next transition time is moved on by the
+ * gap to the following entry.
+ *
+ * @param
+ *  sched   Schedule
+ *  now_s   Current local time
+ *  target  Target temperature of the last transition passed
+ *
+ * @return
+ *  Returns 1 if a transition was passed and target was updated, else 0.
+ *
+ ******************************************************************************/
+uint8_t schedule_poll(schedule_t *sched, uint32_t now_s, int16_t *target);
+
+
+/******************************************************************************
+ * @brief Target temperature of the next transition, for starting early on it.
+ *
+ * @param
+ *  sched   Schedule
+ *
+ * @return
+ *  Target of the next transition, 0 if the schedule is empty.
+ *
+ ******************************************************************************/
+int16_t schedule_next_target(const schedule_t *sched);
+
+
+#endif /* SRC_SCHEDULE_H_ */
@@ -1,7 +1,7 @@
 /*******************************************************************************
  * @file    scheduler.c
- * @brief   Process the events and handles the LM75 temperature sensor state
- *          machine.
+ * @brief   Process the events and handles the bus scheduler of the temperature
+ *          sensors on I2C0.
  *
  * @author  Amey More, Amey.More@colorado.edu
  * @date    Nov 24, 2022
@@ -14,13 +14,25 @@
  * @change  Updated temperature state machine to shutdown and wakeup LM75
  *          sensor. Added logic to handle button events.
  *
+ * @editor  Oct 19, 2026
+ * @change  Moved the LM75 register map to lm75.c and replaced the LM75 state
+ *          machine with a bus scheduler that samples the LM75 and Si7021
+ *          through the sensor driver interface in a single wake window.
+ *
+ * @editor  Oct 19, 2026
+ * @change  Every sensor belongs to a zone, the temperature of a zone is the
+ *          average of its sensors.
+ *
  ******************************************************************************/
 #include "em_core.h"
 #include "em_gpio.h"
+#include "sl_sleeptimer.h"
 
 #include "scheduler.h"
 #include "ble.h"
 #include "i2c.h"
+#include "lm75.h"
+#include "si7021.h"
 #include "common.h"
 
 typedef enum {
@@ -33,27 +45,53 @@ typedef enum {
   EVT_I2C_TR_SUCCESS = 128,
   EVT_I2C_TR_FAIL = 256,
   EVT_TIMER_COMP0_UF = 512,
-  EVT_TIMER_COMP1_UF = 1024
+  EVT_TIMER_COMP1_UF = 1024,
+  EVT_SENSOR_CONVERSION_DONE = 2048   // From soft timer, not an external signal
 } event_type_t;
 
 typedef enum {
-  STATE_LM75_BOOT = 0,
-  STATE_LM75_WAKEUP,
-  STATE_LM75_READ_TEMP,
-  STATE_LM75_SHUTDOWN
-}ftm_state_lm75_t;
-
-
-#define LM75_DEV_ADDR         (0x48)
-#define LM75_REG_CONG_ADDR    (0x01)
-#define LM75_REG_TEMP_ADDR    (0x00)
-#define LM75_REG_PID_ADDR     (0x07)
-#define LM75_SHUTDOWN_MASK    (0x01)
-#define LM75_INTERRUPT_MASK   (0x02)
+  STATE_SENSOR_BUS_IDLE = 0,
+  STATE_SENSOR_BUS_BEGIN,
+  STATE_SENSOR_BUS_WAIT,
+  STATE_SENSOR_BUS_READ,
+  STATE_SENSOR_BUS_SHUTDOWN
+}ftm_state_sensor_bus_t;
+
+
 #define MAX_I2C_FAIL_COUNT    (10)
+#define SOFT_TIMER_FREQ       (32768U)
+
+
+/* All the sensors on the I2C0 bus, sampled together in every round */
+static const sensor_driver_t *g_sensors[] = {
+    &lm75_driver,
+    &si7021_driver
+};
 
+#define SENSORS_COUNT   (sizeof(g_sensors) / sizeof(g_sensors[0]))
 
-ftm_state_lm75_t g_next_state_lm75 = STATE_LM75_BOOT;
+/* Zone of every sensor in g_sensors */
+static const uint8_t g_sensor_zones[] = {
+    ZONE_MAIN,
+    ZONE_MAIN
+};
+
+
+typedef struct {
+  ftm_state_sensor_bus_t state;
+  uint8_t sensor_index;
+  uint32_t sensors_ok;        // Bit per sensor, cleared on a failed transfer
+  uint8_t em1_on;
+  uint32_t em1_start_tick;
+  uint32_t transfer_start_tick;
+  uint32_t round_start_tick;
+  uint32_t bus_ticks;         // I2C busy time of the current round
+  uint32_t em1_ticks;         // EM1 residency of the current round
+}sensor_bus_t;
+
+sensor_bus_t g_sensor_bus = {
+    .state = STATE_SENSOR_BUS_IDLE
+};
 
 
 /******************************************************************************
@@ -256,87 +294,248 @@ void handle_button_events(sl_bt_msg_t *evt)
 
 
 /******************************************************************************
- * @brief Handles the temperature state machine fail event.
+ * @brief Converts sleeptimer ticks to microseconds.
  ******************************************************************************/
-void handleI2CFailedEvent()
+static uint32_t ticks_to_us(uint32_t ticks)
 {
-  g_next_state_lm75 = STATE_LM75_BOOT;
-  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
-  NVIC_DisableIRQ(I2C0_IRQn);
+  return (uint32_t)(((uint64_t)ticks * 1000000) / sl_sleeptimer_get_timer_frequency());
 }
 
 
 /******************************************************************************
- * SEE HEADER FILE FOR FULL DETAILS
- * Handles the state machine of LM75 temperature sensor.
+ * @brief Keeps the MCU in EM1 while the I2C peripheral is in use and tracks
+ * the time spent in EM1 for the current round.
  ******************************************************************************/
-void temperatureStateMachine(sl_bt_msg_t *evt)
+static void sensor_bus_em1_enter(void)
 {
-  uint32_t event = evt->data.evt_system_external_signal.extsignals;
-
-  if (event == 0)
+  if (g_sensor_bus.em1_on)
     return;
 
-  if (!(event & (EVT_TIMER_COMP0_UF | EVT_I2C_TR_FAIL | EVT_I2C_TR_SUCCESS)))
+  g_sensor_bus.em1_on = 1;
+  g_sensor_bus.em1_start_tick = sl_sleeptimer_get_tick_count();
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+
+  NVIC_ClearPendingIRQ(I2C0_IRQn);
+  NVIC_EnableIRQ(I2C0_IRQn);
+}
+
+
+/******************************************************************************
+ * @brief Releases the EM1 requirement once the bus is not needed anymore.
+ ******************************************************************************/
+static void sensor_bus_em1_exit(void)
+{
+  if (!g_sensor_bus.em1_on)
     return;
 
-  static uint8_t i2c_data[2];
+  NVIC_DisableIRQ(I2C0_IRQn);
 
-  switch(g_next_state_lm75)
-  {
-    case STATE_LM75_BOOT:
-      if (event & EVT_TIMER_COMP0_UF) {
-          g_next_state_lm75 = STATE_LM75_WAKEUP;
-          sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+  g_sensor_bus.em1_ticks += sl_sleeptimer_get_tick_count() - g_sensor_bus.em1_start_tick;
+  g_sensor_bus.em1_on = 0;
+}
+
+
+/******************************************************************************
+ * @brief Averages the results of the sensors read successfully in this round
+ * per zone and updates the current temperature of every zone sampled.
+ ******************************************************************************/
+static void sensor_bus_update_temperature(void)
+{
+  int32_t temp_sum[ZONE_MAX] = {0};
+  uint8_t temp_count[ZONE_MAX] = {0};
 
-          NVIC_ClearPendingIRQ(I2C0_IRQn);
-          NVIC_EnableIRQ(I2C0_IRQn);
+  for (uint8_t i = 0; i < SENSORS_COUNT; i++) {
+      int16_t temp_val;
 
-          i2c_data[0] = (uint8_t)LM75_REG_CONG_ADDR;
-          i2c_data[1] = (uint8_t)LM75_INTERRUPT_MASK;
-          I2C0_write(LM75_DEV_ADDR, i2c_data, 2);
+      if (!(g_sensor_bus.sensors_ok & (1 << i)))
+        continue;
+
+      if (g_sensors[i]->get_temperature(&temp_val)) {
+          g_sensor_bus.sensors_ok &= ~(1 << i);
+          continue;
       }
-      break;
 
-    case STATE_LM75_WAKEUP:
-      if ((event & EVT_I2C_TR_FAIL) || (event & EVT_TIMER_COMP0_UF)) {
-          handleI2CFailedEvent();
+      LOG_INFO("%s Temperature: %d\n", g_sensors[i]->name, temp_val);
+      temp_sum[g_sensor_zones[i]] += temp_val;
+      temp_count[g_sensor_zones[i]]++;
+  }
+
+  for (uint8_t zone = 0; zone < ZONE_MAX; zone++) {
+      if (temp_count[zone])
+        update_zone_temperature(zone, (int16_t)(temp_sum[zone] / temp_count[zone]));
+  }
+}
+
+
+/******************************************************************************
+ * @brief Reports the bus time and EM1 residency of the finished round.
+ ******************************************************************************/
+static void sensor_bus_report_round(void)
+{
+  uint32_t round_ticks = sl_sleeptimer_get_tick_count() - g_sensor_bus.round_start_tick;
+
+  LOG_INFO("Sensor round: sensors ok 0x%lx, bus %lu us, EM1 %lu us, total %lu us\n",
+           g_sensor_bus.sensors_ok,
+           ticks_to_us(g_sensor_bus.bus_ticks),
+           ticks_to_us(g_sensor_bus.em1_ticks),
+           ticks_to_us(round_ticks));
+}
+
+
+/******************************************************************************
+ * @brief Starts the operation of the current state on the next sensor that
+ * needs the bus. When all the sensors are done with the current state it moves
+ * to the next state of the round.
+ ******************************************************************************/
+static void sensor_bus_next(void)
+{
+  while (g_sensor_bus.sensor_index < SENSORS_COUNT) {
+      const sensor_driver_t *sensor = g_sensors[g_sensor_bus.sensor_index];
+      uint32_t sensor_mask = 1 << g_sensor_bus.sensor_index;
+      int rc = SENSOR_NO_TRANSFER;
+
+      switch (g_sensor_bus.state) {
+        case STATE_SENSOR_BUS_BEGIN:
+          rc = sensor->begin_conversion();
+          break;
+        case STATE_SENSOR_BUS_READ:
+          if (g_sensor_bus.sensors_ok & sensor_mask)
+            rc = sensor->read();
+          break;
+        case STATE_SENSOR_BUS_SHUTDOWN:
+          rc = sensor->shutdown();
+          break;
+        default:
+          return;
       }
-      else if (event & EVT_I2C_TR_SUCCESS) {
-          g_next_state_lm75 = STATE_LM75_READ_TEMP;
-          I2C0_read(LM75_DEV_ADDR, LM75_REG_TEMP_ADDR, i2c_data, 2);
+
+      if (rc == SENSOR_TRANSFER_STARTED) {
+          g_sensor_bus.transfer_start_tick = sl_sleeptimer_get_tick_count();
+          return;
       }
-      break;
 
-    case STATE_LM75_READ_TEMP:
-      NVIC_DisableIRQ(I2C0_IRQn);
-      if ((event & EVT_I2C_TR_FAIL) || (event & EVT_TIMER_COMP0_UF)) {
-          handleI2CFailedEvent();
+      if (rc == SENSOR_TRANSFER_FAILED) {
+          LOG_ERROR("%s transfer failed\n", sensor->name);
+          g_sensor_bus.sensors_ok &= ~sensor_mask;
       }
-      else if (event & EVT_I2C_TR_SUCCESS) {
-          g_next_state_lm75 = STATE_LM75_SHUTDOWN;
-          uint16_t i2c_data16 = i2c_data[0] << 8 | i2c_data[1];
-          int16_t temp_val = (int16_t)((i2c_data16 * 9) / (5 *256)) + 32;
 
-          if (temp_val != 33)
-            update_current_temperature(temp_val);
+      g_sensor_bus.sensor_index++;
+  }
+
+  g_sensor_bus.sensor_index = 0;
+
+  switch (g_sensor_bus.state) {
+    case STATE_SENSOR_BUS_BEGIN: {
+      uint16_t wait_ms = 0;
 
-          i2c_data[0] = (uint8_t)LM75_REG_CONG_ADDR;
-          i2c_data[1] = (uint8_t)LM75_INTERRUPT_MASK | LM75_SHUTDOWN_MASK;
-          I2C0_write(LM75_DEV_ADDR, i2c_data, 2);
+      for (uint8_t i = 0; i < SENSORS_COUNT; i++) {
+          if ((g_sensor_bus.sensors_ok & (1 << i)) && g_sensors[i]->conversion_time_ms > wait_ms)
+            wait_ms = g_sensors[i]->conversion_time_ms;
+      }
+
+      // Sensors convert in parallel, bus is not needed till the slowest is done
+      sensor_bus_em1_exit();
+      g_sensor_bus.state = STATE_SENSOR_BUS_WAIT;
 
-          LOG_INFO("Temperature: %u\n", temp_val);
+      if (sl_bt_system_set_soft_timer((wait_ms * SOFT_TIMER_FREQ) / 1000 + 1,
+                                      SOFT_TIMER_HANDLE_SENSOR, 1) != SL_STATUS_OK) {
+          LOG_ERROR("Failed to start sensor conversion timer\n");
+          g_sensor_bus.state = STATE_SENSOR_BUS_IDLE;
       }
       break;
+    }
+
+    case STATE_SENSOR_BUS_READ:
+      sensor_bus_update_temperature();
+      g_sensor_bus.state = STATE_SENSOR_BUS_SHUTDOWN;
+      sensor_bus_next();
+      break;
+
+    case STATE_SENSOR_BUS_SHUTDOWN:
+      sensor_bus_em1_exit();
+      sensor_bus_report_round();
+      g_sensor_bus.state = STATE_SENSOR_BUS_IDLE;
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+/******************************************************************************
+ * @brief Abandons the current round, the bus is released and the next round
+ * starts again from the first sensor.
+ ******************************************************************************/
+static void sensor_bus_abort(void)
+{
+  LOG_ERROR("Sensor round aborted in state %d\n", g_sensor_bus.state);
 
-    case STATE_LM75_SHUTDOWN:
-      if ((event & EVT_I2C_TR_FAIL) || (event & EVT_TIMER_COMP0_UF)) {
-          handleI2CFailedEvent();
+  sensor_bus_em1_exit();
+  g_sensor_bus.state = STATE_SENSOR_BUS_IDLE;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Handles the bus scheduler of the temperature sensors.
+ ******************************************************************************/
+void temperatureStateMachine(sl_bt_msg_t *evt)
+{
+  uint32_t event = 0;
+
+  if (SL_BT_MSG_ID(evt->header) == sl_bt_evt_system_external_signal_id)
+    event = evt->data.evt_system_external_signal.extsignals;
+  else if (SL_BT_MSG_ID(evt->header) == sl_bt_evt_system_soft_timer_id &&
+      evt->data.evt_system_soft_timer.handle == SOFT_TIMER_HANDLE_SENSOR)
+    event = EVT_SENSOR_CONVERSION_DONE;
+
+  if (!(event & (EVT_TIMER_COMP0_UF | EVT_I2C_TR_FAIL | EVT_I2C_TR_SUCCESS |
+      EVT_SENSOR_CONVERSION_DONE)))
+    return;
+
+  switch(g_sensor_bus.state)
+  {
+    case STATE_SENSOR_BUS_IDLE:
+      if (event & EVT_TIMER_COMP0_UF) {
+          g_sensor_bus.state = STATE_SENSOR_BUS_BEGIN;
+          g_sensor_bus.sensor_index = 0;
+          g_sensor_bus.sensors_ok = (1 << SENSORS_COUNT) - 1;
+          g_sensor_bus.bus_ticks = 0;
+          g_sensor_bus.em1_ticks = 0;
+          g_sensor_bus.round_start_tick = sl_sleeptimer_get_tick_count();
+
+          sensor_bus_em1_enter();
+          sensor_bus_next();
+      }
+      break;
+
+    case STATE_SENSOR_BUS_WAIT:
+      if (event & EVT_SENSOR_CONVERSION_DONE) {
+          g_sensor_bus.state = STATE_SENSOR_BUS_READ;
+          sensor_bus_em1_enter();
+          sensor_bus_next();
       }
-      else if (event & EVT_I2C_TR_SUCCESS) {
-          g_next_state_lm75 = STATE_LM75_BOOT;
-          sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
-          NVIC_DisableIRQ(I2C0_IRQn);
+      break;
+
+    case STATE_SENSOR_BUS_BEGIN:
+    case STATE_SENSOR_BUS_READ:
+    case STATE_SENSOR_BUS_SHUTDOWN:
+      if (event & EVT_TIMER_COMP0_UF) {
+          sensor_bus_abort();
+      }
+      else if (event & (EVT_I2C_TR_SUCCESS | EVT_I2C_TR_FAIL)) {
+          g_sensor_bus.bus_ticks += sl_sleeptimer_get_tick_count() -
+              g_sensor_bus.transfer_start_tick;
+
+          if (event & EVT_I2C_TR_FAIL) {
+              LOG_ERROR("%s transfer failed\n", g_sensors[g_sensor_bus.sensor_index]->name);
+              g_sensor_bus.sensors_ok &= ~(1 << g_sensor_bus.sensor_index);
+          }
+
+          g_sensor_bus.sensor_index++;
+          sensor_bus_next();
       }
       break;
   }
@@ -1,7 +1,7 @@
 /*******************************************************************************
  * @file    scheduler.h
- * @brief   Process the events and handles the LM75 temperature sensor state
- *          machine.
+ * @brief   Process the events and handles the bus scheduler of the temperature
+ *          sensors on I2C0.
  *
  * @author  Amey More, Amey.More@colorado.edu
  * @date    Nov 24, 2022
@@ -14,6 +14,11 @@
  * @change  Updated temperature state machine to shutdown and wakeup LM75
  *          sensor. Added logic to handle button events.
  *
+ * @editor  Oct 19, 2026
+ * @change  Moved the LM75 register map to lm75.c and replaced the LM75 state
+ *          machine with a bus scheduler that samples the LM75 and Si7021
+ *          through the sensor driver interface in a single wake window.
+ *
  ******************************************************************************/
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
@@ -97,7 +102,11 @@ void handle_button_events(sl_bt_msg_t *evt);
 
 
 /******************************************************************************
- * @brief Handles the state machine of LM75 temperature sensor.
+ * @brief Handles the bus scheduler of the temperature sensors on I2C0. On
+ * every LETIMER0 underflow all the sensors are woken up back to back, the MCU
+ * sleeps in EM2 till the slowest conversion is done, then all of them are read
+ * and shut down in the same wake window. Bus time and EM1 residency of every
+ * round are reported over VCOM.
  *
  * @param
  *  evt   Contains the BT external signal BT API message.
@@ -0,0 +1,45 @@
+/*******************************************************************************
+ * @file    sensor.h
+ * @brief   Common driver interface for the temperature sensors sharing the
+ *          I2C0 bus. Every operation starts at most one non-blocking I2C
+ *          transaction, completion is reported through the I2C events handled
+ *          by the bus scheduler in scheduler.c.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_SENSOR_H_
+#define SRC_SENSOR_H_
+
+#include <stdint.h>
+
+
+// Return values of the sensor driver operations
+#define SENSOR_TRANSFER_STARTED   (0)   // Wait for I2C complete/fail event
+#define SENSOR_NO_TRANSFER        (1)   // Nothing to do on the bus, continue
+#define SENSOR_TRANSFER_FAILED    (-1)  // I2C transfer could not be started
+
+
+typedef struct {
+  const char *name;
+
+  /* Time in milliseconds between begin_conversion() completing and a valid
+   * result being available for read() */
+  uint16_t conversion_time_ms;
+
+  /* Wakes up the sensor and/or triggers a single conversion */
+  int (*begin_conversion)(void);
+
+  /* Starts the transfer of the conversion result */
+  int (*read)(void);
+
+  /* Puts the sensor into its lowest power state */
+  int (*shutdown)(void);
+
+  /* Decodes the result of the last completed read() into degree Fahrenheit.
+   * Returns non-zero if the result is not valid */
+  int (*get_temperature)(int16_t *temp);
+}sensor_driver_t;
+
+
+#endif /* SRC_SENSOR_H_ */
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * @file    si7021.c
+ * @brief   Sensor driver for the Si7021 temperature sensor on the BRD4104A
+ *          radio board. The "no hold master" command is used so the bus is
+ *          free for the other sensors while the Si7021 is converting.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include "si7021.h"
+#include "i2c.h"
+
+
+#define SI7021_DEV_ADDR           (0x40)
+#define SI7021_CMD_MEASURE_TEMP   (0xF3)    // Measure temperature, no hold master
+#define SI7021_CONVERSION_MS      (11)      // 14 bit temperature, 10.8ms max
+
+
+static uint8_t si7021_cmd;
+static uint8_t si7021_data[2];
+
+
+/******************************************************************************
+ * @brief Triggers a temperature measurement.
+ ******************************************************************************/
+static int si7021_begin_conversion(void)
+{
+  si7021_cmd = SI7021_CMD_MEASURE_TEMP;
+
+  if (I2C0_write(SI7021_DEV_ADDR, &si7021_cmd, 1))
+    return SENSOR_TRANSFER_FAILED;
+
+  return SENSOR_TRANSFER_STARTED;
+}
+
+
+/******************************************************************************
+ * @brief Reads the result of the measurement triggered earlier.
+ ******************************************************************************/
+static int si7021_read(void)
+{
+  if (I2C0_receive(SI7021_DEV_ADDR, si7021_data, 2))
+    return SENSOR_TRANSFER_FAILED;
+
+  return SENSOR_TRANSFER_STARTED;
+}
+
+
+/******************************************************************************
+ * @brief The Si7021 returns to standby by itself after every measurement and
+ * its supply is shared with the LCD, so there is nothing to do on the bus.
+ ******************************************************************************/
+static int si7021_shutdown(void)
+{
+  return SENSOR_NO_TRANSFER;
+}
+
+
+/******************************************************************************
+ * @brief Converts the last read measurement to Fahrenheit.
+ * T(C) = 175.72 * code / 65536 - 46.85
+ ******************************************************************************/
+static int si7021_get_temperature(int16_t *temp)
+{
+  uint16_t code = si7021_data[0] << 8 | si7021_data[1];
+  int32_t temp_c_x100 = ((17572 * (int32_t)code) >> 16) - 4685;
+
+  // Lower two bits of the LSB are status bits, bit 1 is set for humidity
+  if (code & 0x02)
+    return -1;
+
+  *temp = (int16_t)((temp_c_x100 * 9 / 5 + 3200) / 100);
+  return 0;
+}
+
+
+const sensor_driver_t si7021_driver = {
+    .name = "Si7021",
+    .conversion_time_ms = SI7021_CONVERSION_MS,
+    .begin_conversion = si7021_begin_conversion,
+    .read = si7021_read,
+    .shutdown = si7021_shutdown,
+    .get_temperature = si7021_get_temperature
+};
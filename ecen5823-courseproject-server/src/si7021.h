@@ -0,0 +1,18 @@
+/*******************************************************************************
+ * @file    si7021.h
+ * @brief   Sensor driver for the Si7021 temperature sensor on the BRD4104A
+ *          radio board.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_SI7021_H_
+#define SRC_SI7021_H_
+
+#include "sensor.h"
+
+
+extern const sensor_driver_t si7021_driver;
+
+
+#endif /* SRC_SI7021_H_ */
@@ -10,6 +10,7 @@
  ******************************************************************************/
 #include "em_letimer.h"
 #include "em_cmu.h"
+#include "sl_sleeptimer.h"
 
 #include "timers.h"
 #include "common.h"
@@ -101,3 +102,66 @@ void timerWaitUs_irq(uint32_t us_wait)
 
   init_LETIMER0((elapsed_time - ms_wait), LETIMER_PERIOD_MS);
 }
+
+
+/*******************************************************************************
+ * Returns the time since boot in seconds, based on the sleeptimer which keeps
+ * running in EM2.
+ *
+ * @return    Seconds since boot
+ *
+ ******************************************************************************/
+uint32_t timerGetUptimeSec(void)
+{
+  return (uint32_t)(sl_sleeptimer_get_tick_count64() / sl_sleeptimer_get_timer_frequency());
+}
+
+
+/*******************************************************************************
+ * Returns the time since boot in milliseconds, based on the sleeptimer.
+ *
+ * @return    Milliseconds since boot
+ *
+ ******************************************************************************/
+uint32_t timerGetUptimeMs(void)
+{
+  return (uint32_t)((sl_sleeptimer_get_tick_count64() * 1000) / sl_sleeptimer_get_timer_frequency());
+}
+
+
+/*******************************************************************************
+ * Returns the time since boot in microseconds, based on the sleeptimer.
+ *
+ * @return    Microseconds since boot
+ *
+ ******************************************************************************/
+uint64_t timerGetUptimeUs(void)
+{
+  return (sl_sleeptimer_get_tick_count64() * 1000000) / sl_sleeptimer_get_timer_frequency();
+}
+
+
+/*******************************************************************************
+ * Converts milliseconds to ticks of the BT stack soft timer.
+ *
+ * @return    Soft timer ticks
+ *
+ ******************************************************************************/
+uint32_t ms_to_ticks(uint32_t ms)
+{
+  return ms / 1000 * 32768 + (ms % 1000) * 32768 / 1000;
+}
+
+
+/*******************************************************************************
+ * Returns the time until a deadline, at least 1 ms.
+ *
+ * @return    Milliseconds to wait
+ *
+ ******************************************************************************/
+uint32_t ms_until(uint32_t deadline_ms, uint32_t now_ms)
+{
+  int32_t wait_ms = (int32_t)(deadline_ms - now_ms);
+
+  return wait_ms < 1 ? 1 : (uint32_t)wait_ms;
+}
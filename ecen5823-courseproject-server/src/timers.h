@@ -36,4 +36,61 @@ void init_LETIMER0(uint16_t comp1_ms, uint16_t comp0_ms);
 void timerWaitUs_irq(uint32_t us_wait);
 
 
+/*******************************************************************************
+ * Returns the time since boot in seconds, based on the sleeptimer which keeps
+ * running in EM2.
+ *
+ * @return    Seconds since boot
+ *
+ ******************************************************************************/
+uint32_t timerGetUptimeSec(void);
+
+
+/*******************************************************************************
+ * Returns the time since boot in milliseconds, based on the sleeptimer.
+ *
+ * @return    Milliseconds since boot
+ *
+ ******************************************************************************/
+uint32_t timerGetUptimeMs(void);
+
+
+/*******************************************************************************
+ * Returns the time since boot in microseconds, based on the sleeptimer. The
+ * resolution is one sleeptimer tick, about 30.5 us. Its low 32 bits wrap after
+ * about 71 minutes, only differences of them are meaningful.
+ *
+ * @return    Microseconds since boot
+ *
+ ******************************************************************************/
+uint64_t timerGetUptimeUs(void);
+
+
+/*******************************************************************************
+ * Converts milliseconds to ticks of the BT stack soft timer at 32768 Hz. The
+ * seconds and the rest are converted apart, ms * 32768 overflows 32 bits from
+ * about 131 s on.
+ *
+ * @param     ms    Value in milliseconds
+ *
+ * @return    Soft timer ticks, rounded down
+ *
+ ******************************************************************************/
+uint32_t ms_to_ticks(uint32_t ms);
+
+
+/*******************************************************************************
+ * Returns the time from now until a deadline, both in milliseconds of the
+ * uptime. The difference is taken wrap-safe and clamped to at least 1 ms, a
+ * deadline already passed still needs the soft timer to fire.
+ *
+ * @param     deadline_ms   Deadline in milliseconds
+ * @param     now_ms        Current time in milliseconds
+ *
+ * @return    Milliseconds to wait, at least 1
+ *
+ ******************************************************************************/
+uint32_t ms_until(uint32_t deadline_ms, uint32_t now_ms);
+
+
 #endif /* SRC_TIMERS_H_ */
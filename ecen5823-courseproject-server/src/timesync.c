@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * @file    timesync.c
+ * @brief   Time sync of a client clock to the server's. See timesync.h for
+ *          details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "timesync.h"
+#include "linksched.h"
+#include "phy.h"
+
+
+/******************************************************************************
+ * @brief Writes a little endian uint32.
+ ******************************************************************************/
+static void timesync_put32(uint8_t *data, uint32_t value)
+{
+  for (uint8_t i = 0; i < 4; i++)
+    data[i] = (uint8_t)(value >> (8 * i));
+}
+
+
+/******************************************************************************
+ * @brief Offset predicted at a client time, Q16 microseconds.
+ ******************************************************************************/
+static uint64_t timesync_predict_q16(const timesync_t *ts, uint32_t client_us)
+{
+  int32_t dt_us = (int32_t)(client_us - ts->ref_us);
+
+  return ts->offset_q16 + (uint64_t)((int64_t)ts->drift_q16 * dt_us / 1000000);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the sync.
+ ******************************************************************************/
+void timesync_init(timesync_t *ts)
+{
+  memset(ts, 0, sizeof(timesync_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes a sample.
+ ******************************************************************************/
+uint8_t timesync_sample(timesync_t *ts, uint32_t client_us, uint32_t server_us,
+                        uint32_t gate_us)
+{
+  uint32_t measured_us = client_us - server_us;
+  uint64_t predicted_q16;
+  int32_t dt_us, error_us;
+  uint32_t error_abs_us;
+
+  if (!ts->locked) {
+      ts->locked = 1;
+      ts->ref_us = client_us;
+      ts->offset_q16 = (uint64_t)measured_us << 16;
+      ts->drift_q16 = 0;
+      ts->dropped_run = 0;
+      ts->samples = 1;
+      return 1;
+  }
+
+  dt_us = (int32_t)(client_us - ts->ref_us);
+  if (dt_us <= 0)
+    return 0;
+
+  predicted_q16 = timesync_predict_q16(ts, client_us);
+  error_us = (int32_t)(measured_us - (uint32_t)(predicted_q16 >> 16));
+  error_abs_us = error_us < 0 ? -error_us : error_us;
+
+  // A packet sent again puts the sample an interval off
+  if (error_abs_us > gate_us) {
+      ts->dropped++;
+      if (++ts->dropped_run >= TIMESYNC_RELOCK) {
+          ts->relocks++;
+          ts->locked = 0;
+          return timesync_sample(ts, client_us, server_us, gate_us);
+      }
+      return 0;
+  }
+
+  ts->dropped_run = 0;
+  ts->ref_us = client_us;
+  ts->offset_q16 = predicted_q16 + (uint64_t)(((int64_t)error_us << 16) >> TIMESYNC_OFFSET_SHIFT);
+  ts->drift_q16 += (int32_t)((((int64_t)error_us << 16) * 1000000 / dt_us) >> TIMESYNC_DRIFT_SHIFT);
+
+  ts->samples++;
+  ts->error_us_sum += error_abs_us;
+  if (error_abs_us > ts->error_us_max)
+    ts->error_us_max = error_abs_us;
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Takes the sample of a probe exchange.
+ ******************************************************************************/
+uint8_t timesync_exchange(timesync_t *ts, uint8_t phy, uint32_t interval_us,
+                          const uint32_t *times_us)
+{
+  uint32_t down_us = phy_packet_us(phy, TIMESYNC_PING_PDU_LEN);
+  uint32_t up_us = phy_packet_us(phy, 0) + LINKSCHED_IFS_US +
+      phy_packet_us(phy, TIMESYNC_ECHO_PDU_LEN);
+  uint32_t server_event_us = times_us[3] - up_us - interval_us;
+
+  // The echo is queued before the next event, the ping before its own
+  if (times_us[2] - times_us[1] >= interval_us / 2 ||
+      (int32_t)(server_event_us - times_us[0]) < 0) {
+      ts->invalid++;
+      return 0;
+  }
+
+  return timesync_sample(ts, times_us[1] - down_us, server_event_us, interval_us / 2);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Server time of a client time.
+ ******************************************************************************/
+uint32_t timesync_server_us(const timesync_t *ts, uint32_t client_us)
+{
+  return client_us - (uint32_t)(timesync_predict_q16(ts, client_us) >> 16);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Packs the record of the estimate.
+ ******************************************************************************/
+void timesync_pack(const timesync_t *ts, uint64_t t1_us, uint8_t *record)
+{
+  record[0] = ts->locked && ts->samples >= TIMESYNC_WARMUP;
+  record[1] = (uint8_t)(t1_us >> 32);
+  record[2] = (uint8_t)(t1_us >> 40);
+  timesync_put32(&record[3], ts->ref_us);
+  timesync_put32(&record[7], (uint32_t)(ts->offset_q16 >> 16));
+  timesync_put32(&record[11], (uint32_t)ts->drift_q16);
+}
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * @file    timesync.h
+ * @brief   Time sync of a client clock to the server's, on the exchange of the
+ *          latency probe. The times the ping and its echo are taken carry the
+ *          queueing of each side, up to a connection interval, so the samples
+ *          are taken at the connection events instead: the ping is taken by
+ *          the client one ping packet after the event it went out on, and its
+ *          echo goes out at the next event, taken by the server one empty
+ *          packet and the echo packet later. The event of the ping is then
+ *          t2 - ping on the client clock and t4 - echo - interval on the
+ *          server's, the time to take a packet being the same on both sides.
+ *          Offset and drift are kept by an alpha beta filter in fixed point,
+ *          the offset in Q16 microseconds and the drift in Q16 ppm, and a
+ *          sample off by more than half an interval from the prediction, a
+ *          packet sent again, is dropped. The estimate is sent to the client
+ *          with every ping, it takes the server time from its own clock by it.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_TIMESYNC_H_
+#define SRC_TIMESYNC_H_
+
+#include <stdint.h>
+
+#include "probe.h"
+
+
+#define TIMESYNC_OFFSET_SHIFT   (2)       // Offset gain 1/4
+#define TIMESYNC_DRIFT_SHIFT    (5)       // Drift gain 1/32, about critically damped
+#define TIMESYNC_RELOCK         (4)       // Samples dropped in a row to lock again
+#define TIMESYNC_WARMUP         (16)      // Samples before the estimate is sent
+
+/* Record of the estimate after the ping, little endian:
+ *  [0]       1 once the estimate is sent, 0 before
+ *  [1..2]    Bits 32 to 47 of the server time of t1 in us
+ *  [3..6]    Client time of the estimate in us
+ *  [7..10]   Client less server time at it in us, modulo 2^32
+ *  [11..14]  Drift of the client clock, ppm Q16 */
+#define TIMESYNC_RECORD_LEN     (15)
+
+// Link layer payloads of the exchange, with the L2CAP and ATT headers and MIC
+#define TIMESYNC_PING_PDU_LEN   (PROBE_PING_LEN + TIMESYNC_RECORD_LEN + 11)
+#define TIMESYNC_ECHO_PDU_LEN   (PROBE_ECHO_LEN + 11)
+
+
+typedef struct {
+  uint8_t locked;
+  uint32_t ref_us;                // Client time of the estimate
+  uint64_t offset_q16;            // Client less server time, its low 48 bits
+  int32_t drift_q16;              // ppm the client clock runs fast
+  uint8_t dropped_run;            // Samples dropped in a row
+  uint32_t samples;               // Taken since the lock
+  uint32_t dropped;               // Stats
+  uint32_t relocks;
+  uint32_t invalid;               // Exchanges outside the event model
+  uint64_t error_us_sum;          // Of the samples taken against the prediction
+  uint32_t error_us_max;
+}timesync_t;
+
+
+/******************************************************************************
+ * @brief Clears the sync of a client.
+ ******************************************************************************/
+void timesync_init(timesync_t *ts);
+
+
+/******************************************************************************
+ * @brief Takes a sample, the time of one connection event on both clocks.
+ *
+ * @param
+ *  ts          Sync
+ *  client_us   Client time of the event
+ *  server_us   Server time of the event
+ *  gate_us     Largest error against the prediction taken
+ *
+ * @return
+ *  Returns 1 if the sample is taken.
+ *
+ ******************************************************************************/
+uint8_t timesync_sample(timesync_t *ts, uint32_t client_us, uint32_t server_us,
+                        uint32_t gate_us);
+
+
+/******************************************************************************
+ * @brief Takes the sample of an echo taken by the probe.
+ *
+ * @param
+ *  ts            Sync
+ *  phy           PHY bit of the link
+ *  interval_us   Connection interval
+ *  times_us      t1 to t4 of the exchange, see probe.h
+ *
+ * @return
+ *  Returns 1 if the sample is taken.
+ *
+ ******************************************************************************/
+uint8_t timesync_exchange(timesync_t *ts, uint8_t phy, uint32_t interval_us,
+                          const uint32_t *times_us);
+
+
+/******************************************************************************
+ * @brief Server time of a client time by the estimate, as the client takes it.
+ ******************************************************************************/
+uint32_t timesync_server_us(const timesync_t *ts, uint32_t client_us);
+
+
+/******************************************************************************
+ * @brief Packs the record of the estimate.
+ *
+ * @param
+ *  ts          Sync
+ *  t1_us       Server time of the ping, 64 bits
+ *  record      TIMESYNC_RECORD_LEN bytes out
+ *
+ ******************************************************************************/
+void timesync_pack(const timesync_t *ts, uint64_t t1_us, uint8_t *record);
+
+
+#endif /* SRC_TIMESYNC_H_ */
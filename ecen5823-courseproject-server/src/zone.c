@@ -0,0 +1,208 @@
+/*******************************************************************************
+ * @file    zone.c
+ * @brief   Zones of the thermostat. See zone.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "zone.h"
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Clears the table.
+ ******************************************************************************/
+void zone_table_init(zone_table_t *table)
+{
+  memset(table, 0, sizeof(zone_table_t));
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Adds a zone.
+ ******************************************************************************/
+int8_t zone_add(zone_table_t *table, uint32_t now_s)
+{
+  zone_t *zone;
+
+  if (table->zone_count == ZONE_MAX)
+    return -1;
+
+  zone = &table->zones[table->zone_count];
+  zone->current_temp = 0;
+  zone->target_temp = 0;
+  zone->actuators = 0;
+  control_init(&zone->control, now_s);
+
+  return (int8_t)table->zone_count++;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Adds an actuator to a zone.
+ ******************************************************************************/
+int8_t zone_add_actuator(zone_table_t *table, uint8_t zone,
+                         control_output_t kind, uint8_t id)
+{
+  zone_actuator_t *actuator;
+
+  if (table->actuator_count == ZONE_MAX_ACTUATORS || zone >= table->zone_count)
+    return -1;
+
+  actuator = &table->actuators[table->actuator_count];
+  actuator->zone = zone;
+  actuator->id = id;
+  actuator->kind = kind;
+
+  table->zones[zone].actuators |= (uint64_t)1 << table->actuator_count;
+
+  if (kind == CONTROL_OUTPUT_HEAT)
+    table->heat |= (uint64_t)1 << table->actuator_count;
+
+  return (int8_t)table->actuator_count++;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sets the current temperature of a zone.
+ ******************************************************************************/
+void zone_set_current(zone_table_t *table, uint8_t zone, int16_t temp)
+{
+  if (zone >= table->zone_count)
+    return;
+
+  table->zones[zone].current_temp = temp;
+
+  if (table->zones[zone].target_temp == 0)
+    table->zones[zone].target_temp = temp;
+
+  table->dirty |= (uint32_t)1 << zone;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sets the target temperature of a zone.
+ ******************************************************************************/
+void zone_set_target(zone_table_t *table, uint8_t zone, int16_t target)
+{
+  if (zone >= table->zone_count || table->zones[zone].target_temp == target)
+    return;
+
+  table->zones[zone].target_temp = target;
+  table->dirty |= (uint32_t)1 << zone;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Records the state an actuator was driven to.
+ ******************************************************************************/
+void zone_set_actuator(zone_table_t *table, uint8_t actuator, uint8_t on)
+{
+  uint64_t bit = (uint64_t)1 << actuator;
+
+  if (actuator >= table->actuator_count)
+    return;
+
+  if (on) {
+      table->on |= bit;
+      table->requested |= bit;
+  }
+  else {
+      table->on &= ~bit;
+      table->requested &= ~bit;
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Drops the requested changes not sent yet.
+ ******************************************************************************/
+void zone_cancel_requests(zone_table_t *table)
+{
+  table->requested = table->on;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Output the actuators of a zone are in.
+ ******************************************************************************/
+control_output_t zone_output(const zone_table_t *table, uint8_t zone)
+{
+  uint64_t on;
+
+  if (zone >= table->zone_count)
+    return CONTROL_OUTPUT_OFF;
+
+  on = table->zones[zone].actuators & table->on;
+
+  if (on & table->heat)
+    return CONTROL_OUTPUT_HEAT;
+
+  if (on)
+    return CONTROL_OUTPUT_COOL;
+
+  return CONTROL_OUTPUT_OFF;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Restarts the control of a zone.
+ ******************************************************************************/
+void zone_reset(zone_table_t *table, uint8_t zone, uint32_t now_s)
+{
+  if (zone >= table->zone_count)
+    return;
+
+  control_reset(&table->zones[zone].control, zone_output(table, zone), now_s);
+  table->dirty |= (uint32_t)1 << zone;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the control of every dirty zone.
+ ******************************************************************************/
+uint8_t zone_run(zone_table_t *table, uint32_t now_s)
+{
+  uint32_t dirty = table->dirty;
+  uint8_t count = 0;
+
+  table->dirty = 0;
+
+  while (dirty) {
+      zone_t *zone = &table->zones[__builtin_ctz(dirty)];
+      control_output_t output;
+      uint64_t wanted = 0;
+
+      dirty &= dirty - 1;
+
+      if (zone->current_temp == 0)
+        continue;
+
+      output = control_update(&zone->control, zone->current_temp,
+                              zone->target_temp, now_s);
+
+      if (output == CONTROL_OUTPUT_HEAT)
+        wanted = zone->actuators & table->heat;
+      else if (output == CONTROL_OUTPUT_COOL)
+        wanted = zone->actuators & ~table->heat;
+
+      table->requested = (table->requested & ~zone->actuators) | wanted;
+
+      count++;
+  }
+
+  table->zones_run += count;
+
+  return count;
+}
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * @file    zone.h
+ * @brief   Zones of the thermostat. Every zone owns its current temperature
+ *          from its sensors, its target, its control state and a set of
+ *          actuators (heaters and ACs). A zone is marked dirty when it gets a
+ *          new sample or target and zone_run() only runs the control of the
+ *          dirty zones, so the cost of a sample does not grow with the number
+ *          of zones. zone_run() only requests the actuator states, they are
+ *          sent by the actuation scheduler in actuation.c. All the memory is
+ *          sized at compile time.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef SRC_ZONE_H_
+#define SRC_ZONE_H_
+
+#include <stdint.h>
+
+#include "control.h"
+
+
+#define ZONE_MAX              (16)    // At most 32, one dirty bit per zone
+#define ZONE_MAX_ACTUATORS    (64)    // At most 64, one bit per actuator
+#define ZONE_MAIN             (0)     // Zone of the schedule and the recovery
+
+#if ZONE_MAX > 32 || ZONE_MAX_ACTUATORS > 64
+#error "Zone bitmasks are too small for ZONE_MAX or ZONE_MAX_ACTUATORS"
+#endif
+
+
+typedef struct {
+  uint8_t zone;
+  uint8_t id;                     // Handle of the caller, e.g. client index
+  control_output_t kind;          // CONTROL_OUTPUT_HEAT or CONTROL_OUTPUT_COOL
+}zone_actuator_t;
+
+typedef struct {
+  int16_t current_temp;
+  int16_t target_temp;
+  control_state_t control;
+  uint64_t actuators;             // Bit per index in zone_table_t.actuators
+}zone_t;
+
+typedef struct {
+  zone_t zones[ZONE_MAX];
+  zone_actuator_t actuators[ZONE_MAX_ACTUATORS];
+  uint8_t zone_count;
+  uint8_t actuator_count;
+  uint64_t heat;                  // Bit per actuator, set for the heaters
+  uint64_t on;                    // Bit per actuator that is on
+  uint64_t requested;             // Bit per actuator the control wants on
+  uint32_t dirty;                 // Bit per zone with a new sample or target
+  uint32_t zones_run;             // Work done by zone_run(), for benchmarks
+}zone_table_t;
+
+
+/******************************************************************************
+ * @brief Clears the table, zones and actuators have to be added.
+ *
+ * @param
+ *  table   Table to be initialized
+ *
+ ******************************************************************************/
+void zone_table_init(zone_table_t *table);
+
+
+/******************************************************************************
+ * @brief Adds a zone with the default control configuration.
+ *
+ * @param
+ *  table   Zone table
+ *  now_s   Current time in seconds
+ *
+ * @return
+ *  Index of the zone, -1 if the table is full.
+ *
+ ******************************************************************************/
+int8_t zone_add(zone_table_t *table, uint32_t now_s);
+
+
+/******************************************************************************
+ * @brief Adds an actuator to a zone, it starts off.
+ *
+ * @param
+ *  table   Zone table
+ *  zone    Index of the zone
+ *  kind    CONTROL_OUTPUT_HEAT for a heater, CONTROL_OUTPUT_COOL for an AC
+ *  id      Handle passed back to the zone_actuate_t callback
+ *
+ * @return
+ *  Index of the actuator, -1 if the table is full or the zone is invalid.
+ *
+ ******************************************************************************/
+int8_t zone_add_actuator(zone_table_t *table, uint8_t zone,
+                         control_output_t kind, uint8_t id);
+
+
+/******************************************************************************
+ * @brief Sets the current temperature of a zone and marks it dirty. A zone
+ * without a target takes the first temperature as its target.
+ ******************************************************************************/
+void zone_set_current(zone_table_t *table, uint8_t zone, int16_t temp);
+
+
+/******************************************************************************
+ * @brief Sets the target temperature of a zone, the zone is marked dirty if
+ * the target changed.
+ ******************************************************************************/
+void zone_set_target(zone_table_t *table, uint8_t zone, int16_t target);
+
+
+/******************************************************************************
+ * @brief Records the state an actuator was driven to, as requested by
+ * zone_run() or manually. A manual change also replaces the request.
+ ******************************************************************************/
+void zone_set_actuator(zone_table_t *table, uint8_t actuator, uint8_t on);
+
+
+/******************************************************************************
+ * @brief Drops the requested actuator changes that were not sent yet, used
+ * when the control is switched off.
+ ******************************************************************************/
+void zone_cancel_requests(zone_table_t *table);
+
+
+/******************************************************************************
+ * @brief Output the actuators of a zone are in, heating wins if both kinds
+ * are on.
+ ******************************************************************************/
+control_output_t zone_output(const zone_table_t *table, uint8_t zone);
+
+
+/******************************************************************************
+ * @brief Restarts the control of a zone from the output its actuators are in
+ * and marks it dirty. Used when the actuators were driven manually.
+ ******************************************************************************/
+void zone_reset(zone_table_t *table, uint8_t zone, uint32_t now_s);
+
+
+/******************************************************************************
+ * @brief Runs the control of every dirty zone that has a temperature and
+ * requests its actuators of the kind of the output on and the others off.
+ * Every zone costs a few mask operations whatever its number of actuators.
+ * The dirty marks are cleared.
+ *
+ * @param
+ *  table     Zone table
+ *  now_s     Current time in seconds
+ *
+ * @return
+ *  Number of zones that were run.
+ *
+ ******************************************************************************/
+uint8_t zone_run(zone_table_t *table, uint32_t now_s);
+
+
+#endif /* SRC_ZONE_H_ */
@@ -0,0 +1,41 @@
+/*******************************************************************************
+ * @file    test.h
+ * @brief   Checks of the host tests. A failed check is printed with its file
+ *          and line and counted, the test returns the count from main() so
+ *          make stops on the first test that fails.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TEST_TEST_H_
+#define TEST_TEST_H_
+
+#include <stdio.h>
+
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+  do { \
+      if (!(cond)) { \
+          printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+          g_failures++; \
+      } \
+  } while (0)
+
+#define CHECK_EQ(actual, expected) \
+  do { \
+      long long actual_ = (long long)(actual); \
+      long long expected_ = (long long)(expected); \
+      if (actual_ != expected_) { \
+          printf("%s:%d: check failed: %s is %lld, expected %lld\n", \
+                 __FILE__, __LINE__, #actual, actual_, expected_); \
+          g_failures++; \
+      } \
+  } while (0)
+
+#define TEST_DONE(name) \
+  (printf("%s: %s\n", name, g_failures ? "FAILED" : "passed"), g_failures)
+
+
+#endif /* TEST_TEST_H_ */
@@ -0,0 +1,173 @@
+/*******************************************************************************
+ * @file    test_beacon.c
+ * @brief   Host tests of the status beacon in beacon.c: the round trip of a
+ *          status through the advertising data, negative temperatures, the
+ *          beacon after other AD structures, a wrong company or format byte,
+ *          truncated data and the change counter of the updates.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "beacon.h"
+#include "adparse.h"
+#include "test.h"
+
+
+static const beacon_status_t g_status = {
+    .current = 695,
+    .target = 700,
+    .mode = 1 | BEACON_MODE_AUTO,
+    .on = 0x05,
+    .health = BEACON_HEALTH_CLIENT_LOST
+};
+
+
+/******************************************************************************
+ * @brief Checks that two statuses are the same field by field.
+ ******************************************************************************/
+static void check_status(const beacon_status_t *actual,
+                         const beacon_status_t *expected)
+{
+  CHECK_EQ(actual->current, expected->current);
+  CHECK_EQ(actual->target, expected->target);
+  CHECK_EQ(actual->mode, expected->mode);
+  CHECK_EQ(actual->on, expected->on);
+  CHECK_EQ(actual->health, expected->health);
+}
+
+
+static void test_round_trip(void)
+{
+  uint8_t data[BEACON_DATA_LEN];
+  beacon_status_t status;
+  uint8_t counter = 0;
+
+  CHECK_EQ(beacon_encode(&g_status, 42, data), BEACON_DATA_LEN);
+  CHECK_EQ(data[3], BEACON_DATA_LEN - 4);
+  CHECK_EQ(data[4], AD_TYPE_MANUFACTURER);
+
+  memset(&status, 0, sizeof(status));
+  CHECK_EQ(beacon_decode(data, sizeof(data), &status, &counter), 1);
+  CHECK_EQ(counter, 42);
+  check_status(&status, &g_status);
+}
+
+
+static void test_negative_temperature(void)
+{
+  beacon_status_t in = g_status;
+  beacon_status_t out;
+  uint8_t data[BEACON_DATA_LEN];
+  uint8_t counter;
+
+  in.current = -125;                      // -12.5 F
+  in.target = -1;
+
+  beacon_encode(&in, 0, data);
+  CHECK_EQ(data[9], 0x83);
+  CHECK_EQ(data[10], 0xFF);
+
+  CHECK_EQ(beacon_decode(data, sizeof(data), &out, &counter), 1);
+  check_status(&out, &in);
+}
+
+
+static void test_preceding_structures(void)
+{
+  static const uint8_t name[] = { 6, AD_TYPE_NAME_COMPLETE, 'T', 'h', 'e', 'r', 'm' };
+  // Manufacturer data of another company, the same length as the beacon
+  static const uint8_t other[] = { 12, AD_TYPE_MANUFACTURER, 0x34, 0x12,
+                                   BEACON_TYPE_STATUS, 9, 0, 0, 0, 0, 0, 0, 0 };
+  uint8_t data[sizeof(name) + sizeof(other) + BEACON_DATA_LEN];
+  beacon_status_t status;
+  uint8_t counter = 0;
+
+  memcpy(data, name, sizeof(name));
+  memcpy(data + sizeof(name), other, sizeof(other));
+  beacon_encode(&g_status, 7, data + sizeof(name) + sizeof(other));
+
+  CHECK_EQ(beacon_decode(data, sizeof(data), &status, &counter), 1);
+  CHECK_EQ(counter, 7);
+  check_status(&status, &g_status);
+}
+
+
+static void test_wrong_format(void)
+{
+  uint8_t data[BEACON_DATA_LEN];
+  beacon_status_t status;
+  uint8_t counter;
+
+  beacon_encode(&g_status, 1, data);
+  data[7] = BEACON_TYPE_STATUS + 1;
+  CHECK_EQ(beacon_decode(data, sizeof(data), &status, &counter), 0);
+
+  beacon_encode(&g_status, 1, data);
+  data[5] ^= 0x01;
+  CHECK_EQ(beacon_decode(data, sizeof(data), &status, &counter), 0);
+
+  // A manufacturer structure of another length is not the beacon
+  beacon_encode(&g_status, 1, data);
+  data[3]--;
+  CHECK_EQ(beacon_decode(data, sizeof(data) - 1, &status, &counter), 0);
+}
+
+
+static void test_truncated(void)
+{
+  uint8_t data[BEACON_DATA_LEN];
+  beacon_status_t status;
+  uint8_t counter;
+
+  beacon_encode(&g_status, 1, data);
+
+  // Every cut of the data ends the walk before the beacon is complete
+  for (uint8_t len = 0; len < BEACON_DATA_LEN; len++)
+    CHECK_EQ(beacon_decode(data, len, &status, &counter), 0);
+
+  // An AD length of 0 ends the significant part ahead of the beacon
+  data[0] = 0;
+  CHECK_EQ(beacon_decode(data, sizeof(data), &status, &counter), 0);
+}
+
+
+static void test_update(void)
+{
+  beacon_t beacon;
+  beacon_status_t status = g_status;
+  beacon_status_t decoded;
+  uint8_t counter;
+
+  beacon_init(&beacon);
+  CHECK_EQ(beacon_update(&beacon, &status), 1);
+  CHECK_EQ(beacon.counter, 1);
+
+  // A repeat leaves the data and the counter
+  CHECK_EQ(beacon_update(&beacon, &status), 0);
+  CHECK_EQ(beacon.counter, 1);
+  CHECK_EQ(beacon.unchanged, 1);
+
+  status.on = 0;
+  CHECK_EQ(beacon_update(&beacon, &status), 1);
+  CHECK_EQ(beacon.counter, 2);
+  CHECK_EQ(beacon.updates, 2);
+
+  CHECK_EQ(beacon_decode(beacon.data, sizeof(beacon.data), &decoded, &counter), 1);
+  CHECK_EQ(counter, 2);
+  check_status(&decoded, &status);
+}
+
+
+int main(void)
+{
+  test_round_trip();
+  test_negative_temperature();
+  test_preceding_structures();
+  test_wrong_format();
+  test_truncated();
+  test_update();
+
+  return TEST_DONE("test_beacon");
+}
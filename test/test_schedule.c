@@ -0,0 +1,275 @@
+/*******************************************************************************
+ * @file    test_schedule.c
+ * @brief   Host tests of the weekly schedule in schedule.c: the transition in
+ *          effect and the next one after a load, the wraparound at the end of
+ *          the week, several transitions passed in one poll, edits in the
+ *          middle of an interval, clock jumps and the normalization of the
+ *          table.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "schedule.h"
+#include "test.h"
+
+
+// Sunday Jan 4 1970 00:00 plus whole weeks, so day 0 of the schedule
+#define WEEK_START    (3 * SCHEDULE_DAY_S + 2800 * SCHEDULE_WEEK_S)
+
+#define SUN           (0)
+#define MON           (1)
+#define WED           (3)
+#define SAT           (6)
+
+#define H(hour)       ((hour) * 4)      // Slot of the full hour
+
+
+/******************************************************************************
+ * @brief Local time of a slot on a day of the week under test.
+ ******************************************************************************/
+static uint32_t at(uint8_t day, uint8_t slot)
+{
+  return WEEK_START + day * SCHEDULE_DAY_S + slot * SCHEDULE_SLOT_S;
+}
+
+
+/******************************************************************************
+ * @brief Puts a transition in a packed schedule.
+ ******************************************************************************/
+static void put(uint8_t *data, uint8_t day, uint8_t index, uint8_t slot,
+                uint8_t target)
+{
+  data[(day * SCHEDULE_MAX_PER_DAY + index) * 2] = slot;
+  data[(day * SCHEDULE_MAX_PER_DAY + index) * 2 + 1] = target;
+}
+
+
+static void test_empty(void)
+{
+  schedule_t sched;
+  uint8_t data[SCHEDULE_PACKED_LEN] = { 0 };
+  int16_t target = 72;
+
+  schedule_init(&sched);
+  CHECK_EQ(sched.next_s, SCHEDULE_NEXT_NONE);
+  CHECK_EQ(schedule_poll(&sched, at(WED, H(12)), &target), 0);
+
+  CHECK_EQ(schedule_load(&sched, data, sizeof(data), at(WED, H(12)), &target), 0);
+  CHECK_EQ(target, 72);
+  CHECK_EQ(sched.next_s, SCHEDULE_NEXT_NONE);
+  CHECK_EQ(schedule_next_target(&sched), 0);
+
+  // A wrong length leaves the schedule as it is
+  CHECK(schedule_load(&sched, data, sizeof(data) - 1, at(WED, H(12)), &target) != 0);
+}
+
+
+static void test_sync_mid_week(void)
+{
+  schedule_t sched;
+  uint8_t data[SCHEDULE_PACKED_LEN] = { 0 };
+  int16_t target = 0;
+
+  put(data, MON, 0, H(6), 70);
+  put(data, MON, 1, H(22), 62);
+  put(data, WED, 0, H(6), 71);
+
+  schedule_init(&sched);
+  schedule_load(&sched, data, sizeof(data), at(MON, H(12)), &target);
+
+  CHECK_EQ(target, 70);
+  CHECK_EQ(sched.next_s, at(MON, H(22)));
+  CHECK_EQ(schedule_next_target(&sched), 62);
+
+  // Not due until the next transition, then due exactly at it
+  CHECK_EQ(schedule_poll(&sched, at(MON, H(22)) - 1, &target), 0);
+  CHECK_EQ(target, 70);
+  CHECK_EQ(schedule_poll(&sched, at(MON, H(22)), &target), 1);
+  CHECK_EQ(target, 62);
+  CHECK_EQ(sched.next_s, at(WED, H(6)));
+}
+
+
+static void test_week_wraparound(void)
+{
+  schedule_t sched;
+  uint8_t data[SCHEDULE_PACKED_LEN] = { 0 };
+  int16_t target = 0;
+
+  put(data, SUN, 0, H(6), 68);
+  put(data, SAT, 0, H(22), 60);
+
+  // Saturday night, the next transition is on Sunday of the next week
+  schedule_init(&sched);
+  schedule_load(&sched, data, sizeof(data), at(SAT, H(23)), &target);
+  CHECK_EQ(target, 60);
+  CHECK_EQ(sched.next_s, at(SAT, H(23)) + 7 * 60 * 60);
+
+  CHECK_EQ(schedule_poll(&sched, sched.next_s, &target), 1);
+  CHECK_EQ(target, 68);
+  CHECK_EQ(sched.next_s, at(SAT, H(22)) + SCHEDULE_WEEK_S);
+
+  // Sunday before the first transition, the one in effect is last Saturday's
+  schedule_load(&sched, data, sizeof(data), at(SUN, H(1)), &target);
+  CHECK_EQ(target, 60);
+  CHECK_EQ(sched.next_s, at(SUN, H(6)));
+}
+
+
+static void test_single_transition(void)
+{
+  schedule_t sched;
+  uint8_t data[SCHEDULE_PACKED_LEN] = { 0 };
+  int16_t target = 0;
+
+  put(data, WED, 0, H(8), 66);
+
+  schedule_init(&sched);
+  schedule_load(&sched, data, sizeof(data), at(MON, H(0)), &target);
+  CHECK_EQ(target, 66);
+  CHECK_EQ(sched.next_s, at(WED, H(8)));
+
+  // The only transition comes round once a week
+  CHECK_EQ(schedule_poll(&sched, at(WED, H(8)), &target), 1);
+  CHECK_EQ(sched.next_s, at(WED, H(8)) + SCHEDULE_WEEK_S);
+}
+
+
+static void test_passed_transitions(void)
+{
+  schedule_t sched;
+  uint8_t data[SCHEDULE_PACKED_LEN] = { 0 };
+  int16_t target = 0;
+
+  put(data, MON, 0, H(6), 70);
+  put(data, MON, 1, H(9), 64);
+  put(data, MON, 2, H(17), 71);
+  put(data, MON, 3, H(22), 62);
+
+  schedule_init(&sched);
+  schedule_load(&sched, data, sizeof(data), at(MON, H(0)), &target);
+  CHECK_EQ(target, 62);
+
+  // Three transitions passed in one poll, the last one wins
+  CHECK_EQ(schedule_poll(&sched, at(MON, H(18)), &target), 1);
+  CHECK_EQ(target, 71);
+  CHECK_EQ(sched.next_s, at(MON, H(22)));
+
+  // Passed the end of the week and round to Monday again
+  CHECK_EQ(schedule_poll(&sched, at(MON, H(7)) + SCHEDULE_WEEK_S, &target), 1);
+  CHECK_EQ(target, 70);
+  CHECK_EQ(sched.next_s, at(MON, H(9)) + SCHEDULE_WEEK_S);
+}
+
+
+static void test_mid_interval_edit(void)
+{
+  schedule_t sched;
+  uint8_t data[SCHEDULE_PACKED_LEN] = { 0 };
+  int16_t target = 0;
+  uint32_t now_s = at(MON, H(12));
+
+  put(data, MON, 0, H(6), 70);
+  put(data, MON, 1, H(22), 62);
+
+  schedule_init(&sched);
+  schedule_load(&sched, data, sizeof(data), at(MON, H(6)), &target);
+  CHECK_EQ(schedule_poll(&sched, now_s, &target), 0);
+  CHECK_EQ(target, 70);
+
+  // A transition added between now and the next one becomes the next one
+  put(data, MON, 2, H(15), 68);
+  schedule_load(&sched, data, sizeof(data), now_s, &target);
+  CHECK_EQ(target, 70);
+  CHECK_EQ(sched.next_s, at(MON, H(15)));
+  CHECK_EQ(schedule_next_target(&sched), 68);
+
+  // A transition added before now takes effect right away
+  put(data, MON, 3, H(11), 65);
+  schedule_load(&sched, data, sizeof(data), now_s, &target);
+  CHECK_EQ(target, 65);
+  CHECK_EQ(sched.next_s, at(MON, H(15)));
+
+  // The transition in effect removed, the one before it is in effect again
+  put(data, MON, 3, 0, 0);
+  put(data, MON, 0, 0, 0);
+  schedule_load(&sched, data, sizeof(data), now_s, &target);
+  CHECK_EQ(target, 62);
+  CHECK_EQ(sched.next_s, at(MON, H(15)));
+
+  // The edit is in effect for the following transitions too
+  CHECK_EQ(schedule_poll(&sched, at(MON, H(15)), &target), 1);
+  CHECK_EQ(target, 68);
+  CHECK_EQ(sched.next_s, at(MON, H(22)));
+}
+
+
+static void test_clock_jump(void)
+{
+  schedule_t sched;
+  uint8_t data[SCHEDULE_PACKED_LEN] = { 0 };
+  int16_t target = 0;
+
+  put(data, MON, 0, H(6), 70);
+  put(data, MON, 1, H(22), 62);
+
+  schedule_init(&sched);
+  schedule_load(&sched, data, sizeof(data), at(MON, H(12)), &target);
+
+  // More than a week on, the transitions are looked up again
+  CHECK_EQ(schedule_poll(&sched, at(MON, H(7)) + 3 * SCHEDULE_WEEK_S, &target), 1);
+  CHECK_EQ(target, 70);
+  CHECK_EQ(sched.next_s, at(MON, H(22)) + 3 * SCHEDULE_WEEK_S);
+
+  // Set back by the clock, sync finds the transition in effect then
+  schedule_sync(&sched, at(MON, H(3)), &target);
+  CHECK_EQ(target, 62);
+  CHECK_EQ(sched.next_s, at(MON, H(6)));
+}
+
+
+static void test_normalize(void)
+{
+  schedule_t sched;
+  uint8_t data[SCHEDULE_PACKED_LEN] = { 0 };
+  uint8_t packed[SCHEDULE_PACKED_LEN];
+  int16_t target = 0;
+
+  // Unsorted, a duplicate slot, an invalid slot and an invalid target
+  put(data, WED, 0, H(18), 71);
+  put(data, WED, 1, H(6), 69);
+  put(data, WED, 2, H(18), 72);
+  put(data, WED, 3, SCHEDULE_SLOTS_PER_DAY, 70);
+  put(data, SAT, 0, H(9), SCHEDULE_MAX_TARGET + 1);
+
+  schedule_init(&sched);
+  schedule_load(&sched, data, sizeof(data), at(WED, H(12)), &target);
+  CHECK_EQ(sched.count, 2);
+  CHECK_EQ(target, 69);
+  CHECK_EQ(schedule_next_target(&sched), 72);
+
+  schedule_pack(&sched, packed);
+  CHECK_EQ(packed[(WED * SCHEDULE_MAX_PER_DAY + 0) * 2], H(6));
+  CHECK_EQ(packed[(WED * SCHEDULE_MAX_PER_DAY + 0) * 2 + 1], 69);
+  CHECK_EQ(packed[(WED * SCHEDULE_MAX_PER_DAY + 1) * 2], H(18));
+  CHECK_EQ(packed[(WED * SCHEDULE_MAX_PER_DAY + 1) * 2 + 1], 72);
+  CHECK_EQ(packed[(WED * SCHEDULE_MAX_PER_DAY + 2) * 2 + 1], 0);
+  CHECK_EQ(packed[(SAT * SCHEDULE_MAX_PER_DAY + 0) * 2 + 1], 0);
+}
+
+
+int main(void)
+{
+  test_empty();
+  test_sync_mid_week();
+  test_week_wraparound();
+  test_single_transition();
+  test_passed_transitions();
+  test_mid_interval_edit();
+  test_clock_jump();
+  test_normalize();
+
+  return TEST_DONE("test_schedule");
+}
@@ -0,0 +1,196 @@
+/*******************************************************************************
+ * @file    bcast_bench.c
+ * @brief   Benchmark of the broadcast mode against the connected mode. See
+ *          bcast_bench.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bcast_bench.h"
+#include "bcast.h"
+#include "connparam.h"
+#include "linksched.h"
+#include "phy.h"
+
+
+#define BENCH_IDLE_MS           (CONNPARAM_IDLE_INTERVAL * 5 / 4)
+#define BENCH_ACTIVE_MS         (CONNPARAM_ACTIVE_INTERVAL * 5 / 4)
+#define BENCH_LISTEN_MS         (BENCH_IDLE_MS * (1 + CONNPARAM_IDLE_LATENCY))
+#define BENCH_SYNC_EXT_LEN      (2)       // Extended header of AUX_SYNC_IND
+#define BENCH_EXT_IND_LEN       (7)       // ADV_EXT_IND with the ADI and AuxPtr
+#define BENCH_AUX_ADV_LEN       (22)      // AUX_ADV_IND with the ADI and SyncInfo
+
+
+/******************************************************************************
+ * @brief Linear congruential generator, keeps runs reproducible per seed.
+ ******************************************************************************/
+static uint32_t bench_rand(uint32_t *state)
+{
+  *state = *state * 1664525U + 1013904223U;
+  return *state >> 8;
+}
+
+
+/******************************************************************************
+ * @brief First time from at_ms on of events every period_ms from phase_ms.
+ ******************************************************************************/
+static uint32_t bench_next(uint32_t phase_ms, uint32_t period_ms, uint32_t at_ms)
+{
+  if (phase_ms >= at_ms)
+    return phase_ms;
+
+  return phase_ms + (at_ms - phase_ms + period_ms - 1) / period_ms * period_ms;
+}
+
+
+/******************************************************************************
+ * @brief Adds the latencies of one client of a burst to the result.
+ ******************************************************************************/
+static void bench_add(bcast_bench_result_t *result, uint32_t latency_ms,
+                      uint32_t ack_ms)
+{
+  result->latency_ms_mean += latency_ms;
+  result->ack_ms_mean += ack_ms;
+
+  if (latency_ms > result->latency_ms_max)
+    result->latency_ms_max = latency_ms;
+  if (ack_ms > result->ack_ms_max)
+    result->ack_ms_max = ack_ms;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the connected mode.
+ ******************************************************************************/
+void bcast_bench_connected(uint8_t actuators, uint32_t seed,
+                           bcast_bench_result_t *result)
+{
+  uint32_t rand_state = seed;
+  uint32_t empty_us = phy_packet_us(PHY_1M, 0);
+
+  memset(result, 0, sizeof(bcast_bench_result_t));
+  result->actuators = actuators;
+
+  // The central sends and listens every event, the client every listened one
+  result->server_us_per_s = actuators * (2 * empty_us + BCAST_BENCH_IFS_US) *
+      1000 / BENCH_IDLE_MS;
+  result->client_us_per_s = (2 * empty_us + BCAST_BENCH_IFS_US + BCAST_BENCH_WIDENING_US) *
+      1000 / BENCH_LISTEN_MS;
+
+  for (uint32_t burst = 0; burst < BCAST_BENCH_BURSTS; burst++) {
+      for (uint8_t i = 0; i < actuators; i++) {
+          uint32_t phase_ms = bench_rand(&rand_state) % BENCH_LISTEN_MS;
+          uint32_t ready_ms = (i / LINKSCHED_TX_PER_ROUND) * BENCH_ACTIVE_MS;
+          uint32_t latency_ms = bench_next(phase_ms, BENCH_LISTEN_MS, ready_ms);
+
+          // The confirmation goes out on the next event of the link
+          bench_add(result, latency_ms, latency_ms + BENCH_IDLE_MS);
+          result->commands++;
+      }
+  }
+
+  result->latency_ms_mean /= (uint32_t)BCAST_BENCH_BURSTS * actuators;
+  result->ack_ms_mean /= (uint32_t)BCAST_BENCH_BURSTS * actuators;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the broadcast mode.
+ ******************************************************************************/
+void bcast_bench_broadcast(uint8_t actuators, uint32_t seed,
+                           bcast_bench_result_t *result)
+{
+  uint32_t rand_state = seed;
+  uint8_t frame_len = BCAST_HEADER_LEN + (actuators + 7) / 8 + BCAST_MAC_LEN;
+  uint32_t train_us = phy_packet_us(PHY_1M, BENCH_SYNC_EXT_LEN + frame_len);
+  uint32_t syncinfo_us = 3 * phy_packet_us(PHY_1M, BENCH_EXT_IND_LEN) +
+      phy_packet_us(PHY_1M, BENCH_AUX_ADV_LEN);
+  uint32_t ack_adv_us = 3 * (phy_packet_us(PHY_1M, BCAST_BENCH_ACK_ADV_LEN) +
+      BCAST_BENCH_ADV_LISTEN_US);
+  uint32_t listen_ms = BCAST_BENCH_TRAIN_MS * (1 + BCAST_BENCH_SYNC_SKIP);
+  uint32_t scan_ms_sum = 0;
+
+  memset(result, 0, sizeof(bcast_bench_result_t));
+  result->actuators = actuators;
+
+  // One train for all the actuators, the acks only cost the server on commands
+  result->server_us_per_s = train_us * 1000 / BCAST_BENCH_TRAIN_MS +
+      syncinfo_us * 1000 / BCAST_BENCH_SYNCINFO_MS;
+  result->client_us_per_s = (train_us + BCAST_BENCH_WIDENING_US) * 1000 / listen_ms +
+      ack_adv_us * 1000 / BCAST_BENCH_ACK_ADV_MS;
+
+  for (uint32_t burst = 0; burst < BCAST_BENCH_BURSTS; burst++) {
+      uint32_t train_ms = bench_rand(&rand_state) % BCAST_BENCH_TRAIN_MS;
+      uint32_t last_ack_ms = 0;
+
+      for (uint8_t i = 0; i < actuators; i++) {
+          uint32_t phase_ms = train_ms +
+              (bench_rand(&rand_state) % (1 + BCAST_BENCH_SYNC_SKIP)) * BCAST_BENCH_TRAIN_MS;
+          uint32_t adv_ms = bench_rand(&rand_state) % BCAST_BENCH_ACK_ADV_MS;
+          uint32_t latency_ms = bench_next(phase_ms, listen_ms, 0);
+          uint32_t ack_ms = bench_next(adv_ms, BCAST_BENCH_ACK_ADV_MS, latency_ms);
+
+          // An advertising event falls in a scan window at the duty cycle
+          while (bench_rand(&rand_state) % 100 >= BCAST_BENCH_SCAN_DUTY_PCT)
+            ack_ms += BCAST_BENCH_ACK_ADV_MS;
+
+          bench_add(result, latency_ms, ack_ms);
+          result->commands++;
+          if (ack_ms > BCAST_BENCH_ACK_TIMEOUT_MS)
+            result->fallbacks++;
+          if (ack_ms > last_ack_ms)
+            last_ack_ms = ack_ms;
+      }
+
+      // The scanner runs until the last ack of the burst
+      scan_ms_sum += last_ack_ms * BCAST_BENCH_SCAN_DUTY_PCT / 100;
+  }
+
+  result->latency_ms_mean /= (uint32_t)BCAST_BENCH_BURSTS * actuators;
+  result->ack_ms_mean /= (uint32_t)BCAST_BENCH_BURSTS * actuators;
+  result->scan_ms_mean = scan_ms_sum / BCAST_BENCH_BURSTS;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs both modes over the actuator counts.
+ ******************************************************************************/
+void bcast_bench_report(void)
+{
+  static const uint8_t counts[] = { 2, 4, 8, 16, 32 };
+  bcast_bench_result_t connected;
+  bcast_bench_result_t broadcast;
+
+  for (uint8_t c = 0; c < sizeof(counts); c++) {
+      bcast_bench_connected(counts[c], 1, &connected);
+      bcast_bench_broadcast(counts[c], 1, &broadcast);
+
+      printf("Broadcast bench %u actuators, connected: server %" PRIu32 " us/s, client %" PRIu32 " us/s, latency mean %" PRIu32 " ms max %" PRIu32 " ms, ack mean %" PRIu32 " ms max %" PRIu32 " ms\n",
+               counts[c],
+               connected.server_us_per_s,
+               connected.client_us_per_s,
+               connected.latency_ms_mean,
+               connected.latency_ms_max,
+               connected.ack_ms_mean,
+               connected.ack_ms_max);
+
+      printf("Broadcast bench %u actuators, broadcast: server %" PRIu32 " us/s, client %" PRIu32 " us/s, latency mean %" PRIu32 " ms max %" PRIu32 " ms, ack mean %" PRIu32 " ms max %" PRIu32 " ms, scanner %" PRIu32 " ms per burst, fallbacks %" PRIu32 "/%" PRIu32 "\n",
+               counts[c],
+               broadcast.server_us_per_s,
+               broadcast.client_us_per_s,
+               broadcast.latency_ms_mean,
+               broadcast.latency_ms_max,
+               broadcast.ack_ms_mean,
+               broadcast.ack_ms_max,
+               broadcast.scan_ms_mean,
+               broadcast.fallbacks,
+               broadcast.commands);
+  }
+}
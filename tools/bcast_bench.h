@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * @file    bcast_bench.h
+ * @brief   Benchmark of the broadcast mode against the connected mode for 2
+ *          to 32 actuators on the 1M PHY. In the connected mode every idle
+ *          link has an event each idle interval, the client listens to every
+ *          (1 + latency)th one and a burst of commands is handed to the links
+ *          LINKSCHED_TX_PER_ROUND per round. In the broadcast mode the server
+ *          sends the command table of bcast.h in every AUX_SYNC_IND and the
+ *          SyncInfo in its extended advertising, a client listens to every
+ *          (skip + 1)th train packet and acks in its connectable advertising,
+ *          which the server scanner catches with a given duty cycle. The idle
+ *          radio on time of the server and of one client, the latency of a
+ *          burst of commands to all the actuators, until applied and until
+ *          acknowledged, and the acks missing the timeout are reported. The radio figures are estimates, the
+ *          RAM of the links is not modelled.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_BCAST_BENCH_H_
+#define TOOLS_BCAST_BENCH_H_
+
+#include <stdint.h>
+
+
+#define BCAST_BENCH_BURSTS            (1000)    // Per mode and actuator count
+#define BCAST_BENCH_IFS_US            (150)
+#define BCAST_BENCH_WIDENING_US       (100)     // Window widening of a receiver
+#define BCAST_BENCH_ADV_LISTEN_US     (200)     // After a connectable advertisement
+#define BCAST_BENCH_TRAIN_MS          (300)     // BCAST_INTERVAL in ble.h
+#define BCAST_BENCH_SYNCINFO_MS       (1000)    // BCAST_ADV_INTERVAL in ble.h
+#define BCAST_BENCH_SYNC_SKIP         (4)       // BCAST_SYNC_SKIP of the client
+#define BCAST_BENCH_ACK_ADV_MS        (2000)    // BCAST_ADV_INTERVAL of the client
+#define BCAST_BENCH_ACK_ADV_LEN       (33)      // Address and the data with the ack
+#define BCAST_BENCH_SCAN_DUTY_PCT     (50)      // Server scanner while acks wait
+#define BCAST_BENCH_ACK_TIMEOUT_MS    (15000)   // BCAST_ACK_TIMEOUT_MS in ble.h
+
+
+typedef struct {
+  uint8_t actuators;
+  uint32_t server_us_per_s;       // Radio on time while idle
+  uint32_t client_us_per_s;       // Of one client
+  uint32_t latency_ms_mean;       // From the command until the client applies it
+  uint32_t latency_ms_max;
+  uint32_t ack_ms_mean;           // From the command until the server has the ack
+  uint32_t ack_ms_max;
+  uint32_t scan_ms_mean;          // Server scanner on per burst
+  uint32_t fallbacks;             // Acks missed, the command goes over a link
+  uint32_t commands;
+}bcast_bench_result_t;
+
+
+/******************************************************************************
+ * @brief Runs the bursts of commands in the connected mode. The run only
+ * depends on the seed.
+ *
+ * @param
+ *  actuators   Clients, up to BCAST_MAX_ACTUATORS
+ *  seed        Seed of the phases of the links
+ *  result      Radio on time and latencies
+ *
+ ******************************************************************************/
+void bcast_bench_connected(uint8_t actuators, uint32_t seed,
+                           bcast_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs the bursts of commands in the broadcast mode. The run only
+ * depends on the seed.
+ *
+ * @param
+ *  actuators   Clients, up to BCAST_MAX_ACTUATORS
+ *  seed        Seed of the phases of the train and the clients
+ *  result      Radio on time and latencies
+ *
+ ******************************************************************************/
+void bcast_bench_broadcast(uint8_t actuators, uint32_t seed,
+                           bcast_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs both modes for 2 to 32 actuators and reports them.
+ ******************************************************************************/
+void bcast_bench_report(void);
+
+
+#endif /* TOOLS_BCAST_BENCH_H_ */
@@ -0,0 +1,228 @@
+/*******************************************************************************
+ * @file    connparam_bench.c
+ * @brief   Benchmark of the connection parameter manager. See
+ *          connparam_bench.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "connparam_bench.h"
+#include "connparam.h"
+
+
+#define BENCH_QUEUE     (8)
+
+
+typedef struct {
+  uint32_t interval_ms;
+  uint8_t latency;
+  uint32_t event;                 // Events since the parameters applied
+  uint8_t update_pending;         // Update waiting to be sent to the client
+  uint8_t update_sent;            // Got by the client, waiting for the instant
+  uint32_t instant;
+  connparam_profile_t update;
+  uint8_t count;                  // Commands waiting for the client
+  uint32_t queued_ms[BENCH_QUEUE];
+  uint8_t first[BENCH_QUEUE];     // First command of a burst
+  uint8_t peripheral_tx;          // Confirmation to be sent by the client
+}bench_link_t;
+
+
+/******************************************************************************
+ * @brief Linear congruential generator, keeps runs reproducible per seed.
+ ******************************************************************************/
+static uint32_t bench_rand(uint32_t *state)
+{
+  *state = *state * 1664525U + 1013904223U;
+  return *state >> 8;
+}
+
+
+/******************************************************************************
+ * @brief Starts a parameter update on the simulated link, refused while the
+ * previous one is still on its way like the stack does.
+ ******************************************************************************/
+static uint8_t bench_apply(connparam_profile_t profile, void *ctx)
+{
+  bench_link_t *link = ctx;
+
+  if (link->update_pending || link->update_sent)
+    return 1;
+
+  link->update_pending = 1;
+  link->update = profile;
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief Sets the parameters of a profile on the simulated link.
+ ******************************************************************************/
+static void bench_set_profile(bench_link_t *link, connparam_profile_t profile)
+{
+  if (profile == CONNPARAM_PROFILE_ACTIVE) {
+      link->interval_ms = CONNPARAM_ACTIVE_INTERVAL * 5 / 4;
+      link->latency = CONNPARAM_ACTIVE_LATENCY;
+  }
+  else {
+      link->interval_ms = CONNPARAM_IDLE_INTERVAL * 5 / 4;
+      link->latency = CONNPARAM_IDLE_LATENCY;
+  }
+
+  link->event = 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the link one connection event at a time.
+ ******************************************************************************/
+void connparam_bench_run(connparam_bench_policy_t policy, uint32_t seed,
+                         connparam_bench_result_t *result)
+{
+  bench_link_t link;
+  connparam_t cp;
+  uint32_t rand_state = seed;
+  uint32_t end_ms = CONNPARAM_BENCH_HOURS * 3600000U;
+  uint32_t central_us = 0;
+  uint32_t peripheral_us = 0;
+  uint32_t next_burst_ms = CONNPARAM_BENCH_SETUP_MS;
+  uint32_t next_command_ms = 0;
+  uint8_t left = 0;
+  uint8_t first = 0;
+  uint8_t setup = 1;
+  connparam_apply_t apply = policy == CONNPARAM_BENCH_MANAGED ? bench_apply : NULL;
+
+  memset(result, 0, sizeof(connparam_bench_result_t));
+  memset(&link, 0, sizeof(bench_link_t));
+
+  if (policy == CONNPARAM_BENCH_FIXED) {
+      link.interval_ms = CONNPARAM_BENCH_FIXED_MS;
+      link.latency = CONNPARAM_BENCH_FIXED_LATENCY;
+  }
+  else if (policy == CONNPARAM_BENCH_IDLE) {
+      bench_set_profile(&link, CONNPARAM_PROFILE_IDLE);
+  }
+  else {
+      bench_set_profile(&link, CONNPARAM_PROFILE_ACTIVE);
+  }
+
+  connparam_init(&cp, 0);
+
+  for (uint32_t now_ms = 0; now_ms < end_ms; now_ms += link.interval_ms) {
+      uint8_t listens;
+
+      if (setup && now_ms >= CONNPARAM_BENCH_SETUP_MS) {
+          setup = 0;
+          connparam_release(&cp, CONNPARAM_HOLD_SETUP, now_ms);
+      }
+
+      // Commands since the last event, queued at their own time
+      while (!left && now_ms >= next_burst_ms) {
+          left = 1 + bench_rand(&rand_state) % CONNPARAM_BENCH_BURST_MAX;
+          next_command_ms = next_burst_ms;
+          next_burst_ms += 1000 + bench_rand(&rand_state) % (2 * CONNPARAM_BENCH_BURST_GAP_S * 1000);
+          result->bursts++;
+          first = 1;
+      }
+
+      while (left && now_ms >= next_command_ms && link.count < BENCH_QUEUE) {
+          link.queued_ms[link.count] = next_command_ms;
+          link.first[link.count] = first;
+          link.count++;
+          left--;
+          first = 0;
+          result->commands++;
+          connparam_activity(&cp, next_command_ms, apply, &link);
+          next_command_ms += 1 + bench_rand(&rand_state) % CONNPARAM_BENCH_GAP_MS;
+      }
+
+      connparam_update(&cp, now_ms, apply, &link);
+
+      // The central is on every event, the peripheral skips up to latency
+      listens = link.event % (link.latency + 1) == 0 || link.peripheral_tx;
+
+      central_us += CONNPARAM_BENCH_EVENT_US;
+      if (link.count || link.update_pending)
+        central_us += CONNPARAM_BENCH_PACKET_US;
+
+      if (listens) {
+          peripheral_us += CONNPARAM_BENCH_EVENT_US;
+
+          if (link.peripheral_tx) {
+              peripheral_us += CONNPARAM_BENCH_PACKET_US;
+              link.peripheral_tx = 0;
+          }
+
+          if (link.count || link.update_pending)
+            peripheral_us += CONNPARAM_BENCH_PACKET_US;
+
+          for (uint8_t i = 0; i < link.count; i++) {
+              uint32_t latency_ms = now_ms - link.queued_ms[i];
+
+              result->latency_ms_sum += latency_ms;
+              if (latency_ms > result->latency_ms_max)
+                result->latency_ms_max = latency_ms;
+              if (link.first[i])
+                result->first_ms_sum += latency_ms;
+          }
+
+          if (link.count)
+            link.peripheral_tx = 1;
+          link.count = 0;
+
+          if (link.update_pending) {
+              link.update_pending = 0;
+              link.update_sent = 1;
+              link.instant = link.event + CONNPARAM_BENCH_INSTANT;
+          }
+      }
+
+      // Keeps the microsecond counters from overflowing
+      result->central_ms += central_us / 1000;
+      central_us %= 1000;
+      result->peripheral_ms += peripheral_us / 1000;
+      peripheral_us %= 1000;
+
+      // Both sides listen on the instant, the new parameters start there
+      if (link.update_sent && link.event >= link.instant) {
+          link.update_sent = 0;
+          bench_set_profile(&link, link.update);
+          result->switches++;
+      }
+      else {
+          link.event++;
+      }
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the four policies.
+ ******************************************************************************/
+void connparam_bench_report(void)
+{
+  static const char *policy_names[] = { "fixed 75 ms/4", "active", "idle", "managed" };
+  connparam_bench_result_t result;
+
+  for (uint8_t policy = CONNPARAM_BENCH_FIXED; policy <= CONNPARAM_BENCH_MANAGED; policy++) {
+      connparam_bench_run(policy, 1, &result);
+
+      printf("Link %s, %" PRIu32 " commands in %" PRIu32 " bursts: radio on per hour central %" PRIu32 " ms, peripheral %" PRIu32 " ms, command latency mean/max %" PRIu32 "/%" PRIu32 " ms, first of a burst mean %" PRIu32 " ms, switches %" PRIu32 "\n",
+               policy_names[policy],
+               result.commands,
+               result.bursts,
+               result.central_ms / CONNPARAM_BENCH_HOURS,
+               result.peripheral_ms / CONNPARAM_BENCH_HOURS,
+               result.commands ? result.latency_ms_sum / result.commands : 0,
+               result.latency_ms_max,
+               result.bursts ? result.first_ms_sum / result.bursts : 0,
+               result.switches);
+  }
+}
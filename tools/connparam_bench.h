@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * @file    connparam_bench.h
+ * @brief   Benchmark of the connection parameter manager in connparam.c. A
+ *          client link is run for a day of command bursts, one connection
+ *          event at a time, with the fixed parameters used before, the active
+ *          and the idle profile alone and the manager switching between the
+ *          two. The peripheral only listens on every (latency + 1)th event
+ *          unless it has something to send, a parameter update takes effect
+ *          CONNPARAM_BENCH_INSTANT events after the peripheral got it. The
+ *          radio on time of both sides per hour and the latency from a
+ *          command until the client gets it are reported. The radio time of
+ *          an event is an estimate, packet losses are not modelled.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_CONNPARAM_BENCH_H_
+#define TOOLS_CONNPARAM_BENCH_H_
+
+#include <stdint.h>
+
+
+#define CONNPARAM_BENCH_HOURS         (24)
+#define CONNPARAM_BENCH_SETUP_MS      (4000)    // Bonding and discovery
+#define CONNPARAM_BENCH_BURST_GAP_S   (600)     // Mean time between bursts
+#define CONNPARAM_BENCH_BURST_MAX     (3)       // Commands per burst
+#define CONNPARAM_BENCH_GAP_MS        (2000)    // Max time between commands
+#define CONNPARAM_BENCH_INSTANT       (6)       // Events until an update applies
+#define CONNPARAM_BENCH_FIXED_MS      (75)      // Former fixed parameters
+#define CONNPARAM_BENCH_FIXED_LATENCY (4)
+
+// Estimated radio on time of an empty connection event, with the ramp up and
+// the window widening, and the extra time of a data packet
+#define CONNPARAM_BENCH_EVENT_US      (350)
+#define CONNPARAM_BENCH_PACKET_US     (250)
+
+
+typedef enum {
+  CONNPARAM_BENCH_FIXED,          // Former fixed parameters
+  CONNPARAM_BENCH_ACTIVE,         // Active profile only
+  CONNPARAM_BENCH_IDLE,           // Idle profile only
+  CONNPARAM_BENCH_MANAGED,        // Switched by the manager
+}connparam_bench_policy_t;
+
+
+typedef struct {
+  uint32_t commands;
+  uint32_t central_ms;            // Radio on time over the run
+  uint32_t peripheral_ms;
+  uint32_t latency_ms_sum;        // From a command until the client gets it
+  uint32_t latency_ms_max;
+  uint32_t first_ms_sum;          // Same for the first command of a burst
+  uint32_t bursts;
+  uint32_t switches;
+}connparam_bench_result_t;
+
+
+/******************************************************************************
+ * @brief Runs the link for CONNPARAM_BENCH_HOURS under the given policy. The
+ * run only depends on the seed.
+ *
+ * @param
+ *  policy    Fixed parameters, one profile or the manager
+ *  seed      Seed of the commands
+ *  result    Radio time and command latency
+ *
+ ******************************************************************************/
+void connparam_bench_run(connparam_bench_policy_t policy, uint32_t seed,
+                         connparam_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs the four policies and reports them.
+ ******************************************************************************/
+void connparam_bench_report(void);
+
+
+#endif /* TOOLS_CONNPARAM_BENCH_H_ */
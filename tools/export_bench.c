@@ -0,0 +1,199 @@
+/*******************************************************************************
+ * @file    export_bench.c
+ * @brief   Throughput of the export against GATT notifications. See
+ *          export_bench.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "export_bench.h"
+#include "export.h"
+#include "history.h"
+#include "linksched.h"
+#include "phy.h"
+
+
+#define BENCH_L2CAP_LEN         (4)       // Header of an L2CAP packet
+#define BENCH_ATT_LEN           (3)       // Header of a notification
+#define BENCH_MIC_LEN           (4)
+
+static history_t bench_history;
+
+
+/******************************************************************************
+ * @brief Fills the history with a record per 5 s sample.
+ ******************************************************************************/
+static void bench_fill(void)
+{
+  history_init(&bench_history);
+
+  for (uint32_t i = 0; i < HISTORY_RECORDS; i++)
+    history_add(&bench_history, 5 * i, 0, 0, 68 + i % 8, 70);
+}
+
+
+/******************************************************************************
+ * @brief Sends a packet with data and its empty acknowledgement if the event
+ * has time left for them.
+ *
+ * @return
+ *  Returns 1 if the packet is sent.
+ *
+ ******************************************************************************/
+static uint8_t bench_packet(export_bench_result_t *result, uint8_t phy,
+                            uint32_t *event_us, uint8_t sent, uint8_t peer_packets,
+                            uint16_t len)
+{
+  uint32_t pair_us = phy_packet_us(phy, (uint8_t)(len + BENCH_MIC_LEN)) +
+      phy_packet_us(phy, 0) + 2 * LINKSCHED_IFS_US;
+
+  if ((peer_packets && sent >= peer_packets) || *event_us + pair_us > EXPORT_BENCH_EVENT_US)
+    return 0;
+
+  *event_us += pair_us;
+  result->airtime_us += pair_us - 2 * LINKSCHED_IFS_US;
+  result->packets++;
+
+  return 1;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sends the history as notifications.
+ ******************************************************************************/
+void export_bench_notify(uint8_t phy, uint16_t att_mtu, uint8_t peer_packets,
+                         export_bench_result_t *result)
+{
+  uint32_t left = HISTORY_RECORDS * HISTORY_RECORD_LEN;
+  uint32_t payload = (uint32_t)att_mtu - BENCH_ATT_LEN;
+
+  memset(result, 0, sizeof(export_bench_result_t));
+
+  while (left) {
+      uint32_t event_us = 0;
+      uint8_t sent = 0;
+
+      result->events++;
+
+      while (left) {
+          uint16_t chunk = left < payload ? left : payload;
+
+          if (!bench_packet(result, phy, &event_us, sent, peer_packets,
+                            BENCH_L2CAP_LEN + BENCH_ATT_LEN + chunk))
+            break;
+
+          sent++;
+          left -= chunk;
+          result->bytes += chunk;
+      }
+
+      if (sent)
+        result->us = (result->events - 1) * EXPORT_BENCH_INTERVAL_US + event_us;
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Sends the history over the L2CAP channel.
+ ******************************************************************************/
+void export_bench_coc(uint8_t phy, uint16_t mps, uint8_t peer_packets,
+                      export_bench_result_t *result)
+{
+  static export_chan_t ch;
+  const export_source_t source = {
+      bench_history.records, HISTORY_RECORD_LEN, HISTORY_RECORDS, &bench_history.written
+  };
+  const uint8_t request[EXPORT_REQUEST_LEN] = { EXPORT_REQUEST_LEN - 2, 0, EXPORT_STREAM_HISTORY };
+  const uint8_t *pdu;
+  uint16_t len;
+
+  memset(result, 0, sizeof(export_bench_result_t));
+  export_init(&ch);
+  export_open(&ch, 0x40, EXPORT_BENCH_COC_MTU, mps, EXPORT_BENCH_COC_CREDITS);
+  export_request(&ch, &source, 1, request, sizeof(request));
+
+  // Up to the SDU without records
+  while (ch.request_pending || ch.source != NULL) {
+      uint32_t event_us = 0;
+      uint32_t pdus = ch.pdus;
+      uint8_t sent = 0;
+
+      result->events++;
+
+      while ((len = export_next(&ch, &pdu)) != 0 && len != EXPORT_ABORT) {
+          if (!bench_packet(result, phy, &event_us, sent, peer_packets, BENCH_L2CAP_LEN + len))
+            break;
+
+          export_sent(&ch);
+          sent++;
+      }
+
+      if (len == EXPORT_ABORT)
+        break;
+
+      if (sent)
+        result->us = (result->events - 1) * EXPORT_BENCH_INTERVAL_US + event_us;
+
+      // The credits go back in place of an empty acknowledgement
+      if (ch.pdus != pdus) {
+          result->airtime_us += phy_packet_us(phy, EXPORT_BENCH_CREDIT_LEN + BENCH_MIC_LEN) -
+              phy_packet_us(phy, 0);
+          export_credit(&ch, (uint16_t)(ch.pdus - pdus));
+      }
+  }
+
+  result->bytes = ch.records * HISTORY_RECORD_LEN;
+}
+
+
+/******************************************************************************
+ * @brief Logs a transfer.
+ ******************************************************************************/
+static void bench_log(const char *phy_name, const char *mode, uint8_t peer_packets,
+                      const export_bench_result_t *result)
+{
+  printf("Export bench %s %s, %s: %" PRIu32 " bytes in %" PRIu32 " us over %" PRIu32 " events, %" PRIu32 " bytes/s, %" PRIu32 " packets, airtime %" PRIu32 " us/kB\n",
+           phy_name,
+           mode,
+           peer_packets ? "phone" : "event bound",
+           result->bytes,
+           result->us,
+           result->events,
+           result->us ? (uint32_t)((uint64_t)result->bytes * 1000000 / result->us) : 0,
+           result->packets,
+           result->bytes ? (uint32_t)((uint64_t)result->airtime_us * 1024 / result->bytes) : 0);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the transfers on both PHYs.
+ ******************************************************************************/
+void export_bench_report(void)
+{
+  static const uint8_t phys[] = { PHY_1M, PHY_2M };
+  static const char *phy_names[] = { "1M", "2M" };
+  static const uint8_t limits[] = { 0, EXPORT_BENCH_PHONE_PACKETS };
+  export_bench_result_t result;
+
+  bench_fill();
+
+  for (uint8_t p = 0; p < sizeof(phys); p++) {
+      for (uint8_t l = 0; l < sizeof(limits); l++) {
+          export_bench_notify(phys[p], EXPORT_BENCH_ATT_MTU, limits[l], &result);
+          bench_log(phy_names[p], "notify MTU 23", limits[l], &result);
+
+          export_bench_notify(phys[p], EXPORT_BENCH_ATT_MTU_MAX, limits[l], &result);
+          bench_log(phy_names[p], "notify MTU 243", limits[l], &result);
+
+          export_bench_coc(phys[p], EXPORT_MAX_MPS, limits[l], &result);
+          bench_log(phy_names[p], "L2CAP MPS 243", limits[l], &result);
+      }
+  }
+}
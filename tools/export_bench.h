@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * @file    export_bench.h
+ * @brief   Throughput of the export of export.c against GATT notifications on
+ *          the 1M and 2M PHYs. The whole temperature history is sent to a
+ *          peer on an encrypted link with the data length extension, once as
+ *          notifications of the default ATT MTU, once of the largest MTU a
+ *          link layer packet takes, and once over the L2CAP channel with the
+ *          PDUs given out by export_next(). A connection event sends packets
+ *          with the empty acknowledgement of the peer while the event has
+ *          time left, and up to the packets per event the peer takes if it
+ *          limits them like a phone. On the channel the peer gives back the
+ *          credits used in its last acknowledgement of the event. The time of
+ *          the transfer, the record bytes per second and the airtime per
+ *          kilobyte are reported. The radio figures are estimates, the
+ *          buffers of the stack are not modelled.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_EXPORT_BENCH_H_
+#define TOOLS_EXPORT_BENCH_H_
+
+#include <stdint.h>
+
+
+#define EXPORT_BENCH_INTERVAL_US      (30000)   // Connection interval of a phone
+#define EXPORT_BENCH_EVENT_US         (28750)   // Up to a slot before the next event
+#define EXPORT_BENCH_PHONE_PACKETS    (6)       // Per event, of a phone that limits them
+#define EXPORT_BENCH_ATT_MTU          (23)      // Default
+#define EXPORT_BENCH_ATT_MTU_MAX      (243)     // L2CAP payload of a 251 byte packet with the MIC
+#define EXPORT_BENCH_COC_MTU          (512)     // SDU of the peer
+#define EXPORT_BENCH_COC_CREDITS      (10)      // Of the peer, given back every event
+#define EXPORT_BENCH_CREDIT_LEN       (12)      // L2CAP signaling packet of the credits
+
+
+typedef struct {
+  uint32_t bytes;                 // Of the records delivered
+  uint32_t packets;               // With data
+  uint32_t events;
+  uint32_t us;                    // Up to the acknowledgement of the last packet
+  uint32_t airtime_us;            // Both ways
+}export_bench_result_t;
+
+
+/******************************************************************************
+ * @brief Sends the history as notifications.
+ *
+ * @param
+ *  phy             PHY bit, PHY_1M or PHY_2M
+ *  att_mtu         ATT MTU of the link
+ *  peer_packets    Packets per event the peer takes, 0 without a limit
+ *  result          Transfer
+ *
+ ******************************************************************************/
+void export_bench_notify(uint8_t phy, uint16_t att_mtu, uint8_t peer_packets,
+                         export_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Sends the history over the L2CAP channel of export.c.
+ *
+ * @param
+ *  phy             PHY bit, PHY_1M or PHY_2M
+ *  mps             MPS of the peer
+ *  peer_packets    Packets per event the peer takes, 0 without a limit
+ *  result          Transfer
+ *
+ ******************************************************************************/
+void export_bench_coc(uint8_t phy, uint16_t mps, uint8_t peer_packets,
+                      export_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs the three transfers on both PHYs, with and without the limit of
+ * a phone, and reports them.
+ ******************************************************************************/
+void export_bench_report(void);
+
+
+#endif /* TOOLS_EXPORT_BENCH_H_ */
@@ -0,0 +1,24 @@
+/*******************************************************************************
+ * @file    host_timers.c
+ * @brief   Host build of the time helpers of timers.h used by the server
+ *          modules. timers.c drives the LETIMER and the sleeptimer through
+ *          emlib and is not built on the host, keep these the same as there.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include "timers.h"
+
+
+/*******************************************************************************
+ * Returns the time until a deadline, at least 1 ms.
+ *
+ * @return    Milliseconds to wait
+ *
+ ******************************************************************************/
+uint32_t ms_until(uint32_t deadline_ms, uint32_t now_ms)
+{
+  int32_t wait_ms = (int32_t)(deadline_ms - now_ms);
+
+  return wait_ms < 1 ? 1 : (uint32_t)wait_ms;
+}
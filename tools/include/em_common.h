@@ -0,0 +1,16 @@
+/*******************************************************************************
+ * @file    em_common.h
+ * @brief   Host stand-in for the emlib header pulled in by timers.h, which only
+ *          needs the fixed width integer types from it.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_INCLUDE_EM_COMMON_H_
+#define TOOLS_INCLUDE_EM_COMMON_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+#endif /* TOOLS_INCLUDE_EM_COMMON_H_ */
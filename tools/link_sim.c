@@ -0,0 +1,852 @@
+/*******************************************************************************
+ * @file    link_sim.c
+ * @brief   Model of the boot of the server. See link_sim.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "link_sim.h"
+#include "adparse.h"
+#include "linksched.h"
+#include "connparam.h"
+#include "phy.h"
+
+
+#define LINK_SIM_WHEEL          (128)   // Longer than the advertising interval
+#define LINK_SIM_MAX_DEVICES    (LINK_SIM_MAX_CLIENTS + LINK_SIM_MAX_ADVERTISERS)
+#define LINK_SIM_NONE           (0xFF)
+#define LINK_SIM_ADV_DATA_LEN   (31)    // Legacy advertising data
+
+#if LINK_SIM_WHEEL <= LINK_SIM_ADV_INTERVAL_MS + LINK_SIM_ADV_DELAY_MS
+#error "Timing wheel is shorter than the advertising interval"
+#endif
+
+
+typedef enum {
+  SIM_CLIENT_SCANNING,
+  SIM_CLIENT_CONNECTING,
+  SIM_CLIENT_BONDING,
+  SIM_CLIENT_BONDED,
+}sim_client_state_t;
+
+
+typedef struct {
+  const link_sim_params_t *params;
+  link_sim_result_t *result;
+  uint8_t state[LINK_SIM_MAX_CLIENTS];
+  uint32_t done_ms[LINK_SIM_MAX_CLIENTS];   // End of connecting or bonding
+  uint8_t clients;
+  uint8_t present;                          // Clients switched on
+  uint8_t connecting;                       // Client connecting, LINK_SIM_NONE
+  uint8_t busy;                             // Clients connecting or bonding
+  uint8_t scanning;
+  uint8_t gave_up;
+  uint32_t scan_from_ms;                    // Receives from then on
+  uint8_t known[LINK_SIM_MAX_CLIENTS];      // Provisioned, looked up by address
+}link_sim_t;
+
+
+// Service UUIDs of the AC and the Heater, client_uuids in ble.c
+static const uint8_t sim_client_uuids[][AD_UUID128_LEN] = {
+    {0x00, 0xaa, 0x9b, 0x5f, 0x73, 0xa6, 0x9f, 0x8c,
+     0x6f, 0x4c, 0xf0, 0x7d, 0x4e, 0x81, 0x32, 0x10},
+    {0xe3, 0x2d, 0xd3, 0xdf, 0x8c, 0xf1, 0xd4, 0xbe,
+     0xc5, 0x4c, 0x57, 0xb0, 0x85, 0x54, 0x68, 0x21}
+};
+
+
+/******************************************************************************
+ * @brief Linear congruential generator, keeps runs reproducible per seed.
+ ******************************************************************************/
+static uint32_t sim_rand(uint32_t *state)
+{
+  *state = *state * 1664525U + 1013904223U;
+  return *state >> 8;
+}
+
+
+/******************************************************************************
+ * @brief Appends an AD structure of random bytes to a payload.
+ ******************************************************************************/
+static uint8_t sim_ad_random(uint8_t *data, uint8_t len, uint8_t type,
+                             uint8_t value_len, uint32_t *rand_state)
+{
+  data[len++] = value_len + 1;
+  data[len++] = type;
+
+  for (uint8_t i = 0; i < value_len; i++)
+    data[len++] = (uint8_t)sim_rand(rand_state);
+
+  return len;
+}
+
+
+/******************************************************************************
+ * @brief Builds the advertising data of a device. A client advertises the
+ * flags and the service UUID of its kind, the AC first. The crowd advertises
+ * the flags and one of: manufacturer data of a beacon, a 16 bit UUID list and
+ * a short name, a 128 bit UUID of another service and the TX power, or a name.
+ *
+ * @return
+ *  Length of the data.
+ ******************************************************************************/
+static uint8_t sim_payload(uint16_t device, uint8_t clients, uint8_t *data,
+                           uint32_t *rand_state)
+{
+  uint8_t len = 0;
+
+  data[len++] = 2;
+  data[len++] = AD_TYPE_FLAGS;
+  data[len++] = 0x06;
+
+  if (device < clients) {
+      data[len++] = AD_UUID128_LEN + 1;
+      data[len++] = AD_TYPE_UUID128_COMPLETE;
+      memcpy(&data[len], sim_client_uuids[device % 2], AD_UUID128_LEN);
+      return len + AD_UUID128_LEN;
+  }
+
+  switch (sim_rand(rand_state) % 4)
+  {
+    case 0:
+      len = sim_ad_random(data, len, AD_TYPE_MANUFACTURER, 25, rand_state);
+      break;
+    case 1:
+      len = sim_ad_random(data, len, AD_TYPE_UUID16_COMPLETE,
+                          2 * (1 + sim_rand(rand_state) % 3), rand_state);
+      len = sim_ad_random(data, len, AD_TYPE_NAME_SHORT, 8, rand_state);
+      break;
+    case 2:
+      len = sim_ad_random(data, len, AD_TYPE_UUID128_COMPLETE, AD_UUID128_LEN, rand_state);
+      len = sim_ad_random(data, len, AD_TYPE_TX_POWER, 1, rand_state);
+      break;
+    default:
+      len = sim_ad_random(data, len, AD_TYPE_NAME_COMPLETE,
+                          4 + sim_rand(rand_state) % 17, rand_state);
+      break;
+  }
+
+  return len;
+}
+
+
+/******************************************************************************
+ * @brief Walks the advertising data of an unknown device for a client service
+ * UUID the way provision_client() does, a client found is known from then on.
+ ******************************************************************************/
+static void sim_parse(link_sim_t *sim, uint16_t device, const uint8_t *data,
+                      uint8_t len)
+{
+  ad_iter_t it;
+  uint8_t kind;
+
+  ad_iter_init(&it, data, len);
+  kind = ad_find_uuid128(&it, sim_client_uuids,
+                         sizeof(sim_client_uuids) / sizeof(sim_client_uuids[0]));
+
+  sim->result->parsed++;
+  sim->result->ad_structs += it.visited;
+  sim->result->ad_compares += it.compares;
+  sim->result->parse_ns += it.visited * LINK_SIM_AD_STRUCT_NS +
+      it.compares * LINK_SIM_UUID_COMPARE_NS;
+
+  if (kind && device < sim->clients)
+    sim->known[device] = 1;
+}
+
+
+/******************************************************************************
+ * @brief Checks if a client is left to be found.
+ ******************************************************************************/
+static uint8_t sim_any_scanning(const link_sim_t *sim)
+{
+  for (uint8_t i = 0; i < sim->clients; i++)
+    if (sim->state[i] == SIM_CLIENT_SCANNING)
+      return 1;
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief Starts the scanner the way start_bt_scan() did for the stop on report
+ * policy and does now for the continuous one.
+ ******************************************************************************/
+static void sim_scan_start(link_sim_t *sim, uint32_t now_ms)
+{
+  // The provisioning scans for new clients until its window ends
+  if (sim->scanning || (!sim->params->provision && !sim_any_scanning(sim)))
+    return;
+
+  if (sim->params->policy == LINK_SIM_POLICY_STOP_ON_REPORT) {
+      if (sim->busy)
+        return;
+
+      if (sim->params->scan_limit &&
+          sim->result->scanner_starts == sim->params->scan_limit) {
+          sim->gave_up = 1;
+          return;
+      }
+  }
+
+  sim->scanning = 1;
+  sim->scan_from_ms = now_ms + LINK_SIM_RESTART_MS;
+  sim->result->scanner_starts++;
+}
+
+
+/******************************************************************************
+ * @brief Checks if the scanner receives at the given time.
+ ******************************************************************************/
+static uint8_t sim_scan_receives(const link_sim_t *sim, uint32_t now_ms)
+{
+  return sim->scanning && now_ms >= sim->scan_from_ms &&
+      (now_ms - sim->scan_from_ms) % LINK_SIM_SCAN_INTERVAL_MS < LINK_SIM_SCAN_WINDOW_MS;
+}
+
+
+/******************************************************************************
+ * @brief Handles a scan report of the device the way handle_bt_scanned() did
+ * for the stop on report policy and does now for the continuous one.
+ ******************************************************************************/
+static void sim_scanned(link_sim_t *sim, uint16_t device, uint32_t now_ms)
+{
+  uint8_t is_client = device < sim->clients && sim->state[device] == SIM_CLIENT_SCANNING &&
+      (!sim->params->provision || sim->known[device]);
+
+  if (sim->params->policy == LINK_SIM_POLICY_STOP_ON_REPORT)
+    sim->scanning = 0;
+
+  if (is_client && sim->connecting == LINK_SIM_NONE) {
+      sim->state[device] = SIM_CLIENT_CONNECTING;
+      sim->done_ms[device] = 0;
+      sim->connecting = device;
+      sim->busy++;
+
+      if (!sim->params->provision && !sim_any_scanning(sim))
+        sim->scanning = 0;
+  }
+  else {
+      sim_scan_start(sim, now_ms);
+  }
+}
+
+
+/******************************************************************************
+ * @brief Moves the clients whose connecting or bonding is done.
+ ******************************************************************************/
+static void sim_clients(link_sim_t *sim, uint32_t now_ms)
+{
+  for (uint8_t i = 0; i < sim->clients; i++) {
+      if (sim->done_ms[i] == 0 || sim->done_ms[i] != now_ms)
+        continue;
+
+      if (sim->state[i] == SIM_CLIENT_CONNECTING) {
+          sim->state[i] = SIM_CLIENT_BONDING;
+          sim->done_ms[i] = now_ms + (sim->params->bonded ? LINK_SIM_ENCRYPT_MS : LINK_SIM_BOND_MS);
+          sim->connecting = LINK_SIM_NONE;
+      }
+      else if (sim->state[i] == SIM_CLIENT_BONDING) {
+          sim->state[i] = SIM_CLIENT_BONDED;
+          sim->done_ms[i] = 0;
+          sim->busy--;
+          sim->result->bonded++;
+          sim->result->all_bonded_ms = now_ms;
+
+          // handle_bt_bonded() starts the scanning again
+          sim_scan_start(sim, now_ms);
+      }
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the boot until every client is bonded.
+ ******************************************************************************/
+void link_sim_run(const link_sim_params_t *params, link_sim_result_t *result)
+{
+  // Too large for the stack of the boot context
+  static uint16_t wheel[LINK_SIM_WHEEL];              // First device + 1 per ms
+  static uint16_t next_in_slot[LINK_SIM_MAX_DEVICES]; // Next device + 1
+  static uint8_t payload[LINK_SIM_MAX_DEVICES][LINK_SIM_ADV_DATA_LEN];
+  static uint8_t payload_len[LINK_SIM_MAX_DEVICES];
+  link_sim_t sim;
+  uint32_t rand_state = params->seed;
+  uint16_t devices;
+
+  memset(result, 0, sizeof(link_sim_result_t));
+  memset(&sim, 0, sizeof(link_sim_t));
+  memset(wheel, 0, sizeof(wheel));
+
+  sim.params = params;
+  sim.result = result;
+  sim.clients = params->clients > LINK_SIM_MAX_CLIENTS ? LINK_SIM_MAX_CLIENTS : params->clients;
+  sim.present = params->absent > sim.clients ? 0 : sim.clients - params->absent;
+  sim.connecting = LINK_SIM_NONE;
+  devices = sim.clients + (params->advertisers > LINK_SIM_MAX_ADVERTISERS ?
+      LINK_SIM_MAX_ADVERTISERS : params->advertisers);
+
+  // The clients come first, every device starts at a random phase
+  for (uint16_t i = 0; i < devices; i++) {
+      uint16_t slot = sim_rand(&rand_state) % LINK_SIM_ADV_INTERVAL_MS;
+
+      // Switched off clients never advertise
+      if (i >= sim.present && i < sim.clients)
+        continue;
+
+      if (params->provision)
+        payload_len[i] = sim_payload(i, sim.clients, payload[i], &rand_state);
+
+      next_in_slot[i] = wheel[slot];
+      wheel[slot] = i + 1;
+  }
+
+  sim_scan_start(&sim, 0);
+  sim.scan_from_ms = 0;
+
+  for (uint32_t now = 0; now < LINK_SIM_MAX_MS; now++) {
+      uint16_t slot = now % LINK_SIM_WHEEL;
+      uint16_t list = wheel[slot];
+
+      sim_clients(&sim, now);
+
+      // start_bt_scan() arms the timeout for the continuous policy
+      if (params->policy == LINK_SIM_POLICY_CONTINUOUS && now == LINK_SIM_SCAN_TIMEOUT_MS)
+        sim.scanning = 0;
+
+      // stop_provisioning() stops the scanner with every client bonded
+      if (params->provision && now == LINK_SIM_PROVISION_MS)
+        sim.scanning = 0;
+
+      if ((result->bonded == sim.present && !sim.scanning) || sim.gave_up)
+        break;
+
+      if (sim.scanning)
+        result->scan_ms++;
+
+      wheel[slot] = 0;
+
+      while (list) {
+          uint16_t device = list - 1;
+          uint16_t next_slot = (now + LINK_SIM_ADV_INTERVAL_MS +
+              sim_rand(&rand_state) % (LINK_SIM_ADV_DELAY_MS + 1)) % LINK_SIM_WHEEL;
+
+          list = next_in_slot[device];
+
+          // The clients stop advertising once connected
+          if (device >= sim.clients || sim.state[device] <= SIM_CLIENT_CONNECTING) {
+              next_in_slot[device] = wheel[next_slot];
+              wheel[next_slot] = device + 1;
+          }
+
+          // The initiator catches the next advertisement of the client
+          if (device == sim.connecting && sim.done_ms[device] == 0)
+            sim.done_ms[device] = now + LINK_SIM_CONNECT_MS;
+
+          if (!sim_scan_receives(&sim, now))
+            continue;
+
+          if (params->accept_list && device >= sim.clients) {
+              result->filtered++;
+              continue;
+          }
+
+          result->reports++;
+          result->cpu_us += LINK_SIM_REPORT_US;
+
+          // Known clients are found by address, the rest is parsed
+          if (params->provision && (device >= sim.clients || !sim.known[device]))
+            sim_parse(&sim, device, payload[device], payload_len[device]);
+
+          sim_scanned(&sim, device, now);
+      }
+  }
+
+  if (result->bonded != sim.present)
+    result->all_bonded_ms = 0;
+}
+
+
+/******************************************************************************
+ * @brief Counts the pairs of links whose events overlap, the events of link i
+ * start at offsets[i] in every interval and last slot_us.
+ ******************************************************************************/
+static uint8_t sim_collisions(const uint32_t *offsets, uint8_t links,
+                              uint32_t slot_us, uint32_t interval_us)
+{
+  uint8_t collisions = 0;
+
+  for (uint8_t i = 0; i < links; i++) {
+      for (uint8_t j = i + 1; j < links; j++) {
+          uint32_t gap_us = (offsets[j] + interval_us - offsets[i]) % interval_us;
+
+          if (gap_us < slot_us || interval_us - gap_us < slot_us)
+            collisions++;
+      }
+  }
+
+  return collisions;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs command bursts over the link schedule.
+ ******************************************************************************/
+void link_sim_capacity(uint8_t links, uint8_t phy, uint8_t idle, uint32_t seed,
+                       link_sim_capacity_t *result)
+{
+  linksched_t ls;
+  uint32_t offsets[LINK_SIM_MAX_CLIENTS];
+  uint32_t listen_us[LINK_SIM_MAX_CLIENTS];     // First listened event
+  uint64_t link_us_sum[LINK_SIM_MAX_CLIENTS];
+  uint32_t link_commands[LINK_SIM_MAX_CLIENTS];
+  uint32_t rand_state = seed;
+  uint32_t slot_us = linksched_slot_us(phy);
+  uint32_t interval_us;
+  uint32_t period_us;
+
+  memset(result, 0, sizeof(link_sim_capacity_t));
+  memset(link_us_sum, 0, sizeof(link_us_sum));
+  memset(link_commands, 0, sizeof(link_commands));
+  memset(offsets, 0, sizeof(offsets));
+
+  if (links > LINK_SIM_MAX_CLIENTS)
+    links = LINK_SIM_MAX_CLIENTS;
+
+  // The former links all ran the active interval, the stack placing their
+  // events back to back
+  for (uint8_t i = 0; i < links; i++)
+    offsets[i] = (i * slot_us) % (CONNPARAM_ACTIVE_INTERVAL * 1250);
+  result->fixed_collisions = sim_collisions(offsets, links, slot_us,
+                                            CONNPARAM_ACTIVE_INTERVAL * 1250);
+
+  linksched_init(&ls);
+  linksched_plan(&ls, links, links * slot_us);
+  interval_us = ls.interval * 1250;
+
+  // The slots of the plan follow the reserve
+  for (uint8_t i = 0; i < links; i++)
+    offsets[i] = (LINKSCHED_RESERVE_US + i * slot_us) % interval_us;
+
+  result->interval = ls.interval;
+  result->fits = ls.fits;
+  result->collisions = sim_collisions(offsets, links, slot_us, interval_us);
+  result->radio_pm = idle ? linksched_utilisation_pm(&ls, 0, links * slot_us) :
+      linksched_utilisation_pm(&ls, links * slot_us, 0);
+  result->bound_ms = linksched_worst_latency_ms(&ls, idle, idle ? CONNPARAM_IDLE_LATENCY : 0);
+
+  // An idle peripheral listens to one event in 1 + latency, at its own phase
+  period_us = idle ? ls.idle_interval * 1250 * (1 + CONNPARAM_IDLE_LATENCY) : interval_us;
+  for (uint8_t i = 0; i < links; i++)
+    listen_us[i] = offsets[i] + (idle ? (sim_rand(&rand_state) % (1 + CONNPARAM_IDLE_LATENCY)) *
+        ls.idle_interval * 1250 : 0);
+
+  for (uint32_t burst = 0; burst < LINK_SIM_BURSTS; burst++) {
+      uint32_t burst_us = sim_rand(&rand_state) % period_us + period_us;
+      uint32_t round_us = burst_us;
+
+      for (uint8_t i = 0; i < links; i++)
+        if (sim_rand(&rand_state) & 1)
+          linksched_mark(&ls, i);
+
+      // service_links() every interval until the burst is handed over
+      while (ls.pending) {
+          for (uint8_t n = 0; n < LINKSCHED_TX_PER_ROUND; n++) {
+              uint8_t link = linksched_next(&ls);
+              uint32_t event_us;
+              uint32_t latency_us;
+
+              if (link == LINKSCHED_NONE)
+                break;
+
+              // Next listened event of the link from the round on
+              event_us = listen_us[link] + ((round_us - listen_us[link] + period_us - 1) / period_us) * period_us;
+              latency_us = event_us - burst_us;
+
+              result->commands++;
+              result->latency_us_sum += latency_us;
+              if (latency_us > result->latency_us_max)
+                result->latency_us_max = latency_us;
+              link_us_sum[link] += latency_us;
+              link_commands[link]++;
+          }
+
+          round_us += interval_us;
+      }
+  }
+
+  result->link_mean_us_min = 0xFFFFFFFF;
+  for (uint8_t i = 0; i < links; i++) {
+      uint32_t mean_us = link_commands[i] ? (uint32_t)(link_us_sum[i] / link_commands[i]) : 0;
+
+      if (mean_us < result->link_mean_us_min)
+        result->link_mean_us_min = mean_us;
+      if (mean_us > result->link_mean_us_max)
+        result->link_mean_us_max = mean_us;
+  }
+}
+
+
+/******************************************************************************
+ * @brief Sleeptimer reading of a clock in us at a time of the model, the
+ * clock runs ppm fast and reads offset_us at time 0.
+ ******************************************************************************/
+static uint32_t sim_clock_us(uint64_t now_us, int32_t ppm, uint32_t offset_us)
+{
+  uint64_t local_us = now_us + now_us * ppm / 1000000 + offset_us;
+  uint64_t ticks = local_us * 32768 / 1000000;
+
+  return (uint32_t)(ticks * 1000000 / 32768);
+}
+
+
+/******************************************************************************
+ * @brief First event of a link from a time on that its peripheral listens to,
+ * one in every events from phase on, the anchor at time 0.
+ ******************************************************************************/
+static uint64_t sim_next_event_us(uint64_t now_us, uint32_t interval_us,
+                                  uint8_t every, uint8_t phase)
+{
+  uint64_t k = (now_us + interval_us - 1) / interval_us;
+
+  k += (phase + every - k % every) % every;
+
+  return k * interval_us;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the latency probe over one link.
+ ******************************************************************************/
+void link_sim_probe(uint8_t phy, uint8_t idle, uint32_t seed, link_sim_probe_t *result)
+{
+  linksched_t ls;
+  uint32_t rand_state = seed;
+  uint32_t interval_us;
+  uint32_t client_offset_us;
+  uint64_t down_us_sum = 0, up_us_sum = 0;
+  uint64_t sync_error_us_sum = 0;
+  uint8_t every;
+  uint8_t phase;
+
+  memset(result, 0, sizeof(link_sim_probe_t));
+  probe_init(&result->probe);
+  timesync_init(&result->sync);
+
+  linksched_init(&ls);
+  linksched_plan(&ls, 1, linksched_slot_us(phy));
+
+  result->interval = idle ? ls.idle_interval : ls.interval;
+  result->latency = idle ? CONNPARAM_IDLE_LATENCY : CONNPARAM_ACTIVE_LATENCY;
+  interval_us = result->interval * 1250;
+  every = result->latency + 1;
+  phase = sim_rand(&rand_state) % every;
+  client_offset_us = sim_rand(&rand_state) * 97;
+
+  for (uint32_t n = 0; n < LINK_SIM_PROBE_PINGS; n++) {
+      // The probe timer and the connection events are not locked
+      uint64_t ping_us = (uint64_t)n * LINK_SIM_PROBE_PERIOD_MS * 1000 +
+          sim_rand(&rand_state) % interval_us;
+      uint64_t event_us, rx_us, echo_us, taken_us;
+      uint8_t ping[PROBE_PING_LEN];
+      uint8_t echo[PROBE_ECHO_LEN];
+      uint8_t record[TIMESYNC_RECORD_LEN];
+      uint32_t t1, t2, t3, t4;
+      uint32_t true_offset_us;
+      int32_t offset_error_us;
+
+      t1 = sim_clock_us(ping_us, 0, 0);
+      probe_ping(&result->probe, t1, ping);
+      timesync_pack(&result->sync, ping_us, record);
+
+      // Down at an event the peripheral listens to, again at its next one
+      event_us = sim_next_event_us(ping_us + LINK_SIM_STACK_US, interval_us, every, phase);
+      while (sim_rand(&rand_state) % 1000 < LINK_SIM_PROBE_PER_PM)
+        event_us += (uint64_t)every * interval_us;
+      rx_us = event_us + phy_packet_us(phy, TIMESYNC_PING_PDU_LEN) + LINK_SIM_EVENT_CPU_US +
+          sim_rand(&rand_state) % LINK_SIM_CPU_JITTER_US;
+
+      // Up at the next event, a peripheral with data does not skip one
+      echo_us = rx_us + LINK_SIM_ECHO_CPU_US;
+      event_us = sim_next_event_us(echo_us + LINK_SIM_STACK_US, interval_us, 1, 0);
+      while (sim_rand(&rand_state) % 1000 < LINK_SIM_PROBE_PER_PM)
+        event_us += interval_us;
+      taken_us = event_us + phy_packet_us(phy, 0) + LINKSCHED_IFS_US +
+          phy_packet_us(phy, TIMESYNC_ECHO_PDU_LEN) + LINK_SIM_EVENT_CPU_US +
+          sim_rand(&rand_state) % LINK_SIM_CPU_JITTER_US;
+
+      t2 = sim_clock_us(rx_us, LINK_SIM_PROBE_PPM, client_offset_us);
+      t3 = sim_clock_us(echo_us, LINK_SIM_PROBE_PPM, client_offset_us);
+      t4 = sim_clock_us(taken_us, 0, 0);
+
+      // The client stamps by the estimate of the ping until the next one
+      if (record[0]) {
+          uint64_t check_us = rx_us + LINK_SIM_PROBE_PERIOD_MS * 500;
+          int32_t sync_error_us = (int32_t)(timesync_server_us(&result->sync,
+                                                               sim_clock_us(check_us, LINK_SIM_PROBE_PPM, client_offset_us)) -
+                                            sim_clock_us(check_us, 0, 0));
+
+          if (sync_error_us < 0)
+            sync_error_us = -sync_error_us;
+          sync_error_us_sum += sync_error_us;
+          result->sync_checks++;
+          if ((uint32_t)sync_error_us > result->sync_error_us_max)
+            result->sync_error_us_max = sync_error_us;
+      }
+
+      memcpy(echo, ping, PROBE_PING_LEN);
+      for (uint8_t i = 0; i < 4; i++) {
+          echo[5 + i] = (uint8_t)(t2 >> (8 * i));
+          echo[9 + i] = (uint8_t)(t3 >> (8 * i));
+      }
+
+      if (probe_echo(&result->probe, echo, sizeof(echo), t4))
+        timesync_exchange(&result->sync, phy, interval_us, result->probe.times_us);
+
+      down_us_sum += rx_us - ping_us;
+      up_us_sum += taken_us - echo_us;
+
+      true_offset_us = sim_clock_us(rx_us, LINK_SIM_PROBE_PPM, client_offset_us) -
+          sim_clock_us(rx_us, 0, 0);
+      offset_error_us = (int32_t)(result->probe.offset_us - true_offset_us);
+      if (offset_error_us < 0)
+        offset_error_us = -offset_error_us;
+      if ((uint32_t)offset_error_us > result->offset_error_us_max)
+        result->offset_error_us_max = offset_error_us;
+  }
+
+  result->down_us_mean = (uint32_t)(down_us_sum / LINK_SIM_PROBE_PINGS);
+  result->up_us_mean = (uint32_t)(up_us_sum / LINK_SIM_PROBE_PINGS);
+  if (result->sync_checks)
+    result->sync_error_us_mean = (uint32_t)(sync_error_us_sum / result->sync_checks);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs 2, 4 and 8 clients among 0 to 250 unrelated advertisers.
+ ******************************************************************************/
+void link_sim_report(void)
+{
+  static const uint8_t client_counts[] = { 2, 4, 8 };
+  static const uint16_t advertiser_counts[] = { 0, 25, 100, 250 };
+  static const link_sim_params_t cases[] = {
+      { LINK_SIM_POLICY_STOP_ON_REPORT, 0, 0, 0, LINK_SIM_SCAN_LIMIT, 0, 0, 0, 0 },
+      { LINK_SIM_POLICY_STOP_ON_REPORT, 0, 0, 0, 0, 0, 0, 0, 0 },
+      { LINK_SIM_POLICY_CONTINUOUS, 0, 0, 0, 0, 0, 0, 0, 0 },
+  };
+  static const char *case_names[] = {
+      "stop on report", "stop on report without limit", "continuous",
+  };
+
+  for (uint8_t c = 0; c < sizeof(client_counts); c++) {
+      for (uint8_t a = 0; a < sizeof(advertiser_counts) / sizeof(advertiser_counts[0]); a++) {
+          for (uint8_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+              link_sim_params_t params = cases[k];
+              link_sim_result_t result;
+              uint32_t bonded_ms = 0, starts = 0, reports = 0;
+              uint8_t done = 0;
+
+              params.clients = client_counts[c];
+              params.advertisers = advertiser_counts[a];
+
+              for (uint8_t run = 0; run < LINK_SIM_RUNS; run++) {
+                  params.seed = run + 1;
+                  link_sim_run(&params, &result);
+
+                  starts += result.scanner_starts;
+                  reports += result.reports;
+                  if (result.all_bonded_ms) {
+                      bonded_ms += result.all_bonded_ms;
+                      done++;
+                  }
+              }
+
+              printf("Link %u clients, %u advertisers, %s: all bonded in %u/%u runs, mean %" PRIu32 " ms, %" PRIu32 " scanner starts, %" PRIu32 " reports\n",
+                       client_counts[c],
+                       advertiser_counts[a],
+                       case_names[k],
+                       done,
+                       LINK_SIM_RUNS,
+                       done ? bonded_ms / done : 0,
+                       starts / LINK_SIM_RUNS,
+                       reports / LINK_SIM_RUNS);
+          }
+      }
+  }
+
+  // One client switched off keeps the scanner on until the timeout
+  for (uint8_t a = 0; a < sizeof(advertiser_counts) / sizeof(advertiser_counts[0]); a++) {
+      for (uint8_t accept_list = 0; accept_list < 2; accept_list++) {
+          link_sim_params_t params = cases[2];
+          link_sim_result_t result;
+          uint32_t reports = 0, filtered = 0, cpu_us = 0, scan_ms = 0;
+
+          params.clients = LINK_SIM_MAX_CLIENTS;
+          params.advertisers = advertiser_counts[a];
+          params.absent = 1;
+          params.accept_list = accept_list;
+
+          for (uint8_t run = 0; run < LINK_SIM_RUNS; run++) {
+              params.seed = run + 1;
+              link_sim_run(&params, &result);
+
+              reports += result.reports;
+              filtered += result.filtered;
+              cpu_us += result.cpu_us;
+              scan_ms += result.scan_ms;
+          }
+
+          // Per minute of scanning, scan_ms is at least the timeout
+          printf("Link %u advertisers, accept list %s: %" PRIu32 " scan reports per minute, %" PRIu32 " filtered, CPU %" PRIu32 " ms per minute\n",
+                   advertiser_counts[a],
+                   accept_list ? "on" : "off",
+                   (uint32_t)((uint64_t)reports * 60000 / scan_ms),
+                   (uint32_t)((uint64_t)filtered * 60000 / scan_ms),
+                   (uint32_t)((uint64_t)cpu_us * 60 / scan_ms));
+      }
+  }
+
+  // A lost client advertises again and is found, connected and secured
+  for (uint8_t a = 0; a < sizeof(advertiser_counts) / sizeof(advertiser_counts[0]); a++) {
+      for (uint8_t bonded = 0; bonded < 2; bonded++) {
+          link_sim_params_t params = cases[2];
+          link_sim_result_t result;
+          uint32_t bonded_ms = 0;
+
+          params.clients = 1;
+          params.advertisers = advertiser_counts[a];
+          params.accept_list = 1;
+          params.bonded = bonded;
+
+          for (uint8_t run = 0; run < LINK_SIM_RUNS; run++) {
+              params.seed = run + 1;
+              link_sim_run(&params, &result);
+              bonded_ms += result.all_bonded_ms;
+          }
+
+          printf("Link %u advertisers, reconnect %s: controllable %" PRIu32 " ms after the link loss\n",
+                   advertiser_counts[a],
+                   bonded ? "from the stored bonding" : "with pairing",
+                   bonded_ms / LINK_SIM_RUNS);
+      }
+  }
+
+  // An AC and a Heater are learned from their service UUIDs
+  for (uint8_t a = 0; a < sizeof(advertiser_counts) / sizeof(advertiser_counts[0]); a++) {
+      link_sim_params_t params = cases[2];
+      link_sim_result_t result;
+      uint32_t bonded_ms = 0, parsed = 0, structs = 0, compares = 0;
+      uint32_t parse_ns = 0, cpu_us = 0, scan_ms = 0;
+      uint8_t done = 0;
+
+      params.clients = 2;
+      params.advertisers = advertiser_counts[a];
+      params.provision = 1;
+
+      for (uint8_t run = 0; run < LINK_SIM_RUNS; run++) {
+          params.seed = run + 1;
+          link_sim_run(&params, &result);
+
+          parsed += result.parsed;
+          structs += result.ad_structs;
+          compares += result.ad_compares;
+          parse_ns += result.parse_ns;
+          cpu_us += result.cpu_us;
+          scan_ms += result.scan_ms;
+          if (result.all_bonded_ms) {
+              bonded_ms += result.all_bonded_ms;
+              done++;
+          }
+      }
+
+      printf("Link %u advertisers, provisioning: all bonded in %u/%u runs, mean %" PRIu32 " ms, %" PRIu32 " reports parsed per minute, %" PRIu32 " AD structures and %" PRIu32 " UUID compares per 100 reports, parse %" PRIu32 " ns per report, CPU %" PRIu32 " ms per minute\n",
+               advertiser_counts[a],
+               done,
+               LINK_SIM_RUNS,
+               done ? bonded_ms / done : 0,
+               (uint32_t)((uint64_t)parsed * 60000 / scan_ms),
+               parsed ? (uint32_t)((uint64_t)structs * 100 / parsed) : 0,
+               parsed ? (uint32_t)((uint64_t)compares * 100 / parsed) : 0,
+               parsed ? parse_ns / parsed : 0,
+               (uint32_t)(((uint64_t)cpu_us * 1000 + parse_ns) * 60 / scan_ms / 1000));
+  }
+
+  // The links of 2, 4 and 8 actuators, all active and all idle
+  for (uint8_t c = 0; c < sizeof(client_counts); c++) {
+      static const uint8_t phys[] = { PHY_1M, PHY_CODED };
+
+      for (uint8_t p = 0; p < sizeof(phys); p++) {
+          for (uint8_t idle = 0; idle < 2; idle++) {
+              link_sim_capacity_t cap;
+
+              link_sim_capacity(client_counts[c], phys[p], idle, 1, &cap);
+
+              printf("Link capacity %u links on PHY %u %s: interval %u%s, collisions %u (fixed interval %u), radio %" PRIu32 ".%" PRIu32 "%%, command latency mean %" PRIu32 " ms max %" PRIu32 " ms bound %" PRIu32 " ms, link means %" PRIu32 "..%" PRIu32 " ms\n",
+                       client_counts[c],
+                       phys[p],
+                       idle ? "idle" : "active",
+                       cap.interval,
+                       cap.fits ? "" : " overbooked",
+                       cap.collisions,
+                       cap.fixed_collisions,
+                       cap.radio_pm / 10,
+                       cap.radio_pm % 10,
+                       cap.commands ? (uint32_t)(cap.latency_us_sum / cap.commands / 1000) : 0,
+                       cap.latency_us_max / 1000,
+                       cap.bound_ms,
+                       cap.link_mean_us_min / 1000,
+                       cap.link_mean_us_max / 1000);
+          }
+      }
+  }
+
+  // The latency probe of one link against the latencies of the model
+  for (uint8_t p = 0; p < 2; p++) {
+      static const uint8_t phys[] = { PHY_1M, PHY_CODED };
+
+      for (uint8_t idle = 0; idle < 2; idle++) {
+          link_sim_probe_t sim;
+          const probe_t *probe = &sim.probe;
+
+          link_sim_probe(phys[p], idle, 1, &sim);
+
+          printf("Link probe PHY %u %s, interval %u latency %u: echoes %" PRIu32 ", rtt mean %" PRIu32 " us p90 %" PRIu32 " max %" PRIu32 ", down %" PRIu32 " us (model %" PRIu32 "), up %" PRIu32 " us (model %" PRIu32 "), offset error max %" PRIu32 " us\n",
+                   phys[p],
+                   idle ? "idle" : "active",
+                   sim.interval,
+                   sim.latency,
+                   probe->echoes,
+                   probe_dist_mean_us(&probe->rtt),
+                   probe_dist_percentile_us(&probe->rtt, 90),
+                   probe->rtt.max_us,
+                   probe_dist_mean_us(&probe->down),
+                   sim.down_us_mean,
+                   probe_dist_mean_us(&probe->up),
+                   sim.up_us_mean,
+                   sim.offset_error_us_max);
+          printf("Link sync PHY %u %s: error mean %" PRIu32 " us max %" PRIu32 " over %" PRIu32 " estimates, %" PRIu32 " samples dropped %" PRIu32 " invalid %" PRIu32 ", drift %" PRId32 " ppm/65536, air %" PRIu32 " us per exchange (%" PRIu32 " us for the sync record), %" PRIu32 " ppm of the radio time\n",
+                   phys[p],
+                   idle ? "idle" : "active",
+                   sim.sync_error_us_mean,
+                   sim.sync_error_us_max,
+                   sim.sync_checks,
+                   sim.sync.samples,
+                   sim.sync.dropped,
+                   sim.sync.invalid,
+                   sim.sync.drift_q16,
+                   phy_transaction_us(phys[p], TIMESYNC_PING_PDU_LEN, TIMESYNC_ECHO_PDU_LEN),
+                   phy_packet_us(phys[p], TIMESYNC_PING_PDU_LEN) -
+                   phy_packet_us(phys[p], TIMESYNC_PING_PDU_LEN - TIMESYNC_RECORD_LEN),
+                   phy_transaction_us(phys[p], TIMESYNC_PING_PDU_LEN, TIMESYNC_ECHO_PDU_LEN) * 1000 /
+                   LINK_SIM_PROBE_PERIOD_MS);
+      }
+  }
+}
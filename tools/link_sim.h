@@ -0,0 +1,207 @@
+/*******************************************************************************
+ * @file    link_sim.h
+ * @brief   Model of the boot of the server for evaluating the scanning. The
+ *          clients and a crowd of unrelated devices advertise, the scanner
+ *          reports the advertisements falling in its scan windows and the
+ *          clients are connected and bonded. Run in virtual time with a 1 ms
+ *          step, the time from boot until every client is bonded is measured
+ *          for the scanner stopped on every report, as done before, and for
+ *          the scanner kept running while the clients connect and bond.
+ *          With a client switched off the scanner runs until its timeout, the
+ *          scan reports reaching the application and their CPU time are
+ *          measured with and without the accept list filtering in the
+ *          controller. The reconnect of a client after a link loss is run
+ *          with a full pairing and with the encryption from a stored bonding.
+ *          In the provisioning case no client is known, every device carries
+ *          advertising data, the clients their service UUID and the crowd a
+ *          mix of flags, manufacturer data, 16 and 128 bit UUID lists and
+ *          names. Every report reaching the application from an unknown
+ *          device is walked with the AD iterator in adparse.c, the time until
+ *          the clients are bonded and the structures and UUID compares per
+ *          report are measured. Packet collisions and the radio time of the
+ *          connections are not modelled in the boot. The capacity case lays
+ *          out the connection events of 2, 4 and 8 links in one interval,
+ *          with the schedule of linksched.c and with the former fixed 30 ms
+ *          interval, counts the overlapping events and runs bursts of
+ *          commands through the round robin of the schedule to the next event
+ *          of every link that its peripheral listens to. The probe case runs
+ *          the latency probe of probe.c over the connection events of one
+ *          link, the client clock drifting against the server's and both read
+ *          at the resolution of the sleeptimer, and sets the latencies the
+ *          probe reports beside the ones of the model. The same exchanges
+ *          feed the time sync of timesync.c, its error is taken as the client
+ *          would see it, half a probe period after each estimate is sent.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_LINK_SIM_H_
+#define TOOLS_LINK_SIM_H_
+
+#include <stdint.h>
+
+#include "probe.h"
+#include "timesync.h"
+
+
+#define LINK_SIM_MAX_CLIENTS          (8)
+#define LINK_SIM_MAX_ADVERTISERS      (250)
+#define LINK_SIM_MAX_MS               (120000)
+#define LINK_SIM_RUNS                 (5)       // Seeds per case
+
+#define LINK_SIM_ADV_INTERVAL_MS      (100)     // Plus the random advDelay
+#define LINK_SIM_ADV_DELAY_MS         (10)
+#define LINK_SIM_SCAN_INTERVAL_MS     (50)      // SCANSCHED_FAST_INTERVAL
+#define LINK_SIM_SCAN_WINDOW_MS       (25)      // SCANSCHED_FAST_WINDOW
+#define LINK_SIM_RESTART_MS           (2)       // Scanner stop and start round
+#define LINK_SIM_CONNECT_MS           (30)      // From the next advertisement
+#define LINK_SIM_BOND_MS              (1500)    // Pairing and passkey confirm
+#define LINK_SIM_ENCRYPT_MS           (300)     // From the stored keys
+#define LINK_SIM_SCAN_LIMIT           (50)      // Former MAX_SESSION_SCANS
+#define LINK_SIM_SCAN_TIMEOUT_MS      (60000)   // Former SCAN_TIMEOUT_S in ble.h
+#define LINK_SIM_PROVISION_MS         (60000)   // PROVISION_WINDOW_S in ble.h
+
+// Estimated CPU time of a scan report reaching the application: wake up from
+// EM2, stack event and handle_bt_scanned()
+#define LINK_SIM_REPORT_US            (120)
+
+// Estimated CPU time of the AD iterator at 38.4 MHz: bounds and type checks of
+// a structure, and a 16 byte compare mostly ending on its first bytes
+#define LINK_SIM_AD_STRUCT_NS         (250)
+#define LINK_SIM_UUID_COMPARE_NS      (500)
+
+#define LINK_SIM_BURSTS               (500)     // Command bursts per capacity case
+
+#define LINK_SIM_PROBE_PINGS          (500)     // Pings per probe case
+#define LINK_SIM_PROBE_PERIOD_MS      (5000)    // PROBE_PERIOD_MS in ble.h
+#define LINK_SIM_PROBE_PPM            (40)      // Client clock fast against the server's
+#define LINK_SIM_PROBE_PER_PM         (20)      // Packets lost per mille, sent again
+#define LINK_SIM_STACK_US             (100)     // Queued to the link layer
+#define LINK_SIM_EVENT_CPU_US         (250)     // Packet received to the application
+#define LINK_SIM_CPU_JITTER_US        (60)      // Added at random to it on each side
+#define LINK_SIM_ECHO_CPU_US          (150)     // Ping taken to echo written
+
+
+typedef enum {
+  LINK_SIM_POLICY_STOP_ON_REPORT,   // Stopped on every report, idle until bonded
+  LINK_SIM_POLICY_CONTINUOUS,       // Runs until every client is found
+}link_sim_policy_t;
+
+
+typedef struct {
+  link_sim_policy_t policy;
+  uint32_t seed;
+  uint8_t clients;
+  uint16_t advertisers;             // Unrelated devices around
+  uint8_t scan_limit;               // Scanner starts before giving up, 0 = none
+  uint8_t absent;                   // Clients switched off, the last ones
+  uint8_t accept_list;              // Controller only reports the clients
+  uint8_t bonded;                   // Clients encrypted from stored keys
+  uint8_t provision;                // Clients unknown, found by service UUID
+}link_sim_params_t;
+
+
+typedef struct {
+  uint32_t all_bonded_ms;           // 0 when not every present client bonded
+  uint32_t reports;                 // Reaching the application
+  uint32_t filtered;                // Dropped by the accept list
+  uint32_t scanner_starts;
+  uint32_t scan_ms;                 // Time the scanner was on
+  uint32_t cpu_us;                  // CPU time on the reports
+  uint32_t parsed;                  // Reports walked for a service UUID
+  uint32_t ad_structs;              // AD structures walked in them
+  uint32_t ad_compares;             // UUIDs compared in them
+  uint32_t parse_ns;                // CPU time of the walks
+  uint8_t bonded;
+}link_sim_result_t;
+
+
+typedef struct {
+  uint16_t interval;                // Active interval, 1.25 ms units
+  uint8_t fits;                     // All the slots fit in the interval
+  uint8_t collisions;               // Overlapping pairs of link events
+  uint8_t fixed_collisions;         // Same with the former fixed interval
+  uint32_t radio_pm;                // Radio time of the links
+  uint32_t commands;
+  uint64_t latency_us_sum;          // Command to its event on the air
+  uint32_t latency_us_max;
+  uint32_t bound_ms;                // linksched_worst_latency_ms()
+  uint32_t link_mean_us_min;        // Fairness, mean latency of the links
+  uint32_t link_mean_us_max;
+}link_sim_capacity_t;
+
+
+typedef struct {
+  uint16_t interval;                // Of the link, 1.25 ms units
+  uint16_t latency;                 // Peripheral latency
+  probe_t probe;                    // As seen by the server
+  uint32_t down_us_mean;            // Of the model
+  uint32_t up_us_mean;
+  uint32_t offset_error_us_max;     // Probe offset against the true one
+  timesync_t sync;                  // Time sync on the same exchanges
+  uint32_t sync_checks;             // Sync estimates sent to the client
+  uint32_t sync_error_us_mean;      // Server time taken by the client against
+  uint32_t sync_error_us_max;       // the true one
+}link_sim_probe_t;
+
+
+/******************************************************************************
+ * @brief Runs LINK_SIM_BURSTS bursts of commands, each link getting a command
+ * in a burst with a chance of one in two, over the links of the schedule.
+ *
+ * @param
+ *  links     Client links, up to LINK_SIM_MAX_CLIENTS
+ *  phy       PHY bit of every link
+ *  idle      1 with the links in the idle profile
+ *  seed      Seed of the bursts
+ *  result    Layout and command latency
+ *
+ ******************************************************************************/
+void link_sim_capacity(uint8_t links, uint8_t phy, uint8_t idle, uint32_t seed,
+                       link_sim_capacity_t *result);
+
+
+/******************************************************************************
+ * @brief Runs LINK_SIM_PROBE_PINGS pings of the latency probe over one link.
+ * A ping goes out at the next event its peripheral listens to, the echo at
+ * the next event after it, and a packet lost is sent again at the next event
+ * of its side. The time sync takes every exchange.
+ *
+ * @param
+ *  phy       PHY bit of the link
+ *  idle      1 with the link in the idle profile
+ *  seed      Seed of the ping times and the packet losses
+ *  result    Latencies of the probe and of the model, error of the sync
+ *
+ ******************************************************************************/
+void link_sim_probe(uint8_t phy, uint8_t idle, uint32_t seed, link_sim_probe_t *result);
+
+
+/******************************************************************************
+ * @brief Runs the boot until every present client is bonded and the scanner
+ * is off, the scanning gives up or LINK_SIM_MAX_MS. The run only depends on
+ * the parameters.
+ *
+ * @param
+ *  params    Policy, population and seed
+ *  result    Time to all bonded and scanner work
+ *
+ ******************************************************************************/
+void link_sim_run(const link_sim_params_t *params, link_sim_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs 2, 4 and 8 clients among 0 to 250 unrelated advertisers for both
+ * policies and reports the mean boot to all bonded time. Then runs 8 clients
+ * with one of them switched off with and without the accept list and reports
+ * the scan reports and CPU time per minute of scanning. Then runs
+ * the reconnect of a client with and without a stored bonding. Then runs the
+ * provisioning of an AC and a Heater and reports the time until both are
+ * bonded and the parsing work per scan report. Then runs the capacity of 2, 4
+ * and 8 links on the 1M and the Coded PHY. Then runs the latency probe of a
+ * link on both PHYs in both profiles.
+ ******************************************************************************/
+void link_sim_report(void);
+
+
+#endif /* TOOLS_LINK_SIM_H_ */
@@ -0,0 +1,86 @@
+/*******************************************************************************
+ * @file    main.c
+ * @brief   Host tool running the simulations and benchmarks of the server
+ *          modules. The reports named on the command line are run in order,
+ *          all of them without a name.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "thermal_sim.h"
+#include "thermal_tuner.h"
+#include "registry_bench.h"
+#include "link_sim.h"
+#include "outbox_bench.h"
+#include "connparam_bench.h"
+#include "phy_bench.h"
+#include "scansched_bench.h"
+#include "bcast_bench.h"
+#include "export_bench.h"
+
+
+#define ARRAY_LEN(a)    (sizeof(a) / sizeof((a)[0]))
+
+
+typedef struct {
+  const char *name;
+  void (*report)(void);
+}tool_report_t;
+
+static const tool_report_t g_reports[] = {
+    { "thermal_sim", thermal_sim_report },
+    { "thermal_tuner", thermal_tuner_report },
+    { "registry_bench", registry_bench_report },
+    { "link_sim", link_sim_report },
+    { "outbox_bench", outbox_bench_report },
+    { "connparam_bench", connparam_bench_report },
+    { "phy_bench", phy_bench_report },
+    { "scansched_bench", scansched_bench_report },
+    { "bcast_bench", bcast_bench_report },
+    { "export_bench", export_bench_report },
+};
+
+
+/******************************************************************************
+ * @brief Runs the report of the given name.
+ *
+ * @return
+ *  Returns 0 if the report is found.
+ *
+ ******************************************************************************/
+static int run_report(const char *name)
+{
+  for (size_t i = 0; i < ARRAY_LEN(g_reports); i++) {
+      if (strcmp(g_reports[i].name, name) == 0) {
+          g_reports[i].report();
+          return 0;
+      }
+  }
+
+  printf("Unknown report %s, one of:", name);
+  for (size_t i = 0; i < ARRAY_LEN(g_reports); i++)
+    printf(" %s", g_reports[i].name);
+  printf("\n");
+
+  return 1;
+}
+
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+      for (size_t i = 0; i < ARRAY_LEN(g_reports); i++)
+        g_reports[i].report();
+      return 0;
+  }
+
+  for (int i = 1; i < argc; i++) {
+      if (run_report(argv[i]) != 0)
+        return 1;
+  }
+
+  return 0;
+}
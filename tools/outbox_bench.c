@@ -0,0 +1,260 @@
+/*******************************************************************************
+ * @file    outbox_bench.c
+ * @brief   Benchmark of the outbox. See outbox_bench.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "outbox_bench.h"
+#include "outbox.h"
+
+
+typedef struct {
+  uint32_t rand_state;
+  uint32_t now_ms;
+  uint8_t notify;                 // Snapshots as notifications
+  uint8_t count;                  // States on their way to the client
+  uint8_t values[OUTBOX_BENCH_TX_QUEUE];
+  uint8_t seqs[OUTBOX_BENCH_TX_QUEUE];
+  uint32_t deliver_ms[OUTBOX_BENCH_TX_QUEUE];
+  uint8_t confirming;             // Confirmation of the indication on its way
+  uint32_t confirm_ms;
+  uint8_t client_value;           // State the relay of the client holds
+  uint8_t client_seq;             // Newest snapshot taken
+  uint8_t client_synced;          // Set once client_seq is valid
+  uint8_t ack_armed;              // Acknowledgement timer of the client
+  uint32_t ack_timer_ms;
+  uint8_t acking;                 // Acknowledgement on its way to the server
+  uint8_t ack_seq;
+  uint32_t ack_ms;
+  uint32_t sent;
+}bench_link_t;
+
+
+/******************************************************************************
+ * @brief Linear congruential generator, keeps runs reproducible per seed.
+ ******************************************************************************/
+static uint32_t bench_rand(uint32_t *state)
+{
+  *state = *state * 1664525U + 1013904223U;
+  return *state >> 8;
+}
+
+
+/******************************************************************************
+ * @brief Sends a state over the simulated link. The client takes it on one of
+ * its next wake ups. One indication is in flight at a time and its
+ * confirmation comes a connection interval after it is taken, notifications
+ * are only held by the TX queue of the stack.
+ ******************************************************************************/
+static uint8_t bench_send(uint8_t value, uint8_t seq, void *ctx)
+{
+  bench_link_t *link = ctx;
+  uint8_t full = link->notify ? link->count == OUTBOX_BENCH_TX_QUEUE :
+      link->count || link->confirming;
+  uint32_t deliver_ms;
+
+  if (full || bench_rand(&link->rand_state) % 100 < OUTBOX_BENCH_FAIL_PERCENT)
+    return 1;
+
+  deliver_ms = link->now_ms + OUTBOX_BENCH_INTERVAL_MS *
+      (1 + bench_rand(&link->rand_state) % (OUTBOX_BENCH_LATENCY + 1));
+
+  // Queued behind the states not taken yet
+  if (link->count && deliver_ms < link->deliver_ms[link->count - 1])
+    deliver_ms = link->deliver_ms[link->count - 1];
+
+  link->values[link->count] = value;
+  link->seqs[link->count] = seq;
+  link->deliver_ms[link->count] = deliver_ms;
+  link->count++;
+  link->sent++;
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * @brief Advances the simulated link by one step. The relay of the client
+ * takes a state as soon as it gets it, a snapshot only if it is newer than
+ * the one it holds. The client acknowledges the snapshots OUTBOX_BENCH_ACK_DELAY_MS
+ * after the first one taken, the acknowledgement reaches the server on the
+ * next connection event.
+ ******************************************************************************/
+static void bench_step(bench_link_t *link, outbox_t *box,
+                       outbox_bench_mode_t mode)
+{
+  uint32_t now_ms = link->now_ms;
+
+  while (link->count && now_ms >= link->deliver_ms[0]) {
+      uint8_t value = link->values[0];
+      uint8_t seq = link->seqs[0];
+
+      link->count--;
+      memmove(link->values, link->values + 1, link->count);
+      memmove(link->seqs, link->seqs + 1, link->count);
+      memmove(link->deliver_ms, link->deliver_ms + 1, link->count * sizeof(uint32_t));
+
+      if (!link->notify) {
+          link->client_value = value;
+          link->confirming = 1;
+          link->confirm_ms = now_ms + OUTBOX_BENCH_INTERVAL_MS;
+          continue;
+      }
+
+      if (!link->client_synced || (int8_t)(seq - link->client_seq) > 0) {
+          link->client_value = value;
+          link->client_seq = seq;
+          link->client_synced = 1;
+      }
+
+      if (!link->ack_armed) {
+          link->ack_armed = 1;
+          link->ack_timer_ms = now_ms + OUTBOX_BENCH_ACK_DELAY_MS;
+      }
+  }
+
+  if (link->confirming && now_ms >= link->confirm_ms) {
+      link->confirming = 0;
+      if (mode == OUTBOX_BENCH_INDICATION)
+        outbox_confirmed(box, now_ms, bench_send, link);
+  }
+
+  if (link->ack_armed && !link->acking && now_ms >= link->ack_timer_ms) {
+      link->ack_armed = 0;
+      link->acking = 1;
+      link->ack_seq = link->client_seq;
+      link->ack_ms = now_ms + OUTBOX_BENCH_INTERVAL_MS;
+  }
+
+  if (link->acking && now_ms >= link->ack_ms) {
+      link->acking = 0;
+      outbox_acked(box, link->ack_seq, now_ms, bench_send, link);
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the bursts of the given size.
+ ******************************************************************************/
+void outbox_bench_run(uint8_t changes, outbox_bench_mode_t mode, uint32_t seed,
+                      outbox_bench_result_t *result)
+{
+  bench_link_t link;
+  outbox_t box;
+  uint32_t rand_state = seed;
+  uint32_t now_ms = 0;
+  uint8_t value = 0;
+
+  memset(result, 0, sizeof(outbox_bench_result_t));
+  memset(&link, 0, sizeof(bench_link_t));
+  link.rand_state = seed ^ 0x5A5A5A5AU;
+  link.notify = mode == OUTBOX_BENCH_NOTIFICATION;
+  outbox_init(&box);
+  if (link.notify)
+    outbox_set_mode(&box, OUTBOX_MODE_NOTIFICATION);
+
+  for (uint32_t burst = 0; burst < OUTBOX_BENCH_BURSTS; burst++) {
+      uint32_t next_change_ms = now_ms;
+      uint32_t last_change_ms = now_ms;
+      uint32_t end_ms;
+      uint32_t waiting = 0;       // Commands the relay does not hold yet
+      uint32_t waiting_ms_sum = 0;
+      uint32_t oldest_ms = 0;
+      uint8_t left = changes;
+      uint8_t converged = 0;
+
+      // Steps of 1 ms through the burst and the quiet time after it
+      for (end_ms = now_ms + OUTBOX_BENCH_QUIET_MS; now_ms < end_ms; now_ms++) {
+          link.now_ms = now_ms;
+          bench_step(&link, &box, mode);
+
+          if (left && now_ms == next_change_ms) {
+              value = !value;
+              left--;
+              result->changes++;
+              last_change_ms = now_ms;
+              next_change_ms = now_ms + 1 + bench_rand(&rand_state) % OUTBOX_BENCH_GAP_MS;
+              end_ms = now_ms + OUTBOX_BENCH_QUIET_MS;
+              converged = 0;
+
+              if (!waiting)
+                oldest_ms = now_ms;
+              waiting++;
+              waiting_ms_sum += now_ms;
+
+              // The direct send only logged a failure, the state was lost
+              if (mode != OUTBOX_BENCH_DIRECT)
+                outbox_push(&box, value, now_ms, bench_send, &link);
+              else
+                bench_send(value, 0, &link);
+          }
+
+          // Soft timer of the backoff and of the acknowledgement timeout
+          if (mode != OUTBOX_BENCH_DIRECT && outbox_wait_ms(&box, now_ms) <= 1)
+            outbox_flush(&box, now_ms, bench_send, &link);
+
+          // The relay holds the state of the latest command
+          if (waiting && link.client_value == value) {
+              result->relayed += waiting;
+              result->relay_ms_sum += waiting * now_ms - waiting_ms_sum;
+              if (now_ms - oldest_ms > result->relay_ms_max)
+                result->relay_ms_max = now_ms - oldest_ms;
+              waiting = 0;
+              waiting_ms_sum = 0;
+          }
+
+          if (!left && !converged && link.client_value == value && !link.count &&
+              !link.confirming && !link.ack_armed && !link.acking) {
+              uint32_t converge_ms = now_ms - last_change_ms;
+
+              converged = 1;
+              result->converge_ms_sum += converge_ms;
+              if (converge_ms > result->converge_ms_max)
+                result->converge_ms_max = converge_ms;
+          }
+      }
+
+      if (!converged)
+        result->stale_bursts++;
+  }
+
+  result->sent = link.sent;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs bursts of 1, 4 and 16 changes.
+ ******************************************************************************/
+void outbox_bench_report(void)
+{
+  static const uint8_t burst_changes[] = { 1, 4, 16 };
+  static const char *mode_names[] = { "direct", "indications", "notifications" };
+  outbox_bench_result_t result;
+
+  for (uint8_t i = 0; i < sizeof(burst_changes); i++) {
+      for (uint8_t mode = OUTBOX_BENCH_DIRECT; mode <= OUTBOX_BENCH_NOTIFICATION; mode++) {
+          uint32_t converged;
+
+          outbox_bench_run(burst_changes[i], mode, 1, &result);
+          converged = OUTBOX_BENCH_BURSTS - result.stale_bursts;
+
+          printf("Outbox %u changes per burst, %" PRIu32 " bursts, %s: stale bursts %" PRIu32 ", convergence mean/max %" PRIu32 "/%" PRIu32 " ms, command to relay mean/max %" PRIu32 "/%" PRIu32 " ms, states per burst %" PRIu32 "\n",
+                   burst_changes[i],
+                   (uint32_t)OUTBOX_BENCH_BURSTS,
+                   mode_names[mode],
+                   result.stale_bursts,
+                   converged ? result.converge_ms_sum / converged : 0,
+                   result.converge_ms_max,
+                   result.relayed ? result.relay_ms_sum / result.relayed : 0,
+                   result.relay_ms_max,
+                   result.sent / OUTBOX_BENCH_BURSTS);
+      }
+  }
+}
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * @file    outbox_bench.h
+ * @brief   Benchmark of the outbox in outbox.c against the direct sends it
+ *          replaced. Bursts of state changes are sent to a simulated client
+ *          over a link with one indication in flight, a confirmation round
+ *          trip stretched by the peripheral latency and some failed sends.
+ *          The bursts the client ends up in a stale state, the time until it
+ *          holds the last state and the indications sent are reported. The
+ *          outbox is run with the indications and with the sequenced
+ *          notifications acknowledged by the client, the time from a command
+ *          until the relay of the client holds its state or a later one is
+ *          reported for the three.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_OUTBOX_BENCH_H_
+#define TOOLS_OUTBOX_BENCH_H_
+
+#include <stdint.h>
+
+
+#define OUTBOX_BENCH_BURSTS           (200)
+#define OUTBOX_BENCH_QUIET_MS         (10000)   // Between two bursts
+#define OUTBOX_BENCH_GAP_MS           (200)     // Max time between changes
+#define OUTBOX_BENCH_INTERVAL_MS      (75)      // Former fixed CONNECTION_INTERVAL
+#define OUTBOX_BENCH_LATENCY          (4)       // Former fixed CONNECTION_LATENCY
+#define OUTBOX_BENCH_FAIL_PERCENT     (5)       // Sends refused by the stack
+#define OUTBOX_BENCH_TX_QUEUE         (4)       // Notifications buffered by the stack
+#define OUTBOX_BENCH_ACK_DELAY_MS     (100)     // ACK_DELAY_MS in the client ble.h
+
+
+typedef enum {
+  OUTBOX_BENCH_DIRECT,            // Direct indications, as done before the outbox
+  OUTBOX_BENCH_INDICATION,        // Outbox with the indications
+  OUTBOX_BENCH_NOTIFICATION,      // Outbox with the sequenced notifications
+}outbox_bench_mode_t;
+
+
+typedef struct {
+  uint32_t changes;
+  uint32_t sent;
+  uint32_t stale_bursts;          // Client not in the last state at the end
+  uint32_t converge_ms_sum;       // From the last change of a burst
+  uint32_t converge_ms_max;
+  uint32_t relayed;               // Commands the relay took
+  uint32_t relay_ms_sum;          // From a command until the relay holds it
+  uint32_t relay_ms_max;
+}outbox_bench_result_t;
+
+
+/******************************************************************************
+ * @brief Runs the bursts of the given size with the direct sends or the
+ * outbox in one of its modes. The run only depends on the seed.
+ *
+ * @param
+ *  changes   State changes per burst
+ *  mode      Direct sends, outbox indications or outbox notifications
+ *  seed      Seed of the changes and of the link
+ *  result    Stale bursts, convergence and relay time and states sent
+ *
+ ******************************************************************************/
+void outbox_bench_run(uint8_t changes, outbox_bench_mode_t mode, uint32_t seed,
+                      outbox_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs bursts of 1, 4 and 16 changes in the three modes and reports
+ * them.
+ ******************************************************************************/
+void outbox_bench_report(void);
+
+
+#endif /* TOOLS_OUTBOX_BENCH_H_ */
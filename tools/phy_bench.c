@@ -0,0 +1,173 @@
+/*******************************************************************************
+ * @file    phy_bench.c
+ * @brief   Benchmark of the PHYs of the client links. See phy_bench.h for
+ *          details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "phy_bench.h"
+#include "phy.h"
+
+
+#define BENCH_INDICATION_LEN    (12)      // STATE_INDICATION_LEN in ble.c
+#define BENCH_CONFIRMATION_LEN  (9)       // STATE_CONFIRMATION_LEN in ble.c
+
+
+typedef struct {
+  uint16_t distance_m;
+  uint8_t log_db;                 // 10 x log10 of the distance
+}bench_distance_t;
+
+static const bench_distance_t bench_distances[] = {
+  { 3, 5 }, { 10, 10 }, { 20, 13 }, { 40, 16 }, { 80, 19 }, { 120, 21 }, { 160, 22 }
+};
+
+typedef struct {
+  uint32_t rand_state;
+  uint8_t phy;
+  int16_t margin_db;              // Over the sensitivity without fading
+  uint32_t airtime_us;
+  uint32_t packets;
+}bench_link_t;
+
+
+/******************************************************************************
+ * @brief Linear congruential generator, keeps runs reproducible per seed.
+ ******************************************************************************/
+static uint32_t bench_rand(uint32_t *state)
+{
+  *state = *state * 1664525U + 1013904223U;
+  return *state >> 8;
+}
+
+
+/******************************************************************************
+ * @brief Sends a packet over the simulated link, its airtime is counted.
+ *
+ * @return
+ *  Returns 1 if the packet got through.
+ *
+ ******************************************************************************/
+static uint8_t bench_packet(bench_link_t *link, uint8_t len)
+{
+  int16_t fade_db = (int16_t)(bench_rand(&link->rand_state) % (2 * PHY_BENCH_FADE_DB + 1)) -
+      PHY_BENCH_FADE_DB;
+
+  link->airtime_us += phy_packet_us(link->phy, len);
+  link->packets++;
+
+  return link->margin_db + fade_db >= 0;
+}
+
+
+/******************************************************************************
+ * @brief Sends a packet until its empty acknowledgement gets back, one try per
+ * connection event.
+ *
+ * @return
+ *  Returns 1 if acknowledged before the link is lost.
+ *
+ ******************************************************************************/
+static uint8_t bench_exchange(bench_link_t *link, uint8_t len, uint8_t events)
+{
+  for (uint8_t event = 0; event < events; event++) {
+      // The peer only answers a packet it got
+      if (bench_packet(link, len) && bench_packet(link, 0))
+        return 1;
+  }
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the opens and transactions.
+ ******************************************************************************/
+void phy_bench_run(uint8_t phy, uint16_t distance_m, uint32_t seed,
+                   phy_bench_result_t *result)
+{
+  bench_link_t link;
+  int16_t sens_dbm = PHY_BENCH_SENS_1M_DBM;
+  uint8_t log_db = 0;
+
+  memset(result, 0, sizeof(phy_bench_result_t));
+  memset(&link, 0, sizeof(bench_link_t));
+  link.rand_state = seed;
+  link.phy = phy;
+
+  for (uint8_t i = 0; i < sizeof(bench_distances) / sizeof(bench_distance_t); i++)
+    if (bench_distances[i].distance_m <= distance_m)
+      log_db = bench_distances[i].log_db;
+
+  if (phy == PHY_2M)
+    sens_dbm = PHY_BENCH_SENS_2M_DBM;
+  else if (phy == PHY_CODED)
+    sens_dbm = PHY_BENCH_SENS_CODED_DBM;
+
+  link.margin_db = PHY_BENCH_TX_DBM - PHY_BENCH_PATH_LOSS_1M_DB -
+      PHY_BENCH_PATH_LOSS_EXP * log_db / 10 - sens_dbm;
+
+  for (uint32_t open = 0; open < PHY_BENCH_OPENS; open++) {
+      result->opens++;
+
+      // The first exchange has to make it before the link is given up
+      if (!bench_exchange(&link, 0, PHY_BENCH_OPEN_EVENTS))
+        continue;
+
+      result->opens_ok++;
+
+      for (uint8_t t = 0; t < PHY_BENCH_TRANSACTIONS; t++) {
+          uint32_t airtime_us = link.airtime_us;
+          uint32_t packets = link.packets;
+
+          result->transactions++;
+
+          // Indication, then its confirmation from the client
+          if (!bench_exchange(&link, BENCH_INDICATION_LEN, PHY_BENCH_TIMEOUT_EVENTS) ||
+              !bench_exchange(&link, BENCH_CONFIRMATION_LEN, PHY_BENCH_TIMEOUT_EVENTS))
+            break;
+
+          result->transactions_ok++;
+          result->airtime_us += link.airtime_us - airtime_us;
+          result->packets += link.packets - packets;
+      }
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the three PHYs over the distances.
+ ******************************************************************************/
+void phy_bench_report(void)
+{
+  static const uint8_t phys[] = { PHY_1M, PHY_2M, PHY_CODED };
+  static const char *phy_names[] = { "1M", "2M", "Coded" };
+  phy_bench_result_t result;
+
+  printf("PHY airtime of an indication and its confirmation without loss: 1M %" PRIu32 " us, 2M %" PRIu32 " us, Coded %" PRIu32 " us\n",
+           phy_transaction_us(PHY_1M, BENCH_INDICATION_LEN, BENCH_CONFIRMATION_LEN),
+           phy_transaction_us(PHY_2M, BENCH_INDICATION_LEN, BENCH_CONFIRMATION_LEN),
+           phy_transaction_us(PHY_CODED, BENCH_INDICATION_LEN, BENCH_CONFIRMATION_LEN));
+
+  for (uint8_t d = 0; d < sizeof(bench_distances) / sizeof(bench_distance_t); d++) {
+      for (uint8_t p = 0; p < sizeof(phys); p++) {
+          phy_bench_run(phys[p], bench_distances[d].distance_m, 1, &result);
+
+          printf("PHY %s at %u m: opens %" PRIu32 "/%" PRIu32 ", transactions %" PRIu32 "/%" PRIu32 ", airtime %" PRIu32 " us per transaction\n",
+                   phy_names[p],
+                   bench_distances[d].distance_m,
+                   result.opens_ok,
+                   result.opens,
+                   result.transactions_ok,
+                   result.transactions,
+                   result.transactions_ok ? result.airtime_us / result.transactions_ok : 0);
+      }
+  }
+}
@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * @file    phy_bench.h
+ * @brief   Benchmark of the PHYs of phy.c for the client links. A client at a
+ *          given distance is opened and sent state indications on the 1M, 2M
+ *          and Coded PHY. A packet gets through when the received power, from
+ *          a log distance path loss and a uniform fading per packet, is over
+ *          the sensitivity of the PHY. A packet not acknowledged is sent again
+ *          on the next connection event and the link is lost after
+ *          PHY_BENCH_TIMEOUT_EVENTS events without an exchange. The success
+ *          rate of the opens and of the transactions and the airtime of a
+ *          transaction, with its retransmissions, are reported per PHY and
+ *          distance. The radio figures are estimates for the EFR32BG13.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_PHY_BENCH_H_
+#define TOOLS_PHY_BENCH_H_
+
+#include <stdint.h>
+
+
+#define PHY_BENCH_OPENS               (1000)    // Per PHY and distance
+#define PHY_BENCH_TRANSACTIONS        (10)      // Per link opened
+#define PHY_BENCH_TX_DBM              (8)
+#define PHY_BENCH_PATH_LOSS_1M_DB     (40)      // At 1 m
+#define PHY_BENCH_PATH_LOSS_EXP       (30)      // 10 x path loss exponent
+#define PHY_BENCH_FADE_DB             (12)      // Fading of +/- that much
+#define PHY_BENCH_SENS_1M_DBM         (-94)
+#define PHY_BENCH_SENS_2M_DBM         (-91)
+#define PHY_BENCH_SENS_CODED_DBM      (-103)
+#define PHY_BENCH_OPEN_EVENTS         (6)       // To the first exchange
+#define PHY_BENCH_TIMEOUT_EVENTS      (10)      // Supervision timeout
+
+
+typedef struct {
+  uint32_t opens;
+  uint32_t opens_ok;
+  uint32_t transactions;
+  uint32_t transactions_ok;
+  uint32_t airtime_us;            // Of the transactions completed
+  uint32_t packets;               // Sent for the transactions completed
+}phy_bench_result_t;
+
+
+/******************************************************************************
+ * @brief Runs the opens and transactions of a client at the given distance
+ * on a PHY. The run only depends on the seed.
+ *
+ * @param
+ *  phy         PHY bit of phy.h
+ *  distance_m  Distance of the client
+ *  seed        Seed of the fading
+ *  result      Success rates and airtime
+ *
+ ******************************************************************************/
+void phy_bench_run(uint8_t phy, uint16_t distance_m, uint32_t seed,
+                   phy_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs the three PHYs from 3 m to 160 m and reports them.
+ ******************************************************************************/
+void phy_bench_report(void);
+
+
+#endif /* TOOLS_PHY_BENCH_H_ */
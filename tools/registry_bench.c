@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * @file    registry_bench.c
+ * @brief   Benchmark of the client registry. See registry_bench.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "registry_bench.h"
+#include "registry.h"
+
+
+#define BENCH_STATE_SCANNING    (1 << 1)    // Same bits as client_conn_state_t
+#define BENCH_STATE_CONNECTING  (1 << 2)
+#define BENCH_STATE_BONDED      (1 << 6)
+
+
+/******************************************************************************
+ * @brief Linear congruential generator, keeps runs reproducible per seed.
+ ******************************************************************************/
+static uint32_t bench_rand(uint32_t *state)
+{
+  *state = *state * 1664525U + 1013904223U;
+  return *state >> 8;
+}
+
+
+/******************************************************************************
+ * @brief Fills a random address.
+ ******************************************************************************/
+static void bench_addr(uint32_t *state, uint8_t *addr)
+{
+  for (uint8_t i = 0; i < REGISTRY_ADDR_LEN; i++)
+    addr[i] = (uint8_t)bench_rand(state);
+}
+
+
+/******************************************************************************
+ * @brief Linear scan by address the way get_client_by_addr() did it.
+ ******************************************************************************/
+static uint8_t linear_find_addr(uint8_t (*addrs)[REGISTRY_ADDR_LEN], uint8_t count,
+                                const uint8_t *addr, uint32_t *compares)
+{
+  for (uint8_t i = 0; i < count; i++) {
+      (*compares)++;
+      if (!memcmp(addrs[i], addr, REGISTRY_ADDR_LEN))
+        return i;
+  }
+
+  return REGISTRY_NONE;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the scan reports and lookups for the given number of clients.
+ ******************************************************************************/
+void registry_bench_run(uint8_t clients, uint32_t seed,
+                        registry_bench_result_t *result)
+{
+  // Too large for the stack of the boot context
+  static registry_t reg;
+  static uint8_t addrs[REGISTRY_MAX_CLIENTS][REGISTRY_ADDR_LEN];
+  static uint8_t states[REGISTRY_MAX_CLIENTS];
+  uint32_t rand_state = seed;
+
+  if (clients > REGISTRY_MAX_CLIENTS)
+    clients = REGISTRY_MAX_CLIENTS;
+
+  memset(result, 0, sizeof(registry_bench_result_t));
+  registry_init(&reg);
+
+  for (uint8_t i = 0; i < clients; i++) {
+      do {
+          bench_addr(&rand_state, addrs[i]);
+      } while (registry_add(&reg, addrs[i], 0, BENCH_STATE_SCANNING) == REGISTRY_NONE);
+
+      states[i] = 1;
+      registry_set_conn(&reg, i, i + 1);
+  }
+
+  for (uint32_t n = 0; n < REGISTRY_BENCH_REPORTS; n++) {
+      uint8_t addr[REGISTRY_ADDR_LEN];
+      uint8_t client = REGISTRY_NONE;
+      uint8_t found;
+
+      if (bench_rand(&rand_state) % 100 < REGISTRY_BENCH_CLIENT_PERCENT) {
+          client = bench_rand(&rand_state) % clients;
+          memcpy(addr, addrs[client], REGISTRY_ADDR_LEN);
+      }
+      else {
+          bench_addr(&rand_state, addr);
+      }
+
+      found = registry_find_addr(&reg, addr);
+      if (found != linear_find_addr(addrs, clients, addr, &result->linear_compares))
+        printf("Registry lookup mismatch\n");
+      result->lookups++;
+
+      if (found == REGISTRY_NONE)
+        continue;
+
+      result->client_reports++;
+
+      // A client report moves it on, as a connection would
+      if (registry_find_conn(&reg, found + 1) != found)
+        printf("Registry handle mismatch\n");
+      result->linear_conn_visits += found + 1;
+
+      states[found] = (states[found] + 1) % 3;
+      registry_set_state(&reg, found, states[found] == 0 ? BENCH_STATE_SCANNING :
+                         states[found] == 1 ? BENCH_STATE_CONNECTING : BENCH_STATE_BONDED);
+
+      // start_bt_scan() asks for any client connecting before every scan
+      registry_first_in_states(&reg, BENCH_STATE_CONNECTING);
+      for (uint8_t i = 0; i < clients; i++) {
+          result->linear_state_visits++;
+          if (states[i] == 1)
+            break;
+      }
+  }
+
+  result->compares = reg.compares;
+  result->probes = reg.probes;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the benchmark for 2, 16 and 64 clients.
+ ******************************************************************************/
+void registry_bench_report(void)
+{
+  static const uint8_t client_counts[] = { 2, 16, 64 };
+  registry_bench_result_t result;
+
+  for (uint8_t i = 0; i < sizeof(client_counts); i++) {
+      registry_bench_run(client_counts[i], 1, &result);
+
+      printf("Registry %u clients, %" PRIu32 " reports: address compares per 100 reports linear %" PRIu32 ", registry %" PRIu32 " (%" PRIu32 " probes), clients visited per 100 handle/state lookups linear %" PRIu32 "/%" PRIu32 ", registry 100/100\n",
+               client_counts[i],
+               result.lookups,
+               (result.linear_compares * 100) / result.lookups,
+               (result.compares * 100) / result.lookups,
+               (result.probes * 100) / result.lookups,
+               (result.linear_conn_visits * 100) / result.client_reports,
+               (result.linear_state_visits * 100) / result.client_reports);
+  }
+}
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ * @file    registry_bench.h
+ * @brief   Benchmark of the client registry in registry.c against the linear
+ *          scans it replaced. A stream of scan reports, mostly from unknown
+ *          devices, and connection handle and state lookups are run for a
+ *          growing number of clients and the address compares and probes
+ *          per lookup are reported.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_REGISTRY_BENCH_H_
+#define TOOLS_REGISTRY_BENCH_H_
+
+#include <stdint.h>
+
+
+#define REGISTRY_BENCH_REPORTS        (10000)
+#define REGISTRY_BENCH_CLIENT_PERCENT (10)    // Reports from a client
+
+
+typedef struct {
+  uint32_t lookups;
+  uint32_t client_reports;        // Reports from a client
+  uint32_t linear_compares;       // Address compares of the linear scan
+  uint32_t compares;              // Address compares of the registry
+  uint32_t probes;                // Hash slots looked at by the registry
+  uint32_t linear_conn_visits;    // Clients looked at per handle lookup
+  uint32_t linear_state_visits;   // Clients looked at per state lookup
+}registry_bench_result_t;
+
+
+/******************************************************************************
+ * @brief Runs the scan reports and lookups for the given number of clients.
+ * The run only depends on the seed.
+ *
+ * @param
+ *  clients   Number of clients, up to REGISTRY_MAX_CLIENTS
+ *  seed      Seed of the addresses
+ *  result    Work of the registry and the linear scans
+ *
+ ******************************************************************************/
+void registry_bench_run(uint8_t clients, uint32_t seed,
+                        registry_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs the benchmark for 2, 16 and 64 clients and reports it.
+ ******************************************************************************/
+void registry_bench_report(void);
+
+
+#endif /* TOOLS_REGISTRY_BENCH_H_ */
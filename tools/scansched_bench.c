@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * @file    scansched_bench.c
+ * @brief   Benchmark of the scan scheduler. See scansched_bench.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "scansched_bench.h"
+#include "scansched.h"
+
+
+/******************************************************************************
+ * @brief Linear congruential generator, keeps runs reproducible per seed.
+ ******************************************************************************/
+static uint32_t bench_rand(uint32_t *state)
+{
+  *state = *state * 1664525U + 1013904223U;
+  return *state >> 8;
+}
+
+
+/******************************************************************************
+ * @brief Checks if the scanner listens at the given time and gives its radio
+ * on time since the loss. The fixed policies scan with the fast timing of the
+ * scheduler from the loss on.
+ ******************************************************************************/
+static uint8_t bench_listening(scansched_bench_policy_t policy,
+                               scansched_t *sched, uint32_t now_ms,
+                               uint32_t *on_ms)
+{
+  uint32_t interval_ms;
+  uint32_t window_ms;
+
+  if (policy == SCANSCHED_BENCH_SCHEDULED) {
+      scansched_update(sched, now_ms);
+      *on_ms = scansched_on_ms(sched, now_ms);
+      interval_ms = scansched_interval(sched) * 5 / 8;
+      window_ms = scansched_window(sched) * 5 / 8;
+
+      // The scanner restarts on every phase change, the windows with it
+      return (now_ms - sched->phase_ms) % interval_ms < window_ms;
+  }
+
+  interval_ms = SCANSCHED_FAST_INTERVAL * 5 / 8;
+  window_ms = SCANSCHED_FAST_WINDOW * 5 / 8;
+
+  if (policy == SCANSCHED_BENCH_FIXED && now_ms >= SCANSCHED_BENCH_TIMEOUT_MS) {
+      *on_ms = (uint32_t)((uint64_t)SCANSCHED_BENCH_TIMEOUT_MS * window_ms / interval_ms);
+      return 0;
+  }
+
+  *on_ms = (uint32_t)((uint64_t)now_ms * window_ms / interval_ms);
+
+  return now_ms % interval_ms < window_ms;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the loss and reappearance of the client.
+ ******************************************************************************/
+void scansched_bench_run(scansched_bench_policy_t policy, uint32_t absent_s,
+                         uint32_t seed, scansched_bench_result_t *result)
+{
+  uint32_t rand_state = seed;
+
+  memset(result, 0, sizeof(scansched_bench_result_t));
+
+  for (uint32_t run = 0; run < SCANSCHED_BENCH_RUNS; run++) {
+      scansched_t sched;
+      uint32_t appear_ms = absent_s * 1000 + bench_rand(&rand_state) % SCANSCHED_BENCH_OFFSET_MS;
+      uint32_t adv_ms = appear_ms;
+      uint32_t on_ms = 0;
+      uint8_t found = 0;
+
+      // The link is lost at 0, the scanner restarts
+      scansched_init(&sched);
+      scansched_restart(&sched, 0);
+
+      while (adv_ms - appear_ms < SCANSCHED_BENCH_MAX_MS) {
+          if (bench_listening(policy, &sched, adv_ms, &on_ms)) {
+              found = 1;
+              break;
+          }
+
+          adv_ms += SCANSCHED_BENCH_ADV_MS + bench_rand(&rand_state) % (SCANSCHED_BENCH_ADV_DELAY_MS + 1);
+      }
+
+      result->on_ms_sum += on_ms;
+      result->run_s_sum += adv_ms / 1000;
+
+      if (!found) {
+          result->missed++;
+          continue;
+      }
+
+      result->found++;
+      result->rediscover_ms_sum += adv_ms - appear_ms;
+      if (adv_ms - appear_ms > result->rediscover_ms_max)
+        result->rediscover_ms_max = adv_ms - appear_ms;
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the client gone 1 minute, 1 hour and 1 day.
+ ******************************************************************************/
+void scansched_bench_report(void)
+{
+  static const uint32_t absent_s[] = { 60, 60 * 60, 24 * 60 * 60 };
+  static const char *policy_names[] = { "fixed with timeout", "fixed", "scheduled" };
+  scansched_bench_result_t result;
+
+  for (uint8_t i = 0; i < sizeof(absent_s) / sizeof(absent_s[0]); i++) {
+      for (uint8_t policy = SCANSCHED_BENCH_FIXED; policy <= SCANSCHED_BENCH_SCHEDULED; policy++) {
+          scansched_bench_run(policy, absent_s[i], 1, &result);
+
+          printf("Scan %" PRIu32 " s absent, %s: found %" PRIu32 ", missed %" PRIu32 ", rediscovery mean/max %" PRIu32 "/%" PRIu32 " ms, radio on %" PRIu32 " s, %" PRIu32 " s per hour\n",
+                   absent_s[i],
+                   policy_names[policy],
+                   result.found,
+                   result.missed,
+                   result.found ? result.rediscover_ms_sum / result.found : 0,
+                   result.rediscover_ms_max,
+                   result.on_ms_sum / SCANSCHED_BENCH_RUNS / 1000,
+                   (uint32_t)((uint64_t)result.on_ms_sum * 3600 / result.run_s_sum / 1000));
+      }
+  }
+}
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * @file    scansched_bench.h
+ * @brief   Benchmark of the scan scheduler in scansched.c. A client is lost at
+ *          the start of a run and reappears after 1 minute, 1 hour or 1 day,
+ *          plus up to SCANSCHED_BENCH_OFFSET_MS so the reappearances spread
+ *          over the scan intervals, advertising every 250 ms plus a random
+ *          advDelay. The scanner is
+ *          run with the former fixed timing that gave up after the scan
+ *          timeout, with the fixed timing kept on and with the scheduler. The
+ *          time from the reappearance until an advertisement falls in a scan
+ *          window and the radio on time of the scanner until then are
+ *          reported. A window is taken to catch any advertisement starting
+ *          in it, the channel of the window and the packet length are not
+ *          modelled.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_SCANSCHED_BENCH_H_
+#define TOOLS_SCANSCHED_BENCH_H_
+
+#include <stdint.h>
+
+
+#define SCANSCHED_BENCH_RUNS          (50)      // Reappearances per case
+#define SCANSCHED_BENCH_ADV_MS        (250)     // ADVERTISING_MIN of the client
+#define SCANSCHED_BENCH_ADV_DELAY_MS  (10)
+#define SCANSCHED_BENCH_OFFSET_MS     (20000)   // Max extra delay of the reappearance
+#define SCANSCHED_BENCH_MAX_MS        (3600000) // Not found by then is missed
+#define SCANSCHED_BENCH_TIMEOUT_MS    (60000)   // Former SCAN_TIMEOUT_S
+
+
+typedef enum {
+  SCANSCHED_BENCH_FIXED,          // Fast timing until the scan timeout
+  SCANSCHED_BENCH_CONTINUOUS,     // Fast timing forever
+  SCANSCHED_BENCH_SCHEDULED,      // Scan scheduler
+}scansched_bench_policy_t;
+
+
+typedef struct {
+  uint32_t found;
+  uint32_t missed;
+  uint32_t rediscover_ms_sum;     // From the reappearance
+  uint32_t rediscover_ms_max;
+  uint32_t on_ms_sum;             // Radio on from the loss until found or missed
+  uint32_t run_s_sum;             // Length of the runs
+}scansched_bench_result_t;
+
+
+/******************************************************************************
+ * @brief Runs the loss and reappearance of a client SCANSCHED_BENCH_RUNS
+ * times. The runs only depend on the seed.
+ *
+ * @param
+ *  policy    Scan timing
+ *  absent_s  Time the client is gone
+ *  seed      Seed of the reappearance and of the advertising
+ *  result    Rediscovery time and radio on time
+ *
+ ******************************************************************************/
+void scansched_bench_run(scansched_bench_policy_t policy, uint32_t absent_s,
+                         uint32_t seed, scansched_bench_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs the three policies with the client gone 1 minute, 1 hour and
+ * 1 day and reports them.
+ ******************************************************************************/
+void scansched_bench_report(void);
+
+
+#endif /* TOOLS_SCANSCHED_BENCH_H_ */
@@ -0,0 +1,544 @@
+/*******************************************************************************
+ * @file    thermal_sim.c
+ * @brief   First order thermal model of a room for evaluating the control and
+ *          sampling settings. See thermal_sim.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "thermal_sim.h"
+#include "schedule.h"
+
+
+#define SIM_SUNDAY_S    (3 * THERMAL_SIM_DAY_S)   // Local time of the first day
+
+
+typedef struct {
+  int32_t room_mf;
+  control_output_t relays;
+  uint32_t rand_state;
+  int16_t readings[THERMAL_SIM_MAX_FILTER_LEN];
+  int32_t readings_sum;
+  uint8_t readings_index;
+}thermal_sim_room_t;
+
+
+/******************************************************************************
+ * @brief Linear congruential generator, keeps runs reproducible per seed.
+ ******************************************************************************/
+static uint32_t sim_rand(thermal_sim_room_t *room)
+{
+  room->rand_state = room->rand_state * 1664525U + 1013904223U;
+  return room->rand_state >> 8;
+}
+
+
+/******************************************************************************
+ * @brief Outdoor temperature, a triangle wave over the day with the minimum at
+ * midnight and the maximum at noon.
+ ******************************************************************************/
+static int32_t outdoor_mf(const thermal_sim_params_t *params, uint32_t time_s)
+{
+  int64_t phase = time_s % THERMAL_SIM_DAY_S;
+
+  if (phase > THERMAL_SIM_DAY_S / 2)
+    phase = THERMAL_SIM_DAY_S - phase;
+
+  return params->outdoor_mean_mf +
+      (int32_t)((params->outdoor_swing_mf * (4 * phase - THERMAL_SIM_DAY_S)) / THERMAL_SIM_DAY_S);
+}
+
+
+/******************************************************************************
+ * @brief Advances the room by one step with the current relay states.
+ ******************************************************************************/
+static void room_step(thermal_sim_room_t *room, const thermal_sim_params_t *params,
+                      uint32_t time_s)
+{
+  int32_t delta = (int32_t)(((int64_t)(outdoor_mf(params, time_s) - room->room_mf) *
+      THERMAL_SIM_STEP_S) / params->tau_s);
+
+  if (room->relays == CONTROL_OUTPUT_HEAT)
+    delta += (params->heat_rate_mf_per_h * THERMAL_SIM_STEP_S) / 3600;
+  else if (room->relays == CONTROL_OUTPUT_COOL)
+    delta -= (params->cool_rate_mf_per_h * THERMAL_SIM_STEP_S) / 3600;
+
+  room->room_mf += delta;
+}
+
+
+/******************************************************************************
+ * @brief Simulated LM75 reading of the room, 0.5C resolution with noise and
+ * converted to F the same way as lm75.c does.
+ ******************************************************************************/
+static int16_t sensor_read(thermal_sim_room_t *room, const thermal_sim_params_t *params)
+{
+  int32_t temp_mc = ((room->room_mf - 32000) * 5) / 9;
+  int32_t half_c;
+  uint16_t data16;
+
+  if (params->noise_mc)
+    temp_mc += (int32_t)(sim_rand(room) % (2 * params->noise_mc + 1)) - params->noise_mc;
+
+  half_c = temp_mc / 500;
+  data16 = (uint16_t)(half_c << 7);
+
+  return (int16_t)((data16 * 9) / (5 * 256)) + 32;
+}
+
+
+/******************************************************************************
+ * @brief Moving average of the last filter_len readings, the window starts
+ * filled with the first reading.
+ ******************************************************************************/
+static int16_t filter_reading(thermal_sim_room_t *room, uint8_t filter_len,
+                              int16_t reading, uint8_t first)
+{
+  if (first) {
+      for (uint8_t i = 0; i < filter_len; i++)
+        room->readings[i] = reading;
+      room->readings_sum = (int32_t)reading * filter_len;
+      room->readings_index = 0;
+  }
+
+  room->readings_sum += reading - room->readings[room->readings_index];
+  room->readings[room->readings_index] = reading;
+  room->readings_index = (room->readings_index + 1) % filter_len;
+
+  return (int16_t)((room->readings_sum + filter_len / 2) / filter_len);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Loads a heating season day.
+ ******************************************************************************/
+void thermal_sim_default_params(thermal_sim_params_t *params)
+{
+  params->seed = 1;
+  params->target = 70;
+  params->initial_mf = 70000;
+  params->outdoor_mean_mf = 45000;
+  params->outdoor_swing_mf = 10000;
+  params->tau_s = 4 * 60 * 60;
+  params->heat_rate_mf_per_h = 15000;
+  params->cool_rate_mf_per_h = 15000;
+  params->noise_mc = 250;
+  params->sample_period_s = 60;
+  params->filter_len = 1;
+  params->conn_interval_ms = 75;
+  params->conn_latency = 4;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs one day of the room in virtual time.
+ ******************************************************************************/
+void thermal_sim_run_day(const control_config_t *config,
+                         const thermal_sim_params_t *params,
+                         thermal_sim_result_t *result)
+{
+  thermal_sim_room_t room = {
+      .room_mf = params->initial_mf,
+      .relays = CONTROL_OUTPUT_OFF,
+      .rand_state = params->seed
+  };
+  control_state_t ctl;
+  int32_t target_mf = params->target * 1000;
+  uint64_t error_sum = 0;
+  uint32_t samples = 0;
+  uint32_t conn_events;
+  uint8_t filter_len = params->filter_len;
+
+  if (filter_len == 0)
+    filter_len = 1;
+  else if (filter_len > THERMAL_SIM_MAX_FILTER_LEN)
+    filter_len = THERMAL_SIM_MAX_FILTER_LEN;
+
+  control_init(&ctl, 0);
+  ctl.config = *config;
+
+  result->max_error_mf = 0;
+  result->actuator_cycles = 0;
+  result->indications = 0;
+
+  for (uint32_t time_s = 0; time_s < THERMAL_SIM_DAY_S; time_s += THERMAL_SIM_STEP_S) {
+      int32_t error_mf;
+
+      if (time_s % params->sample_period_s == 0) {
+          int16_t reading = filter_reading(&room, filter_len,
+                                           sensor_read(&room, params), samples == 0);
+          control_output_t output = control_update(&ctl, reading, params->target, time_s);
+
+          if (output != room.relays) {
+              result->indications += control_relay_changes(room.relays, output);
+              if (output != CONTROL_OUTPUT_OFF)
+                result->actuator_cycles++;
+              room.relays = output;
+          }
+          samples++;
+      }
+
+      room_step(&room, params, time_s);
+
+      error_mf = room.room_mf - target_mf;
+      if (error_mf < 0)
+        error_mf = -error_mf;
+      if (error_mf > result->max_error_mf)
+        result->max_error_mf = error_mf;
+      error_sum += (uint64_t)error_mf * THERMAL_SIM_STEP_S;
+  }
+
+  conn_events = (uint32_t)(((uint64_t)THERMAL_SIM_DAY_S * 1000) /
+      ((uint32_t)params->conn_interval_ms * (1 + params->conn_latency)));
+
+  result->comfort_error_mf = (int32_t)(error_sum / THERMAL_SIM_DAY_S);
+  result->legacy_indications = ctl.legacy_switches;
+  result->radio_energy_uj = conn_events * THERMAL_SIM_CLIENTS * THERMAL_SIM_UJ_PER_CONN_EVENT +
+      result->indications * THERMAL_SIM_UJ_PER_INDICATION;
+  result->cpu_energy_uj = samples * THERMAL_SIM_UJ_PER_SAMPLE;
+}
+
+
+/******************************************************************************
+ * @brief Loads the same day and night targets for every day of the week.
+ ******************************************************************************/
+static void load_setback_schedule(schedule_t *sched, int16_t day_target,
+                                  int16_t *target)
+{
+  schedule_entry_t table[SCHEDULE_DAYS][SCHEDULE_MAX_PER_DAY] = { 0 };
+
+  for (uint8_t day = 0; day < SCHEDULE_DAYS; day++) {
+      table[day][0].slot = THERMAL_SIM_DAY_START_SLOT;
+      table[day][0].target = day_target;
+      table[day][1].slot = THERMAL_SIM_NIGHT_START_SLOT;
+      table[day][1].target = day_target - THERMAL_SIM_SETBACK;
+  }
+
+  schedule_init(sched);
+  schedule_load(sched, (const uint8_t *)table, sizeof(table), SIM_SUNDAY_S, target);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs a week on a schedule with a night setback.
+ ******************************************************************************/
+void thermal_sim_run_recovery(const control_config_t *config,
+                              const thermal_sim_params_t *params,
+                              thermal_sim_recovery_t mode,
+                              thermal_sim_recovery_result_t *result)
+{
+  thermal_sim_room_t room = {
+      .room_mf = params->initial_mf,
+      .relays = CONTROL_OUTPUT_OFF,
+      .rand_state = params->seed
+  };
+  control_state_t ctl;
+  recovery_model_t model;
+  schedule_t sched;
+  int16_t target = params->target;
+  uint32_t arrival_error_sum = 0;
+  uint32_t pending_s = 0;         // Transition the arrival is timed against
+  int32_t pending_mf = 0;
+  uint8_t pending = 0;
+  uint32_t samples = 0;
+  uint8_t filter_len = params->filter_len;
+
+  if (filter_len == 0)
+    filter_len = 1;
+  else if (filter_len > THERMAL_SIM_MAX_FILTER_LEN)
+    filter_len = THERMAL_SIM_MAX_FILTER_LEN;
+
+  control_init(&ctl, 0);
+  ctl.config = *config;
+  recovery_init(&model);
+  load_setback_schedule(&sched, params->target, &target);
+
+  result->transitions = 0;
+  result->max_late_s = -(int32_t)THERMAL_SIM_MAX_LATE_S;
+  result->runtime_s = 0;
+
+  for (uint32_t time_s = 0; time_s < THERMAL_SIM_RECOVERY_DAYS * THERMAL_SIM_DAY_S;
+      time_s += THERMAL_SIM_STEP_S) {
+      uint32_t local_s = SIM_SUNDAY_S + time_s;
+
+      if (time_s % params->sample_period_s == 0) {
+          int16_t reading = filter_reading(&room, filter_len,
+                                           sensor_read(&room, params), samples == 0);
+          uint32_t due_s = sched.next_s;
+          int16_t next_target = schedule_next_target(&sched);
+          int16_t last_target = target;
+          uint8_t early = 0;
+          control_output_t output;
+
+          if (schedule_poll(&sched, local_s, &target)) {
+              // Start timing unless the target was already taken early
+              if (target > last_target && !(pending && pending_s == due_s)) {
+                  pending = 1;
+                  pending_s = due_s;
+                  pending_mf = target * 1000;
+              }
+          }
+          else if (next_target > target) {
+              if (mode == THERMAL_SIM_RECOVERY_FIXED)
+                early = sched.next_s - local_s <= THERMAL_SIM_FIXED_LEAD_S;
+              else if (mode == THERMAL_SIM_RECOVERY_LEARNED)
+                early = recovery_precondition(&model, reading, next_target,
+                                              sched.next_s, local_s);
+
+              if (early) {
+                  target = next_target;
+                  pending = 1;
+                  pending_s = sched.next_s;
+                  pending_mf = target * 1000;
+              }
+          }
+
+          output = control_update(&ctl, reading, target, time_s);
+          recovery_update(&model, output, reading, time_s);
+          room.relays = output;
+          samples++;
+      }
+
+      room_step(&room, params, time_s);
+
+      if (room.relays != CONTROL_OUTPUT_OFF)
+        result->runtime_s += THERMAL_SIM_STEP_S;
+
+      if (pending && local_s >= pending_s + THERMAL_SIM_MAX_LATE_S) {
+          // Never got there, count it as late as the window
+          arrival_error_sum += THERMAL_SIM_MAX_LATE_S;
+          result->max_late_s = THERMAL_SIM_MAX_LATE_S;
+          result->transitions++;
+          pending = 0;
+      }
+      else if (pending && room.room_mf >= pending_mf - THERMAL_SIM_ARRIVAL_MF) {
+          int32_t late_s = (int32_t)(local_s - pending_s);
+
+          arrival_error_sum += late_s < 0 ? -late_s : late_s;
+          if (late_s > result->max_late_s)
+            result->max_late_s = late_s;
+          result->transitions++;
+          pending = 0;
+      }
+  }
+
+  result->arrival_error_s = result->transitions ? arrival_error_sum / result->transitions : 0;
+}
+
+
+/******************************************************************************
+ * @brief Actuator callback of the zone runs, the relays always follow.
+ ******************************************************************************/
+static uint8_t sim_actuate(uint8_t id, uint8_t on, void *ctx)
+{
+  (void)id;
+  (void)on;
+  (void)ctx;
+
+  return 0;
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs one day of a building with zone_count zones.
+ ******************************************************************************/
+void thermal_sim_run_zones(const thermal_sim_params_t *params, uint8_t zone_count,
+                           uint8_t run_all, uint32_t stagger_s,
+                           thermal_sim_zones_result_t *result)
+{
+  // Too large for the stack of the boot context
+  static zone_table_t table;
+  static thermal_sim_room_t rooms[ZONE_MAX];
+  actuation_t sched;
+  uint32_t phases = params->sample_period_s / THERMAL_SIM_STEP_S;
+  uint64_t error_sum = 0;
+
+  if (zone_count > ZONE_MAX)
+    zone_count = ZONE_MAX;
+
+  zone_table_init(&table);
+  actuation_init(&sched, stagger_s);
+
+  for (uint8_t zone = 0; zone < zone_count; zone++) {
+      zone_add(&table, 0);
+
+      for (uint8_t i = 0; i < THERMAL_SIM_ZONE_ACTUATORS; i++)
+        zone_add_actuator(&table, zone,
+                          i % 2 ? CONTROL_OUTPUT_COOL : CONTROL_OUTPUT_HEAT, i);
+
+      rooms[zone].room_mf = params->initial_mf - (zone % 4) * 1000;
+      rooms[zone].relays = CONTROL_OUTPUT_OFF;
+      rooms[zone].rand_state = params->seed + zone;
+      zone_set_target(&table, zone, params->target + (zone % 3) - 1);
+  }
+
+  result->samples = 0;
+  result->peak_starts = 0;
+
+  for (uint32_t time_s = 0; time_s < THERMAL_SIM_DAY_S; time_s += THERMAL_SIM_STEP_S) {
+      uint32_t phase = (time_s / THERMAL_SIM_STEP_S) % phases;
+      uint32_t starts = sched.starts;
+
+      for (uint8_t zone = 0; zone < zone_count; zone++) {
+          if (zone % phases == phase) {
+              zone_set_current(&table, zone, sensor_read(&rooms[zone], params));
+
+              if (run_all)
+                table.dirty = ((uint32_t)1 << zone_count) - 1;
+
+              zone_run(&table, time_s);
+              result->samples++;
+          }
+      }
+
+      actuation_run(&sched, &table, time_s, sim_actuate, NULL);
+
+      if (sched.starts - starts > result->peak_starts)
+        result->peak_starts = sched.starts - starts;
+
+      for (uint8_t zone = 0; zone < zone_count; zone++) {
+          thermal_sim_room_t *room = &rooms[zone];
+          int32_t error_mf;
+
+          room->relays = zone_output(&table, zone);
+          room_step(room, params, time_s);
+
+          error_mf = room->room_mf - table.zones[zone].target_temp * 1000;
+          error_sum += (uint64_t)(error_mf < 0 ? -error_mf : error_mf) * THERMAL_SIM_STEP_S;
+      }
+  }
+
+  result->zones_run = table.zones_run;
+  result->actuator_visits = sched.visits;
+  result->actuator_cycles = sched.starts;
+  result->indications = sched.commands;
+  result->bursts = sched.bursts;
+  result->peak_burst = sched.peak_burst;
+  result->comfort_error_mf = (int32_t)(error_sum / ((uint64_t)THERMAL_SIM_DAY_S * zone_count));
+}
+
+
+/******************************************************************************
+ * @brief Logs the result of one simulated day.
+ ******************************************************************************/
+static void log_result(const char *name, const thermal_sim_result_t *result)
+{
+  printf("Sim %s: error avg %" PRId32 " mF max %" PRId32 " mF, cycles %" PRIu32 ", indications %" PRIu32 " (on/off control %" PRIu32 "), radio %" PRIu32 " uJ, cpu %" PRIu32 " uJ\n",
+           name,
+           result->comfort_error_mf,
+           result->max_error_mf,
+           result->actuator_cycles,
+           result->indications,
+           result->legacy_indications,
+           result->radio_energy_uj,
+           result->cpu_energy_uj);
+}
+
+
+/******************************************************************************
+ * @brief Runs and logs the recovery week for every mode. Extra runtime is
+ * against applying the day target at the transition.
+ ******************************************************************************/
+static void log_recovery(const char *week, const thermal_sim_params_t *params)
+{
+  static const char *names[] = { "none", "fixed lead", "learned" };
+  thermal_sim_recovery_result_t recovery;
+  control_state_t ctl;
+  uint32_t baseline_runtime_s = 0;
+
+  control_init(&ctl, 0);
+
+  for (uint8_t mode = THERMAL_SIM_RECOVERY_NONE; mode <= THERMAL_SIM_RECOVERY_LEARNED; mode++) {
+      thermal_sim_run_recovery(&ctl.config, params, (thermal_sim_recovery_t)mode, &recovery);
+
+      if (mode == THERMAL_SIM_RECOVERY_NONE)
+        baseline_runtime_s = recovery.runtime_s;
+
+      printf("Sim recovery %s week, %s: %" PRIu32 " mornings, arrival error avg %" PRIu32 " s, latest %" PRId32 " s, runtime %" PRIu32 " s (extra %" PRId32 " s)\n",
+               week,
+               names[mode],
+               recovery.transitions,
+               recovery.arrival_error_s,
+               recovery.max_late_s,
+               recovery.runtime_s,
+               (int32_t)(recovery.runtime_s - baseline_runtime_s));
+  }
+}
+
+
+/******************************************************************************
+ * @brief Runs and logs the zone day from one zone up to ZONE_MAX, running the
+ * dirty zones without and with the stagger, and every zone. The work per
+ * sample is in hundredths.
+ ******************************************************************************/
+static void log_zones(const thermal_sim_params_t *params)
+{
+  static const char *names[] = { "dirty zones", "dirty zones staggered", "all zones staggered" };
+  thermal_sim_zones_result_t result;
+
+  for (uint8_t zone_count = 1; zone_count <= ZONE_MAX; zone_count *= 2) {
+      for (uint8_t run = 0; run < 3; run++) {
+          thermal_sim_run_zones(params, zone_count, run == 2,
+                                run ? ACTUATION_STAGGER_S : 0, &result);
+
+          printf("Sim zones %u (%u actuators), %s: %" PRIu32 " samples, zones run %" PRIu32 "/100 per sample, actuators visited %" PRIu32 "/100 per sample, cycles %" PRIu32 ", peak starts %" PRIu32 ", indications %" PRIu32 " in %" PRIu32 " bursts (peak %" PRIu32 "), error avg %" PRId32 " mF\n",
+                   zone_count,
+                   zone_count * THERMAL_SIM_ZONE_ACTUATORS,
+                   names[run],
+                   result.samples,
+                   (result.zones_run * 100) / result.samples,
+                   (result.actuator_visits * 100) / result.samples,
+                   result.actuator_cycles,
+                   result.peak_starts,
+                   result.indications,
+                   result.bursts,
+                   result.peak_burst,
+                   result.comfort_error_mf);
+      }
+  }
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Reports a simulated day for the supported controls.
+ ******************************************************************************/
+void thermal_sim_report(void)
+{
+  thermal_sim_params_t params;
+  thermal_sim_result_t result;
+  control_state_t ctl;
+
+  thermal_sim_default_params(&params);
+  control_init(&ctl, 0);
+
+  ctl.config.deadband = 0;
+  ctl.config.min_on_time_s = 0;
+  ctl.config.min_off_time_s = 0;
+  thermal_sim_run_day(&ctl.config, &params, &result);
+  log_result("on/off", &result);
+
+  control_init(&ctl, 0);
+  thermal_sim_run_day(&ctl.config, &params, &result);
+  log_result("deadband", &result);
+
+  ctl.config.mode = CONTROL_MODE_PI;
+  thermal_sim_run_day(&ctl.config, &params, &result);
+  log_result("PI", &result);
+
+  log_recovery("mild", &params);
+
+  // A fixed lead only suits the weather it was picked for
+  params.outdoor_mean_mf = THERMAL_SIM_COLD_OUTDOOR_MF;
+  log_recovery("cold", &params);
+
+  thermal_sim_default_params(&params);
+  log_zones(&params);
+}
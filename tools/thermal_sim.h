@@ -0,0 +1,184 @@
+/*******************************************************************************
+ * @file    thermal_sim.h
+ * @brief   First order thermal model of a room for evaluating the control and
+ *          sampling settings. The room is heated by the heater, cooled by the
+ *          AC and leaks towards the outdoor temperature. A whole day is run in
+ *          virtual time in a tight loop: the room feeds a simulated LM75 and
+ *          the relays of the simulated clients follow the control engine.
+ *          A week on the schedule is run to compare the learned recovery in
+ *          recovery.c with a fixed lead. A day of up to ZONE_MAX rooms is run
+ *          through the zone table in zone.c and the actuation scheduler in
+ *          actuation.c to measure the control loop work per sample as the
+ *          zones grow, and the starts and indication bursts of the stagger.
+ *          It is a host tool, the firmware modules it runs are built from the
+ *          server sources with plain gcc, see the Makefile.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_THERMAL_SIM_H_
+#define TOOLS_THERMAL_SIM_H_
+
+#include <stdint.h>
+
+#include "control.h"
+#include "recovery.h"
+#include "zone.h"
+#include "actuation.h"
+
+
+#define THERMAL_SIM_DAY_S             (24 * 60 * 60)
+#define THERMAL_SIM_STEP_S            (10)
+#define THERMAL_SIM_MAX_FILTER_LEN    (8)
+
+// Estimated energy costs used for the simulated day
+#define THERMAL_SIM_UJ_PER_SAMPLE       (40)  // Sensor round, EM1 + I2C
+#define THERMAL_SIM_UJ_PER_INDICATION   (50)  // Indication and confirmation
+#define THERMAL_SIM_UJ_PER_CONN_EVENT   (12)  // Empty connection event
+#define THERMAL_SIM_CLIENTS             (2)
+
+// Week on a schedule of a night setback, for the recovery runs
+#define THERMAL_SIM_RECOVERY_DAYS       (7)
+#define THERMAL_SIM_SETBACK             (8)   // Night target below the day one
+#define THERMAL_SIM_DAY_START_SLOT      (24)  // 06:00
+#define THERMAL_SIM_NIGHT_START_SLOT    (88)  // 22:00
+#define THERMAL_SIM_FIXED_LEAD_S        (60 * 60)
+#define THERMAL_SIM_ARRIVAL_MF          (500) // Arrived once this close
+#define THERMAL_SIM_MAX_LATE_S          (3 * 60 * 60)
+#define THERMAL_SIM_COLD_OUTDOOR_MF     (20000)
+
+// Zone runs, every zone has two heaters and two ACs
+#define THERMAL_SIM_ZONE_ACTUATORS      (ZONE_MAX_ACTUATORS / ZONE_MAX)
+
+
+typedef enum {
+  THERMAL_SIM_RECOVERY_NONE = 0,  // Target changes at the transition
+  THERMAL_SIM_RECOVERY_FIXED,     // Target changes a fixed lead before
+  THERMAL_SIM_RECOVERY_LEARNED    // Target changes at the learned lead
+}thermal_sim_recovery_t;
+
+
+typedef struct {
+  uint32_t seed;                  // Seed of the sensor noise
+  int16_t target;                 // Target temperature in F
+  int32_t initial_mf;             // Temperatures in milli degree F
+  int32_t outdoor_mean_mf;
+  int32_t outdoor_swing_mf;       // Peak deviation over the day
+  uint32_t tau_s;                 // Time constant of the room
+  int32_t heat_rate_mf_per_h;     // Heating rate of the heater
+  int32_t cool_rate_mf_per_h;     // Cooling rate of the AC
+  int32_t noise_mc;               // Peak sensor noise in milli degree C
+  uint32_t sample_period_s;        // Multiple of THERMAL_SIM_STEP_S
+  uint8_t filter_len;             // Readings averaged before the control
+  uint16_t conn_interval_ms;
+  uint16_t conn_latency;
+}thermal_sim_params_t;
+
+typedef struct {
+  int32_t comfort_error_mf;       // Mean absolute error from the target
+  int32_t max_error_mf;
+  uint32_t actuator_cycles;       // Heater and AC starts
+  uint32_t indications;           // One per relay change
+  uint32_t legacy_indications;    // Indications of plain on/off control
+  uint32_t radio_energy_uj;
+  uint32_t cpu_energy_uj;
+}thermal_sim_result_t;
+
+typedef struct {
+  uint32_t transitions;           // Morning transitions measured
+  uint32_t arrival_error_s;       // Mean absolute error of the arrival time
+  int32_t max_late_s;             // Negative if always early
+  uint32_t runtime_s;             // Heater and AC on time over the week
+}thermal_sim_recovery_result_t;
+
+typedef struct {
+  uint32_t samples;               // Sensor samples over all the zones
+  uint32_t zones_run;             // Zones the control loop was run for
+  uint32_t actuator_visits;       // Actuators looked at by the scheduler
+  uint32_t actuator_cycles;       // Actuator starts
+  uint32_t peak_starts;           // Most starts in one step
+  uint32_t indications;           // One per command
+  uint32_t bursts;                // Scheduler runs that sent indications
+  uint32_t peak_burst;            // Most indications sent by one run
+  int32_t comfort_error_mf;       // Mean absolute error over the zones
+}thermal_sim_zones_result_t;
+
+
+/******************************************************************************
+ * @brief Loads a heating season day with the current firmware sampling and
+ * connection settings.
+ *
+ * @param
+ *  params  Parameters to be initialized
+ *
+ ******************************************************************************/
+void thermal_sim_default_params(thermal_sim_params_t *params);
+
+
+/******************************************************************************
+ * @brief Runs one day of the room with the given control configuration in
+ * virtual time. The run only depends on the configuration and the parameters,
+ * the same seed always gives the same result.
+ *
+ * @param
+ *  config  Control configuration under test
+ *  params  Room, sensor and link parameters
+ *  result  Comfort and energy figures of the simulated day
+ *
+ ******************************************************************************/
+void thermal_sim_run_day(const control_config_t *config,
+                         const thermal_sim_params_t *params,
+                         thermal_sim_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs a week on a schedule with a night setback. Every morning the
+ * time the room gets within THERMAL_SIM_ARRIVAL_MF of the day target is
+ * compared with the time of the transition. The learned recovery starts with
+ * an empty model, so the first mornings are included in its learning.
+ *
+ * @param
+ *  config  Control configuration
+ *  params  Room, sensor and link parameters, target is the day target
+ *  mode    When the day target is applied
+ *  result  Arrival and runtime figures of the week
+ *
+ ******************************************************************************/
+void thermal_sim_run_recovery(const control_config_t *config,
+                              const thermal_sim_params_t *params,
+                              thermal_sim_recovery_t mode,
+                              thermal_sim_recovery_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs one day of a building with zone_count rooms, each a zone with
+ * THERMAL_SIM_ZONE_ACTUATORS actuators. The zones are sampled every
+ * sample_period_s with staggered phases and go through the zone table and
+ * the actuation scheduler as the firmware does, the scheduler also runs on
+ * every step as its soft timer would.
+ *
+ * @param
+ *  params      Room, sensor and link parameters, the rooms start and are
+ *              targeted around them
+ *  zone_count  Number of zones, up to ZONE_MAX
+ *  run_all     Set to 1 to run every zone on every sample instead of only the
+ *              dirty ones, for comparison
+ *  stagger_s   Time between two actuator starts, 0 for none
+ *  result      Work and comfort figures of the day
+ *
+ ******************************************************************************/
+void thermal_sim_run_zones(const thermal_sim_params_t *params, uint8_t zone_count,
+                           uint8_t run_all, uint32_t stagger_s,
+                           thermal_sim_zones_result_t *result);
+
+
+/******************************************************************************
+ * @brief Runs a simulated day for the plain on/off control, the default
+ * deadband control and the PI control, and a week of recovery with no lead, a
+ * fixed lead and the learned lead, and the zone runs from 1 to ZONE_MAX zones,
+ * and prints them.
+ ******************************************************************************/
+void thermal_sim_report(void);
+
+
+#endif /* TOOLS_THERMAL_SIM_H_ */
@@ -0,0 +1,208 @@
+/*******************************************************************************
+ * @file    thermal_tuner.c
+ * @brief   Parameter sweep over the control and sampling settings using the
+ *          thermal simulator. See thermal_tuner.h for details.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "thermal_tuner.h"
+#include "thermal_sim.h"
+#include "control.h"
+
+
+#define ARRAY_LEN(a)    (sizeof(a) / sizeof((a)[0]))
+
+
+typedef struct {
+  uint32_t on_s;
+  uint32_t off_s;
+}min_times_t;
+
+static const int16_t g_deadbands[] = { 0, 1, 2 };
+static const min_times_t g_min_times[] = { { 0, 0 }, { 180, 300 }, { 600, 600 } };
+static const uint32_t g_sample_periods_s[] = { 30, 60, 120, 300 };
+static const uint8_t g_filter_lens[] = { 1, 2, 4 };
+static const uint16_t g_conn_latencies[] = { 0, 4, 9 };
+
+#define TUNER_GRID_POINTS   (ARRAY_LEN(g_deadbands) * ARRAY_LEN(g_min_times) * \
+                             ARRAY_LEN(g_sample_periods_s) * ARRAY_LEN(g_filter_lens) * \
+                             ARRAY_LEN(g_conn_latencies))
+
+
+typedef struct {
+  uint32_t grid_point;
+  int32_t comfort_error_mf;
+  uint32_t energy_uj;
+}tuner_point_t;
+
+typedef struct {
+  tuner_point_t front[THERMAL_TUNER_FRONT_MAX];
+  uint8_t front_count;
+  uint8_t front_overflow;
+}thermal_tuner_t;
+
+thermal_tuner_t g_thermal_tuner = {
+    .front_count = 0,
+    .front_overflow = 0
+};
+
+
+/******************************************************************************
+ * @brief Decodes the grid point index into a control configuration and the
+ * simulation parameters. Every index maps to exactly one combination so the
+ * sweep does not need to store the grid.
+ ******************************************************************************/
+static void decode_grid_point(uint32_t grid_point, control_config_t *config,
+                              thermal_sim_params_t *params)
+{
+  control_state_t ctl;
+  uint32_t index = grid_point;
+
+  control_init(&ctl, 0);
+  *config = ctl.config;
+  thermal_sim_default_params(params);
+
+  config->deadband = g_deadbands[index % ARRAY_LEN(g_deadbands)];
+  index /= ARRAY_LEN(g_deadbands);
+
+  config->min_on_time_s = g_min_times[index % ARRAY_LEN(g_min_times)].on_s;
+  config->min_off_time_s = g_min_times[index % ARRAY_LEN(g_min_times)].off_s;
+  index /= ARRAY_LEN(g_min_times);
+
+  params->sample_period_s = g_sample_periods_s[index % ARRAY_LEN(g_sample_periods_s)];
+  index /= ARRAY_LEN(g_sample_periods_s);
+
+  params->filter_len = g_filter_lens[index % ARRAY_LEN(g_filter_lens)];
+  index /= ARRAY_LEN(g_filter_lens);
+
+  params->conn_latency = g_conn_latencies[index % ARRAY_LEN(g_conn_latencies)];
+}
+
+
+/******************************************************************************
+ * @brief Adds the point to the Pareto front if no point on the front is at
+ * least as good in both comfort error and energy, and drops the points the new
+ * one dominates.
+ ******************************************************************************/
+static void front_insert(const tuner_point_t *point)
+{
+  uint8_t kept = 0;
+
+  for (uint8_t i = 0; i < g_thermal_tuner.front_count; i++) {
+      const tuner_point_t *other = &g_thermal_tuner.front[i];
+
+      if (other->comfort_error_mf <= point->comfort_error_mf &&
+          other->energy_uj <= point->energy_uj)
+        return;
+  }
+
+  for (uint8_t i = 0; i < g_thermal_tuner.front_count; i++) {
+      const tuner_point_t *other = &g_thermal_tuner.front[i];
+
+      if (point->comfort_error_mf <= other->comfort_error_mf &&
+          point->energy_uj <= other->energy_uj)
+        continue;
+
+      g_thermal_tuner.front[kept++] = *other;
+  }
+
+  g_thermal_tuner.front_count = kept;
+
+  if (g_thermal_tuner.front_count == THERMAL_TUNER_FRONT_MAX) {
+      g_thermal_tuner.front_overflow = 1;
+      return;
+  }
+
+  g_thermal_tuner.front[g_thermal_tuner.front_count++] = *point;
+}
+
+
+/******************************************************************************
+ * @brief Reports the Pareto front sorted by energy.
+ ******************************************************************************/
+static void front_report(void)
+{
+  // Insertion sort, the front holds at most THERMAL_TUNER_FRONT_MAX points
+  for (uint8_t i = 1; i < g_thermal_tuner.front_count; i++) {
+      tuner_point_t point = g_thermal_tuner.front[i];
+      uint8_t j = i;
+
+      while (j > 0 && g_thermal_tuner.front[j - 1].energy_uj > point.energy_uj) {
+          g_thermal_tuner.front[j] = g_thermal_tuner.front[j - 1];
+          j--;
+      }
+      g_thermal_tuner.front[j] = point;
+  }
+
+  printf("Tuner: %" PRIu32 " grid points, %u on the Pareto front%s\n",
+           (uint32_t)TUNER_GRID_POINTS, g_thermal_tuner.front_count,
+           g_thermal_tuner.front_overflow ? " (front full, some points dropped)" : "");
+
+  for (uint8_t i = 0; i < g_thermal_tuner.front_count; i++) {
+      control_config_t config;
+      thermal_sim_params_t params;
+
+      decode_grid_point(g_thermal_tuner.front[i].grid_point, &config, &params);
+
+      printf("Tuner: error %" PRId32 " mF, energy %" PRIu32 " uJ/day: deadband %d, min on %" PRIu32 " s, min off %" PRIu32 " s, sample %" PRIu32 " s, filter %u, latency %u\n",
+               g_thermal_tuner.front[i].comfort_error_mf,
+               g_thermal_tuner.front[i].energy_uj,
+               config.deadband,
+               config.min_on_time_s,
+               config.min_off_time_s,
+               params.sample_period_s,
+               params.filter_len,
+               params.conn_latency);
+  }
+}
+
+
+/******************************************************************************
+ * @brief Runs a grid point for every seed and adds its mean to the front.
+ ******************************************************************************/
+static void run_grid_point(uint32_t grid_point)
+{
+  control_config_t config;
+  thermal_sim_params_t params;
+  thermal_sim_result_t result;
+  tuner_point_t point = {
+      .grid_point = grid_point,
+      .comfort_error_mf = 0,
+      .energy_uj = 0
+  };
+
+  decode_grid_point(point.grid_point, &config, &params);
+
+  for (uint32_t seed = 1; seed <= THERMAL_TUNER_SEEDS; seed++) {
+      params.seed = seed;
+      thermal_sim_run_day(&config, &params, &result);
+
+      point.comfort_error_mf += result.comfort_error_mf;
+      point.energy_uj += result.radio_energy_uj + result.cpu_energy_uj;
+  }
+
+  point.comfort_error_mf /= THERMAL_TUNER_SEEDS;
+  point.energy_uj /= THERMAL_TUNER_SEEDS;
+
+  front_insert(&point);
+}
+
+
+/******************************************************************************
+ * SEE HEADER FILE FOR FULL DETAILS
+ * Runs the sweep and prints the Pareto front.
+ ******************************************************************************/
+void thermal_tuner_report(void)
+{
+  g_thermal_tuner.front_count = 0;
+  g_thermal_tuner.front_overflow = 0;
+
+  for (uint32_t grid_point = 0; grid_point < TUNER_GRID_POINTS; grid_point++)
+    run_grid_point(grid_point);
+
+  front_report();
+}
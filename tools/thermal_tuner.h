@@ -0,0 +1,26 @@
+/*******************************************************************************
+ * @file    thermal_tuner.h
+ * @brief   Parameter sweep over the control and sampling settings using the
+ *          thermal simulator. Every grid point is run for a fixed set of seeds
+ *          and the Pareto front of comfort error versus device energy is kept.
+ *
+ * @date    Oct 19, 2026
+ *
+ ******************************************************************************/
+#ifndef TOOLS_THERMAL_TUNER_H_
+#define TOOLS_THERMAL_TUNER_H_
+
+#include <stdint.h>
+
+
+#define THERMAL_TUNER_SEEDS           (3)   // Simulated days per grid point
+#define THERMAL_TUNER_FRONT_MAX       (16)
+
+
+/******************************************************************************
+ * @brief Runs every grid point of the sweep and prints the Pareto front.
+ ******************************************************************************/
+void thermal_tuner_report(void);
+
+
+#endif /* TOOLS_THERMAL_TUNER_H_ */